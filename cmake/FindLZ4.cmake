@@ -0,0 +1,44 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+#  Variables defined here
+#  LZ4_FOUND              System has lz4 libs/headers
+#  LZ4_LIBRARIES          The lz4 libraries
+#  LZ4_INCLUDE_DIR        The location of lz4 headers
+
+find_path(LZ4_INCLUDE_DIR
+  NAMES lz4.h
+  HINTS ${LZ4_ROOT_DIR}/include)
+
+find_library(LZ4_LIBRARY
+  NAMES lz4
+  HINTS ${LZ4_ROOT_DIR}/lib)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(
+  LZ4
+  DEFAULT_MSG
+  LZ4_LIBRARY
+  LZ4_INCLUDE_DIR)
+
+if (LZ4_FOUND)
+  set(LZ4_LIBRARIES ${LZ4_LIBRARY})
+endif()
+
+mark_as_advanced(
+  LZ4_ROOT_DIR
+  LZ4_LIBRARY
+  LZ4_INCLUDE_DIR)
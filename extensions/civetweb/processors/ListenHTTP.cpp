@@ -62,6 +62,20 @@ core::Property ListenHTTP::HeadersAsAttributesRegex("HTTP Headers to receive as
                                                     " should be passed along as FlowFile attributes",
                                                     "");
 
+core::Property ListenHTTP::BatchSize(
+    core::PropertyBuilder::createProperty("Batch Size")
+        ->withDescription("Maximum number of buffered FlowFiles that are committed in a single session when Buffer Size is set")
+        ->isRequired(false)
+        ->withDefaultValue<uint64_t>(1000)->build());
+
+core::Property ListenHTTP::BufferSize(
+    core::PropertyBuilder::createProperty("Buffer Size")
+        ->withDescription("Maximum number of received FlowFiles waiting to be committed. When set, requests are written to the content repository by the "
+                          "HTTP threads and committed in batches by the processor; requests that arrive while the buffer or an outgoing connection "
+                          "is full are answered with 503 Service Unavailable. 0 commits every request in its own session.")
+        ->isRequired(false)
+        ->withDefaultValue<uint64_t>(0)->build());
+
 core::Relationship ListenHTTP::Success("success", "All files are routed to success");
 
 void ListenHTTP::initialize() {
@@ -77,6 +91,8 @@ void ListenHTTP::initialize() {
   properties.insert(SSLVerifyPeer);
   properties.insert(SSLMinimumVersion);
   properties.insert(HeadersAsAttributesRegex);
+  properties.insert(BatchSize);
+  properties.insert(BufferSize);
   setSupportedProperties(properties);
   // Set the supported relationships
   std::set<core::Relationship> relationships;
@@ -145,6 +161,16 @@ void ListenHTTP::onSchedule(core::ProcessContext *context, core::ProcessSessionF
     logger_->log_debug("ListenHTTP using %s: %s", HeadersAsAttributesRegex.getName(), headersAsAttributesPattern);
   }
 
+  if (!context->getProperty(BatchSize.getName(), batch_size_) || batch_size_ == 0) {
+    batch_size_ = 1000;
+  }
+  if (!context->getProperty(BufferSize.getName(), buffer_size_)) {
+    buffer_size_ = 0;
+  }
+  if (buffer_size_ > 0) {
+    logger_->log_debug("ListenHTTP buffering up to %llu FlowFiles, committed in batches of %llu", buffer_size_, batch_size_);
+  }
+
   auto numThreads = getMaxConcurrentTasks();
 
   logger_->log_info("ListenHTTP starting HTTP server on port %s and path %s with %d threads", randomPort ? "random" : listeningPort, basePath, numThreads);
@@ -201,7 +227,7 @@ void ListenHTTP::onSchedule(core::ProcessContext *context, core::ProcessSessionF
   }
 
   server_.reset(new CivetServer(options));
-  handler_.reset(new Handler(basePath, context, sessionFactory, std::move(authDNPattern), std::move(headersAsAttributesPattern)));
+  handler_.reset(new Handler(basePath, context, sessionFactory, std::move(authDNPattern), std::move(headersAsAttributesPattern), buffer_size_ > 0 ? this : nullptr));
   server_->addHandler(basePath, handler_.get());
 
   if (randomPort) {
@@ -216,9 +242,44 @@ void ListenHTTP::onSchedule(core::ProcessContext *context, core::ProcessSessionF
 }
 
 ListenHTTP::~ListenHTTP() {
+  // stop the handlers before releasing what they buffered
+  server_.reset();
+  handler_.reset();
+  discardBuffered();
+}
+
+bool ListenHTTP::offer(const std::shared_ptr<FlowFileRecord> &flow_file) {
+  if (buffered_.fetch_add(1) >= buffer_size_ || flowFilesOutGoingFull()) {
+    buffered_--;
+    return false;
+  }
+  buffer_.enqueue(flow_file);
+  return true;
+}
+
+void ListenHTTP::discardBuffered() {
+  std::shared_ptr<FlowFileRecord> flow_file;
+  // the records release their claims, and with them the content, when they are destroyed
+  while (buffer_.try_dequeue(flow_file)) {
+    buffered_--;
+  }
 }
 
 void ListenHTTP::onTrigger(core::ProcessContext *context, core::ProcessSession *session) {
+  // Commit what the handler received since the last trigger in this session
+  std::shared_ptr<FlowFileRecord> received;
+  uint64_t batched = 0;
+  while (batched < batch_size_ && buffer_.try_dequeue(received)) {
+    buffered_--;
+    batched++;
+    session->add(received);
+    session->getProvenanceReporter()->receive(received, "http://" + getPort(), "", "ListenHTTP received FlowFile", 0);
+    session->transfer(received, Success);
+  }
+  if (batched > 0) {
+    logger_->log_debug("ListenHTTP committing %llu buffered FlowFiles", batched);
+  }
+
   std::shared_ptr<FlowFileRecord> flow_file = std::static_pointer_cast<FlowFileRecord>(session->get());
 
   // Do nothing if there are no incoming files
@@ -248,15 +309,63 @@ void ListenHTTP::onTrigger(core::ProcessContext *context, core::ProcessSession *
   session->remove(flow_file);
 }
 
-ListenHTTP::Handler::Handler(std::string base_uri, core::ProcessContext *context, core::ProcessSessionFactory *session_factory, std::string &&auth_dn_regex, std::string &&header_as_attrs_regex)
+ListenHTTP::Handler::Handler(std::string base_uri, core::ProcessContext *context, core::ProcessSessionFactory *session_factory, std::string &&auth_dn_regex, std::string &&header_as_attrs_regex,
+                             ListenHTTP *listener)
     : base_uri_(std::move(base_uri)),
       auth_dn_regex_(std::move(auth_dn_regex)),
       headers_as_attrs_regex_(std::move(header_as_attrs_regex)),
+      listener_(listener),
       logger_(logging::LoggerFactory<ListenHTTP::Handler>::getLogger()) {
   process_context_ = context;
   session_factory_ = session_factory;
 }
 
+bool ListenHTTP::Handler::buffer_request(struct mg_connection *conn, const mg_request_info *req_info, bool has_body) {
+  auto content_repo = process_context_->getContentRepository();
+  std::shared_ptr<ResourceClaim> claim;
+  uint64_t size = 0;
+  if (has_body) {
+    // The body goes straight into the content repository; only the flow file record waits for the commit
+    claim = std::make_shared<ResourceClaim>(content_repo);
+    auto stream = content_repo->write(claim);
+    if (nullptr == stream) {
+      send_error_response(conn);
+      return true;
+    }
+    ListenHTTP::WriteCallback callback(conn, req_info);
+    int64_t written = callback.process(stream);
+    stream->closeStream();
+    if (written < 0) {
+      content_repo->remove(claim);
+      send_error_response(conn);
+      return true;
+    }
+    size = static_cast<uint64_t>(written);
+  }
+
+  std::map<std::string, std::string> attributes;
+  auto flow_file = std::make_shared<FlowFileRecord>(process_context_->getFlowFileRepository(), content_repo, attributes, claim);
+  flow_file->setSize(size);
+  flow_file->setOffset(0);
+  set_header_attributes(req_info, flow_file);
+
+  if (!listener_->offer(flow_file)) {
+    logger_->log_debug("ListenHTTP buffer is full, rejecting request");
+    send_unavailable_response(conn);
+    return true;
+  }
+
+  mg_printf(conn, "HTTP/1.1 200 OK\r\n");
+  write_body(conn, req_info);
+  return true;
+}
+
+void ListenHTTP::Handler::send_unavailable_response(struct mg_connection *conn) {
+  mg_printf(conn, "HTTP/1.1 503 Service Unavailable\r\n"
+            "Content-Type: text/html\r\n"
+            "Content-Length: 0\r\n\r\n");
+}
+
 void ListenHTTP::Handler::send_error_response(struct mg_connection *conn) {
   mg_printf(conn, "HTTP/1.1 500 Internal Server Error\r\n"
             "Content-Type: text/html\r\n"
@@ -296,9 +405,19 @@ bool ListenHTTP::Handler::handlePost(CivetServer *server, struct mg_connection *
     return true;
   }
 
+  if (listener_ != nullptr && listener_->buffered_ >= listener_->buffer_size_) {
+    // Refuse before the client sends the body
+    send_unavailable_response(conn);
+    return true;
+  }
+
   // Always send 100 Continue, as allowed per standard to minimize client delay (https://www.w3.org/Protocols/rfc2616/rfc2616-sec8.html)
   mg_printf(conn, "HTTP/1.1 100 Continue\r\n\r\n");
 
+  if (listener_ != nullptr) {
+    return buffer_request(conn, req_info, true);
+  }
+
   auto session = session_factory_->createSession();
   ListenHTTP::WriteCallback callback(conn, req_info);
   auto flow_file = std::static_pointer_cast<FlowFileRecord>(session->create());
@@ -359,6 +478,10 @@ bool ListenHTTP::Handler::handleGet(CivetServer *server, struct mg_connection *c
     return true;
   }
 
+  if (listener_ != nullptr) {
+    return buffer_request(conn, req_info, false);
+  }
+
   auto session = session_factory_->createSession();
   auto flow_file = std::static_pointer_cast<FlowFileRecord>(session->create());
 
@@ -20,6 +20,7 @@
 #ifndef __LISTEN_HTTP_H__
 #define __LISTEN_HTTP_H__
 
+#include <atomic>
 #include <memory>
 #include <regex>
 
@@ -49,7 +50,10 @@ class ListenHTTP : public core::Processor {
    */
   ListenHTTP(std::string name, utils::Identifier uuid = utils::Identifier())
       : Processor(name, uuid),
-        logger_(logging::LoggerFactory<ListenHTTP>::getLogger()) {
+        logger_(logging::LoggerFactory<ListenHTTP>::getLogger()),
+        batch_size_(0),
+        buffer_size_(0),
+        buffered_(0) {
   }
   // Destructor
   virtual ~ListenHTTP();
@@ -64,6 +68,8 @@ class ListenHTTP : public core::Processor {
   static core::Property SSLVerifyPeer;
   static core::Property SSLMinimumVersion;
   static core::Property HeadersAsAttributesRegex;
+  static core::Property BatchSize;
+  static core::Property BufferSize;
   // Supported Relationships
   static core::Relationship Success;
 
@@ -86,7 +92,8 @@ class ListenHTTP : public core::Processor {
             core::ProcessContext *context,
             core::ProcessSessionFactory *sessionFactory,
             std::string &&authDNPattern,
-            std::string &&headersAsAttributesPattern);
+            std::string &&headersAsAttributesPattern,
+            ListenHTTP *listener = nullptr);
     bool handlePost(CivetServer *server, struct mg_connection *conn);
     bool handleGet(CivetServer *server, struct mg_connection *conn);
 
@@ -112,15 +119,21 @@ class ListenHTTP : public core::Processor {
    private:
     // Send HTTP 500 error response to client
     void send_error_response(struct mg_connection *conn);
+    // Send HTTP 503 response to client when the buffer is full
+    void send_unavailable_response(struct mg_connection *conn);
     bool auth_request(mg_connection *conn, const mg_request_info *req_info) const;
     void set_header_attributes(const mg_request_info *req_info, const std::shared_ptr<FlowFileRecord> &flow_file) const;
     void write_body(mg_connection *conn, const mg_request_info *req_info);
+    // Hands a received flow file to the processor instead of committing it here
+    bool buffer_request(struct mg_connection *conn, const mg_request_info *req_info, bool has_body);
 
     std::string base_uri_;
     std::regex auth_dn_regex_;
     std::regex headers_as_attrs_regex_;
     core::ProcessContext *process_context_;
     core::ProcessSessionFactory *session_factory_;
+    // set when received flow files are buffered for the processor to commit in batches
+    ListenHTTP *listener_;
 
     // Logger
     std::shared_ptr<logging::Logger> logger_;
@@ -167,9 +180,21 @@ class ListenHTTP : public core::Processor {
   // Logger
   std::shared_ptr<logging::Logger> logger_;
 
+  // Buffers a flow file received by the handler, unless the buffer or an outgoing connection is full
+  bool offer(const std::shared_ptr<FlowFileRecord> &flow_file);
+  // Releases the content of flow files that were received but never committed
+  void discardBuffered();
+
   std::unique_ptr<CivetServer> server_;
   std::unique_ptr<Handler> handler_;
   std::string listeningPort;
+
+  // maximum number of buffered flow files committed per trigger
+  uint64_t batch_size_;
+  // maximum number of buffered flow files, 0 if requests are committed by the handler
+  uint64_t buffer_size_;
+  std::atomic<uint64_t> buffered_;
+  moodycamel::ConcurrentQueue<std::shared_ptr<FlowFileRecord>> buffer_;
 };
 
 REGISTER_RESOURCE(ListenHTTP, "Starts an HTTP Server and listens on a given base path to transform incoming requests into FlowFiles. The default URI of the Service will be "
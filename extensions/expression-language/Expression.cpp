@@ -28,6 +28,7 @@
 #include <utils/StringUtils.h>
 #include <expression/Expression.h>
 #include <regex>
+#include <unordered_map>
 #ifndef DISABLE_CURL
 #include <curl/curl.h>
 #endif
@@ -722,6 +723,25 @@ Value expr_base64Decode(const std::vector<Value> &args) {
 
 #ifdef EXPRESSION_LANGUAGE_USE_REGEX
 
+/**
+ * Returns the compiled regex for the pattern. Patterns rarely change between evaluations, so the
+ * compiled regexes are cached per thread rather than compiled on every evaluation.
+ */
+std::shared_ptr<const std::regex> get_regex(const std::string &pattern) {
+  static const size_t MAX_CACHED_REGEXES = 64;
+  static thread_local std::unordered_map<std::string, std::shared_ptr<const std::regex>> regexes;
+  auto cached = regexes.find(pattern);
+  if (cached != regexes.end()) {
+    return cached->second;
+  }
+  auto regex = std::make_shared<const std::regex>(pattern);
+  if (regexes.size() >= MAX_CACHED_REGEXES) {
+    regexes.clear();
+  }
+  regexes.emplace(pattern, regex);
+  return regex;
+}
+
 Value expr_replace(const std::vector<Value> &args) {
   std::string result = args[0].asString();
   const std::string &find = args[1].asString();
@@ -740,16 +760,16 @@ Value expr_replace(const std::vector<Value> &args) {
 
 Value expr_replaceFirst(const std::vector<Value> &args) {
   std::string result = args[0].asString();
-  const std::regex find(args[1].asString());
+  const auto find = get_regex(args[1].asString());
   const std::string &replace = args[2].asString();
-  return Value(std::regex_replace(result, find, replace, std::regex_constants::format_first_only));
+  return Value(std::regex_replace(result, *find, replace, std::regex_constants::format_first_only));
 }
 
 Value expr_replaceAll(const std::vector<Value> &args) {
   std::string result = args[0].asString();
-  const std::regex find(args[1].asString());
+  const auto find = get_regex(args[1].asString());
   const std::string &replace = args[2].asString();
-  return Value(std::regex_replace(result, find, replace));
+  return Value(std::regex_replace(result, *find, replace));
 }
 
 Value expr_replaceNull(const std::vector<Value> &args) {
@@ -762,23 +782,23 @@ Value expr_replaceNull(const std::vector<Value> &args) {
 
 Value expr_replaceEmpty(const std::vector<Value> &args) {
   std::string result = args[0].asString();
-  const std::regex find("^[ \n\r\t]*$");
+  static const std::regex find("^[ \n\r\t]*$");
   const std::string &replace = args[1].asString();
   return Value(std::regex_replace(result, find, replace));
 }
 
 Value expr_matches(const std::vector<Value> &args) {
   const auto &subject = args[0].asString();
-  const std::regex expr = std::regex(args[1].asString());
+  const auto expr = get_regex(args[1].asString());
 
-  return Value(std::regex_match(subject.begin(), subject.end(), expr));
+  return Value(std::regex_match(subject.begin(), subject.end(), *expr));
 }
 
 Value expr_find(const std::vector<Value> &args) {
   const auto &subject = args[0].asString();
-  const std::regex expr = std::regex(args[1].asString());
+  const auto expr = get_regex(args[1].asString());
 
-  return Value(std::regex_search(subject.begin(), subject.end(), expr));
+  return Value(std::regex_search(subject.begin(), subject.end(), *expr));
 }
 
 #endif  // EXPRESSION_LANGUAGE_USE_REGEX
@@ -894,7 +914,8 @@ Value expr_random(const std::vector<Value> &args) {
 }
 
 template<Value T(const std::vector<Value> &)>
-Expression make_dynamic_function_incomplete(const std::string &function_name, const std::vector<Expression> &args, std::size_t num_args) {
+Expression make_dynamic_function_incomplete(const std::string &function_name, const std::vector<Expression> &args, std::size_t num_args,
+                                            bool deterministic = true) {
 
   if (args.size() < num_args) {
     std::stringstream message_ss;
@@ -913,17 +934,32 @@ Expression make_dynamic_function_incomplete(const std::string &function_name, co
       return T(args);
     },
                                  multi_args);
-  } else {
-    return make_dynamic([=](const Parameters &params, const std::vector<Expression> &sub_exprs) -> Value {
-      std::vector<Value> evaluated_args;
-
-      for (const auto &arg : args) {
-        evaluated_args.emplace_back(arg(params));
-      }
+  }
 
-      return T(evaluated_args);
-    });
+  // fold calls whose arguments are all known at compile time into their result
+  if (deterministic && std::none_of(args.begin(), args.end(), [](const Expression &arg) {return arg.is_dynamic();})) {
+    std::vector<Value> evaluated_args;
+    evaluated_args.reserve(args.size());
+    for (const auto &arg : args) {
+      evaluated_args.emplace_back(arg(Parameters()));
+    }
+    try {
+      return Expression(T(evaluated_args));
+    } catch (const std::exception &) {
+      // leave the error to be raised on evaluation, as without folding
+    }
   }
+
+  return make_dynamic([=](const Parameters &params, const std::vector<Expression> &sub_exprs) -> Value {
+    std::vector<Value> evaluated_args;
+    evaluated_args.reserve(args.size());
+
+    for (const auto &arg : args) {
+      evaluated_args.emplace_back(arg(params));
+    }
+
+    return T(evaluated_args);
+  });
 }
 
 Value expr_literal(const std::vector<Value> &args) {
@@ -1135,7 +1171,7 @@ Expression make_allMatchingAttributes(const std::string &function_name, const st
     std::vector<Expression> out_exprs;
 
     for (const auto &arg : args) {
-      const std::regex attr_regex = std::regex(arg(params).asString());
+      const auto attr_regex = get_regex(arg(params).asString());
       const auto cur_flow_file = params.flow_file.lock();
       std::map<std::string, std::string> attrs;
 
@@ -1144,7 +1180,7 @@ Expression make_allMatchingAttributes(const std::string &function_name, const st
       }
 
       for (const auto &attr : attrs) {
-        if (std::regex_match(attr.first.begin(), attr.first.end(), attr_regex)) {
+        if (std::regex_match(attr.first.begin(), attr.first.end(), *attr_regex)) {
           out_exprs.emplace_back(make_dynamic([=](const Parameters &params,
                       const std::vector<Expression> &sub_exprs) -> Value {
                     std::string attr_val;
@@ -1188,7 +1224,7 @@ Expression make_anyMatchingAttribute(const std::string &function_name, const std
     std::vector<Expression> out_exprs;
 
     for (const auto &arg : args) {
-      const std::regex attr_regex = std::regex(arg(params).asString());
+      const auto attr_regex = get_regex(arg(params).asString());
       const auto cur_flow_file = params.flow_file.lock();
       std::map<std::string, std::string> attrs;
 
@@ -1197,7 +1233,7 @@ Expression make_anyMatchingAttribute(const std::string &function_name, const std
       }
 
       for (const auto &attr : attrs) {
-        if (std::regex_match(attr.first.begin(), attr.first.end(), attr_regex)) {
+        if (std::regex_match(attr.first.begin(), attr.first.end(), *attr_regex)) {
           out_exprs.emplace_back(make_dynamic([=](const Parameters &params,
                       const std::vector<Expression> &sub_exprs) -> Value {
                     std::string attr_val;
@@ -1344,11 +1380,11 @@ Expression make_join(const std::string &function_name, const std::vector<Express
 
 Expression make_dynamic_function(const std::string &function_name, const std::vector<Expression> &args) {
   if (function_name == "hostname") {
-    return make_dynamic_function_incomplete<expr_hostname>(function_name, args, 0);
+    return make_dynamic_function_incomplete<expr_hostname>(function_name, args, 0, false);
   } else if (function_name == "ip") {
-    return make_dynamic_function_incomplete<expr_ip>(function_name, args, 0);
+    return make_dynamic_function_incomplete<expr_ip>(function_name, args, 0, false);
   } else if (function_name == "UUID") {
-    return make_dynamic_function_incomplete<expr_uuid>(function_name, args, 0);
+    return make_dynamic_function_incomplete<expr_uuid>(function_name, args, 0, false);
   } else if (function_name == "toUpper") {
     return make_dynamic_function_incomplete<expr_toUpper>(function_name, args, 1);
   } else if (function_name == "toLower") {
@@ -1448,7 +1484,7 @@ Expression make_dynamic_function(const std::string &function_name, const std::ve
   } else if (function_name == "toRadix") {
     return make_dynamic_function_incomplete<expr_toRadix>(function_name, args, 1);
   } else if (function_name == "random") {
-    return make_dynamic_function_incomplete<expr_random>(function_name, args, 0);
+    return make_dynamic_function_incomplete<expr_random>(function_name, args, 0, false);
   } else if (function_name == "literal") {
     return make_dynamic_function_incomplete<expr_literal>(function_name, args, 1);
   } else if (function_name == "isNull") {
@@ -1496,7 +1532,7 @@ Expression make_dynamic_function(const std::string &function_name, const std::ve
     return make_dynamic_function_incomplete<expr_toDate>(function_name, args, 1);
 #endif  // EXPRESSION_LANGUAGE_USE_DATE
   } else if (function_name == "now") {
-    return make_dynamic_function_incomplete<expr_now>(function_name, args, 0);
+    return make_dynamic_function_incomplete<expr_now>(function_name, args, 0, false);
   } else {
     std::string msg("Unknown expression function: ");
     msg.append(function_name);
@@ -1572,7 +1608,8 @@ Expression Expression::operator+(const Expression &other_expr) const {
 
 Value Expression::operator()(const Parameters &params) const {
   if (is_dynamic()) {
-    return val_fn_(params, sub_expr_generator_(params));
+    // only multi-expressions generate sub-expressions
+    return is_multi_ ? val_fn_(params, sub_expr_generator_(params)) : val_fn_(params, {});
   } else {
     return val_;
   }
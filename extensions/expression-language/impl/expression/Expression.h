@@ -70,7 +70,8 @@ static const std::function<Value(const Parameters &params, const std::vector<Exp
 class Expression {
  public:
 
-  Expression() {
+  Expression()
+      : is_multi_(false) {
     val_fn_ = NOOP_FN;
   }
 
@@ -146,6 +147,8 @@ class Expression {
 
 /**
  * Compiles an expression from a string in the NiFi expression language syntax.
+ * Function calls whose arguments are all literals are evaluated once, at compile
+ * time, unless the function's result varies between calls (e.g. now, UUID).
  *
  * @param expr_str
  * @return
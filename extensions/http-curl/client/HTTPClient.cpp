@@ -25,6 +25,7 @@
 #include <algorithm>
 #include "utils/StringUtils.h"
 #include "utils/RegexUtils.h"
+#include "HTTPConnectionPool.h"
 
 namespace org {
 namespace apache {
@@ -234,6 +235,11 @@ bool HTTPClient::submit() {
   }
 
   curl_easy_setopt(http_session_, CURLOPT_URL, url_.c_str());
+  // reuse the DNS entries and TLS sessions left behind by earlier clients
+  curl_easy_setopt(http_session_, CURLOPT_SHARE, HTTPConnectionPool::getInstance().getShare(isSecure(url_) ? ssl_context_service_ : nullptr));
+  if (HTTPConnectionPool::supportsHTTP2()) {
+    curl_easy_setopt(http_session_, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+  }
   logger_->log_debug("Submitting to %s", url_);
   if (callback == nullptr) {
     content_.ptr = &read_callback_;
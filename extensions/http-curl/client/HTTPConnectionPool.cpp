@@ -0,0 +1,116 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "HTTPConnectionPool.h"
+#include <memory>
+#include <utility>
+#include "core/logging/LoggerConfiguration.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+HTTPConnectionPool::HTTPConnectionPool()
+    : logger_(logging::LoggerFactory<HTTPConnectionPool>::getLogger()) {
+}
+
+HTTPConnectionPool::~HTTPConnectionPool() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (plain_ != nullptr) {
+    curl_share_cleanup(plain_->share_);
+  }
+  for (const auto &secure : secure_) {
+    curl_share_cleanup(secure.second->share_);
+  }
+  for (const auto &retired : retired_) {
+    curl_share_cleanup(retired->share_);
+  }
+}
+
+CURLSH *HTTPConnectionPool::getShare(const std::shared_ptr<minifi::controllers::SSLContextService> &ssl_context_service) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (ssl_context_service == nullptr) {
+    if (plain_ == nullptr) {
+      plain_ = createShare(nullptr);
+    }
+    return plain_->share_;
+  }
+
+  removeExpired();
+  auto &share = secure_[ssl_context_service.get()];
+  if (share == nullptr || share->ssl_context_service_.lock() != ssl_context_service) {
+    // a new service was allocated where an expired one lived, whose share is still in use
+    if (share != nullptr) {
+      retired_.push_back(std::move(share));
+    }
+    share = createShare(ssl_context_service);
+  }
+  return share->share_;
+}
+
+bool HTTPConnectionPool::supportsHTTP2() {
+  static const bool http2 = (curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2) != 0;
+  return http2;
+}
+
+std::unique_ptr<HTTPConnectionPool::Share> HTTPConnectionPool::createShare(const std::shared_ptr<minifi::controllers::SSLContextService> &ssl_context_service) {
+  std::unique_ptr<Share> share(new Share());
+  share->ssl_context_service_ = ssl_context_service;
+  share->share_ = curl_share_init();
+  curl_share_setopt(share->share_, CURLSHOPT_LOCKFUNC, &HTTPConnectionPool::lock);
+  curl_share_setopt(share->share_, CURLSHOPT_UNLOCKFUNC, &HTTPConnectionPool::unlock);
+  curl_share_setopt(share->share_, CURLSHOPT_USERDATA, static_cast<void*>(share.get()));
+  curl_share_setopt(share->share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(share->share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  // the connection cache is not shared: libcurl does not support using it from concurrent threads
+  logger_->log_debug("Created curl share for %s connections", ssl_context_service == nullptr ? "plain" : ssl_context_service->getName());
+  return share;
+}
+
+void HTTPConnectionPool::removeExpired() {
+  for (auto it = secure_.begin(); it != secure_.end();) {
+    // a share that a client still uses cannot be cleaned up; it is retried on the next call
+    if (it->second->ssl_context_service_.expired() && curl_share_cleanup(it->second->share_) == CURLSHE_OK) {
+      it = secure_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (auto it = retired_.begin(); it != retired_.end();) {
+    if (curl_share_cleanup((*it)->share_) == CURLSHE_OK) {
+      it = retired_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void HTTPConnectionPool::lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *share) {
+  static_cast<Share*>(share)->locks_[data].lock();
+}
+
+void HTTPConnectionPool::unlock(CURL *handle, curl_lock_data data, void *share) {
+  static_cast<Share*>(share)->locks_[data].unlock();
+}
+
+} /* namespace utils */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
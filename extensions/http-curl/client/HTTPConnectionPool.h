@@ -0,0 +1,99 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef EXTENSIONS_HTTP_CURL_CLIENT_HTTPCONNECTIONPOOL_H_
+#define EXTENSIONS_HTTP_CURL_CLIENT_HTTPCONNECTIONPOOL_H_
+
+#include <curl/curl.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "controllers/SSLContextService.h"
+#include "core/logging/Logger.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Purpose and Justification: Every HTTPClient owns its own curl easy handle, so without sharing each
+ * request resolves the host and performs a full TLS handshake again. The pool hands out curl share
+ * handles that hold the DNS cache and the TLS session cache, so that a client resumes the sessions
+ * that earlier clients negotiated.
+ *
+ * Design: One share exists per SSL context service, and one for plain connections, so that a TLS
+ * session is only resumed with the credentials it was established with. Open connections are not
+ * shared, since libcurl's shared connection cache is not safe to use from concurrent threads.
+ */
+class HTTPConnectionPool {
+ public:
+  static HTTPConnectionPool &getInstance() {
+    static HTTPConnectionPool pool;
+    return pool;
+  }
+
+  ~HTTPConnectionPool();
+
+  /**
+   * Returns the share for connections using the given SSL context service, which may be null.
+   */
+  CURLSH *getShare(const std::shared_ptr<minifi::controllers::SSLContextService> &ssl_context_service);
+
+  /**
+   * Returns whether libcurl negotiates HTTP/2 over TLS, which lets requests to the same origin
+   * share one connection.
+   */
+  static bool supportsHTTP2();
+
+ private:
+  struct Share {
+    std::weak_ptr<minifi::controllers::SSLContextService> ssl_context_service_;
+    CURLSH *share_;
+    std::mutex locks_[CURL_LOCK_DATA_LAST];
+  };
+
+  HTTPConnectionPool();
+
+  std::unique_ptr<Share> createShare(const std::shared_ptr<minifi::controllers::SSLContextService> &ssl_context_service);
+
+  // drops the shares of SSL context services that no longer exist and are not used by a client
+  void removeExpired();
+
+  static void lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *share);
+
+  static void unlock(CURL *handle, curl_lock_data data, void *share);
+
+  std::mutex mutex_;
+  std::unique_ptr<Share> plain_;
+  std::map<const minifi::controllers::SSLContextService*, std::unique_ptr<Share>> secure_;
+  // shares displaced from secure_ while clients still used them
+  std::vector<std::unique_ptr<Share>> retired_;
+
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+} /* namespace utils */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* EXTENSIONS_HTTP_CURL_CLIENT_HTTPCONNECTIONPOOL_H_ */
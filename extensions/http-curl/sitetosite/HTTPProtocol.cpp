@@ -55,6 +55,8 @@ std::shared_ptr<Transaction> HttpSiteToSiteClient::createTransaction(std::string
   uri << getBaseURI() << "data-transfer/" << dir_str << "/" << getPortId() << "/transactions";
   auto client = create_http_client(uri.str(), "POST");
   client->appendHeader(PROTOCOL_VERSION_HEADER, "1");
+  if (use_compression_)
+    client->appendHeader(USE_COMPRESSION_HEADER, "true");
   client->setConnectionTimeout(5);
   client->setContentType("application/json");
   client->appendHeader("Accept: application/json");
@@ -90,6 +92,8 @@ std::shared_ptr<Transaction> HttpSiteToSiteClient::createTransaction(std::string
         }
 
         client->appendHeader(PROTOCOL_VERSION_HEADER, "1");
+        if (use_compression_)
+          client->appendHeader(USE_COMPRESSION_HEADER, "true");
         peer_->setStream(std::unique_ptr<io::DataStream>(new io::HttpStream(client)));
         transactionID = transaction->getUUIDStr();
         logger_->log_debug("Created transaction id -%s-", transactionID);
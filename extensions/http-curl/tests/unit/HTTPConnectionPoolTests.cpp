@@ -0,0 +1,92 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <memory>
+#include <string>
+#include <vector>
+#include "TestBase.h"
+#include "HTTPClient.h"
+#include "HTTPConnectionPool.h"
+#include "CivetServer.h"
+#include "../TestServer.h"
+
+namespace {
+
+/**
+ * Answers every request with the value of its X-Test header, or "none" without one.
+ */
+class EchoHeaderHandler : public CivetHandler {
+ public:
+  bool handleGet(CivetServer *server, struct mg_connection *conn) {
+    const char *header = mg_get_header(conn, "X-Test");
+    std::string body = header == nullptr ? "none" : header;
+    mg_printf(conn, "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: %lu\r\n\r\n", body.length());
+    mg_printf(conn, "%s", body.c_str());
+    return true;
+  }
+};
+
+std::string get(const std::string &url, const std::string &header) {
+  utils::HTTPClient client(url, std::shared_ptr<minifi::controllers::SSLContextService>());
+  client.initialize("GET");
+  if (!header.empty()) {
+    client.appendHeader("X-Test", header);
+  }
+  REQUIRE(client.submit());
+  REQUIRE(200 == client.getResponseCode());
+  const auto &body = client.getResponseBody();
+  return std::string(body.data(), body.size());
+}
+
+}  // namespace
+
+TEST_CASE("HTTPConnectionPool hands out one share per SSL context service", "[HTTPConnectionPool1]") {
+  TestController testController;
+  auto &pool = utils::HTTPConnectionPool::getInstance();
+  auto first = std::make_shared<minifi::controllers::SSLContextService>("first");
+  auto second = std::make_shared<minifi::controllers::SSLContextService>("second");
+
+  CURLSH *plain = pool.getShare(nullptr);
+  REQUIRE(plain != nullptr);
+  REQUIRE(plain == pool.getShare(nullptr));
+
+  CURLSH *first_share = pool.getShare(first);
+  REQUIRE(first_share != nullptr);
+  REQUIRE(first_share == pool.getShare(first));
+  REQUIRE(first_share != plain);
+
+  CURLSH *second_share = pool.getShare(second);
+  REQUIRE(second_share != first_share);
+  REQUIRE(second_share != plain);
+}
+
+TEST_CASE("HTTPConnectionPool requests through a share do not see each other's options", "[HTTPConnectionPool2]") {
+  TestController testController;
+  std::string port = "8097";
+  std::string path = "/echo";
+  EchoHeaderHandler handler;
+  init_webserver();
+  CivetServer *server = start_webserver(port, path, &handler);
+  std::string url = "http://localhost:" + port + path;
+
+  // the clients resolve the host through the same share, but every request starts from its own options
+  REQUIRE("first" == get(url, "first"));
+  REQUIRE("none" == get(url, ""));
+  REQUIRE("second" == get(url, "second"));
+
+  stop_webserver(server);
+}
@@ -44,6 +44,7 @@ core::Property BinFiles::MinEntries("Minimum Number of Entries", "The minimum nu
 core::Property BinFiles::MaxEntries("Maximum Number of Entries", "The maximum number of files to include in a bundle. If not specified, there is no maximum.", "");
 core::Property BinFiles::MaxBinAge("Max Bin Age", "The maximum age of a Bin that will trigger a Bin to be complete. Expected format is <duration> <time unit>", "");
 core::Property BinFiles::MaxBinCount("Maximum number of Bins", "Specifies the maximum number of bins that can be held in memory at any one time", "100");
+core::Property BinFiles::BatchSize("Batch Size", "Maximum number of FlowFiles taken from the incoming connections and binned per trigger", "1");
 core::Relationship BinFiles::Original("original", "The FlowFiles that were used to create the bundle");
 core::Relationship BinFiles::Failure("failure", "If the bundle cannot be created, all FlowFiles that would have been used to created the bundle will be transferred to failure");
 const char *BinFiles::FRAGMENT_COUNT_ATTRIBUTE = "fragment.count";
@@ -64,6 +65,7 @@ void BinFiles::initialize() {
   properties.insert(MaxEntries);
   properties.insert(MaxBinAge);
   properties.insert(MaxBinCount);
+  properties.insert(BatchSize);
   setSupportedProperties(properties);
   // Set the supported relationships
   std::set<core::Relationship> relationships;
@@ -107,6 +109,11 @@ void BinFiles::onSchedule(core::ProcessContext *context, core::ProcessSessionFac
       logger_->log_debug("BinFiles: MaxBinAge [%d]", valInt);
     }
   }
+  value = "";
+  if (context->getProperty(BatchSize.getName(), value) && !value.empty() && core::Property::StringToInt(value, valInt) && valInt > 0) {
+    batchSize_ = static_cast<uint32_t>(valInt);
+    logger_->log_debug("BinFiles: BatchSize [%d]", valInt);
+  }
 }
 
 void BinFiles::preprocessFlowFile(core::ProcessContext *context, core::ProcessSession *session, std::shared_ptr<core::FlowFile> flow) {
@@ -235,23 +242,28 @@ bool BinManager::offer(const std::string &group, std::shared_ptr<core::FlowFile>
 }
 
 void BinFiles::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
-  std::shared_ptr<FlowFileRecord> flow = std::static_pointer_cast < FlowFileRecord > (session->get());
-
-  if (flow != nullptr) {
+  bool failed = false;
+  for (const auto &flowFile : session->get(batchSize_)) {
+    std::shared_ptr<FlowFileRecord> flow = std::static_pointer_cast < FlowFileRecord > (flowFile);
     preprocessFlowFile(context.get(), session.get(), flow);
     std::string groupId = getGroupId(context.get(), flow);
 
     bool offer = this->binManager_.offer(groupId, flow);
     if (!offer) {
       session->transfer(flow, Failure);
-      context->yield();
-      return;
+      failed = true;
+      continue;
     }
 
     // remove the flowfile from the process session, it add to merge session later.
     session->remove(flow);
   }
 
+  if (failed) {
+    context->yield();
+    return;
+  }
+
   // migrate bin to ready bin
   this->binManager_.gatherReadyBins();
   if (this->binManager_.getBinCount() > maxBinCount_) {
@@ -19,11 +19,13 @@
  */
 #include "CompressContent.h"
 #include <stdio.h>
+#include <string.h>
 #include <algorithm>
 #include <memory>
 #include <string>
 #include <map>
 #include <set>
+#include <zlib.h>
 #include "utils/TimeUtil.h"
 #include "utils/StringUtils.h"
 #include "core/ProcessContext.h"
@@ -35,10 +37,17 @@ namespace nifi {
 namespace minifi {
 namespace processors {
 
-core::Property CompressContent::CompressLevel("Compression Level", "The compression level to use; this is valid only when using GZIP compression.", "1");
+core::Property CompressContent::CompressLevel("Compression Level", "The compression level to use; this is valid only when using GZIP, LZ4 or ZSTD compression.", "1");
 core::Property CompressContent::CompressMode("Mode", "Indicates whether the processor should compress content or decompress content.", MODE_COMPRESS);
 core::Property CompressContent::CompressFormat("Compression Format", "The compression format to use.", COMPRESSION_FORMAT_ATTRIBUTE);
 core::Property CompressContent::UpdateFileName("Update Filename", "Determines if filename extension need to be updated", "false");
+core::Property CompressContent::CompressThreads(
+    core::PropertyBuilder::createProperty("Compression Threads")->withDescription("The number of threads used to compress a single FlowFile. GZIP content larger than the "
+                                                                                  "Parallel Block Size is split into blocks that are compressed concurrently, and ZSTD "
+                                                                                  "compresses with this many workers when libzstd supports them.")->withDefaultValue<int>(1)->build());
+core::Property CompressContent::BlockSize(
+    core::PropertyBuilder::createProperty("Parallel Block Size")->withDescription("The amount of uncompressed data in each block of parallel GZIP compression. "
+                                                                                  "Every block is written as a separate gzip member.")->withDefaultValue<core::DataSizeValue>("1 MB")->build());
 core::Relationship CompressContent::Success("success", "FlowFiles will be transferred to the success relationship after successfully being compressed or decompressed");
 core::Relationship CompressContent::Failure("failure", "FlowFiles will be transferred to the failure relationship if they fail to compress/decompress");
 
@@ -49,6 +58,8 @@ void CompressContent::initialize() {
   properties.insert(CompressMode);
   properties.insert(CompressFormat);
   properties.insert(UpdateFileName);
+  properties.insert(CompressThreads);
+  properties.insert(BlockSize);
   setSupportedProperties(properties);
   // Set the supported relationships
   std::set<core::Relationship> relationships;
@@ -74,17 +85,49 @@ void CompressContent::onSchedule(core::ProcessContext *context, core::ProcessSes
   if (context->getProperty(UpdateFileName.getName(), value) && !value.empty()) {
     org::apache::nifi::minifi::utils::StringUtils::StringToBool(value, updateFileName_);
   }
-  logger_->log_info("Compress Content: Mode [%s] Format [%s] Level [%d] UpdateFileName [%d]", compressMode_, compressFormat_, compressLevel_, updateFileName_);
+  value = "";
+  if (context->getProperty(CompressThreads.getName(), value) && !value.empty()) {
+    core::Property::StringToInt(value, compressThreads_);
+  }
+  value = "";
+  if (context->getProperty(BlockSize.getName(), value) && !value.empty()) {
+    core::Property::StringToInt(value, blockSize_);
+  }
+  if (compressThreads_ < 1) {
+    compressThreads_ = 1;
+  }
+  if (blockSize_ == 0) {
+    blockSize_ = 1024 * 1024;
+  }
+  logger_->log_info("Compress Content: Mode [%s] Format [%s] Level [%d] UpdateFileName [%d] Threads [%d]", compressMode_, compressFormat_, compressLevel_, updateFileName_, compressThreads_);
+  if (pool_) {
+    pool_->shutdown();
+    pool_ = nullptr;
+  }
+  if (compressThreads_ > 1) {
+    pool_ = std::unique_ptr<utils::ThreadPool<bool>>(new utils::ThreadPool<bool>(compressThreads_, false, nullptr, "CompressContent"));
+    pool_->start();
+  }
   // update the mimeTypeMap
   compressionFormatMimeTypeMap_["application/gzip"] = COMPRESSION_FORMAT_GZIP;
   compressionFormatMimeTypeMap_["application/bzip2"] = COMPRESSION_FORMAT_BZIP2;
   compressionFormatMimeTypeMap_["application/x-bzip2"] = COMPRESSION_FORMAT_BZIP2;
   compressionFormatMimeTypeMap_["application/x-lzma"] = COMPRESSION_FORMAT_LZMA;
   compressionFormatMimeTypeMap_["application/x-xz"] = COMPRESSION_FORMAT_XZ_LZMA2;
+  compressionFormatMimeTypeMap_["application/x-lz4"] = COMPRESSION_FORMAT_LZ4;
+  compressionFormatMimeTypeMap_["application/zstd"] = COMPRESSION_FORMAT_ZSTD;
   fileExtension_[COMPRESSION_FORMAT_GZIP] = ".gz";
   fileExtension_[COMPRESSION_FORMAT_LZMA] = ".lzma";
   fileExtension_[COMPRESSION_FORMAT_BZIP2] = ".bz2";
   fileExtension_[COMPRESSION_FORMAT_XZ_LZMA2] = ".xz";
+  fileExtension_[COMPRESSION_FORMAT_LZ4] = ".lz4";
+  fileExtension_[COMPRESSION_FORMAT_ZSTD] = ".zst";
+}
+
+void CompressContent::notifyStop() {
+  if (pool_) {
+    pool_->shutdown();
+  }
 }
 
 void CompressContent::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
@@ -122,6 +165,14 @@ void CompressContent::onTrigger(const std::shared_ptr<core::ProcessContext> &con
     mimeType = "application/x-lzma";
   } else if (compressFormat == COMPRESSION_FORMAT_XZ_LZMA2) {
     mimeType = "application/x-xz";
+#ifdef LZ4_SUPPORT
+  } else if (compressFormat == COMPRESSION_FORMAT_LZ4) {
+    mimeType = "application/x-lz4";
+#endif
+#ifdef ZSTD_SUPPORT
+  } else if (compressFormat == COMPRESSION_FORMAT_ZSTD) {
+    mimeType = "application/zstd";
+#endif
   } else {
     logger_->log_error("Compress format is invalid %s", compressFormat);
     session->transfer(flowFile, Failure);
@@ -134,7 +185,7 @@ void CompressContent::onTrigger(const std::shared_ptr<core::ProcessContext> &con
     fileExtension = search->second;
   }
   std::shared_ptr<core::FlowFile> processFlowFile = session->create(flowFile);
-  CompressContent::WriteCallback callback(compressMode_, compressLevel_, compressFormat, flowFile, session);
+  CompressContent::WriteCallback callback(compressMode_, compressLevel_, compressFormat, flowFile, session, pool_.get(), compressThreads_, blockSize_);
   session->write(processFlowFile, &callback);
 
   if (callback.status_ < 0) {
@@ -165,6 +216,212 @@ void CompressContent::onTrigger(const std::shared_ptr<core::ProcessContext> &con
   }
 }
 
+la_ssize_t CompressContent::WriteCallback::archive_write_block(struct archive *arch, void *context, const void *buff, size_t size) {
+  WriteCallback *callback = (WriteCallback *) context;
+  const char *data = reinterpret_cast<const char *>(buff);
+  size_t remaining = size;
+  while (remaining > 0) {
+    size_t len = std::min(remaining, callback->block_size_ - callback->block_.size());
+    callback->block_.append(data, len);
+    data += len;
+    remaining -= len;
+    if (callback->block_.size() == callback->block_size_ && !callback->submitBlock(callback->threads_ * 2)) {
+      archive_set_error(arch, EIO, "Error compressing flowfile");
+      return -1;
+    }
+  }
+  return size;
+}
+
+bool CompressContent::WriteCallback::submitBlock(size_t max_pending) {
+  if (!block_.empty()) {
+    auto input = std::make_shared<std::string>();
+    input->swap(block_);
+    block_.reserve(block_size_);
+    auto output = std::make_shared<std::string>();
+    int level = (int) compress_level_;
+    std::function<bool()> task = [input, output, level]() {
+      return compressGzipMember(*input, level, *output);
+    };
+    utils::Worker<bool> worker(task, "CompressContent");
+    std::future<bool> future;
+    if (!pool_->execute(std::move(worker), future)) {
+      return false;
+    }
+    pending_blocks_.emplace_back(output, std::move(future));
+    blocks_++;
+  }
+  // blocks are written in submission order, which bounds the memory held by finished blocks
+  while (pending_blocks_.size() > max_pending) {
+    std::shared_ptr<std::string> output = pending_blocks_.front().first;
+    bool compressed = false;
+    try {
+      compressed = pending_blocks_.front().second.get();
+    } catch (const std::future_error &) {
+      // the pool was shut down before the block was compressed
+    }
+    pending_blocks_.pop_front();
+    if (!compressed) {
+      logger_->log_error("Compress Content failed to compress a gzip block");
+      return false;
+    }
+    if (stream_->write(reinterpret_cast<uint8_t*>(const_cast<char*>(output->data())), output->size()) < 0) {
+      return false;
+    }
+    size_ += output->size();
+  }
+  return true;
+}
+
+bool CompressContent::WriteCallback::writeTar(archive_write_callback *writer) {
+  // the tar stream is built exactly as in the serial case, only the compression filter is replaced by writer
+  struct archive *arch = archive_write_new();
+  if (!arch) {
+    status_ = -1;
+    return false;
+  }
+  if (archive_write_set_format_ustar(arch) != ARCHIVE_OK || archive_write_add_filter_none(arch) != ARCHIVE_OK || archive_write_set_bytes_per_block(arch, 0) != ARCHIVE_OK
+      || archive_write_open(arch, this, NULL, writer, NULL) != ARCHIVE_OK) {
+    archive_write_log_error_cleanup(arch);
+    return false;
+  }
+  struct archive_entry *entry = archive_entry_new();
+  if (!entry) {
+    archive_write_log_error_cleanup(arch);
+    return false;
+  }
+  std::string fileName;
+  flow_->getAttribute(FlowAttributeKey(FILENAME), fileName);
+  archive_entry_set_pathname(entry, fileName.c_str());
+  archive_entry_set_size(entry, flow_->getSize());
+  archive_entry_set_mode(entry, S_IFREG | 0755);
+  ReadCallbackCompress readCb(flow_, arch, entry);
+  session_->read(flow_, &readCb);
+  archive_entry_free(entry);
+  if (readCb.status_ < 0 || archive_write_close(arch) != ARCHIVE_OK) {
+    archive_write_log_error_cleanup(arch);
+    return false;
+  }
+  archive_write_free(arch);
+  return true;
+}
+
+int64_t CompressContent::WriteCallback::compressGzipBlocks() {
+  block_.reserve(block_size_);
+  // on failure, blocks still being compressed own their buffers, so they need not be waited for
+  if (!writeTar(archive_write_block)) {
+    return -1;
+  }
+  if (!submitBlock(0)) {
+    status_ = -1;
+    return -1;
+  }
+  logger_->log_debug("Compress Content wrote %llu gzip blocks of up to %llu bytes", blocks_, block_size_);
+  return size_;
+}
+
+#ifdef ZSTD_SUPPORT
+la_ssize_t CompressContent::WriteCallback::archive_write_zstd(struct archive *arch, void *context, const void *buff, size_t size) {
+  WriteCallback *callback = (WriteCallback *) context;
+  if (!callback->writeZstd(buff, size, ZSTD_e_continue)) {
+    archive_set_error(arch, EIO, "Error compressing flowfile");
+    return -1;
+  }
+  return size;
+}
+
+la_ssize_t CompressContent::WriteCallback::archive_read_zstd(struct archive *arch, void *context, const void **buff) {
+  WriteCallback *callback = (WriteCallback *) context;
+  ZSTD_outBuffer output = { callback->zstd_output_.data(), callback->zstd_output_.size(), 0 };
+  while (output.pos == 0) {
+    if (callback->zstd_input_.pos == callback->zstd_input_.size && !callback->zstd_input_end_) {
+      callback->session_->read(callback->flow_, &callback->readDecompressCb_);
+      if (callback->readDecompressCb_.read_size_ < 0) {
+        archive_set_error(arch, EIO, "Error reading flowfile");
+        return -1;
+      }
+      callback->zstd_input_ = { callback->readDecompressCb_.buffer_, (size_t) callback->readDecompressCb_.read_size_, 0 };
+      callback->zstd_input_end_ = callback->readDecompressCb_.read_size_ == 0;
+    }
+    // called without input once the content is exhausted, to flush what the decoder still holds
+    size_t ret = ZSTD_decompressStream(callback->zstd_dstream_, &output, &callback->zstd_input_);
+    if (ZSTD_isError(ret)) {
+      archive_set_error(arch, EIO, "Error decompressing zstd content: %s", ZSTD_getErrorName(ret));
+      return -1;
+    }
+    if (output.pos == 0 && callback->zstd_input_end_) {
+      if (ret != 0) {
+        archive_set_error(arch, EIO, "Truncated zstd content");
+        return -1;
+      }
+      break;
+    }
+  }
+  *buff = callback->zstd_output_.data();
+  return output.pos;
+}
+
+bool CompressContent::WriteCallback::writeZstd(const void *data, size_t size, ZSTD_EndDirective mode) {
+  ZSTD_inBuffer input = { data, size, 0 };
+  size_t remaining;
+  do {
+    ZSTD_outBuffer output = { zstd_output_.data(), zstd_output_.size(), 0 };
+    remaining = ZSTD_compressStream2(zstd_cctx_, &output, &input, mode);
+    if (ZSTD_isError(remaining)) {
+      logger_->log_error("Compress Content zstd error %s", ZSTD_getErrorName(remaining));
+      return false;
+    }
+    if (output.pos > 0) {
+      if (stream_->write(zstd_output_.data(), output.pos) < 0) {
+        return false;
+      }
+      size_ += output.pos;
+    }
+  } while (mode == ZSTD_e_end ? remaining != 0 : input.pos < input.size);
+  return true;
+}
+
+int64_t CompressContent::WriteCallback::compressZstd() {
+  zstd_cctx_ = ZSTD_createCCtx();
+  if (!zstd_cctx_) {
+    status_ = -1;
+    return -1;
+  }
+  ZSTD_CCtx_setParameter(zstd_cctx_, ZSTD_c_compressionLevel, std::max(1, (int) compress_level_));
+  // workers compress while the tar stream is still being fed; libzstd built without threads rejects them
+  if (threads_ > 1 && ZSTD_isError(ZSTD_CCtx_setParameter(zstd_cctx_, ZSTD_c_nbWorkers, (int) threads_))) {
+    logger_->log_warn("Compress Content compresses zstd on one thread, libzstd does not support workers");
+  }
+  zstd_output_.resize(ZSTD_CStreamOutSize());
+  if (!writeTar(archive_write_zstd)) {
+    return -1;
+  }
+  if (!writeZstd(nullptr, 0, ZSTD_e_end)) {
+    status_ = -1;
+    return -1;
+  }
+  return size_;
+}
+#endif
+
+bool CompressContent::WriteCallback::compressGzipMember(const std::string &input, int level, std::string &output) {
+  z_stream strm;
+  memset(&strm, 0, sizeof(strm));
+  // a window size of 15 + 16 writes a gzip header and trailer
+  if (deflateInit2(&strm, std::max(0, std::min(9, level)), Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+  output.resize(deflateBound(&strm, input.size()));
+  strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+  strm.avail_in = input.size();
+  strm.next_out = reinterpret_cast<Bytef *>(&output[0]);
+  strm.avail_out = output.size();
+  int ret = deflate(&strm, Z_FINISH);
+  output.resize(strm.total_out);
+  deflateEnd(&strm);
+  return ret == Z_STREAM_END;
+}
+
 } /* namespace processors */
 } /* namespace minifi */
 } /* namespace nifi */
@@ -20,6 +20,14 @@
 #ifndef __COMPRESS_CONTENT_H__
 #define __COMPRESS_CONTENT_H__
 
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 #include "FlowFileRecord.h"
 #include "core/Processor.h"
 #include "core/ProcessSession.h"
@@ -29,6 +37,10 @@
 #include "archive_entry.h"
 #include "archive.h"
 #include "core/logging/LoggerConfiguration.h"
+#include "utils/ThreadPool.h"
+#ifdef ZSTD_SUPPORT
+#include <zstd.h>
+#endif
 
 namespace org {
 namespace apache {
@@ -41,6 +53,16 @@ namespace processors {
 #define COMPRESSION_FORMAT_BZIP2 "bzip2"
 #define COMPRESSION_FORMAT_XZ_LZMA2 "xz-lzma2"
 #define COMPRESSION_FORMAT_LZMA "lzma"
+#define COMPRESSION_FORMAT_LZ4 "lz4"
+#define COMPRESSION_FORMAT_ZSTD "zstd"
+
+// read size when streaming flow file content into the compressor
+#define COMPRESS_BUFFER_SIZE (64 * 1024)
+
+#ifdef ZSTD_SUPPORT
+// leading bytes of a zstd frame
+static const char ZSTD_MAGIC[] = { '\x28', '\xB5', '\x2F', '\xFD' };
+#endif
 
 #define MODE_COMPRESS "compress"
 #define MODE_DECOMPRESS "decompress"
@@ -53,10 +75,13 @@ public:
    * Create a new processor
    */
   explicit CompressContent(std::string name, utils::Identifier uuid = utils::Identifier()) :
-      core::Processor(name, uuid), logger_(logging::LoggerFactory<CompressContent>::getLogger()), updateFileName_(false) {
+      core::Processor(name, uuid), logger_(logging::LoggerFactory<CompressContent>::getLogger()), updateFileName_(false), compressThreads_(1), blockSize_(1024 * 1024) {
   }
   // Destructor
   virtual ~CompressContent() {
+    if (pool_) {
+      pool_->shutdown();
+    }
   }
   // Processor Name
   static constexpr char const* ProcessorName = "CompressContent";
@@ -65,6 +90,8 @@ public:
   static core::Property CompressLevel;
   static core::Property CompressFormat;
   static core::Property UpdateFileName;
+  static core::Property CompressThreads;
+  static core::Property BlockSize;
 
   // Supported Relationships
   static core::Relationship Failure;
@@ -80,8 +107,7 @@ public:
     ~ReadCallbackCompress() {
     }
     int64_t process(std::shared_ptr<io::BaseStream> stream) {
-      int max_read = getpagesize();
-      uint8_t buffer[max_read];
+      std::vector<uint8_t> buffer(COMPRESS_BUFFER_SIZE);
       int64_t ret = 0;
       uint64_t read_size = 0;
 
@@ -92,13 +118,13 @@ public:
         return -1;
       }
       while (read_size < flow_->getSize()) {
-        ret = stream->read(buffer, sizeof(buffer));
+        ret = stream->read(buffer.data(), buffer.size());
         if (ret < 0) {
           status_ = -1;
           return -1;
         }
         if (ret > 0) {
-          ret = archive_write_data(arch_, buffer, ret);
+          ret = archive_write_data(arch_, buffer.data(), ret);
           if (ret < 0) {
             logger_->log_error("Compress Content archive error %s", archive_error_string(arch_));
             status_ = -1;
@@ -146,16 +172,28 @@ public:
   class WriteCallback: public OutputStreamCallback {
   public:
     WriteCallback(std::string &compress_mode, int64_t compress_level, std::string &compress_format,
-        std::shared_ptr<core::FlowFile> &flow, const std::shared_ptr<core::ProcessSession> &session) :
+        std::shared_ptr<core::FlowFile> &flow, const std::shared_ptr<core::ProcessSession> &session,
+        utils::ThreadPool<bool> *pool = nullptr, int threads = 1, uint64_t block_size = 0) :
         compress_mode_(compress_mode), compress_level_(compress_level), compress_format_(compress_format),
         flow_(flow), session_(session),
         logger_(logging::LoggerFactory<CompressContent>::getLogger()),
-        readDecompressCb_(flow) {
+        readDecompressCb_(flow), pool_(pool), threads_(threads), block_size_(block_size) {
       size_ = 0;
+      blocks_ = 0;
       stream_ = nullptr;
       status_ = 0;
+#ifdef ZSTD_SUPPORT
+      zstd_cctx_ = nullptr;
+      zstd_dstream_ = nullptr;
+      zstd_input_ = { nullptr, 0, 0 };
+      zstd_input_end_ = false;
+#endif
     }
     ~WriteCallback() {
+#ifdef ZSTD_SUPPORT
+      ZSTD_freeCCtx(zstd_cctx_);
+      ZSTD_freeDStream(zstd_dstream_);
+#endif
     }
 
     std::string compress_mode_;
@@ -168,6 +206,46 @@ public:
     std::shared_ptr<logging::Logger> logger_;
     CompressContent::ReadCallbackDecompress readDecompressCb_;
     int status_;
+    // compresses gzip blocks in parallel when set
+    utils::ThreadPool<bool> *pool_;
+    int threads_;
+    uint64_t block_size_;
+    // the uncompressed data of the block being filled, and the blocks being compressed in order
+    std::string block_;
+    std::deque<std::pair<std::shared_ptr<std::string>, std::future<bool>>> pending_blocks_;
+    uint64_t blocks_;
+#ifdef ZSTD_SUPPORT
+    // the zstd stream of the flow file; libarchive writes and reads the tar stream inside it
+    ZSTD_CCtx *zstd_cctx_;
+    ZSTD_DStream *zstd_dstream_;
+    ZSTD_inBuffer zstd_input_;
+    bool zstd_input_end_;
+    std::vector<uint8_t> zstd_output_;
+
+    static la_ssize_t archive_write_zstd(struct archive *arch, void *context, const void *buff, size_t size);
+
+    static la_ssize_t archive_read_zstd(struct archive *arch, void *context, const void **buff);
+
+    // compresses data into the stream; ZSTD_e_end also completes the frame
+    bool writeZstd(const void *data, size_t size, ZSTD_EndDirective mode);
+
+    // compresses the flow file as a zstd frame, with threads_ workers
+    int64_t compressZstd();
+#endif
+
+    // writes the flow file as a tar entry to writer, which applies the compression
+    bool writeTar(archive_write_callback *writer);
+
+    static la_ssize_t archive_write_block(struct archive *arch, void *context, const void *buff, size_t size);
+
+    // hands the current block to the pool, and writes out finished blocks while more than max_pending are queued
+    bool submitBlock(size_t max_pending);
+
+    // compresses the flow file as a series of gzip members, each compressed on the thread pool
+    int64_t compressGzipBlocks();
+
+    // gzip members may be concatenated, so blocks are compressed independently of each other
+    static bool compressGzipMember(const std::string &input, int level, std::string &output);
 
     static la_ssize_t archive_write(struct archive *arch, void *context, const void *buff, size_t size) {
       WriteCallback *callback = (WriteCallback *) context;
@@ -209,7 +287,15 @@ public:
       struct archive *arch;
       int r;
 
-      if (compress_mode_ == MODE_COMPRESS) {
+      if (compress_mode_ == MODE_COMPRESS && compress_format_ == COMPRESSION_FORMAT_GZIP && pool_ && flow_->getSize() > block_size_) {
+        this->stream_ = stream;
+        return compressGzipBlocks();
+#ifdef ZSTD_SUPPORT
+      } else if (compress_mode_ == MODE_COMPRESS && compress_format_ == COMPRESSION_FORMAT_ZSTD) {
+        this->stream_ = stream;
+        return compressZstd();
+#endif
+      } else if (compress_mode_ == MODE_COMPRESS) {
         arch = archive_write_new();
         if (!arch) {
           status_ = -1;
@@ -251,6 +337,21 @@ public:
             archive_write_log_error_cleanup(arch);
             return -1;
           }
+#ifdef LZ4_SUPPORT
+        } else if (compress_format_ == COMPRESSION_FORMAT_LZ4) {
+          // writes the LZ4 frame format with the liblz4 that libarchive is built with
+          r = archive_write_add_filter_lz4(arch);
+          if (r != ARCHIVE_OK) {
+            archive_write_log_error_cleanup(arch);
+            return -1;
+          }
+          std::string option = "lz4:compression-level=" + std::to_string(std::max(1, std::min(9, (int) compress_level_)));
+          r = archive_write_set_options(arch, option.c_str());
+          if (r != ARCHIVE_OK) {
+            archive_write_log_error_cleanup(arch);
+            return -1;
+          }
+#endif
         } else {
             archive_write_log_error_cleanup(arch);
             return -1;
@@ -305,7 +406,25 @@ public:
           return -1;
         }
         this->stream_ = stream;
+#ifdef ZSTD_SUPPORT
+        // zstd content is recognised by its first bytes, which are kept as the first input of the zstd stream
+        session_->read(flow_, &readDecompressCb_);
+        if (readDecompressCb_.read_size_ >= (int64_t) sizeof(ZSTD_MAGIC) && memcmp(readDecompressCb_.buffer_, ZSTD_MAGIC, sizeof(ZSTD_MAGIC)) == 0) {
+          zstd_dstream_ = ZSTD_createDStream();
+          if (!zstd_dstream_ || ZSTD_isError(ZSTD_initDStream(zstd_dstream_))) {
+            archive_read_log_error_cleanup(arch);
+            return -1;
+          }
+          zstd_input_ = { readDecompressCb_.buffer_, (size_t) readDecompressCb_.read_size_, 0 };
+          zstd_output_.resize(ZSTD_DStreamOutSize());
+          r = archive_read_open2(arch, this, NULL, archive_read_zstd, archive_skip, NULL);
+        } else {
+          readDecompressCb_.offset_ = 0;
+          r = archive_read_open2(arch, this, NULL, archive_read, archive_skip, NULL);
+        }
+#else
         r = archive_read_open2(arch, this, NULL, archive_read, archive_skip, NULL);
+#endif
         if (r != ARCHIVE_OK) {
           archive_read_log_error_cleanup(arch);
           return -1;
@@ -358,6 +477,7 @@ public:
   virtual void initialize(void);
 
 protected:
+  virtual void notifyStop();
 
 private:
   std::shared_ptr<logging::Logger> logger_;
@@ -367,6 +487,10 @@ private:
   bool updateFileName_;
   std::map<std::string, std::string> compressionFormatMimeTypeMap_;
   std::map<std::string, std::string> fileExtension_;
+  int64_t compressThreads_;
+  uint64_t blockSize_;
+  // compresses the blocks of large gzip flow files when more than one thread is configured
+  std::unique_ptr<utils::ThreadPool<bool>> pool_;
 };
 
 REGISTER_RESOURCE (CompressContent, "Compresses or decompresses the contents of FlowFiles using a user-specified compression algorithm and updates the mime.type attribute as appropriate");
@@ -79,6 +79,10 @@ core::Property PublishKafka::KerberosKeytabPath("Kerberos Keytab Path",
 core::Property PublishKafka::MessageKeyField("Message Key Field", "The name of a field in the Input Records that should be used as the Key for the Kafka message.\n"
                                              "Supports Expression Language: true (will be evaluated using flow file attributes)",
                                              "");
+core::Property PublishKafka::FlowFilesPerTrigger(
+    core::PropertyBuilder::createProperty("FlowFiles Per Trigger")->withDescription("Maximum number of FlowFiles published by a single trigger. They are routed once Kafka has "
+                                                                                   "acknowledged or rejected all of their messages")->isRequired(false)->withDefaultValue<uint64_t>(10)->build());
+
 core::Relationship PublishKafka::Success("success", "Any FlowFile that is successfully sent to Kafka will be routed to this Relationship");
 core::Relationship PublishKafka::Failure("failure", "Any FlowFile that cannot be sent to Kafka will be routed to this Relationship");
 
@@ -107,6 +111,7 @@ void PublishKafka::initialize() {
   properties.insert(KerberosPrincipal);
   properties.insert(KerberosKeytabPath);
   properties.insert(MessageKeyField);
+  properties.insert(FlowFilesPerTrigger);
   setSupportedProperties(properties);
   // Set the supported relationships
   std::set<core::Relationship> relationships;
@@ -116,6 +121,9 @@ void PublishKafka::initialize() {
 }
 
 void PublishKafka::onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
+  if (!context->getProperty(FlowFilesPerTrigger.getName(), flow_files_per_trigger_) || flow_files_per_trigger_ == 0) {
+    flow_files_per_trigger_ = 10;
+  }
 }
 
 bool PublishKafka::configureNewConnection(const std::shared_ptr<KafkaConnection> &conn, const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::FlowFile> &ff) {
@@ -288,6 +296,8 @@ bool PublishKafka::configureNewConnection(const std::shared_ptr<KafkaConnection>
 
   // Set the logger callback
   rd_kafka_conf_set_log_cb(conf_, KafkaConnection::logCallback);
+  // Delivery reports route the flow files; they are served by the triggers polling the producer
+  rd_kafka_conf_set_dr_msg_cb(conf_, &PublishKafka::messageDelivered);
 
   auto producer = rd_kafka_new(RD_KAFKA_PRODUCER, conf_, errstr, sizeof(errstr));
 
@@ -301,14 +311,8 @@ bool PublishKafka::configureNewConnection(const std::shared_ptr<KafkaConnection>
   return true;
 }
 
-void PublishKafka::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
-  logger_->log_trace("Enter trigger");
-  std::shared_ptr<core::FlowFile> flowFile = session->get();
-
-  if (!flowFile) {
-    return;
-  }
-
+void PublishKafka::publish(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session, const std::shared_ptr<core::FlowFile> &flowFile,
+                           Batch &batch) {
   std::string client_id, brokers, topic;
 
   std::shared_ptr<KafkaConnection> conn = nullptr;
@@ -381,21 +385,133 @@ void PublishKafka::onTrigger(const std::shared_ptr<core::ProcessContext> &contex
 
   auto thisTopic = conn->getTopic(topic);
   if (thisTopic) {
-    PublishKafka::ReadCallback callback(max_seg_size_, kafkaKey, thisTopic->getTopic(), conn->getConnection(), flowFile, attributeNameRegex);
+    auto delivery = std::make_shared<Delivery>(flowFile);
+    PublishKafka::ReadCallback callback(max_seg_size_, kafkaKey, thisTopic->getTopic(), conn->getConnection(), delivery, attributeNameRegex);
     session->read(flowFile, &callback);
     if (callback.status_ < 0) {
       logger_->log_error("Failed to send flow to kafka topic %s", topic);
-      session->transfer(flowFile, Failure);
+      delivery->failed_ = true;
     } else {
-      logger_->log_debug("Sent flow with length %d to kafka topic %s", callback.read_size_, topic);
-      session->transfer(flowFile, Success);
+      logger_->log_debug("Produced flow with length %llu to kafka topic %s", callback.read_size_, topic);
     }
+    // messages produced before a failure are still reported, so the flow file waits for them either way
+    batch.deliveries_.push_back(delivery);
+    batch.connections_.insert(conn);
   } else {
     logger_->log_error("Topic %s is invalid", topic);
     session->transfer(flowFile, Failure);
   }
 }
 
+void PublishKafka::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
+  logger_->log_trace("Enter trigger");
+  completeBatches(0);
+
+  {
+    std::lock_guard<std::mutex> lock(batches_mutex_);
+    if (batches_.size() >= MAX_PENDING_BATCHES) {
+      logger_->log_debug("%d batches are waiting for Kafka, not taking new flow files", batches_.size());
+      return;
+    }
+  }
+
+  auto session = sessionFactory->createSession();
+  auto flowFiles = session->get(flow_files_per_trigger_);
+  if (flowFiles.empty()) {
+    return;
+  }
+
+  auto batch = std::make_shared<Batch>();
+  batch->session_ = session;
+  try {
+    for (const auto &flowFile : flowFiles) {
+      publish(context, session, flowFile, *batch);
+    }
+  } catch (...) {
+    // messages already produced keep their delivery state alive until they are reported
+    session->rollback();
+    throw;
+  }
+
+  if (batch->deliveries_.empty()) {
+    session->commit();
+    return;
+  }
+  std::lock_guard<std::mutex> lock(batches_mutex_);
+  batches_.push_back(batch);
+  // keep being triggered until the reports for this batch have been served
+  setTriggerWhenEmpty(true);
+}
+
+void PublishKafka::completeBatches(int timeout_ms) {
+  std::lock_guard<std::mutex> lock(batches_mutex_);
+  std::set<std::shared_ptr<KafkaConnection>> connections;
+  for (const auto &batch : batches_) {
+    connections.insert(batch->connections_.begin(), batch->connections_.end());
+  }
+  for (const auto &conn : connections) {
+    if (timeout_ms > 0) {
+      rd_kafka_flush(conn->getConnection(), timeout_ms);
+    } else {
+      rd_kafka_poll(conn->getConnection(), 0);
+    }
+  }
+
+  for (auto it = batches_.begin(); it != batches_.end();) {
+    const auto &batch = *it;
+    bool complete = std::all_of(batch->deliveries_.begin(), batch->deliveries_.end(), [](const std::shared_ptr<Delivery> &delivery) {
+      return delivery->pending_ == 0;
+    });
+    if (!complete) {
+      ++it;
+      continue;
+    }
+    try {
+      for (const auto &delivery : batch->deliveries_) {
+        if (delivery->failed_) {
+          logger_->log_error("Kafka did not accept all messages of flow file %s", delivery->flow_file_->getUUIDStr());
+          batch->session_->transfer(delivery->flow_file_, Failure);
+        } else {
+          batch->session_->transfer(delivery->flow_file_, Success);
+        }
+      }
+      batch->session_->commit();
+    } catch (std::exception &exception) {
+      logger_->log_error("Failed to commit Kafka batch: %s", exception.what());
+      batch->session_->rollback();
+    }
+    it = batches_.erase(it);
+  }
+  setTriggerWhenEmpty(!batches_.empty());
+}
+
+void PublishKafka::notifyStop() {
+  // give outstanding messages the same grace period as closing a connection
+  completeBatches(10 * 1000);
+  std::lock_guard<std::mutex> lock(batches_mutex_);
+  if (!batches_.empty()) {
+    logger_->log_warn("%d batches were not delivered to Kafka before stopping, rolling them back", batches_.size());
+  }
+  for (const auto &batch : batches_) {
+    try {
+      batch->session_->rollback();
+    } catch (std::exception &exception) {
+      logger_->log_error("Failed to roll back Kafka batch: %s", exception.what());
+    }
+  }
+  batches_.clear();
+  setTriggerWhenEmpty(false);
+}
+
+void PublishKafka::messageDelivered(rd_kafka_t *rk, const rd_kafka_message_t *message, void *opaque) {
+  auto delivery = static_cast<std::shared_ptr<Delivery>*>(message->_private);
+  if (message->err) {
+    (*delivery)->failed_ = true;
+  }
+  (*delivery)->pending_--;
+  delete delivery;
+}
+
 } /* namespace processors */
 } /* namespace minifi */
 } /* namespace nifi */
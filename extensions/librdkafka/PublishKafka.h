@@ -29,7 +29,12 @@
 #include "core/logging/LoggerConfiguration.h"
 #include "core/logging/Logger.h"
 #include "rdkafka.h"
+#include <atomic>
+#include <list>
+#include <mutex>
 #include <regex>
+#include <set>
+#include <vector>
 
 namespace org {
 namespace apache {
@@ -309,6 +314,7 @@ class PublishKafka : public core::Processor {
         connection_pool_(5),
         logger_(logging::LoggerFactory<PublishKafka>::getLogger()) {
     max_seg_size_ = -1;
+    flow_files_per_trigger_ = 10;
   }
   // Destructor
   virtual ~PublishKafka() {
@@ -338,22 +344,48 @@ class PublishKafka : public core::Processor {
   static core::Property KerberosPrincipal;
   static core::Property KerberosKeytabPath;
   static core::Property MessageKeyField;
+  static core::Property FlowFilesPerTrigger;
 
   // Supported Relationships
   static core::Relationship Failure;
   static core::Relationship Success;
 
+  /**
+   * Delivery state of one flow file, shared with librdkafka until it has reported every message
+   * produced from the flow file.
+   */
+  struct Delivery {
+    Delivery(const std::shared_ptr<core::FlowFile> &flow_file)
+        : flow_file_(flow_file),
+          pending_(0),
+          failed_(false) {
+    }
+    std::shared_ptr<core::FlowFile> flow_file_;
+    std::atomic<uint64_t> pending_;
+    std::atomic<bool> failed_;
+  };
+
+  /**
+   * Flow files taken by one trigger. Their session is committed by a later trigger, once all of
+   * them have been delivered or have failed.
+   */
+  struct Batch {
+    std::shared_ptr<core::ProcessSession> session_;
+    std::vector<std::shared_ptr<Delivery>> deliveries_;
+    std::set<std::shared_ptr<KafkaConnection>> connections_;
+  };
+
   // Nest Callback Class for read stream
   class ReadCallback : public InputStreamCallback {
    public:
-    ReadCallback(uint64_t max_seg_size, const std::string &key, rd_kafka_topic_t *rkt, rd_kafka_t *rk, const std::shared_ptr<core::FlowFile> flowFile, const std::regex &attributeNameRegex)
+    ReadCallback(uint64_t max_seg_size, const std::string &key, rd_kafka_topic_t *rkt, rd_kafka_t *rk, const std::shared_ptr<Delivery> &delivery, const std::regex &attributeNameRegex)
         : max_seg_size_(max_seg_size),
           key_(key),
           rkt_(rkt),
           rk_(rk),
-          flowFile_(flowFile),
+          delivery_(delivery),
           attributeNameRegex_(attributeNameRegex) {
-      flow_size_ = flowFile_->getSize();
+      flow_size_ = delivery_->flow_file_->getSize();
       status_ = 0;
       read_size_ = 0;
       hdrs = nullptr;
@@ -366,13 +398,11 @@ class PublishKafka : public core::Processor {
     int64_t process(std::shared_ptr<io::BaseStream> stream) {
       if (flow_size_ < max_seg_size_)
         max_seg_size_ = flow_size_;
-      std::vector<unsigned char> buffer;
-      buffer.reserve(max_seg_size_);
       read_size_ = 0;
       status_ = 0;
       rd_kafka_resp_err_t err;
 
-      for (auto kv : flowFile_->getAttributes()) {
+      for (auto kv : delivery_->flow_file_->getAttributes()) {
         if (regex_match(kv.first, attributeNameRegex_)) {
           if (!hdrs) {
             hdrs = rd_kafka_headers_new(8);
@@ -381,33 +411,48 @@ class PublishKafka : public core::Processor {
         }
       }
 
+      // read and produce one segment at a time; librdkafka copies each into its own message
+      std::vector<unsigned char> buffer(max_seg_size_);
       while (read_size_ < flow_size_) {
-        int readRet = stream->read(&buffer[0], max_seg_size_);
-        if (readRet < 0) {
-          status_ = -1;
-          return read_size_;
-        }
-        if (readRet > 0) {
-          if (hdrs) {
-            rd_kafka_headers_t *hdrs_copy;
-            hdrs_copy = rd_kafka_headers_copy(hdrs);
-            err = rd_kafka_producev(rk_, RD_KAFKA_V_RKT(rkt_), RD_KAFKA_V_PARTITION(RD_KAFKA_PARTITION_UA), RD_KAFKA_V_MSGFLAGS(RD_KAFKA_MSG_F_COPY), RD_KAFKA_V_VALUE(&buffer[0], readRet),
-                                    RD_KAFKA_V_HEADERS(hdrs_copy), RD_KAFKA_V_KEY(key_.c_str(), key_.size()), RD_KAFKA_V_END);
-            if (err) {
-              rd_kafka_headers_destroy(hdrs_copy);
-            }
-          } else {
-            err = rd_kafka_producev(rk_, RD_KAFKA_V_RKT(rkt_), RD_KAFKA_V_PARTITION(RD_KAFKA_PARTITION_UA), RD_KAFKA_V_MSGFLAGS(RD_KAFKA_MSG_F_COPY), RD_KAFKA_V_VALUE(&buffer[0], readRet),
-                                    RD_KAFKA_V_KEY(key_.c_str(), key_.size()), RD_KAFKA_V_END);
-          }
-          if (err) {
+        uint64_t segment = std::min<uint64_t>(max_seg_size_, flow_size_ - read_size_);
+        uint64_t filled = 0;
+        while (filled < segment) {
+          int readRet = stream->read(&buffer[filled], segment - filled);
+          if (readRet < 0) {
             status_ = -1;
             return read_size_;
           }
-          read_size_ += readRet;
-        } else {
+          if (readRet == 0) {
+            break;
+          }
+          filled += readRet;
+        }
+        if (filled == 0) {
           break;
         }
+        // owned by librdkafka until the delivery report frees it
+        auto opaque = new std::shared_ptr<Delivery>(delivery_);
+        delivery_->pending_++;
+        if (hdrs) {
+          rd_kafka_headers_t *hdrs_copy;
+          hdrs_copy = rd_kafka_headers_copy(hdrs);
+          err = rd_kafka_producev(rk_, RD_KAFKA_V_RKT(rkt_), RD_KAFKA_V_PARTITION(RD_KAFKA_PARTITION_UA), RD_KAFKA_V_MSGFLAGS(RD_KAFKA_MSG_F_COPY), RD_KAFKA_V_VALUE(buffer.data(), filled),
+                                  RD_KAFKA_V_HEADERS(hdrs_copy), RD_KAFKA_V_KEY(key_.c_str(), key_.size()), RD_KAFKA_V_OPAQUE(opaque), RD_KAFKA_V_END);
+          if (err) {
+            rd_kafka_headers_destroy(hdrs_copy);
+          }
+        } else {
+          err = rd_kafka_producev(rk_, RD_KAFKA_V_RKT(rkt_), RD_KAFKA_V_PARTITION(RD_KAFKA_PARTITION_UA), RD_KAFKA_V_MSGFLAGS(RD_KAFKA_MSG_F_COPY), RD_KAFKA_V_VALUE(buffer.data(), filled),
+                                  RD_KAFKA_V_KEY(key_.c_str(), key_.size()), RD_KAFKA_V_OPAQUE(opaque), RD_KAFKA_V_END);
+        }
+        if (err) {
+          delete opaque;
+          delivery_->pending_--;
+          delivery_->failed_ = true;
+          status_ = -1;
+          return read_size_;
+        }
+        read_size_ += filled;
       }
       return read_size_;
     }
@@ -417,9 +462,9 @@ class PublishKafka : public core::Processor {
     rd_kafka_topic_t *rkt_;
     rd_kafka_t *rk_;
     rd_kafka_headers_t *hdrs;
-    std::shared_ptr<core::FlowFile> flowFile_;
+    std::shared_ptr<Delivery> delivery_;
     int status_;
-    int read_size_;
+    uint64_t read_size_;
     std::regex attributeNameRegex_;
   };
 
@@ -435,7 +480,7 @@ class PublishKafka : public core::Processor {
    * @param sessionFactory process session factory that is used when creating
    * ProcessSession objects.
    */
-  virtual void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) override;
+  virtual void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) override;
   virtual void initialize() override;
   virtual void onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) override;
 
@@ -443,6 +488,22 @@ class PublishKafka : public core::Processor {
 
   bool configureNewConnection(const std::shared_ptr<KafkaConnection> &conn, const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::FlowFile> &ff);
 
+  /**
+   * Produces the content of a flow file. Flow files that cannot be produced are transferred to
+   * failure right away; the others are added to the batch.
+   */
+  void publish(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session, const std::shared_ptr<core::FlowFile> &flowFile, Batch &batch);
+
+  /**
+   * Serves delivery reports and commits the batches whose messages have all been reported.
+   * @param timeout_ms time to wait for outstanding messages, 0 to only collect what was reported
+   */
+  void completeBatches(int timeout_ms);
+
+  virtual void notifyStop() override;
+
+  static void messageDelivered(rd_kafka_t *rk, const rd_kafka_message_t *message, void *opaque);
+
  private:
   std::shared_ptr<logging::Logger> logger_;
 
@@ -455,6 +516,13 @@ class PublishKafka : public core::Processor {
   //std::string topic_;
   uint64_t max_seg_size_;
   std::regex attributeNameRegex;
+  uint64_t flow_files_per_trigger_;
+
+  // batches produced but not yet committed, oldest first
+  std::mutex batches_mutex_;
+  std::list<std::shared_ptr<Batch>> batches_;
+  // a trigger does not take new flow files while this many batches are outstanding
+  static const size_t MAX_PENDING_BATCHES = 16;
 };
 
 REGISTER_RESOURCE(PublishKafka, "This Processor puts the contents of a FlowFile to a Topic in Apache Kafka. The content of a FlowFile becomes the contents of a Kafka message. "
@@ -20,6 +20,7 @@
 #ifndef __ABSTRACTMQTT_H__
 #define __ABSTRACTMQTT_H__
 
+#include <string>
 #include "FlowFileRecord.h"
 #include "core/Processor.h"
 #include "core/ProcessSession.h"
@@ -115,7 +116,9 @@ class AbstractMQTTProcessor : public core::Processor {
   static int msgReceived(void *context, char *topicName, int topicLen, MQTTClient_message *message) {
     AbstractMQTTProcessor *processor = (AbstractMQTTProcessor *) context;
     if (processor->isSubscriber_) {
-      if (!processor->enqueueReceiveMQTTMsg(message))
+      // topicLen is only set when the topic contains null characters
+      std::string topic = topicLen > 0 ? std::string(topicName, topicLen) : std::string(topicName);
+      if (!processor->enqueueReceiveMQTTMsg(topic, message))
         MQTTClient_freeMessage(&message);
     } else {
       MQTTClient_freeMessage(&message);
@@ -129,7 +132,7 @@ class AbstractMQTTProcessor : public core::Processor {
   }
   bool reconnect();
   // enqueue receive MQTT message
-  virtual bool enqueueReceiveMQTTMsg(MQTTClient_message *message) {
+  virtual bool enqueueReceiveMQTTMsg(const std::string &topic, MQTTClient_message *message) {
     return false;
   }
 
@@ -24,6 +24,7 @@
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
 #include "utils/TimeUtil.h"
 #include "utils/StringUtils.h"
 #include "core/ProcessContext.h"
@@ -37,6 +38,52 @@ namespace processors {
 
 core::Property ConsumeMQTT::MaxFlowSegSize("Max Flow Segment Size", "Maximum flow content payload segment size for the MQTT record", "");
 core::Property ConsumeMQTT::QueueBufferMaxMessage("Queue Max Message", "Maximum number of messages allowed on the received MQTT queue", "");
+core::Property ConsumeMQTT::OutputMode(
+    core::PropertyBuilder::createProperty("Output Mode")
+        ->withDescription("Message creates a FlowFile per message. Demarcated packs the payloads of consecutive messages with the same topic and "
+                          "QoS into one FlowFile, separated by the Message Demarcator, and starts a new FlowFile when either changes. Records packs "
+                          "many messages into one FlowFile as length prefixed records carrying the topic and QoS of every message.")
+        ->isRequired(false)
+        ->withAllowableValues<std::string>({ MQTT_OUTPUT_MESSAGE, MQTT_OUTPUT_DEMARCATED, MQTT_OUTPUT_RECORDS })
+        ->withDefaultValue(MQTT_OUTPUT_MESSAGE)->build());
+core::Property ConsumeMQTT::MessageDemarcator(
+    core::PropertyBuilder::createProperty("Message Demarcator")
+        ->withDescription("Separator written between the payloads in the Demarcated output mode. \\n, \\r and \\t are unescaped.")
+        ->isRequired(false)
+        ->withDefaultValue("\\n")->build());
+core::Property ConsumeMQTT::BatchSize(
+    core::PropertyBuilder::createProperty("Batch Size")
+        ->withDescription("Maximum number of messages packed into one FlowFile in the Demarcated and Records output modes")
+        ->isRequired(false)
+        ->withDefaultValue<uint64_t>(1000)->build());
+
+std::string ConsumeMQTT::unescapeDemarcator(const std::string &value) {
+  std::string result;
+  for (size_t i = 0; i < value.length(); i++) {
+    if (value[i] == '\\' && i + 1 < value.length()) {
+      switch (value[i + 1]) {
+        case 'n':
+          result += '\n';
+          i++;
+          continue;
+        case 'r':
+          result += '\r';
+          i++;
+          continue;
+        case 't':
+          result += '\t';
+          i++;
+          continue;
+        case '\\':
+          result += '\\';
+          i++;
+          continue;
+      }
+    }
+    result += value[i];
+  }
+  return result;
+}
 
 void ConsumeMQTT::initialize() {
   // Set the supported properties
@@ -52,6 +99,9 @@ void ConsumeMQTT::initialize() {
   properties.insert(Topic);
   properties.insert(MaxFlowSegSize);
   properties.insert(QueueBufferMaxMessage);
+  properties.insert(OutputMode);
+  properties.insert(MessageDemarcator);
+  properties.insert(BatchSize);
   setSupportedProperties(properties);
   // Set the supported relationships
   std::set<core::Relationship> relationships;
@@ -59,14 +109,14 @@ void ConsumeMQTT::initialize() {
   setSupportedRelationships(relationships);
 }
 
-bool ConsumeMQTT::enqueueReceiveMQTTMsg(MQTTClient_message *message) {
+bool ConsumeMQTT::enqueueReceiveMQTTMsg(const std::string &topic, MQTTClient_message *message) {
   if (queue_.size_approx() >= maxQueueSize_) {
     logger_->log_debug("MQTT queue full");
     return false;
   } else {
     if (message->payloadlen > maxSegSize_)
       message->payloadlen = maxSegSize_;
-    queue_.enqueue(message);
+    queue_.enqueue(ReceivedMessage { topic, message });
     logger_->log_debug("enqueue MQTT message length %d", message->payloadlen);
     return true;
   }
@@ -86,15 +136,95 @@ void ConsumeMQTT::onSchedule(core::ProcessContext *context, core::ProcessSession
     maxSegSize_ = valInt;
     logger_->log_debug("ConsumeMQTT: Max Flow Segment Size [%ll]", maxSegSize_);
   }
+  value = "";
+  if (context->getProperty(OutputMode.getName(), value) && !value.empty()) {
+    outputMode_ = value;
+  }
+  value = "";
+  if (context->getProperty(MessageDemarcator.getName(), value)) {
+    demarcator_ = unescapeDemarcator(value);
+  }
+  if (!context->getProperty(BatchSize.getName(), batchSize_) || batchSize_ == 0) {
+    batchSize_ = 1000;
+  }
+  logger_->log_debug("ConsumeMQTT: Output Mode [%s], Batch Size [%llu]", outputMode_, batchSize_);
+}
+
+void ConsumeMQTT::appendRecord(std::vector<uint8_t> &buffer, const std::string &topic, const MQTTClient_message *message) {
+  const uint16_t topic_length = static_cast<uint16_t>(std::min<size_t>(topic.length(), UINT16_MAX));
+  const uint32_t payload_length = static_cast<uint32_t>(message->payloadlen);
+  buffer.push_back(static_cast<uint8_t>(topic_length >> 8));
+  buffer.push_back(static_cast<uint8_t>(topic_length));
+  buffer.insert(buffer.end(), topic.begin(), topic.begin() + topic_length);
+  buffer.push_back(static_cast<uint8_t>(message->qos));
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    buffer.push_back(static_cast<uint8_t>(payload_length >> shift));
+  }
+  const uint8_t *payload = reinterpret_cast<const uint8_t*>(message->payload);
+  buffer.insert(buffer.end(), payload, payload + payload_length);
+}
+
+void ConsumeMQTT::transferBatch(const std::shared_ptr<core::ProcessSession> &session, std::deque<ReceivedMessage> &msg_queue) {
+  const bool records = outputMode_ == MQTT_OUTPUT_RECORDS;
+  std::vector<uint8_t> buffer;
+  const std::string topic = msg_queue.front().topic;
+  const int qos = msg_queue.front().message->qos;
+  bool single_topic = true;
+  uint64_t count = 0;
+  while (!msg_queue.empty() && count < batchSize_) {
+    ReceivedMessage &received = msg_queue.front();
+    if (!records && (received.topic != topic || received.message->qos != qos)) {
+      // demarcated payloads carry no topic or QoS of their own, so they only share a flow file with their kind
+      break;
+    }
+    if (records) {
+      appendRecord(buffer, received.topic, received.message);
+    } else {
+      if (count > 0) {
+        buffer.insert(buffer.end(), demarcator_.begin(), demarcator_.end());
+      }
+      const uint8_t *payload = reinterpret_cast<const uint8_t*>(received.message->payload);
+      buffer.insert(buffer.end(), payload, payload + received.message->payloadlen);
+    }
+    single_topic = single_topic && received.topic == topic;
+    MQTTClient_freeMessage(&received.message);
+    msg_queue.pop_front();
+    count++;
+  }
+
+  std::shared_ptr<core::FlowFile> processFlowFile = session->create();
+  ConsumeMQTT::BatchWriteCallback callback(&buffer);
+  session->write(processFlowFile, &callback);
+  if (callback.status_ < 0) {
+    logger_->log_error("ConsumeMQTT fail for the flow with UUID %s", processFlowFile->getUUIDStr());
+    session->remove(processFlowFile);
+    return;
+  }
+  session->putAttribute(processFlowFile, MQTT_BROKER_ATTRIBUTE, uri_.c_str());
+  // the topics of the individual messages are only kept by the records when a wildcard matched several
+  session->putAttribute(processFlowFile, MQTT_TOPIC_ATTRIBUTE, single_topic ? topic : topic_);
+  if (!records) {
+    session->putAttribute(processFlowFile, MQTT_QOS_ATTRIBUTE, std::to_string(qos));
+  }
+  session->putAttribute(processFlowFile, MQTT_RECORD_COUNT_ATTRIBUTE, std::to_string(count));
+  logger_->log_debug("ConsumeMQTT packed %llu messages into the flow with UUID %s", count, processFlowFile->getUUIDStr());
+  session->transfer(processFlowFile, Success);
 }
 
 void ConsumeMQTT::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
   // reconnect if necessary
   reconnect();
-  std::deque<MQTTClient_message *> msg_queue;
-  getReceivedMQTTMsg(msg_queue);
+  std::deque<ReceivedMessage> msg_queue;
+  // a batched trigger takes one batch; the rest stays queued for the next trigger
+  getReceivedMQTTMsg(msg_queue, outputMode_ == MQTT_OUTPUT_MESSAGE ? maxQueueSize_ : batchSize_);
+  if (outputMode_ != MQTT_OUTPUT_MESSAGE) {
+    while (!msg_queue.empty()) {
+      transferBatch(session, msg_queue);
+    }
+    return;
+  }
   while (!msg_queue.empty()) {
-    MQTTClient_message *message = msg_queue.front();
+    MQTTClient_message *message = msg_queue.front().message;
     std::shared_ptr<core::FlowFile> processFlowFile = session->create();
     ConsumeMQTT::WriteCallback callback(message);
     session->write(processFlowFile, &callback);
@@ -103,8 +233,8 @@ void ConsumeMQTT::onTrigger(const std::shared_ptr<core::ProcessContext> &context
       session->remove(processFlowFile);
     } else {
       session->putAttribute(processFlowFile, MQTT_BROKER_ATTRIBUTE, uri_.c_str());
-      session->putAttribute(processFlowFile, MQTT_TOPIC_ATTRIBUTE, topic_.c_str());
-      logger_->log_debug("ConsumeMQTT processing success for the flow with UUID %s topic %s", processFlowFile->getUUIDStr(), topic_);
+      session->putAttribute(processFlowFile, MQTT_TOPIC_ATTRIBUTE, msg_queue.front().topic);
+      logger_->log_debug("ConsumeMQTT processing success for the flow with UUID %s topic %s", processFlowFile->getUUIDStr(), msg_queue.front().topic);
       session->transfer(processFlowFile, Success);
     }
     MQTTClient_freeMessage(&message);
@@ -22,6 +22,8 @@
 
 #include <limits>
 #include <deque>
+#include <string>
+#include <vector>
 #include "FlowFileRecord.h"
 #include "core/Processor.h"
 #include "core/ProcessSession.h"
@@ -41,6 +43,12 @@ namespace processors {
 
 #define MQTT_TOPIC_ATTRIBUTE "mqtt.topic"
 #define MQTT_BROKER_ATTRIBUTE "mqtt.broker"
+#define MQTT_RECORD_COUNT_ATTRIBUTE "mqtt.record.count"
+#define MQTT_QOS_ATTRIBUTE "mqtt.qos"
+
+#define MQTT_OUTPUT_MESSAGE "Message"
+#define MQTT_OUTPUT_DEMARCATED "Demarcated"
+#define MQTT_OUTPUT_RECORDS "Records"
 
 // ConsumeMQTT Class
 class ConsumeMQTT : public processors::AbstractMQTTProcessor {
@@ -55,12 +63,15 @@ class ConsumeMQTT : public processors::AbstractMQTTProcessor {
     isSubscriber_ = true;
     maxQueueSize_ = 100;
     maxSegSize_ = ULLONG_MAX;
+    outputMode_ = MQTT_OUTPUT_MESSAGE;
+    demarcator_ = "\n";
+    batchSize_ = 1000;
   }
   // Destructor
   virtual ~ConsumeMQTT() {
-    MQTTClient_message *message;
-    while (queue_.try_dequeue(message)) {
-      MQTTClient_freeMessage(&message);
+    ReceivedMessage received;
+    while (queue_.try_dequeue(received)) {
+      MQTTClient_freeMessage(&received.message);
     }
   }
   // Processor Name
@@ -68,6 +79,14 @@ class ConsumeMQTT : public processors::AbstractMQTTProcessor {
   // Supported Properties
   static core::Property MaxFlowSegSize;
   static core::Property QueueBufferMaxMessage;
+  static core::Property OutputMode;
+  static core::Property MessageDemarcator;
+  static core::Property BatchSize;
+  // a message received from the broker along with the topic it was published to
+  struct ReceivedMessage {
+    std::string topic;
+    MQTTClient_message *message;
+  };
   // Nest Callback Class for write stream
   class WriteCallback : public OutputStreamCallback {
    public:
@@ -84,6 +103,24 @@ class ConsumeMQTT : public processors::AbstractMQTTProcessor {
     }
     int status_;
   };
+  // Nest Callback Class for writing a batch of messages that was packed into one buffer
+  class BatchWriteCallback : public OutputStreamCallback {
+   public:
+    BatchWriteCallback(std::vector<uint8_t> *buffer)
+        : buffer_(buffer),
+          status_(0) {
+    }
+    int64_t process(std::shared_ptr<io::BaseStream> stream) {
+      if (buffer_->empty())
+        return 0;
+      int64_t len = stream->write(buffer_->data(), buffer_->size());
+      if (len < 0)
+        status_ = -1;
+      return len;
+    }
+    std::vector<uint8_t> *buffer_;
+    int status_;
+  };
 
  public:
   /**
@@ -97,22 +134,42 @@ class ConsumeMQTT : public processors::AbstractMQTTProcessor {
   virtual void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session);
   // Initialize, over write by NiFi ConsumeMQTT
   virtual void initialize(void);
-  virtual bool enqueueReceiveMQTTMsg(MQTTClient_message *message);
+  virtual bool enqueueReceiveMQTTMsg(const std::string &topic, MQTTClient_message *message);
+
+  /**
+   * Appends a message to the content of a Records batch: the topic length as an unsigned 16 bit
+   * integer, the topic, the QoS as one byte, the payload length as an unsigned 32 bit integer and
+   * the payload, with integers in network byte order.
+   */
+  static void appendRecord(std::vector<uint8_t> &buffer, const std::string &topic, const MQTTClient_message *message);
+
+  /**
+   * Unescapes \n, \r, \t and \\ in a configured Message Demarcator.
+   */
+  static std::string unescapeDemarcator(const std::string &value);
 
  protected:
-  void getReceivedMQTTMsg(std::deque<MQTTClient_message *> &msg_queue) {
-    MQTTClient_message *message;
-    while (queue_.try_dequeue(message)) {
-      msg_queue.push_back(message);
+  // takes at most limit messages, so that a busy broker cannot keep a trigger busy forever
+  void getReceivedMQTTMsg(std::deque<ReceivedMessage> &msg_queue, uint64_t limit) {
+    ReceivedMessage received;
+    while (msg_queue.size() < limit && queue_.try_dequeue(received)) {
+      msg_queue.push_back(received);
     }
   }
 
+  // packs up to batchSize_ messages from the front of msg_queue into a single flow file; in the Demarcated
+  // mode only the leading messages that share the topic and QoS of the first one
+  void transferBatch(const std::shared_ptr<core::ProcessSession> &session, std::deque<ReceivedMessage> &msg_queue);
+
  private:
   std::shared_ptr<logging::Logger> logger_;
   std::mutex mutex_;
   uint64_t maxQueueSize_;
   uint64_t maxSegSize_;
-  moodycamel::ConcurrentQueue<MQTTClient_message *> queue_;
+  std::string outputMode_;
+  std::string demarcator_;
+  uint64_t batchSize_;
+  moodycamel::ConcurrentQueue<ReceivedMessage> queue_;
 };
 
 REGISTER_RESOURCE(ConsumeMQTT, "This Processor gets the contents of a FlowFile from a MQTT broker for a specified topic. The the payload of the MQTT message becomes content of a FlowFile");
@@ -17,11 +17,15 @@
  */
 #include "FlowFileRepository.h"
 #include "rocksdb/write_batch.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 #include "FlowFileRecord.h"
+#include "io/CompactEncoding.h"
 
 namespace org {
 namespace apache {
@@ -30,6 +34,357 @@ namespace minifi {
 namespace core {
 namespace repository {
 
+namespace {
+// deltas start with a marker that neither a compact nor a legacy record starts with
+const uint8_t DELTA_RECORD_MARKER = 0xFE;
+const uint8_t DELTA_RECORD_VERSION = 2;
+
+const char DELTA_KEY_SEPARATOR = '#';
+
+const uint64_t FINGERPRINT_BASIS = 14695981039346656037ULL;
+const uint64_t FINGERPRINT_PRIME = 1099511628211ULL;
+
+// the index is zero padded so that the deltas of a record sort in the order they were written
+std::string deltaKey(const std::string &key, uint32_t index) {
+  char suffix[16];
+  snprintf(suffix, sizeof(suffix), "%c%010u", DELTA_KEY_SEPARATOR, index);
+  return key + suffix;
+}
+
+bool isDeltaOf(const std::string &delta_key, const std::string &key) {
+  return delta_key.length() > key.length() && delta_key[key.length()] == DELTA_KEY_SEPARATOR && delta_key.compare(0, key.length(), key) == 0;
+}
+
+std::string baseKey(const std::string &key) {
+  return key.substr(0, key.find(DELTA_KEY_SEPARATOR));
+}
+
+// FNV-1a, which unlike std::hash is the same in every process, since deltas store the fingerprints of removed keys
+uint64_t fingerprint(const char *data, size_t length, uint64_t hash = FINGERPRINT_BASIS) {
+  for (size_t i = 0; i < length; i++) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= FINGERPRINT_PRIME;
+  }
+  return hash;
+}
+
+uint64_t contentFingerprint(const char *path, size_t length, uint64_t size, uint64_t offset) {
+  uint64_t hash = fingerprint(path, length);
+  hash = fingerprint(reinterpret_cast<const char *>(&size), sizeof(size), hash);
+  return fingerprint(reinterpret_cast<const char *>(&offset), sizeof(offset), hash);
+}
+
+void fingerprintAttributes(const std::map<std::string, std::string> &attributes, std::vector<std::pair<uint64_t, uint64_t>> &fingerprints) {
+  fingerprints.clear();
+  fingerprints.reserve(attributes.size());
+  for (const auto &attribute : attributes) {
+    fingerprints.emplace_back(fingerprint(attribute.first.data(), attribute.first.length()), fingerprint(attribute.second.data(), attribute.second.length()));
+  }
+  std::sort(fingerprints.begin(), fingerprints.end());
+}
+
+/**
+ * Fingerprints the attributes of view ordered by the key fingerprint; order holds the index in
+ * view.attributes of each of them.
+ */
+void fingerprintAttributes(const FlowFileRecordView &view, std::vector<std::pair<uint64_t, uint64_t>> &fingerprints, std::vector<size_t> &order) {
+  std::vector<std::pair<std::pair<uint64_t, uint64_t>, size_t>> indexed;
+  indexed.reserve(view.attributes.size());
+  for (size_t i = 0; i < view.attributes.size(); i++) {
+    const auto &attribute = view.attributes[i];
+    indexed.emplace_back(std::make_pair(fingerprint(attribute.first.data, attribute.first.length), fingerprint(attribute.second.data, attribute.second.length)), i);
+  }
+  std::sort(indexed.begin(), indexed.end());
+  fingerprints.clear();
+  order.clear();
+  fingerprints.reserve(indexed.size());
+  order.reserve(indexed.size());
+  for (const auto &attribute : indexed) {
+    fingerprints.push_back(attribute.first);
+    order.push_back(attribute.second);
+  }
+}
+
+size_t stringSize(const FlowFileRecordView::String &value) {
+  return io::CompactWriter::varintSize(value.length) + value.length;
+}
+
+void writeString(io::CompactWriter &writer, const FlowFileRecordView::String &value) {
+  writer.writeVarint(value.length);
+  writer.writeBytes(reinterpret_cast<const uint8_t *>(value.data), value.length);
+}
+
+/**
+ * Encodes what changed since the previous version, whose attribute fingerprints are given: the
+ * timestamps, the connection, the content if it changed, the attributes that were set and the
+ * fingerprints of the keys that were removed.
+ */
+void encodeDelta(const std::vector<std::pair<uint64_t, uint64_t>> &previous, bool content_changed, const FlowFileRecordView &current,
+                 const std::vector<std::pair<uint64_t, uint64_t>> &fingerprints, const std::vector<size_t> &order, std::vector<uint8_t> &buffer) {
+  std::vector<size_t> set;
+  std::vector<uint64_t> removed;
+  auto prev = previous.begin();
+  size_t curr = 0;
+  // both are ordered by the key fingerprint, so one pass finds every difference
+  while (prev != previous.end() || curr < fingerprints.size()) {
+    if (curr == fingerprints.size() || (prev != previous.end() && prev->first < fingerprints[curr].first)) {
+      removed.push_back(prev->first);
+      ++prev;
+    } else if (prev == previous.end() || fingerprints[curr].first < prev->first) {
+      set.push_back(order[curr]);
+      ++curr;
+    } else {
+      if (prev->second != fingerprints[curr].second) {
+        set.push_back(order[curr]);
+      }
+      ++prev;
+      ++curr;
+    }
+  }
+
+  size_t size = 2;
+  size += io::CompactWriter::varintSize(current.event_time);
+  size += io::CompactWriter::varintSize(current.entry_date);
+  size += io::CompactWriter::varintSize(current.lineage_start_date);
+  size += stringSize(current.connection);
+  size += 1;
+  if (content_changed) {
+    size += stringSize(current.content_path) + io::CompactWriter::varintSize(current.size) + io::CompactWriter::varintSize(current.offset);
+  }
+  size += io::CompactWriter::varintSize(set.size());
+  for (const auto index : set) {
+    size += stringSize(current.attributes[index].first) + stringSize(current.attributes[index].second);
+  }
+  size += io::CompactWriter::varintSize(removed.size());
+  for (const auto key : removed) {
+    size += io::CompactWriter::varintSize(key);
+  }
+
+  buffer.resize(size);
+  io::CompactWriter writer(buffer.data(), buffer.size());
+  writer.writeByte(DELTA_RECORD_MARKER);
+  writer.writeByte(DELTA_RECORD_VERSION);
+  writer.writeVarint(current.event_time);
+  writer.writeVarint(current.entry_date);
+  writer.writeVarint(current.lineage_start_date);
+  writeString(writer, current.connection);
+  writer.writeByte(content_changed ? 1 : 0);
+  if (content_changed) {
+    writeString(writer, current.content_path);
+    writer.writeVarint(current.size);
+    writer.writeVarint(current.offset);
+  }
+  writer.writeVarint(set.size());
+  for (const auto index : set) {
+    writeString(writer, current.attributes[index].first);
+    writeString(writer, current.attributes[index].second);
+  }
+  writer.writeVarint(removed.size());
+  for (const auto key : removed) {
+    writer.writeVarint(key);
+  }
+}
+
+bool applyDelta(const uint8_t *buffer, size_t size, FlowFileRecordFields &fields) {
+  io::CompactReader reader(buffer, size);
+  uint8_t marker;
+  uint8_t version;
+  uint8_t content_changed;
+  if (!reader.readByte(marker) || marker != DELTA_RECORD_MARKER || !reader.readByte(version) || version != DELTA_RECORD_VERSION) {
+    return false;
+  }
+  if (!reader.readVarint(fields.event_time) || !reader.readVarint(fields.entry_date) || !reader.readVarint(fields.lineage_start_date) || !reader.readString(fields.connection)
+      || !reader.readByte(content_changed)) {
+    return false;
+  }
+  if (content_changed && (!reader.readString(fields.content_path) || !reader.readVarint(fields.size) || !reader.readVarint(fields.offset))) {
+    return false;
+  }
+  uint64_t count;
+  if (!reader.readVarint(count)) {
+    return false;
+  }
+  for (uint64_t i = 0; i < count; i++) {
+    std::string key;
+    if (!reader.readString(key) || !reader.readString(fields.attributes[key])) {
+      return false;
+    }
+  }
+  if (!reader.readVarint(count) || count > reader.remaining()) {
+    return false;
+  }
+  std::vector<uint64_t> removed(count);
+  for (auto &key : removed) {
+    if (!reader.readVarint(key)) {
+      return false;
+    }
+  }
+  if (!removed.empty()) {
+    std::sort(removed.begin(), removed.end());
+    for (auto attribute = fields.attributes.begin(); attribute != fields.attributes.end();) {
+      if (std::binary_search(removed.begin(), removed.end(), fingerprint(attribute->first.data(), attribute->first.length()))) {
+        attribute = fields.attributes.erase(attribute);
+      } else {
+        ++attribute;
+      }
+    }
+  }
+  return true;
+}
+}  // namespace
+
+void FlowFileRepository::journal(rocksdb::WriteBatch &batch, const std::string &key, const uint8_t *buf, size_t bufLen, JournalEntry &entry) {
+  rocksdb::Slice value(reinterpret_cast<const char *>(buf), bufLen);
+  entry.key = key;
+  entry.added_bytes = bufLen;
+  if (max_deltas_ == 0) {
+    batch.Put(key, value);
+    return;
+  }
+
+  // the record is only located in the buffer, its fields are fingerprinted where they are
+  FlowFileRecordView view;
+  std::vector<size_t> order;
+  entry.tracked = FlowFileRecord::View(buf, bufLen, view);
+  if (entry.tracked) {
+    entry.record.content = contentFingerprint(view.content_path.data, view.content_path.length, view.size, view.offset);
+    fingerprintAttributes(view, entry.record.attributes, order);
+  }
+
+  std::lock_guard<std::mutex> lock(persisted_mutex_);
+  auto persisted = persisted_.find(key);
+  if (entry.tracked && persisted != persisted_.end() && persisted->second.deltas < max_deltas_) {
+    std::vector<uint8_t> delta;
+    encodeDelta(persisted->second.attributes, persisted->second.content != entry.record.content, view, entry.record.attributes, order, delta);
+    if (delta.size() < bufLen) {
+      entry.record.record_bytes = persisted->second.record_bytes;
+      entry.record.delta_bytes = persisted->second.delta_bytes + delta.size();
+      entry.record.deltas = persisted->second.deltas + 1;
+      entry.added_bytes = delta.size();
+      batch.Put(deltaKey(key, entry.record.deltas), rocksdb::Slice(reinterpret_cast<const char *>(delta.data()), delta.size()));
+      return;
+    }
+  }
+
+  // a full record replaces the one stored before it and its deltas
+  if (persisted != persisted_.end()) {
+    for (uint32_t i = 1; i <= persisted->second.deltas; i++) {
+      batch.Delete(deltaKey(key, i));
+    }
+    entry.released_bytes = persisted->second.record_bytes + persisted->second.delta_bytes;
+  }
+  entry.record.record_bytes = bufLen;
+  batch.Put(key, value);
+}
+
+void FlowFileRepository::persisted(std::vector<JournalEntry> &entries) {
+  uint64_t added = 0;
+  uint64_t released = 0;
+  {
+    std::lock_guard<std::mutex> lock(persisted_mutex_);
+    for (auto &entry : entries) {
+      added += entry.added_bytes;
+      released += entry.released_bytes;
+      if (entry.tracked) {
+        persisted_[entry.key] = std::move(entry.record);
+      } else {
+        persisted_.erase(entry.key);
+      }
+    }
+  }
+  repo_size_ += added;
+  if (released > repo_size_.load()) {
+    repo_size_ = 0;
+  } else {
+    repo_size_ -= released;
+  }
+}
+
+bool FlowFileRepository::Put(std::string key, const uint8_t *buf, size_t bufLen) {
+  rocksdb::WriteBatch batch;
+  std::vector<JournalEntry> entries(1);
+  journal(batch, key, buf, bufLen, entries.front());
+  if (!db_->Write(write_options_, &batch).ok()) {
+    return false;
+  }
+  persisted(entries);
+  return true;
+}
+
+bool FlowFileRepository::MultiPut(const std::vector<std::pair<std::string, std::unique_ptr<io::DataStream>>> &data) {
+  rocksdb::WriteBatch batch;
+  std::vector<JournalEntry> entries(data.size());
+  for (size_t i = 0; i < data.size(); i++) {
+    journal(batch, data[i].first, data[i].second->getBuffer(), data[i].second->getSize(), entries[i]);
+  }
+  if (!db_->Write(write_options_, &batch).ok()) {
+    logger_->log_error("Failed to store %llu flow file records", data.size());
+    return false;
+  }
+  persisted(entries);
+  return true;
+}
+
+bool FlowFileRepository::Get(const std::string &key, std::string &value) {
+  if (db_ == nullptr)
+    return false;
+  if (!db_->Get(rocksdb::ReadOptions(), key, &value).ok()) {
+    return false;
+  }
+  if (max_deltas_ == 0) {
+    return true;
+  }
+  {
+    // a record known to have no deltas is returned as stored
+    std::lock_guard<std::mutex> lock(persisted_mutex_);
+    auto persisted = persisted_.find(key);
+    if (persisted != persisted_.end() && persisted->second.deltas == 0) {
+      return true;
+    }
+  }
+  FlowFileRecordFields fields;
+  uint32_t deltas = 0;
+  uint64_t stored_bytes = 0;
+  if (!readRecord(db_, key, fields, deltas, stored_bytes) || deltas == 0) {
+    return true;
+  }
+  io::DataStream stream;
+  FlowFileRecord::Serialize(fields, stream);
+  value.assign(reinterpret_cast<const char *>(stream.getBuffer()), stream.getSize());
+  return true;
+}
+
+bool FlowFileRepository::Contains(const std::string &key) {
+  if (db_ == nullptr)
+    return false;
+  // the full record is stored as long as the flow file is, whatever deltas follow it
+  rocksdb::PinnableSlice value;
+  return db_->Get(rocksdb::ReadOptions(), db_->DefaultColumnFamily(), key, &value).ok();
+}
+
+bool FlowFileRepository::readRecord(rocksdb::DB *db, const std::string &key, FlowFileRecordFields &fields, uint32_t &deltas, uint64_t &stored_bytes) {
+  deltas = 0;
+  stored_bytes = 0;
+  std::unique_ptr<rocksdb::Iterator> it(db->NewIterator(rocksdb::ReadOptions()));
+  it->Seek(key);
+  if (!it->Valid() || it->key() != key) {
+    return false;
+  }
+  stored_bytes += it->value().size();
+  if (!FlowFileRecord::DeSerialize(reinterpret_cast<const uint8_t *>(it->value().data()), it->value().size(), fields)) {
+    return false;
+  }
+  for (it->Next(); it->Valid() && isDeltaOf(it->key().ToString(), key); it->Next()) {
+    stored_bytes += it->value().size();
+    if (!applyDelta(reinterpret_cast<const uint8_t *>(it->value().data()), it->value().size(), fields)) {
+      logger_->log_warn("Could not apply delta %s", it->key().ToString());
+      return false;
+    }
+    deltas++;
+  }
+  return true;
+}
+
 void FlowFileRepository::flush() {
   rocksdb::WriteBatch batch;
   std::string key;
@@ -41,14 +396,32 @@ void FlowFileRepository::flush() {
   uint64_t decrement_total = 0;
   while (keys_to_delete.size_approx() > 0) {
     if (keys_to_delete.try_dequeue(key)) {
-      db_->Get(options, key, &value);
-      decrement_total += value.size();
+      if (key.find(DELTA_KEY_SEPARATOR) != std::string::npos) {
+        // a delta that recovery could not attribute to a record
+        if (db_->Get(options, key, &value).ok()) {
+          decrement_total += value.size();
+        }
+        batch.Delete(key);
+        continue;
+      }
+      FlowFileRecordFields fields;
+      uint32_t deltas = 0;
+      uint64_t stored_bytes = 0;
       std::shared_ptr<FlowFileRecord> eventRead = std::make_shared<FlowFileRecord>(shared_from_this(), content_repo_);
-      if (eventRead->DeSerialize(reinterpret_cast<const uint8_t *>(value.data()), value.size())) {
+      if (readRecord(db_, key, fields, deltas, stored_bytes)) {
+        eventRead->DeSerialize(fields);
         purgeList.push_back(eventRead);
+      } else if (db_->Get(options, key, &value).ok()) {
+        stored_bytes = value.size();
       }
+      decrement_total += stored_bytes;
       logger_->log_debug("Issuing batch delete, including %s, Content path %s", eventRead->getUUIDStr(), eventRead->getContentFullPath());
       batch.Delete(key);
+      for (uint32_t i = 1; i <= deltas; i++) {
+        batch.Delete(deltaKey(key, i));
+      }
+      std::lock_guard<std::mutex> lock(persisted_mutex_);
+      persisted_.erase(key);
     }
   }
   if (db_->Write(rocksdb::WriteOptions(), &batch).ok()) {
@@ -107,35 +480,84 @@ void FlowFileRepository::prune_stored_flowfiles() {
     return;
   }
 
+  // a record is followed by its deltas, so each record is restored once the next one starts
+  std::string record_key;
+  FlowFileRecordFields fields;
+  PersistedRecord stored;
+  bool valid = false;
   rocksdb::Iterator* it = stored_database_->NewIterator(rocksdb::ReadOptions());
   for (it->SeekToFirst(); it->Valid(); it->Next()) {
-    std::shared_ptr<FlowFileRecord> eventRead = std::make_shared<FlowFileRecord>(shared_from_this(), content_repo_);
     std::string key = it->key().ToString();
     repo_size_ += it->value().size();
-    if (eventRead->DeSerialize(reinterpret_cast<const uint8_t *>(it->value().data()), it->value().size())) {
-      logger_->log_debug("Found connection for %s, path %s ", eventRead->getConnectionUuid(), eventRead->getContentFullPath());
-      auto search = connectionMap.find(eventRead->getConnectionUuid());
-      if (!corrupt_checkpoint && search != connectionMap.end()) {
-        // we find the connection for the persistent flowfile, create the flowfile and enqueue that
-        std::shared_ptr<core::FlowFile> flow_file_ref = std::static_pointer_cast<core::FlowFile>(eventRead);
-        eventRead->setStoredToRepository(true);
-        search->second->put(eventRead);
-      } else {
-        logger_->log_warn("Could not find connection for %s, path %s ", eventRead->getConnectionUuid(), eventRead->getContentFullPath());
-        if (eventRead->getContentFullPath().length() > 0) {
-          if (nullptr != eventRead->getResourceClaim()) {
-            content_repo_->remove(eventRead->getResourceClaim());
-          }
-        }
+    const uint8_t *buffer = reinterpret_cast<const uint8_t *>(it->value().data());
+    if (!record_key.empty() && isDeltaOf(key, record_key)) {
+      if (valid && !applyDelta(buffer, it->value().size(), fields)) {
+        logger_->log_warn("Could not apply delta %s", key);
+        valid = false;
+      }
+      if (!valid) {
         keys_to_delete.enqueue(key);
       }
-    } else {
+      stored.delta_bytes += it->value().size();
+      stored.deltas++;
+      continue;
+    }
+    if (!record_key.empty()) {
+      if (valid) {
+        restore(record_key, fields, stored, corrupt_checkpoint);
+      } else {
+        keys_to_delete.enqueue(record_key);
+      }
+    }
+    if (key.find(DELTA_KEY_SEPARATOR) != std::string::npos) {
+      // a delta whose record is gone
+      logger_->log_warn("Removing delta %s of missing flow file %s", key, baseKey(key));
       keys_to_delete.enqueue(key);
+      record_key.clear();
+      continue;
+    }
+    record_key = key;
+    fields = FlowFileRecordFields();
+    stored = PersistedRecord();
+    stored.record_bytes = it->value().size();
+    valid = FlowFileRecord::DeSerialize(buffer, it->value().size(), fields);
+  }
+  if (!record_key.empty()) {
+    if (valid) {
+      restore(record_key, fields, stored, corrupt_checkpoint);
+    } else {
+      keys_to_delete.enqueue(record_key);
     }
   }
 
   delete it;
+}
 
+void FlowFileRepository::restore(const std::string &key, FlowFileRecordFields &fields, PersistedRecord &stored, bool corrupt_checkpoint) {
+  std::shared_ptr<FlowFileRecord> eventRead = std::make_shared<FlowFileRecord>(shared_from_this(), content_repo_);
+  if (max_deltas_ > 0) {
+    // later writes of the flow file continue from the recovered version
+    stored.content = contentFingerprint(fields.content_path.data(), fields.content_path.length(), fields.size, fields.offset);
+    fingerprintAttributes(fields.attributes, stored.attributes);
+    std::lock_guard<std::mutex> lock(persisted_mutex_);
+    persisted_[key] = std::move(stored);
+  }
+  eventRead->DeSerialize(fields);
+  logger_->log_debug("Found connection for %s, path %s ", eventRead->getConnectionUuid(), eventRead->getContentFullPath());
+  auto search = connectionMap.find(eventRead->getConnectionUuid());
+  if (!corrupt_checkpoint && search != connectionMap.end()) {
+    // we find the connection for the persistent flowfile, create the flowfile and enqueue that
+    eventRead->setStoredToRepository(true);
+    search->second->put(eventRead);
+  } else {
+    logger_->log_warn("Could not find connection for %s, path %s ", eventRead->getConnectionUuid(), eventRead->getContentFullPath());
+    if (eventRead->getContentFullPath().length() > 0) {
+      if (nullptr != eventRead->getResourceClaim()) {
+        content_repo_->remove(eventRead->getResourceClaim());
+      }
+    }
+    keys_to_delete.enqueue(key);
+  }
 }
 
 /**
@@ -18,14 +18,21 @@
 #ifndef LIBMINIFI_INCLUDE_CORE_REPOSITORY_FLOWFILEREPOSITORY_H_
 #define LIBMINIFI_INCLUDE_CORE_REPOSITORY_FLOWFILEREPOSITORY_H_
 
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "utils/file/FileUtils.h"
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/slice.h"
+#include "rocksdb/write_batch.h"
 #include "rocksdb/utilities/checkpoint.h"
 #include "core/Repository.h"
 #include "core/Core.h"
 #include "Connection.h"
+#include "FlowFileRecord.h"
 #include "core/logging/LoggerConfiguration.h"
 #include "concurrentqueue.h"
 
@@ -46,10 +53,18 @@ namespace repository {
 #define MAX_FLOWFILE_REPOSITORY_STORAGE_SIZE (10*1024*1024) // 10M
 #define MAX_FLOWFILE_REPOSITORY_ENTRY_LIFE_TIME (600000) // 10 minute
 #define FLOWFILE_REPOSITORY_PURGE_PERIOD (2000) // 2000 msec
+#define FLOWFILE_REPOSITORY_MAX_DELTAS (8)
 
 /**
  * Flow File repository
  * Design: Extends Repository and implements the run function, using rocksdb as the primary substrate.
+ *
+ * A flow file that is stored again, typically because it moved to the next connection, is written
+ * as a delta against its last persisted version under the key "<uuid>#<n>": the new connection,
+ * the timestamps, the content if it changed, the attributes that were set and the fingerprints of
+ * the keys that were removed. Changes are found by comparing fingerprints of the fields. After
+ * nifi.flowfile.repository.max.deltas deltas the full record is written again and the deltas are
+ * deleted. Reads and recovery apply the deltas of a record in key order.
  */
 class FlowFileRepository : public core::Repository, public std::enable_shared_from_this<FlowFileRepository> {
  public:
@@ -65,6 +80,7 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
         Repository(repo_name.length() > 0 ? repo_name : core::getClassName<FlowFileRepository>(), directory, maxPartitionMillis, maxPartitionBytes, purgePeriod),
         content_repo_(nullptr),
         checkpoint_(nullptr),
+        max_deltas_(FLOWFILE_REPOSITORY_MAX_DELTAS),
         logger_(logging::LoggerFactory<FlowFileRepository>::getLogger()) {
     db_ = NULL;
   }
@@ -95,6 +111,17 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
       }
     }
     logger_->log_debug("NiFi FlowFile Max Storage Time: [%d] ms", max_partition_millis_);
+    if (configure->get(Configure::nifi_flowfile_repository_sync_writes, value)) {
+      utils::StringUtils::StringToBool(value, write_options_.sync);
+    }
+    logger_->log_debug("NiFi FlowFile Repository sync writes: %s", write_options_.sync ? "true" : "false");
+    if (configure->get(Configure::nifi_flowfile_repository_max_deltas, value)) {
+      int64_t max_deltas;
+      if (Property::StringToInt(value, max_deltas) && max_deltas >= 0) {
+        max_deltas_ = max_deltas;
+      }
+    }
+    logger_->log_debug("NiFi FlowFile Repository max deltas: %u", max_deltas_);
     rocksdb::Options options;
     options.create_if_missing = true;
     options.use_direct_io_for_flush_and_compaction = true;
@@ -111,17 +138,14 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
 
   virtual void run();
 
-  virtual bool Put(std::string key, const uint8_t *buf, size_t bufLen) {
-    // persistent to the DB
-    rocksdb::Slice value((const char *) buf, bufLen);
-    rocksdb::Status status;
-    repo_size_ += bufLen;
-    status = db_->Put(rocksdb::WriteOptions(), key, value);
-    if (status.ok())
-      return true;
-    else
-      return false;
-  }
+  virtual bool Put(std::string key, const uint8_t *buf, size_t bufLen);
+
+  /**
+   * Stores all records with a single WriteBatch, i.e. one WAL append for the
+   * whole session commit. Concurrent callers are further merged by RocksDB's
+   * write group, so sessions committing together share a single sync.
+   */
+  virtual bool MultiPut(const std::vector<std::pair<std::string, std::unique_ptr<io::DataStream>>> &data);
   /**
    * 
    * Deletes the key
@@ -132,19 +156,15 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
     return true;
   }
   /**
-   * Sets the value from the provided key
+   * Sets the value from the provided key, with the deltas of the record applied
    * @return status of the get operation.
    */
-  virtual bool Get(const std::string &key, std::string &value) {
-    if (db_ == nullptr)
-      return false;
-    rocksdb::Status status;
-    status = db_->Get(rocksdb::ReadOptions(), key, &value);
-    if (status.ok())
-      return true;
-    else
-      return false;
-  }
+  virtual bool Get(const std::string &key, std::string &value);
+
+  /**
+   * Returns whether the record of key is stored, without reading or rebuilding it.
+   */
+  virtual bool Contains(const std::string &key);
 
   virtual void loadComponent(const std::shared_ptr<core::ContentRepository> &content_repo);
 
@@ -161,6 +181,69 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
   }
 
  private:
+  /**
+   * What the repository knows about the last persisted version of a flow file, against which the
+   * next write is diffed. Only fingerprints of the fields are kept, not the fields themselves.
+   */
+  struct PersistedRecord {
+    PersistedRecord()
+        : content(0),
+          record_bytes(0),
+          delta_bytes(0),
+          deltas(0) {
+    }
+    // fingerprint of the content path, size and offset
+    uint64_t content;
+    // fingerprints of each attribute key and of its value, ordered by the key fingerprint
+    std::vector<std::pair<uint64_t, uint64_t>> attributes;
+    // bytes stored for the full record and for its deltas
+    uint64_t record_bytes;
+    uint64_t delta_bytes;
+    // deltas written since the full record
+    uint32_t deltas;
+  };
+
+  /**
+   * A write added to a batch. It becomes the persisted version of the flow file once the batch
+   * is stored, so a failed batch leaves what is known about the stored records untouched.
+   */
+  struct JournalEntry {
+    JournalEntry()
+        : tracked(false),
+          added_bytes(0),
+          released_bytes(0) {
+    }
+    std::string key;
+    // false for records that are not diffed, which also forgets an earlier version
+    bool tracked;
+    PersistedRecord record;
+    uint64_t added_bytes;
+    // bytes of the full record and deltas that the write replaces
+    uint64_t released_bytes;
+  };
+
+  /**
+   * Adds the record, or its delta against the last persisted version, to the batch.
+   */
+  void journal(rocksdb::WriteBatch &batch, const std::string &key, const uint8_t *buf, size_t bufLen, JournalEntry &entry);
+
+  /**
+   * Records the journaled writes of a stored batch as persisted and updates the repository size.
+   */
+  void persisted(std::vector<JournalEntry> &entries);
+
+  /**
+   * Reads the full record of key from db and applies its deltas.
+   * @param deltas number of deltas that were applied
+   * @param stored_bytes bytes stored for the record and its deltas
+   */
+  bool readRecord(rocksdb::DB *db, const std::string &key, FlowFileRecordFields &fields, uint32_t &deltas, uint64_t &stored_bytes);
+
+  /**
+   * Enqueues a recovered flow file to its connection, or schedules its removal.
+   * @param stored what is stored for the flow file; its fingerprints are taken from fields
+   */
+  void restore(const std::string &key, FlowFileRecordFields &fields, PersistedRecord &stored, bool corrupt_checkpoint);
 
   /**
    * Initialize the repository
@@ -181,7 +264,13 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
   moodycamel::ConcurrentQueue<std::string> keys_to_delete;
   std::shared_ptr<core::ContentRepository> content_repo_;
   rocksdb::DB* db_;
+  // options for every write; sync is set by nifi.flowfile.repository.sync.writes
+  rocksdb::WriteOptions write_options_;
   std::unique_ptr<rocksdb::Checkpoint> checkpoint_;
+  // deltas written before the full record is rewritten; 0 always writes full records
+  uint32_t max_deltas_;
+  std::mutex persisted_mutex_;
+  std::unordered_map<std::string, PersistedRecord> persisted_;
   std::shared_ptr<logging::Logger> logger_;
 };
 
@@ -104,48 +104,59 @@ void ExecuteSQL::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
     }
 
     auto stmt = flow_file
-                ? db->prepare(*dynamic_sql)
-                : db->prepare(sql_);
+                ? db->prepare_cached(*dynamic_sql)
+                : db->prepare_cached(sql_);
 
     if (flow_file) {
-      for (int i = 1; i < INT_MAX; i++) {
-        std::string val;
-        std::stringstream val_key;
-        val_key << "sql.args." << i << ".value";
+      std::string key("sql.args.");
+      const size_t prefix_length = key.size();
+      std::string val;
+      const int count = stmt->bind_parameter_count();
 
-        if (!flow_file->getAttribute(val_key.str(), val)) {
+      for (int i = 1; i <= count; i++) {
+        key.resize(prefix_length);
+        key += std::to_string(i);
+        key += ".value";
+
+        if (!flow_file->getAttribute(key, val)) {
           break;
         }
 
-        stmt.bind_text(i, val);
+        stmt->bind_text(i, val);
       }
     }
 
-    stmt.step();
+    stmt->step();
 
-    if (!stmt.is_ok()) {
+    if (!stmt->is_ok()) {
       logger_->log_error("SQL statement execution failed: %s", db->errormsg());
-      session->transfer(flow_file, Failure);
+      if (flow_file) {
+        session->transfer(flow_file, Failure);
+        flow_file = nullptr;
+      }
     }
 
-    auto num_cols = stmt.column_count();
+    auto num_cols = stmt->column_count();
     std::vector<std::string> col_names;
 
     for (int i = 0; i < num_cols; i++) {
-      col_names.emplace_back(stmt.column_name(i));
+      col_names.emplace_back(stmt->column_name(i));
     }
 
-    while (stmt.is_ok() && !stmt.is_done()) {
+    while (stmt->is_ok() && !stmt->is_done()) {
       auto result_ff = session->create();
 
       for (int i = 0; i < num_cols; i++) {
-        result_ff->addAttribute(col_names[i], stmt.column_text(i));
+        result_ff->addAttribute(col_names[i], stmt->column_text(i));
       }
 
       session->transfer(result_ff, Success);
-      stmt.step();
+      stmt->step();
     }
 
+    // a cached statement must not keep its read transaction open
+    stmt->reset();
+
     if (flow_file) {
       session->transfer(flow_file, Original);
     }
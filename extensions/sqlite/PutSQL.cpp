@@ -17,6 +17,10 @@
 
 #include "PutSQL.h"
 
+#include <vector>
+
+#include "utils/StringUtils.h"
+
 namespace org {
 namespace apache {
 namespace nifi {
@@ -33,8 +37,17 @@ core::Property PutSQL::SQLStatement(  // NOLINT
     "");
 core::Property PutSQL::BatchSize(  // NOLINT
     "Batch Size",
-    "The maximum number of flow files to process in one batch",
+    "The maximum number of flow files to process in one batch. Each batch is executed in one transaction",
     "1");
+core::Property PutSQL::StatementCacheSize(  // NOLINT
+    "Statement Cache Size",
+    "The number of prepared statements kept for each database connection",
+    "16");
+core::Property PutSQL::EnableWAL(  // NOLINT
+    "Enable WAL",
+    "Switches the database to write-ahead logging, which lets readers run concurrently with the batches "
+    "and avoids most of the journal syncs",
+    "false");
 
 core::Relationship PutSQL::Success(  // NOLINT
     "success",
@@ -51,6 +64,8 @@ void PutSQL::initialize() {
   properties.insert(ConnectionURL);
   properties.insert(BatchSize);
   properties.insert(SQLStatement);
+  properties.insert(StatementCacheSize);
+  properties.insert(EnableWAL);
   setSupportedProperties(std::move(properties));
 
   std::set<core::Relationship> relationships;
@@ -78,6 +93,17 @@ void PutSQL::onSchedule(core::ProcessContext *context,
   }
 
   context->getProperty(SQLStatement.getName(), sql_);
+
+  std::string statement_cache_size;
+  context->getProperty(StatementCacheSize.getName(), statement_cache_size);
+
+  if (!statement_cache_size.empty()) {
+    statement_cache_size_ = std::stoull(statement_cache_size);
+  }
+
+  std::string enable_wal;
+  context->getProperty(EnableWAL.getName(), enable_wal);
+  utils::StringUtils::StringToBool(enable_wal, enable_wal_);
 }
 
 void PutSQL::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
@@ -88,12 +114,14 @@ void PutSQL::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
     return;
   }
 
-  uint64_t batch_processed = 1;
+  uint64_t batch_processed = 0;
+
+  // flow files whose statements succeeded; they are routed once the transaction is committed
+  std::vector<std::shared_ptr<FlowFileRecord>> executed;
+  std::shared_ptr<minifi::sqlite::SQLiteConnection> db;
 
   try {
     // Use an existing context, if one is available
-    std::shared_ptr<minifi::sqlite::SQLiteConnection> db;
-
     if (conn_q_.try_dequeue(db)) {
       logger_->log_debug("Using available SQLite connection");
     }
@@ -108,7 +136,14 @@ void PutSQL::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
         logger_->log_error(err_msg.str().c_str());
         throw std::runtime_error("Connection Error");
       }
+      if (enable_wal_) {
+        db->exec("PRAGMA journal_mode=WAL");
+      }
     }
+    db->set_statement_cache_size(statement_cache_size_);
+
+    // the whole batch shares one journal sync; a savepoint per flow file keeps failures isolated
+    db->begin();
 
     do {
       auto sql = std::make_shared<std::string>();
@@ -122,37 +157,43 @@ void PutSQL::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
         context->getProperty(SQLStatement, *sql, flow_file);
       }
 
-      auto stmt = db->prepare(*sql);
-      for (uint64_t i = 1; i < UINT64_MAX; i++) {
-        std::string val;
-        std::stringstream val_key;
-        val_key << "sql.args." << i << ".value";
-
-        if (!flow_file->getAttribute(val_key.str(), val)) {
-          break;
-        }
-
-        stmt.bind_text(i, val);
+      db->exec("SAVEPOINT flow_file");
+      bool ok = false;
+      try {
+        auto stmt = db->prepare_cached(*sql);
+        bind_arguments(*stmt, flow_file);
+        stmt->step();
+        ok = stmt->is_ok();
+        stmt->reset();
+      } catch (std::exception &exception) {
+        logger_->log_error("Caught Exception %s", exception.what());
       }
 
-      stmt.step();
-
-      if (!stmt.is_ok()) {
+      if (ok) {
+        db->exec("RELEASE flow_file");
+        executed.push_back(flow_file);
+      } else {
         logger_->log_error("SQL statement execution failed: %s", db->errormsg());
+        db->exec("ROLLBACK TO flow_file");
+        db->exec("RELEASE flow_file");
         session->transfer(flow_file, Failure);
       }
+      flow_file = nullptr;
+      batch_processed++;
 
-      session->transfer(flow_file, Success);
+      if (batch_processed >= batch_size_) {
+        break;
+      }
 
       flow_file = std::static_pointer_cast<FlowFileRecord>(session->get());
+    } while (flow_file);
 
-      if (!flow_file) {
-        logger_->log_info("Processed %d in batch", batch_processed);
-        break;
-      }
+    db->commit();
+    logger_->log_debug("Processed %d in batch", batch_processed);
 
-      batch_processed++;
-    } while (batch_processed < batch_size_);
+    for (const auto &executed_flow_file : executed) {
+      session->transfer(executed_flow_file, Success);
+    }
 
     // Make connection available for use again
     if (conn_q_.size_approx() < getMaxConcurrentTasks()) {
@@ -163,15 +204,52 @@ void PutSQL::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
     }
   } catch (std::exception &exception) {
     logger_->log_error("Caught Exception %s", exception.what());
-    session->transfer(flow_file, Failure);
+    rollback(db, executed, flow_file, session);
     this->yield();
   } catch (...) {
     logger_->log_error("Caught Exception");
-    session->transfer(flow_file, Failure);
+    rollback(db, executed, flow_file, session);
     this->yield();
   }
 }
 
+void PutSQL::rollback(const std::shared_ptr<minifi::sqlite::SQLiteConnection> &db, const std::vector<std::shared_ptr<FlowFileRecord>> &executed,
+                      const std::shared_ptr<FlowFileRecord> &flow_file, const std::shared_ptr<core::ProcessSession> &session) {
+  if (db && db->in_transaction()) {
+    try {
+      db->rollback();
+    } catch (std::exception &exception) {
+      logger_->log_error("Failed to roll back transaction: %s", exception.what());
+    }
+  }
+  // the statements of these flow files succeeded, but were rolled back with the batch
+  for (const auto &executed_flow_file : executed) {
+    session->transfer(executed_flow_file, Retry);
+  }
+  if (flow_file) {
+    session->transfer(flow_file, Failure);
+  }
+}
+
+void PutSQL::bind_arguments(minifi::sqlite::SQLiteStatement &stmt, const std::shared_ptr<FlowFileRecord> &flow_file) {
+  std::string key("sql.args.");
+  const size_t prefix_length = key.size();
+  std::string val;
+  const int count = stmt.bind_parameter_count();
+
+  for (int i = 1; i <= count; i++) {
+    key.resize(prefix_length);
+    key += std::to_string(i);
+    key += ".value";
+
+    if (!flow_file->getAttribute(key, val)) {
+      break;
+    }
+
+    stmt.bind_text(i, val);
+  }
+}
+
 int64_t PutSQL::SQLReadCallback::process(std::shared_ptr<io::BaseStream> stream) {
   sql_->resize(stream->getSize());
   auto num_read = static_cast<uint64_t >(stream->readData(reinterpret_cast<uint8_t *>(&(*sql_)[0]),
@@ -23,6 +23,10 @@
 
 #include <concurrentqueue.h>
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "SQLiteConnection.h"
 
 namespace org {
@@ -36,12 +40,16 @@ class PutSQL : public core::Processor {
   explicit PutSQL(const std::string &name, utils::Identifier uuid = utils::Identifier())
       : Processor(name, uuid),
         batch_size_(100),
+        statement_cache_size_(16),
+        enable_wal_(false),
         logger_(logging::LoggerFactory<PutSQL>::getLogger()) {
   }
 
   static core::Property ConnectionURL;
   static core::Property SQLStatement;
   static core::Property BatchSize;
+  static core::Property StatementCacheSize;
+  static core::Property EnableWAL;
 
   static core::Relationship Success;
   static core::Relationship Retry;
@@ -67,10 +75,19 @@ class PutSQL : public core::Processor {
   };
 
  private:
+  // rolls back the batch; executed flow files are retried and the current one fails
+  void rollback(const std::shared_ptr<minifi::sqlite::SQLiteConnection> &db, const std::vector<std::shared_ptr<FlowFileRecord>> &executed,
+                const std::shared_ptr<FlowFileRecord> &flow_file, const std::shared_ptr<core::ProcessSession> &session);
+
+  // binds the sql.args.N.value attributes to the parameters of the statement
+  static void bind_arguments(minifi::sqlite::SQLiteStatement &stmt, const std::shared_ptr<FlowFileRecord> &flow_file);
+
   std::shared_ptr<logging::Logger> logger_;
   moodycamel::ConcurrentQueue<std::shared_ptr<minifi::sqlite::SQLiteConnection>> conn_q_;
 
   uint64_t batch_size_;
+  uint64_t statement_cache_size_;
+  bool enable_wal_;
   std::string db_url_;
   std::string sql_;
 };
@@ -20,6 +20,12 @@
 
 #include <sqlite3.h>
 
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
 namespace org {
 namespace apache {
 namespace nifi {
@@ -55,6 +61,21 @@ class SQLiteStatement {
     db_ = db;
   }
 
+  SQLiteStatement(SQLiteStatement &&other)
+      : logger_(std::move(other.logger_)),
+        stmt_(other.stmt_),
+        db_(other.db_),
+        is_ok_(other.is_ok_),
+        is_busy_(other.is_busy_),
+        is_done_(other.is_done_),
+        is_error_(other.is_error_),
+        is_row_(other.is_row_) {
+    other.stmt_ = nullptr;
+  }
+
+  SQLiteStatement(const SQLiteStatement &) = delete;
+  SQLiteStatement &operator=(const SQLiteStatement &) = delete;
+
   ~SQLiteStatement() {
     sqlite3_finalize(stmt_);
   }
@@ -109,6 +130,14 @@ class SQLiteStatement {
     }
   }
 
+  int bind_parameter_count() {
+    return sqlite3_bind_parameter_count(stmt_);
+  }
+
+  void clear_bindings() {
+    sqlite3_clear_bindings(stmt_);
+  }
+
   void step() {
     int rc = sqlite3_step(stmt_);
     if (rc == SQLITE_BUSY) {
@@ -193,6 +222,7 @@ class SQLiteStatement {
 
   void reset() {
     sqlite3_reset(stmt_);
+    reset_flags();
   }
 
  private:
@@ -237,12 +267,18 @@ class SQLiteConnection {
   SQLiteConnection(SQLiteConnection &&other)
       : logger_(std::move(other.logger_)),
         filename_(std::move(other.filename_)),
-        db_(other.db_) {
+        db_(other.db_),
+        statement_cache_size_(other.statement_cache_size_),
+        statements_(std::move(other.statements_)),
+        statement_index_(std::move(other.statement_index_)) {
     other.db_ = nullptr;
   }
 
   ~SQLiteConnection() {
     logger_->log_info("Closing SQLite database: %s", filename_);
+    // cached statements must be finalized before the database can be closed
+    statement_index_.clear();
+    statements_.clear();
     sqlite3_close(db_);
   }
 
@@ -250,6 +286,76 @@ class SQLiteConnection {
     return SQLiteStatement(db_, sql);
   }
 
+  /**
+   * Returns a prepared statement for the SQL, reusing one of the statements most recently prepared
+   * on this connection if possible. The statement is reset and its parameters are cleared.
+   */
+  std::shared_ptr<SQLiteStatement> prepare_cached(const std::string &sql) {
+    auto cached = statement_index_.find(sql);
+    if (cached != statement_index_.end()) {
+      statements_.splice(statements_.begin(), statements_, cached->second);
+      std::shared_ptr<SQLiteStatement> stmt = cached->second->second;
+      stmt->reset();
+      stmt->clear_bindings();
+      return stmt;
+    }
+
+    auto stmt = std::make_shared<SQLiteStatement>(db_, sql);
+    if (statement_cache_size_ == 0) {
+      return stmt;
+    }
+    statements_.emplace_front(sql, stmt);
+    statement_index_[sql] = statements_.begin();
+    if (statements_.size() > statement_cache_size_) {
+      statement_index_.erase(statements_.back().first);
+      statements_.pop_back();
+    }
+    return stmt;
+  }
+
+  /**
+   * Sets the number of prepared statements kept by prepare_cached.
+   */
+  void set_statement_cache_size(size_t size) {
+    statement_cache_size_ = size;
+    while (statements_.size() > statement_cache_size_) {
+      statement_index_.erase(statements_.back().first);
+      statements_.pop_back();
+    }
+  }
+
+  /**
+   * Executes SQL that returns no rows, such as transaction control statements and pragmas.
+   */
+  void exec(const std::string &sql) {
+    char *err = nullptr;
+    if (sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &err) != SQLITE_OK) {
+      std::stringstream err_msg;
+      err_msg << "Failed to execute "
+              << sql
+              << " because "
+              << (err ? err : sqlite3_errmsg(db_));
+      sqlite3_free(err);
+      throw std::runtime_error(err_msg.str());
+    }
+  }
+
+  void begin() {
+    exec("BEGIN");
+  }
+
+  void commit() {
+    exec("COMMIT");
+  }
+
+  void rollback() {
+    exec("ROLLBACK");
+  }
+
+  bool in_transaction() {
+    return sqlite3_get_autocommit(db_) == 0;
+  }
+
   std::string errormsg() {
     return sqlite3_errmsg(db_);
   }
@@ -259,6 +365,11 @@ class SQLiteConnection {
   std::string filename_;
 
   sqlite3 *db_ = nullptr;
+
+  size_t statement_cache_size_ = 16;
+  // prepared statements by their SQL, most recently used first
+  std::list<std::pair<std::string, std::shared_ptr<SQLiteStatement>>> statements_;
+  std::unordered_map<std::string, std::list<std::pair<std::string, std::shared_ptr<SQLiteStatement>>>::iterator> statement_index_;
 };
 
 } /* namespace sqlite */
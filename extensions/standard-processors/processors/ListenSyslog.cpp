@@ -18,12 +18,21 @@
  * limitations under the License.
  */
 #include "ListenSyslog.h"
+#include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <set>
-#include <queue>
 #include "utils/TimeUtil.h"
 #include "utils/StringUtils.h"
 #include "core/ProcessContext.h"
@@ -37,7 +46,8 @@ namespace minifi {
 namespace processors {
 #ifndef WIN32
 core::Property ListenSyslog::RecvBufSize(
-    core::PropertyBuilder::createProperty("Receive Buffer Size")->withDescription("The size of each buffer used to receive Syslog messages.")->
+    core::PropertyBuilder::createProperty("Receive Buffer Size")->withDescription("The size of each buffer used to receive Syslog messages. Longer UDP datagrams are truncated and "
+                                                                                  "longer TCP messages are split.")->
     withDefaultValue<core::DataSizeValue>("65507 B")->build());
 
 core::Property ListenSyslog::MaxSocketBufSize(
@@ -49,14 +59,20 @@ core::Property ListenSyslog::MaxConnections(
         ->withDefaultValue<int>(2)->build());
 
 core::Property ListenSyslog::MaxBatchSize(
-    core::PropertyBuilder::createProperty("Max Batch Size")->withDescription("The maximum number of Syslog events to add to a single FlowFile.")->withDefaultValue<int>(1)->build());
+    core::PropertyBuilder::createProperty("Max Batch Size")->withDescription("The maximum number of Syslog events to add to a single FlowFile. Messages are only batched when "
+                                                                             "they are not parsed, and only with messages from the same sender.")->withDefaultValue<int>(1)->build());
+
+core::Property ListenSyslog::MaxQueueSize(
+    core::PropertyBuilder::createProperty("Max Size of Message Queue")->withDescription("The maximum number of Syslog messages received but not yet written to FlowFiles. "
+                                                                                        "Messages received while the queue is full are dropped.")->withDefaultValue<int>(10000)->build());
 
 core::Property ListenSyslog::MessageDelimiter(
     core::PropertyBuilder::createProperty("Message Delimiter")->withDescription("Specifies the delimiter to place between Syslog messages when multiple "
                                                                                 "messages are bundled together (see <Max Batch Size> core::Property).")->withDefaultValue("\n")->build());
 
 core::Property ListenSyslog::ParseMessages(
-    core::PropertyBuilder::createProperty("Parse Messages")->withDescription("Indicates if the processor should parse the Syslog messages. If set to false, each outgoing FlowFile will only.")
+    core::PropertyBuilder::createProperty("Parse Messages")->withDescription("Indicates if the processor should parse the Syslog messages. If set to false, each outgoing FlowFile will only "
+                                                                             "contain the sender, protocol, and port, and no additional attributes.")
         ->withDefaultValue<bool>(false)->build());
 
 core::Property ListenSyslog::Protocol(
@@ -69,6 +85,56 @@ core::Property ListenSyslog::Port(
 core::Relationship ListenSyslog::Success("success", "All files are routed to success");
 core::Relationship ListenSyslog::Invalid("invalid", "SysLog message format invalid");
 
+namespace {
+// datagrams received with one recvmmsg call
+const size_t UDP_BATCH = 16;
+const size_t MAX_DATAGRAM_SIZE = 65507;
+const size_t TCP_READ_SIZE = 64 * 1024;
+// queued events keep their buffers for reuse unless they grew beyond this
+const size_t MAX_POOLED_CAPACITY = 4096;
+const int POLL_TIMEOUT_MS = 100;
+const int MAX_POLL_EVENTS = 64;
+const char MONTHS[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+// HH:mm:ss
+bool isTime(const char *pos) {
+  return isDigit(pos[0]) && isDigit(pos[1]) && pos[2] == ':' && isDigit(pos[3]) && isDigit(pos[4]) && pos[5] == ':' && isDigit(pos[6]) && isDigit(pos[7]);
+}
+
+// yyyy-MM-dd
+bool isDate(const char *pos) {
+  return isDigit(pos[0]) && isDigit(pos[1]) && isDigit(pos[2]) && isDigit(pos[3]) && pos[4] == '-' && isDigit(pos[5]) && isDigit(pos[6]) && pos[7] == '-' && isDigit(pos[8]) && isDigit(pos[9]);
+}
+
+bool isMonth(const char *pos) {
+  for (size_t month = 0; month < sizeof(MONTHS) - 1; month += 3) {
+    if (memcmp(pos, MONTHS + month, 3) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool setNonBlocking(int socket) {
+  int flags = fcntl(socket, F_GETFL, 0);
+  return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+#ifdef __linux__
+bool watch(int poll_fd, int socket) {
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = socket;
+  return epoll_ctl(poll_fd, EPOLL_CTL_ADD, socket, &event) == 0;
+}
+#endif
+}  // namespace
+
 void ListenSyslog::initialize() {
   // Set the supported properties
   std::set<core::Property> properties;
@@ -76,6 +142,7 @@ void ListenSyslog::initialize() {
   properties.insert(MaxSocketBufSize);
   properties.insert(MaxConnections);
   properties.insert(MaxBatchSize);
+  properties.insert(MaxQueueSize);
   properties.insert(MessageDelimiter);
   properties.insert(ParseMessages);
   properties.insert(Protocol);
@@ -88,234 +155,511 @@ void ListenSyslog::initialize() {
   setSupportedRelationships(relationships);
 }
 
-void ListenSyslog::startSocketThread() {
-  if (_thread != NULL)
-    return;
+void ListenSyslog::onSchedule(core::ProcessContext *context, core::ProcessSessionFactory *sessionFactory) {
+  stopSocketThread();
+
+  std::string value;
+  if (context->getProperty(Protocol.getName(), value)) {
+    _protocol = value;
+  }
+  if (context->getProperty(RecvBufSize.getName(), value)) {
+    core::Property::StringToInt(value, _recvBufSize);
+  }
+  if (context->getProperty(MaxSocketBufSize.getName(), value)) {
+    core::Property::StringToInt(value, _maxSocketBufSize);
+  }
+  if (context->getProperty(MaxConnections.getName(), value)) {
+    core::Property::StringToInt(value, _maxConnections);
+  }
+  if (context->getProperty(MaxQueueSize.getName(), value)) {
+    core::Property::StringToInt(value, _maxQueueSize);
+  }
+  if (context->getProperty(MessageDelimiter.getName(), value)) {
+    _messageDelimiter = value;
+  }
+  if (context->getProperty(ParseMessages.getName(), value)) {
+    org::apache::nifi::minifi::utils::StringUtils::StringToBool(value, _parseMessages);
+  }
+  if (context->getProperty(Port.getName(), value)) {
+    core::Property::StringToInt(value, _port);
+  }
+  if (context->getProperty(MaxBatchSize.getName(), value)) {
+    core::Property::StringToInt(value, _maxBatchSize);
+  }
+  if (_recvBufSize <= 0 || _recvBufSize > static_cast<int64_t>(MAX_DATAGRAM_SIZE)) {
+    _recvBufSize = MAX_DATAGRAM_SIZE;
+  }
+  if (_protocol == "TCP") {
+    _buffer.resize(TCP_READ_SIZE);
+  } else {
+    _buffer.resize(UDP_BATCH * _recvBufSize);
+  }
+
+  startSocketThread();
+}
+
+void ListenSyslog::notifyStop() {
+  stopSocketThread();
+}
 
+void ListenSyslog::startSocketThread() {
   logger_->log_trace("ListenSysLog Socket Thread Start");
   _serverTheadRunning = true;
-  _thread = new std::thread(run, this);
-  _thread->detach();
+  _thread = std::thread(&ListenSyslog::runThread, this);
 }
 
-void ListenSyslog::run(ListenSyslog *process) {
-  process->runThread();
+void ListenSyslog::stopSocketThread() {
+  _serverTheadRunning = false;
+  if (_thread.joinable()) {
+    _thread.join();
+  }
 }
 
 void ListenSyslog::runThread() {
+  std::vector<int> ready;
   while (_serverTheadRunning) {
-    if (_resetServerSocket) {
-      _resetServerSocket = false;
-      // need to reset the socket
-      std::vector<int>::iterator it;
-      for (it = _clientSockets.begin(); it != _clientSockets.end(); ++it) {
-        int clientSocket = *it;
-        close(clientSocket);
+    if (_serverSocket < 0 && !openServerSocket()) {
+      break;
+    }
+    if (!waitForEvents(ready)) {
+      logger_->log_error("ListenSysLog waiting for sockets failed with error %d", errno);
+      break;
+    }
+    for (int socket : ready) {
+      if (socket == _serverSocket) {
+        // server socket, either we have UDP datagrams or TCP connection requests
+        if (_protocol == "TCP") {
+          acceptConnections();
+        } else {
+          receiveDatagrams();
+        }
+        continue;
       }
-      _clientSockets.clear();
-      if (_serverSocket > 0) {
-        close(_serverSocket);
-        _serverSocket = 0;
+      auto connection = std::find_if(_clientSockets.begin(), _clientSockets.end(), [socket](const Connection &connection) {
+        return connection.socket == socket;
+      });
+      if (connection != _clientSockets.end() && !receiveStream(*connection)) {
+        // closing the socket also removes it from the epoll instance
+        close(connection->socket);
+        logger_->log_debug("ListenSysLog client socket %d close", connection->socket);
+        _clientSockets.erase(connection);
       }
     }
+  }
+  closeSockets();
+}
 
-    if (_serverSocket <= 0) {
-      uint16_t portno = _port;
-      struct sockaddr_in serv_addr;
-      int sockfd;
-      if (_protocol == "TCP")
-        sockfd = socket(AF_INET, SOCK_STREAM, 0);
-      else
-        sockfd = socket(AF_INET, SOCK_DGRAM, 0);
-      if (sockfd < 0) {
-        logger_->log_error("ListenSysLog Server socket creation failed");
-        break;
-      }
-      bzero(reinterpret_cast<char *>(&serv_addr), sizeof(serv_addr));
-      serv_addr.sin_family = AF_INET;
-      serv_addr.sin_addr.s_addr = INADDR_ANY;
-      serv_addr.sin_port = htons(portno);
-      if (bind(sockfd, (struct sockaddr *) &serv_addr, sizeof(serv_addr)) < 0) {
-        logger_->log_error("ListenSysLog Server socket bind failed");
-        break;
-      }
-      if (_protocol == "TCP")
-        listen(sockfd, 5);
-      _serverSocket = sockfd;
-      logger_->log_info("ListenSysLog Server socket %d bind OK to port %d", _serverSocket, portno);
+bool ListenSyslog::openServerSocket() {
+  int sockfd;
+  if (_protocol == "TCP")
+    sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  else
+    sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sockfd < 0) {
+    logger_->log_error("ListenSysLog Server socket creation failed");
+    return false;
+  }
+  int reuse = 1;
+  setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  int socketBufSize = static_cast<int>(_maxSocketBufSize);
+  if (setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &socketBufSize, sizeof(socketBufSize)) < 0) {
+    logger_->log_warn("ListenSysLog could not set the socket buffer size to %d", socketBufSize);
+  }
+  struct sockaddr_in serv_addr;
+  memset(&serv_addr, 0, sizeof(serv_addr));
+  serv_addr.sin_family = AF_INET;
+  serv_addr.sin_addr.s_addr = INADDR_ANY;
+  serv_addr.sin_port = htons(static_cast<uint16_t>(_port));
+  if (!setNonBlocking(sockfd) || bind(sockfd, (struct sockaddr *) &serv_addr, sizeof(serv_addr)) < 0) {
+    logger_->log_error("ListenSysLog Server socket bind failed");
+    close(sockfd);
+    return false;
+  }
+  if (_protocol == "TCP")
+    listen(sockfd, 5);
+#ifdef __linux__
+  _pollFd = epoll_create1(EPOLL_CLOEXEC);
+  if (_pollFd < 0 || !watch(_pollFd, sockfd)) {
+    logger_->log_error("ListenSysLog epoll setup failed with error %d", errno);
+    close(sockfd);
+    if (_pollFd >= 0) {
+      close(_pollFd);
+      _pollFd = -1;
+    }
+    return false;
+  }
+#endif
+  _serverSocket = sockfd;
+  logger_->log_info("ListenSysLog Server socket %d bind OK to port %d", _serverSocket, _port);
+  return true;
+}
+
+void ListenSyslog::closeSockets() {
+  for (const auto &connection : _clientSockets) {
+    close(connection.socket);
+  }
+  _clientSockets.clear();
+  if (_serverSocket >= 0) {
+    logger_->log_debug("ListenSysLog Server socket %d close", _serverSocket);
+    close(_serverSocket);
+    _serverSocket = -1;
+  }
+  if (_pollFd >= 0) {
+    close(_pollFd);
+    _pollFd = -1;
+  }
+}
+
+bool ListenSyslog::waitForEvents(std::vector<int> &ready) {
+  ready.clear();
+#ifdef __linux__
+  struct epoll_event events[MAX_POLL_EVENTS];
+  int count = epoll_wait(_pollFd, events, MAX_POLL_EVENTS, POLL_TIMEOUT_MS);
+  if (count < 0) {
+    return errno == EINTR;
+  }
+  for (int i = 0; i < count; i++) {
+    ready.push_back(events[i].data.fd);
+  }
+#else
+  std::vector<struct pollfd> sockets;
+  sockets.push_back({ _serverSocket, POLLIN, 0 });
+  for (const auto &connection : _clientSockets) {
+    sockets.push_back({ connection.socket, POLLIN, 0 });
+  }
+  int count = poll(sockets.data(), sockets.size(), POLL_TIMEOUT_MS);
+  if (count < 0) {
+    return errno == EINTR;
+  }
+  for (const auto &socket : sockets) {
+    if (socket.revents != 0) {
+      ready.push_back(socket.fd);
     }
-    FD_ZERO(&_readfds);
-    FD_SET(_serverSocket, &_readfds);
-    _maxFds = _serverSocket;
-    std::vector<int>::iterator it;
-    for (it = _clientSockets.begin(); it != _clientSockets.end(); ++it) {
-      int clientSocket = *it;
-      if (clientSocket >= _maxFds)
-        _maxFds = clientSocket;
-      FD_SET(clientSocket, &_readfds);
+  }
+#endif
+  return true;
+}
+
+void ListenSyslog::acceptConnections() {
+  while (true) {
+    struct sockaddr_in cli_addr;
+    socklen_t clilen = sizeof(cli_addr);
+    int newsockfd = accept(_serverSocket, reinterpret_cast<struct sockaddr *>(&cli_addr), &clilen);
+    if (newsockfd < 0) {
+      return;
     }
-    fd_set fds;
-    struct timeval tv;
-    int retval;
-    fds = _readfds;
-    tv.tv_sec = 0;
-    // 100 msec
-    tv.tv_usec = 100000;
-    retval = select(_maxFds + 1, &fds, NULL, NULL, &tv);
-    if (retval < 0)
-      break;
-    if (retval == 0)
+    if (_clientSockets.size() >= (uint64_t) _maxConnections || !setNonBlocking(newsockfd)) {
+      close(newsockfd);
       continue;
-    if (FD_ISSET(_serverSocket, &fds)) {
-      // server socket, either we have UDP datagram or TCP connection request
-      if (_protocol == "TCP") {
-        socklen_t clilen;
-        struct sockaddr_in cli_addr;
-        clilen = sizeof(cli_addr);
-        int newsockfd = accept(_serverSocket, reinterpret_cast<struct sockaddr *>(&cli_addr), &clilen);
-        if (newsockfd > 0) {
-          if (_clientSockets.size() < (uint64_t) _maxConnections) {
-            _clientSockets.push_back(newsockfd);
-            logger_->log_info("ListenSysLog new client socket %d connection", newsockfd);
-            continue;
-          } else {
-            close(newsockfd);
-          }
-        }
-      } else {
-        socklen_t clilen;
-        struct sockaddr_in cli_addr;
-        clilen = sizeof(cli_addr);
-        int recvlen = recvfrom(_serverSocket, _buffer, sizeof(_buffer), 0, (struct sockaddr *) &cli_addr, &clilen);
-        if (recvlen > 0 && (uint64_t) (recvlen + getEventQueueByteSize()) <= _recvBufSize) {
-          uint8_t *payload = new uint8_t[recvlen];
-          memcpy(payload, _buffer, recvlen);
-          putEvent(payload, recvlen);
-        }
+    }
+#ifdef __linux__
+    if (!watch(_pollFd, newsockfd)) {
+      close(newsockfd);
+      continue;
+    }
+#endif
+    char sender[INET_ADDRSTRLEN] = { 0 };
+    inet_ntop(AF_INET, &cli_addr.sin_addr, sender, sizeof(sender));
+    Connection connection;
+    connection.socket = newsockfd;
+    connection.sender = sender;
+    _clientSockets.push_back(std::move(connection));
+    logger_->log_info("ListenSysLog new client socket %d connection", newsockfd);
+  }
+}
+
+void ListenSyslog::receiveDatagrams() {
+  const size_t size = _buffer.size() / UDP_BATCH;
+  struct sockaddr_in senders[UDP_BATCH];
+  char sender[INET_ADDRSTRLEN];
+#ifdef __linux__
+  struct mmsghdr headers[UDP_BATCH];
+  struct iovec vectors[UDP_BATCH];
+  memset(headers, 0, sizeof(headers));
+  for (size_t i = 0; i < UDP_BATCH; i++) {
+    vectors[i].iov_base = &_buffer[i * size];
+    vectors[i].iov_len = size;
+    headers[i].msg_hdr.msg_iov = &vectors[i];
+    headers[i].msg_hdr.msg_iovlen = 1;
+    headers[i].msg_hdr.msg_name = &senders[i];
+  }
+  while (_serverTheadRunning) {
+    for (size_t i = 0; i < UDP_BATCH; i++) {
+      headers[i].msg_hdr.msg_namelen = sizeof(senders[i]);
+    }
+    int count = recvmmsg(_serverSocket, headers, UDP_BATCH, MSG_DONTWAIT, nullptr);
+    if (count <= 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i = 0; i < count; i++) {
+      if (headers[i].msg_hdr.msg_flags & MSG_TRUNC) {
+        logger_->log_debug("ListenSysLog truncated a datagram to %llu bytes", size);
       }
+      inet_ntop(AF_INET, &senders[i].sin_addr, sender, sizeof(sender));
+      putEvent(&_buffer[i * size], headers[i].msg_len, sender);
     }
-    it = _clientSockets.begin();
-    while (it != _clientSockets.end()) {
-      int clientSocket = *it;
-      if (FD_ISSET(clientSocket, &fds)) {
-        int recvlen = readline(clientSocket, _buffer, sizeof(_buffer));
-        if (recvlen <= 0) {
-          close(clientSocket);
-          logger_->log_debug("ListenSysLog client socket %d close", clientSocket);
-          it = _clientSockets.erase(it);
-        } else {
-          if ((uint64_t) (recvlen + getEventQueueByteSize()) <= _recvBufSize) {
-            uint8_t *payload = new uint8_t[recvlen];
-            memcpy(payload, _buffer, recvlen);
-            putEvent(payload, recvlen);
-          }
-          ++it;
-        }
+    if (count < static_cast<int>(UDP_BATCH)) {
+      return;
+    }
+  }
+#else
+  for (size_t i = 0; i < UDP_BATCH; i++) {
+    socklen_t clilen = sizeof(senders[i]);
+    ssize_t recvlen = recvfrom(_serverSocket, &_buffer[0], size, MSG_DONTWAIT, reinterpret_cast<struct sockaddr *>(&senders[i]), &clilen);
+    if (recvlen <= 0) {
+      return;
+    }
+    inet_ntop(AF_INET, &senders[i].sin_addr, sender, sizeof(sender));
+    std::lock_guard<std::mutex> lock(mutex_);
+    putEvent(&_buffer[0], recvlen, sender);
+  }
+#endif
+}
+
+bool ListenSyslog::receiveStream(Connection &connection) {
+  while (_serverTheadRunning) {
+    ssize_t recvlen = recv(connection.socket, &_buffer[0], _buffer.size(), MSG_DONTWAIT);
+    if (recvlen == 0) {
+      if (!connection.pending.empty()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        putEvent(connection.pending.data(), connection.pending.size(), connection.sender);
       }
+      return false;
+    }
+    if (recvlen < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    extractMessages(connection, &_buffer[0], recvlen);
+    if (static_cast<size_t>(recvlen) < _buffer.size()) {
+      return true;
     }
   }
-  return;
+  return true;
 }
 
-int ListenSyslog::readline(int fd, char *bufptr, size_t len) {
-  char *bufx = bufptr;
-  static char *bp;
-  static int cnt = 0;
-  static char b[2048];
-  char c;
-
-  while (--len > 0) {
-    if (--cnt <= 0) {
-      cnt = recv(fd, b, sizeof(b), 0);
-      if (cnt < 0) {
-        if (errno == EINTR) {
-          len++; /* the while will decrement */
-          continue;
-        }
+void ListenSyslog::extractMessages(Connection &connection, const char *data, size_t len) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const char *end = data + len;
+  while (data < end) {
+    const char *newline = static_cast<const char *>(memchr(data, '\n', end - data));
+    if (newline == nullptr) {
+      connection.pending.append(data, end - data);
+      if (connection.pending.size() >= static_cast<size_t>(_recvBufSize)) {
+        putEvent(connection.pending.data(), connection.pending.size(), connection.sender);
+        connection.pending.clear();
+      }
+      return;
+    }
+    const char *message = data;
+    size_t length = newline - data;
+    if (!connection.pending.empty()) {
+      connection.pending.append(data, length);
+      message = connection.pending.data();
+      length = connection.pending.size();
+    }
+    if (length > 0 && message[length - 1] == '\r') {
+      length--;
+    }
+    if (length > 0) {
+      putEvent(message, length, connection.sender);
+    }
+    connection.pending.clear();
+    data = newline + 1;
+  }
+}
+
+void ListenSyslog::putEvent(const char *payload, size_t len, const std::string &sender) {
+  if (_eventCount >= static_cast<size_t>(_maxQueueSize)) {
+    _droppedEvents++;
+    return;
+  }
+  if (_eventCount == _events.size()) {
+    _events.emplace_back();
+  }
+  SysLogEvent &event = _events[_eventCount++];
+  event.payload.assign(payload, len);
+  event.sender = sender;
+}
+
+int64_t ListenSyslog::WriteCallback::process(std::shared_ptr<io::BaseStream> stream) {
+  int64_t ret = 0;
+  for (size_t i = begin_; i < end_; i++) {
+    if (i > begin_ && !delimiter_.empty()) {
+      if (stream->write(reinterpret_cast<uint8_t *>(const_cast<char *>(delimiter_.data())), delimiter_.size()) < 0) {
         return -1;
       }
-      if (cnt == 0)
-        return 0;
-      bp = b;
+      ret += delimiter_.size();
     }
-    c = *bp++;
-    *bufptr++ = c;
-    if (c == '\n') {
-      *bufptr = '\n';
-      return bufptr - bufx + 1;
+    const std::string &payload = events_[i].payload;
+    if (!payload.empty()) {
+      if (stream->write(reinterpret_cast<uint8_t *>(const_cast<char *>(payload.data())), payload.size()) < 0) {
+        return -1;
+      }
+      ret += payload.size();
     }
   }
-  return -1;
+  return ret;
 }
 
-void ListenSyslog::onTrigger(core::ProcessContext *context, core::ProcessSession *session) {
-  std::string value;
-  bool needResetServerSocket = false;
-  if (context->getProperty(Protocol.getName(), value)) {
-    if (_protocol != value)
-      needResetServerSocket = true;
-    _protocol = value;
+bool ListenSyslog::parseMessage(const char *data, size_t length, ParsedMessage &message) {
+  const char *pos = data;
+  const char *end = data + length;
+  while (end > pos && (end[-1] == '\n' || end[-1] == '\r')) {
+    --end;
   }
-  if (context->getProperty(RecvBufSize.getName(), value)) {
-    core::Property::StringToInt(value, _recvBufSize);
+
+  // <PRIORITY>
+  if (pos == end || *pos != '<') {
+    return false;
   }
-  if (context->getProperty(MaxSocketBufSize.getName(), value)) {
-    core::Property::StringToInt(value, _maxSocketBufSize);
+  const char *digits = ++pos;
+  int priority = 0;
+  while (pos < end && isDigit(*pos) && pos - digits < 3) {
+    priority = priority * 10 + (*pos++ - '0');
   }
-  if (context->getProperty(MaxConnections.getName(), value)) {
-    core::Property::StringToInt(value, _maxConnections);
+  if (pos == digits || pos == end || *pos != '>' || priority > 191) {
+    return false;
   }
-  if (context->getProperty(MessageDelimiter.getName(), value)) {
-    _messageDelimiter = value;
+  ++pos;
+
+  // optional VERSION followed by a space; an RFC 5424 timestamp has four digits
+  const char *version = pos;
+  while (pos < end && isDigit(*pos) && pos - version < 3) {
+    ++pos;
   }
-  if (context->getProperty(ParseMessages.getName(), value)) {
-    org::apache::nifi::minifi::utils::StringUtils::StringToBool(value, _parseMessages);
+  if (pos > version && pos < end && *pos == ' ') {
+    message.version.assign(version, pos - version);
+    ++pos;
+  } else {
+    message.version.clear();
+    pos = version;
   }
-  if (context->getProperty(Port.getName(), value)) {
-    int64_t oldPort = _port;
-    core::Property::StringToInt(value, _port);
-    if (_port != oldPort)
-      needResetServerSocket = true;
+
+  // TIMESTAMP
+  const char *timestamp = pos;
+  if (pos < end && *pos >= 'A' && *pos <= 'Z') {
+    // RFC 3164: MMM d HH:mm:ss, where a single digit day is padded with a space
+    if (end - pos < 15 || !isMonth(pos) || pos[3] != ' ' || !(pos[4] == ' ' || isDigit(pos[4])) || !isDigit(pos[5]) || pos[6] != ' ' || !isTime(pos + 7)) {
+      return false;
+    }
+    pos += 15;
+  } else {
+    // RFC 5424: yyyy-MM-ddTHH:mm:ss followed by an optional fraction and the zone
+    const char *space = static_cast<const char *>(memchr(pos, ' ', end - pos));
+    if (space == nullptr || space - pos < 19 || !isDate(pos) || pos[10] != 'T' || !isTime(pos + 11)) {
+      return false;
+    }
+    pos = space;
   }
-  if (context->getProperty(MaxBatchSize.getName(), value)) {
-    core::Property::StringToInt(value, _maxBatchSize);
+  message.timestamp.assign(timestamp, pos - timestamp);
+
+  // HOSTNAME and BODY
+  if (pos == end || *pos != ' ') {
+    return false;
+  }
+  const char *hostname = ++pos;
+  const char *space = static_cast<const char *>(memchr(pos, ' ', end - pos));
+  if (space == nullptr || space == hostname) {
+    return false;
   }
+  message.hostname.assign(hostname, space - hostname);
+  message.body.assign(space + 1, end - space - 1);
 
-  if (needResetServerSocket)
-    _resetServerSocket = true;
+  message.priority = priority;
+  message.severity = priority % 8;
+  message.facility = priority / 8;
+  return true;
+}
 
-  startSocketThread();
+void ListenSyslog::transferEvents(core::ProcessSession *session, size_t count) {
+  const std::string port = std::to_string(_port);
+  if (_parseMessages) {
+    ParsedMessage message;
+    for (size_t i = 0; i < count; i++) {
+      const SysLogEvent &event = _polledEvents[i];
+      std::shared_ptr<core::FlowFile> flowFile = session->create();
+      if (!flowFile)
+        return;
+      ListenSyslog::WriteCallback callback(_polledEvents, i, i + 1, _messageDelimiter);
+      session->write(flowFile, &callback);
+      bool valid = parseMessage(event.payload.data(), event.payload.size(), message);
+      if (valid) {
+        flowFile->addAttribute("syslog.priority", std::to_string(message.priority));
+        flowFile->addAttribute("syslog.severity", std::to_string(message.severity));
+        flowFile->addAttribute("syslog.facility", std::to_string(message.facility));
+        if (!message.version.empty()) {
+          flowFile->addAttribute("syslog.version", message.version);
+        }
+        flowFile->addAttribute("syslog.timestamp", message.timestamp);
+        flowFile->addAttribute("syslog.hostname", message.hostname);
+        flowFile->addAttribute("syslog.body", message.body);
+      }
+      flowFile->addAttribute("syslog.valid", valid ? "true" : "false");
+      flowFile->addAttribute("syslog.sender", event.sender);
+      flowFile->addAttribute("syslog.protocol", _protocol);
+      flowFile->addAttribute("syslog.port", port);
+      session->transfer(flowFile, valid ? Success : Invalid);
+    }
+    return;
+  }
+
+  const size_t batchSize = _maxBatchSize > 0 ? static_cast<size_t>(_maxBatchSize) : count;
+  size_t begin = 0;
+  while (begin < count) {
+    // a batch only holds messages of one sender
+    size_t end = begin + 1;
+    while (end < count && end - begin < batchSize && _polledEvents[end].sender == _polledEvents[begin].sender) {
+      end++;
+    }
+    std::shared_ptr<core::FlowFile> flowFile = session->create();
+    if (!flowFile)
+      return;
+    ListenSyslog::WriteCallback callback(_polledEvents, begin, end, _messageDelimiter);
+    session->write(flowFile, &callback);
+    flowFile->addAttribute("syslog.sender", _polledEvents[begin].sender);
+    flowFile->addAttribute("syslog.protocol", _protocol);
+    flowFile->addAttribute("syslog.port", port);
+    session->transfer(flowFile, Success);
+    begin = end;
+  }
+}
 
-  // read from the event queue
-  if (isEventQueueEmpty()) {
+void ListenSyslog::onTrigger(core::ProcessContext *context, core::ProcessSession *session) {
+  // the events of one trigger are written from _polledEvents, so triggers take turns
+  std::unique_lock<std::mutex> poll_lock(poll_mutex_, std::try_to_lock);
+  if (!poll_lock.owns_lock()) {
     context->yield();
     return;
   }
 
-  std::queue<SysLogEvent> eventQueue;
-  pollEvent(eventQueue, _maxBatchSize);
-  bool firstEvent = true;
-  std::shared_ptr<FlowFileRecord> flowFile = NULL;
-  while (!eventQueue.empty()) {
-    SysLogEvent event = eventQueue.front();
-    eventQueue.pop();
-    if (firstEvent) {
-      flowFile = std::static_pointer_cast<FlowFileRecord>(session->create());
-      if (!flowFile)
-        return;
-      ListenSyslog::WriteCallback callback(event.payload, event.len);
-      session->write(flowFile, &callback);
-      delete[] event.payload;
-      firstEvent = false;
-    } else {
-      ListenSyslog::WriteCallback callback(event.payload, event.len);
-      session->append(flowFile, &callback);
-      delete[] event.payload;
+  size_t count;
+  uint64_t dropped;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // hand the buffers of the events written last time back to the socket thread
+    _events.swap(_polledEvents);
+    count = _eventCount;
+    _eventCount = 0;
+    dropped = _droppedEvents;
+    _droppedEvents = 0;
+  }
+  if (dropped > 0) {
+    logger_->log_warn("ListenSysLog dropped %llu messages because the message queue was full", dropped);
+  }
+  if (count == 0) {
+    context->yield();
+    return;
+  }
+
+  transferEvents(session, count);
+
+  for (size_t i = 0; i < count; i++) {
+    // do not keep the buffers of unusually large messages around
+    if (_polledEvents[i].payload.capacity() > MAX_POOLED_CAPACITY) {
+      std::string().swap(_polledEvents[i].payload);
     }
   }
-  flowFile->addAttribute("syslog.protocol", _protocol);
-  flowFile->addAttribute("syslog.port", std::to_string(_port));
-  session->transfer(flowFile, Success);
 }
 #endif
 } /* namespace processors */
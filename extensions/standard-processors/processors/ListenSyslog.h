@@ -26,15 +26,19 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
-#include <sys/select.h>
 #include <sys/time.h>
 #else
 #include <WinSock2.h>
 #endif
 #include <errno.h>
 #include <sys/types.h>
+#include <atomic>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <vector>
 #include "FlowFileRecord.h"
 #include "core/Processor.h"
 #include "core/ProcessSession.h"
@@ -50,13 +54,6 @@ namespace nifi {
 namespace minifi {
 namespace processors {
 
-
-// SyslogEvent
-typedef struct {
-  char *payload;
-  uint64_t len;
-} SysLogEvent;
-
 // ListenSyslog Class
 class ListenSyslog : public core::Processor {
  public:
@@ -67,40 +64,24 @@ class ListenSyslog : public core::Processor {
   ListenSyslog(std::string name,  utils::Identifier uuid = utils::Identifier())
       : Processor(name, uuid),
         logger_(logging::LoggerFactory<ListenSyslog>::getLogger()) {
-    _eventQueueByteSize = 0;
-    _serverSocket = 0;
     _recvBufSize = 65507;
     _maxSocketBufSize = 1024 * 1024;
     _maxConnections = 2;
     _maxBatchSize = 1;
+    _maxQueueSize = 10000;
     _messageDelimiter = "\n";
     _protocol = "UDP";
     _port = 514;
     _parseMessages = false;
-    _serverSocket = 0;
-    _maxFds = 0;
-    FD_ZERO(&_readfds);
-    _thread = NULL;
-    _resetServerSocket = false;
+    _serverSocket = -1;
+    _pollFd = -1;
+    _eventCount = 0;
+    _droppedEvents = 0;
     _serverTheadRunning = false;
   }
   // Destructor
   virtual ~ListenSyslog() {
-    _serverTheadRunning = false;
-    if (this->_thread)
-      delete this->_thread;
-    // need to reset the socket
-    std::vector<int>::iterator it;
-    for (it = _clientSockets.begin(); it != _clientSockets.end(); ++it) {
-      int clientSocket = *it;
-      close(clientSocket);
-    }
-    _clientSockets.clear();
-    if (_serverSocket > 0) {
-      logger_->log_debug("ListenSysLog Server socket %d close", _serverSocket);
-      close(_serverSocket);
-      _serverSocket = 0;
-    }
+    stopSocketThread();
   }
   // Processor Name
   static constexpr char const *ProcessorName = "ListenSyslog";
@@ -109,6 +90,7 @@ class ListenSyslog : public core::Processor {
   static core::Property MaxSocketBufSize;
   static core::Property MaxConnections;
   static core::Property MaxBatchSize;
+  static core::Property MaxQueueSize;
   static core::Property MessageDelimiter;
   static core::Property ParseMessages;
   static core::Property Protocol;
@@ -116,101 +98,122 @@ class ListenSyslog : public core::Processor {
   // Supported Relationships
   static core::Relationship Success;
   static core::Relationship Invalid;
-  // Nest Callback Class for write stream
-  class WriteCallback : public OutputStreamCallback {
-   public:
-    WriteCallback(char *data, uint64_t size)
-        : _data(reinterpret_cast<uint8_t*>(data)),
-          _dataSize(size) {
-    }
-    uint8_t *_data;
-    uint64_t _dataSize;
-    int64_t process(std::shared_ptr<io::BaseStream> stream) {
-      int64_t ret = 0;
-      if (_data && _dataSize > 0)
-        ret = stream->write(_data, _dataSize);
-      return ret;
-    }
+
+  /**
+   * Fields of a syslog message in RFC 5424 or RFC 3164 format.
+   */
+  struct ParsedMessage {
+    int priority;
+    int severity;
+    int facility;
+    std::string version;
+    std::string timestamp;
+    std::string hostname;
+    std::string body;
   };
 
+  /**
+   * Parses (<PRIORITY>)(VERSION )(TIMESTAMP) (HOSTNAME) (BODY), where the version is optional and
+   * the timestamp is either an RFC 5424 or an RFC 3164 timestamp.
+   * @return whether the message matched one of the formats
+   */
+  static bool parseMessage(const char *data, size_t length, ParsedMessage &message);
+
  public:
   // OnTrigger method, implemented by NiFi ListenSyslog
   virtual void onTrigger(core::ProcessContext *context, core::ProcessSession *session);
   // Initialize, over write by NiFi ListenSyslog
   virtual void initialize(void);
 
+  virtual void onSchedule(core::ProcessContext *context, core::ProcessSessionFactory *sessionFactory);
+
  protected:
+  virtual void notifyStop();
 
  private:
+  // a received message with the address of its sender
+  struct SysLogEvent {
+    std::string payload;
+    std::string sender;
+  };
+
+  // a TCP client and the part of its next message received so far
+  struct Connection {
+    int socket;
+    std::string sender;
+    std::string pending;
+  };
+
+  // Nest Callback Class for write stream
+  class WriteCallback : public OutputStreamCallback {
+   public:
+    WriteCallback(const std::vector<SysLogEvent> &events, size_t begin, size_t end, const std::string &delimiter)
+        : events_(events),
+          begin_(begin),
+          end_(end),
+          delimiter_(delimiter) {
+    }
+    int64_t process(std::shared_ptr<io::BaseStream> stream);
+
+   private:
+    const std::vector<SysLogEvent> &events_;
+    size_t begin_;
+    size_t end_;
+    const std::string &delimiter_;
+  };
+
   // Logger
   std::shared_ptr<logging::Logger> logger_;
-  // Run function for the thread
-  static void run(ListenSyslog *process);
   // Run Thread
   void runThread();
-  // Queue for store syslog event
-  std::queue<SysLogEvent> _eventQueue;
-  // Size of Event queue in bytes
-  uint64_t _eventQueueByteSize;
-  // Get event queue size
-  uint64_t getEventQueueSize() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return _eventQueue.size();
-  }
-  // Get event queue byte size
-  uint64_t getEventQueueByteSize() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return _eventQueueByteSize;
-  }
-  // Whether the event queue  is empty
-  bool isEventQueueEmpty() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return _eventQueue.empty();
-  }
-  // Put event into directory listing
-  void putEvent(uint8_t *payload, uint64_t len) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    SysLogEvent event;
-    event.payload = reinterpret_cast<char*>(payload);
-    event.len = len;
-    _eventQueue.push(event);
-    _eventQueueByteSize += len;
-  }
-  // Read \n terminated line from TCP socket
-  int readline(int fd, char *bufptr, size_t len);
   // start server socket and handling client socket
   void startSocketThread();
-  // Poll event
-  void pollEvent(std::queue<SysLogEvent> &list, int maxSize) {
-    std::lock_guard<std::mutex> lock(mutex_);
-
-    while (!_eventQueue.empty() && (maxSize == 0 || list.size() < maxSize)) {
-      SysLogEvent event = _eventQueue.front();
-      _eventQueue.pop();
-      _eventQueueByteSize -= event.len;
-      list.push(event);
-    }
-    return;
-  }
-  // Mutex for protection of the directory listing
+  // stops the socket thread and closes all sockets
+  void stopSocketThread();
+  bool openServerSocket();
+  void closeSockets();
+  // waits up to 100 msec for readable sockets
+  bool waitForEvents(std::vector<int> &ready);
+  void acceptConnections();
+  void receiveDatagrams();
+  // returns false once the connection is closed
+  bool receiveStream(Connection &connection);
+  // frames the complete messages received on a connection
+  void extractMessages(Connection &connection, const char *data, size_t len);
+  // Put event into the queue, reusing the buffers of events that were already processed. The caller
+  // holds mutex_.
+  void putEvent(const char *payload, size_t len, const std::string &sender);
+  void transferEvents(core::ProcessSession *session, size_t count);
+
+  // Mutex for protection of the event queue
   std::mutex mutex_;
+  // serializes the triggers that drain the event queue
+  std::mutex poll_mutex_;
+  // events received by the socket thread; only the first _eventCount are valid, the rest keep their
+  // buffers for reuse
+  std::vector<SysLogEvent> _events;
+  size_t _eventCount;
+  // events being written to flow files, swapped with _events
+  std::vector<SysLogEvent> _polledEvents;
+  uint64_t _droppedEvents;
   int64_t _recvBufSize;
   int64_t _maxSocketBufSize;
   int64_t _maxConnections;
   int64_t _maxBatchSize;
+  int64_t _maxQueueSize;
   std::string _messageDelimiter;
   std::string _protocol;
-  int64_t _port;bool _parseMessages;
+  int64_t _port;
+  bool _parseMessages;
   int _serverSocket;
-  std::vector<int> _clientSockets;
-  int _maxFds;
-  fd_set _readfds;
+  // epoll instance, or -1 where poll() is used
+  int _pollFd;
+  std::vector<Connection> _clientSockets;
   // thread
-  std::thread *_thread;
-  // whether to reset the server socket
-  bool _resetServerSocket;bool _serverTheadRunning;
-  // buffer for read socket
-  char _buffer[2048];
+  std::thread _thread;
+  std::atomic<bool> _serverTheadRunning;
+  // datagram buffers, and the read buffer for TCP connections
+  std::vector<char> _buffer;
 };
 
 REGISTER_RESOURCE(ListenSyslog,"Listens for Syslog messages being sent to a given port over TCP or UDP. Incoming messages are checked against regular expressions for RFC5424 and RFC3164 formatted messages. "
@@ -0,0 +1,121 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include "TestBase.h"
+#include "LogAttribute.h"
+#include "ListenSyslog.h"
+
+using minifi::processors::ListenSyslog;
+
+namespace {
+
+bool parse(const std::string &text, ListenSyslog::ParsedMessage &message) {
+  return ListenSyslog::parseMessage(text.data(), text.size(), message);
+}
+
+}  // namespace
+
+TEST_CASE("ListenSyslogParsesRFC5424", "[listenSyslog1]") {
+  ListenSyslog::ParsedMessage message;
+  REQUIRE(parse("<34>1 2003-10-11T22:14:15.003Z mymachine.example.com su - ID47 - 'su root' failed\n", message));
+  REQUIRE(34 == message.priority);
+  REQUIRE(2 == message.severity);
+  REQUIRE(4 == message.facility);
+  REQUIRE("1" == message.version);
+  REQUIRE("2003-10-11T22:14:15.003Z" == message.timestamp);
+  REQUIRE("mymachine.example.com" == message.hostname);
+  REQUIRE("su - ID47 - 'su root' failed" == message.body);
+
+  REQUIRE(parse("<165>2003-08-24T05:14:15.000003-07:00 192.0.2.1 myproc 8710 - - %% It's time", message));
+  REQUIRE(165 == message.priority);
+  REQUIRE(message.version.empty());
+  REQUIRE("2003-08-24T05:14:15.000003-07:00" == message.timestamp);
+  REQUIRE("192.0.2.1" == message.hostname);
+}
+
+TEST_CASE("ListenSyslogParsesRFC3164", "[listenSyslog2]") {
+  ListenSyslog::ParsedMessage message;
+  REQUIRE(parse("<13>Oct 11 22:14:15 mymachine su: 'su root' failed", message));
+  REQUIRE(13 == message.priority);
+  REQUIRE(5 == message.severity);
+  REQUIRE(1 == message.facility);
+  REQUIRE("Oct 11 22:14:15" == message.timestamp);
+  REQUIRE("mymachine" == message.hostname);
+  REQUIRE("su: 'su root' failed" == message.body);
+
+  REQUIRE(parse("<0>Feb  5 01:02:03 host ", message));
+  REQUIRE("Feb  5 01:02:03" == message.timestamp);
+  REQUIRE(message.body.empty());
+}
+
+TEST_CASE("ListenSyslogRejectsInvalidMessages", "[listenSyslog3]") {
+  ListenSyslog::ParsedMessage message;
+  REQUIRE(!parse("", message));
+  REQUIRE(!parse("no priority", message));
+  REQUIRE(!parse("<192>Oct 11 22:14:15 mymachine body", message));
+  REQUIRE(!parse("<13>Foo 11 22:14:15 mymachine body", message));
+  REQUIRE(!parse("<13>Oct 11 22:14 mymachine body", message));
+  REQUIRE(!parse("<13>2003-10-11 22:14:15 mymachine body", message));
+  REQUIRE(!parse("<13>Oct 11 22:14:15 mymachine", message));
+  REQUIRE(!parse("<13>1 2003-10-11T22:14:15Z", message));
+}
+
+TEST_CASE("ListenSyslogReceivesUDP", "[listenSyslog4]") {
+  TestController testController;
+  LogTestController::getInstance().setDebug<minifi::processors::LogAttribute>();
+  std::shared_ptr<TestPlan> plan = testController.createPlan();
+
+  auto listen = plan->addProcessor("ListenSyslog", "listen");
+  listen->setAutoTerminatedRelationships({ ListenSyslog::Invalid });
+  plan->addProcessor("LogAttribute", "log", core::Relationship("success", "description"), true);
+  plan->setProperty(listen, ListenSyslog::Port.getName(), "20514");
+  plan->setProperty(listen, ListenSyslog::ParseMessages.getName(), "true");
+
+  // schedules the processor, which opens the socket
+  plan->runNextProcessor();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  int sender = socket(AF_INET, SOCK_DGRAM, 0);
+  REQUIRE(sender >= 0);
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(20514);
+  address.sin_addr.s_addr = inet_addr("127.0.0.1");
+  const std::string message = "<13>Oct 11 22:14:15 mymachine su: 'su root' failed";
+  REQUIRE(message.size() == sendto(sender, message.data(), message.size(), 0, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)));
+  close(sender);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  plan->runCurrentProcessor();
+  plan->runNextProcessor();
+
+  REQUIRE(LogTestController::getInstance().contains("key:syslog.hostname value:mymachine"));
+  REQUIRE(LogTestController::getInstance().contains("key:syslog.priority value:13"));
+  REQUIRE(LogTestController::getInstance().contains("key:syslog.valid value:true"));
+  REQUIRE(LogTestController::getInstance().contains("key:syslog.sender value:127.0.0.1"));
+  LogTestController::getInstance().reset();
+}
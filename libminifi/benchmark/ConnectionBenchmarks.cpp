@@ -0,0 +1,83 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include "../test/TestBase.h"
+#include "Connection.h"
+#include "FlowFileRecord.h"
+#include "core/FlowFilePrioritizer.h"
+
+namespace {
+
+std::shared_ptr<minifi::Connection> connection;
+
+std::shared_ptr<core::FlowFile> createFlowFile() {
+  auto flow = std::make_shared<minifi::FlowFileRecord>(nullptr, nullptr, std::map<std::string, std::string>());
+  // already persisted, so put() measures only the queue
+  flow->setStoredToRepository(true);
+  return flow;
+}
+
+void setUpConnection(benchmark::State &st, const std::string &prioritizer, bool penalized_head) {
+  if (st.thread_index != 0) {
+    return;
+  }
+  connection = std::make_shared<minifi::Connection>(nullptr, nullptr, "benchmark");
+  connection->setPrioritizer(core::FlowFilePrioritizer::create(prioritizer));
+  if (penalized_head) {
+    auto penalized = createFlowFile();
+    penalized->setPenaltyExpiration(getTimeMillis() + 3600 * 1000);
+    connection->put(penalized);
+  }
+}
+
+void put_poll(benchmark::State &st) {
+  auto flow = createFlowFile();
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  for (auto _ : st) {
+    connection->put(flow);
+    benchmark::DoNotOptimize(connection->poll(expired));
+  }
+  st.SetItemsProcessed(st.iterations());
+}
+
+}  // namespace
+
+static void Connection_PutPoll(benchmark::State &st) {
+  setUpConnection(st, "", false);
+  put_poll(st);
+}
+BENCHMARK(Connection_PutPoll)->ThreadRange(1, 16)->UseRealTime();
+
+static void Connection_PutPoll_PenalizedHead(benchmark::State &st) {
+  setUpConnection(st, "", true);
+  put_poll(st);
+}
+BENCHMARK(Connection_PutPoll_PenalizedHead)->ThreadRange(1, 16)->UseRealTime();
+
+static void Connection_PutPoll_OldestFirst(benchmark::State &st) {
+  setUpConnection(st, "OldestFlowFileFirstPrioritizer", false);
+  put_poll(st);
+}
+BENCHMARK(Connection_PutPoll_OldestFirst)->ThreadRange(1, 16)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -21,6 +21,7 @@
 #include "ResourceClaim.h"
 #include "core/Core.h"
 #include "repository/FileSystemRepository.h"
+#include "repository/SlabContentRepository.h"
 #include "repository/VolatileContentRepository.h"
 #include "properties/Configure.h"
 
@@ -105,6 +106,7 @@ class MemoryMapBMFixture : public benchmark::Fixture {
 
 typedef MemoryMapBMFixture<core::repository::FileSystemRepository> FSMemoryMapBMFixture;
 typedef MemoryMapBMFixture<core::repository::VolatileContentRepository> VolatileMemoryMapBMFixture;
+typedef MemoryMapBMFixture<core::repository::SlabContentRepository> SlabMemoryMapBMFixture;
 
 #ifdef ENABLE_ROCKSDB_BENCHMARKS 
 typedef MemoryMapBMFixture<core::repository::DatabaseContentRepository> DatabaseMemoryMapBMFixture;
@@ -389,6 +391,104 @@ BENCHMARK_F(VolatileMemoryMapBMFixture, Callback_VolatileRepository_RandomRead_L
   cb_read_random<VolatileMemoryMapBMFixture>(this, st);
 }
 
+BENCHMARK_F(SlabMemoryMapBMFixture, MemoryMap_SlabContentRepository_Read_Tiny)(benchmark::State &st) {
+  init_db_repo();
+  set_test_input(10, 'x');
+  set_test_expected_output(10, 'x');
+  mmap_read<SlabMemoryMapBMFixture>(this, st);
+}
+
+BENCHMARK_F(SlabMemoryMapBMFixture, Callback_SlabContentRepository_Read_Tiny)(benchmark::State &st) {
+  init_db_repo();
+  set_test_input(10, 'x');
+  set_test_expected_output(10, 'x');
+  cb_read<SlabMemoryMapBMFixture>(this, st);
+}
+
+BENCHMARK_F(SlabMemoryMapBMFixture, MemoryMap_SlabContentRepository_WriteRead_Tiny)(benchmark::State &st) {
+  init_db_repo();
+  set_test_input(10, 'x');
+  set_test_expected_output(10, 'y');
+  mmap_write_read<SlabMemoryMapBMFixture>(this, st);
+}
+
+BENCHMARK_F(SlabMemoryMapBMFixture, Callback_SlabContentRepository_WriteRead_Tiny)(benchmark::State &st) {
+  init_db_repo();
+  set_test_input(10, 'x');
+  set_test_expected_output(10, 'y');
+  cb_write_read<SlabMemoryMapBMFixture>(this, st);
+}
+
+BENCHMARK_F(SlabMemoryMapBMFixture, MemoryMap_SlabContentRepository_Read_Small)(benchmark::State &st) {
+  init_db_repo();
+  set_test_input(131072, 'x');
+  set_test_expected_output(131072, 'x');
+  mmap_read<SlabMemoryMapBMFixture>(this, st);
+}
+
+BENCHMARK_F(SlabMemoryMapBMFixture, Callback_SlabContentRepository_Read_Small)(benchmark::State &st) {
+  init_db_repo();
+  set_test_input(131072, 'x');
+  set_test_expected_output(131072, 'x');
+  cb_read<SlabMemoryMapBMFixture>(this, st);
+}
+
+BENCHMARK_F(SlabMemoryMapBMFixture, MemoryMap_SlabContentRepository_WriteRead_Small)(benchmark::State &st) {
+  init_db_repo();
+  set_test_input(131072, 'x');
+  set_test_expected_output(131072, 'y');
+  mmap_write_read<SlabMemoryMapBMFixture>(this, st);
+}
+
+BENCHMARK_F(SlabMemoryMapBMFixture, Callback_SlabContentRepository_WriteRead_Small)(benchmark::State &st) {
+  init_db_repo();
+  set_test_input(131072, 'x');
+  set_test_expected_output(131072, 'y');
+  cb_write_read<SlabMemoryMapBMFixture>(this, st);
+}
+
+BENCHMARK_F(SlabMemoryMapBMFixture, MemoryMap_SlabContentRepository_Read_Large)(benchmark::State &st) {
+  init_db_repo();
+  set_test_input(33554432, 'x');
+  set_test_expected_output(33554432, 'x');
+  mmap_read<SlabMemoryMapBMFixture>(this, st);
+}
+
+BENCHMARK_F(SlabMemoryMapBMFixture, Callback_SlabContentRepository_Read_Large)(benchmark::State &st) {
+  init_db_repo();
+  set_test_input(33554432, 'x');
+  set_test_expected_output(33554432, 'x');
+  cb_read<SlabMemoryMapBMFixture>(this, st);
+}
+
+BENCHMARK_F(SlabMemoryMapBMFixture, MemoryMap_SlabContentRepository_WriteRead_Large)(benchmark::State &st) {
+  init_db_repo();
+  set_test_input(33554432, 'x');
+  set_test_expected_output(33554432, 'y');
+  mmap_write_read<SlabMemoryMapBMFixture>(this, st);
+}
+
+BENCHMARK_F(SlabMemoryMapBMFixture, Callback_SlabContentRepository_WriteRead_Large)(benchmark::State &st) {
+  init_db_repo();
+  set_test_input(33554432, 'x');
+  set_test_expected_output(33554432, 'y');
+  cb_write_read<SlabMemoryMapBMFixture>(this, st);
+}
+
+BENCHMARK_F(SlabMemoryMapBMFixture, MemoryMap_SlabContentRepository_RandomRead_Large)(benchmark::State &st) {
+  init_db_repo();
+  set_test_input(33554432, 'x');
+  set_test_expected_output(33554432, 'x');
+  mmap_read_random<SlabMemoryMapBMFixture>(this, st);
+}
+
+BENCHMARK_F(SlabMemoryMapBMFixture, Callback_SlabContentRepository_RandomRead_Large)(benchmark::State &st) {
+  init_db_repo();
+  set_test_input(33554432, 'x');
+  set_test_expected_output(33554432, 'x');
+  cb_read_random<SlabMemoryMapBMFixture>(this, st);
+}
+
 #ifdef ENABLE_ROCKSDB_BENCHMARKS 
 
 BENCHMARK_F(DatabaseMemoryMapBMFixture, MemoryMap_DatabaseRepository_Read_Tiny)(benchmark::State &st) {
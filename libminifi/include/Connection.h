@@ -28,12 +28,16 @@
 #include <atomic>
 #include <algorithm>
 #include "core/Core.h"
+#include "ConnectionMetrics.h"
 #include "core/Connectable.h"
 #include "core/logging/Logger.h"
 #include "core/Relationship.h"
 #include "core/Connectable.h"
 #include "core/FlowFile.h"
+#include "core/FlowFilePrioritizer.h"
+#include "core/FlowFileQueue.h"
 #include "core/Repository.h"
+#include "io/DataStream.h"
 
 namespace org {
 namespace apache {
@@ -131,19 +135,34 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
   uint64_t getFlowExpirationDuration() {
     return expired_duration_;
   }
+  // Set the prioritizer ordering this connection, nullptr for unordered (per producer FIFO) delivery
+  void setPrioritizer(const std::shared_ptr<core::FlowFilePrioritizer> &prioritizer) {
+    queue_.setPrioritizer(prioritizer);
+  }
+  // Get the prioritizer ordering this connection
+  std::shared_ptr<core::FlowFilePrioritizer> getPrioritizer() const {
+    return queue_.getPrioritizer();
+  }
   // Check whether the queue is empty
   bool isEmpty();
   // Check whether the queue is full to apply back pressure
   bool isFull();
   // Get queue size
   uint64_t getQueueSize() {
-    std::lock_guard<std::mutex> lock(mutex_);
     return queue_.size();
   }
+  // Get the number of queued flow files that are penalized
+  uint64_t getPenalizedQueueSize() {
+    return queue_.getPenalizedCount();
+  }
   // Get queue data size
   uint64_t getQueueDataSize() {
     return queued_data_size_;
   }
+  // Get the enqueue, dequeue and queue wait metrics
+  const ConnectionMetrics &getConnectionMetrics() const {
+    return connection_metrics_;
+  }
   void put(std::shared_ptr<core::Connectable> flow) {
     std::shared_ptr<core::FlowFile> ff = std::static_pointer_cast<core::FlowFile>(flow);
     if (nullptr != ff) {
@@ -152,8 +171,35 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
   }
   // Put the flow file into queue
   void put(std::shared_ptr<core::FlowFile> flow);
+  // Put the flow files into queue, persisting the ones not yet stored with a single repository write
+  void multiPut(std::vector<std::shared_ptr<core::FlowFile>> &flows);
+
+  // Flow files serialized for one write to the flow file repository
+  struct FlowFileBatch {
+    std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+    std::vector<std::pair<std::string, std::unique_ptr<io::DataStream>>> data;
+  };
+  /**
+   * Serializes the flow files that are not stored yet, as queued on the given connection, into the batch.
+   */
+  static void serializeFlowFiles(const std::shared_ptr<core::Repository> &flow_repository, const std::shared_ptr<core::ContentRepository> &content_repo,
+                                 const std::vector<std::shared_ptr<core::FlowFile>> &flows, const std::string &connection_uuid, FlowFileBatch &batch);
+  /**
+   * Stores the batch with one repository write and marks its flow files as stored.
+   * @return false if the batch could not be stored
+   */
+  static bool storeFlowFiles(const std::shared_ptr<core::Repository> &flow_repository, FlowFileBatch &batch);
   // Poll the flow file from queue, the expired flow file record also being returned
   std::shared_ptr<core::FlowFile> poll(std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords);
+  /**
+   * Polls up to max_count flow files from the queue in one pass.
+   * @param max_count maximum number of flow files to return
+   * @param max_bytes stop once the returned flow files reach this size, 0 for no limit
+   * @param flows vector to which the polled flow files are appended
+   * @param expiredFlowRecords receives the expired flow files found along the way
+   * @return number of flow files appended to flows
+   */
+  size_t poll(size_t max_count, uint64_t max_bytes, std::vector<std::shared_ptr<core::FlowFile>> &flows, std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords);
   // Drain the flow records
   void drain();
 
@@ -162,7 +208,7 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
   }
 
   bool isWorkAvailable() {
-    return !isEmpty();
+    return queue_.isWorkAvailable();
   }
 
   bool isRunning() {
@@ -192,12 +238,15 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
   std::shared_ptr<core::ContentRepository> content_repo_;
 
  private:
-  // Mutex for protection
-  std::mutex mutex_;
+  // Records a flow file leaving the queue at now
+  void recordDequeue(const std::shared_ptr<core::FlowFile> &flow, uint64_t now);
+
   // Queued data size
   std::atomic<uint64_t> queued_data_size_;
+  // Enqueue, dequeue and queue wait metrics
+  ConnectionMetrics connection_metrics_;
   // Queue for the Flow File
-  std::queue<std::shared_ptr<core::FlowFile>> queue_;
+  core::FlowFileQueue queue_;
   // flow repository
   // Logger
   std::shared_ptr<logging::Logger> logger_;
@@ -0,0 +1,94 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_CONNECTIONMETRICS_H_
+#define LIBMINIFI_INCLUDE_CONNECTIONMETRICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include "utils/LatencyHistogram.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+
+/**
+ * Purpose: Counts the flow files passing through a connection and how long they were queued.
+ */
+class ConnectionMetrics {
+ public:
+  ConnectionMetrics()
+      : enqueued_(0),
+        enqueued_bytes_(0),
+        dequeued_(0),
+        dequeued_bytes_(0) {
+  }
+
+  void recordEnqueue(uint64_t flow_files, uint64_t bytes) {
+    enqueued_.fetch_add(flow_files, std::memory_order_relaxed);
+    enqueued_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  /**
+   * Records a flow file leaving the queue.
+   * @param bytes size of the flow file
+   * @param wait_millis time the flow file spent in the queue
+   */
+  void recordDequeue(uint64_t bytes, uint64_t wait_millis) {
+    dequeued_.fetch_add(1, std::memory_order_relaxed);
+    dequeued_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    queue_wait_.record(wait_millis);
+  }
+
+  uint64_t getEnqueued() const {
+    return enqueued_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getEnqueuedBytes() const {
+    return enqueued_bytes_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getDequeued() const {
+    return dequeued_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getDequeuedBytes() const {
+    return dequeued_bytes_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the histogram of queue wait times in milliseconds.
+   */
+  const utils::LatencyHistogram &getQueueWait() const {
+    return queue_wait_;
+  }
+
+ private:
+  std::atomic<uint64_t> enqueued_;
+  std::atomic<uint64_t> enqueued_bytes_;
+  std::atomic<uint64_t> dequeued_;
+  std::atomic<uint64_t> dequeued_bytes_;
+  utils::LatencyHistogram queue_wait_;
+};
+
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_CONNECTIONMETRICS_H_ */
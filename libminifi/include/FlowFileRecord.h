@@ -24,6 +24,8 @@
 #include <vector>
 #include <queue>
 #include <map>
+#include <string>
+#include <utility>
 #include <mutex>
 #include <atomic>
 #include <iostream>
@@ -70,6 +72,7 @@ enum FlowAttribute {
 };
 
 // FlowFile Attribute Key
+// serialized records refer to these keys by their index, so new keys may only be appended
 static const char *FlowAttributeKeyArray[MAX_FLOW_ATTRIBUTES] = { "path", "absolute.path", "filename", "uuid", "priority", "mime.type", "discard.reason", "alternate.identifier", "flow.id" };
 
 // FlowFile Attribute Enum to Key
@@ -105,6 +108,57 @@ public:
   virtual bool process(std::shared_ptr<io::BaseMemoryMap> map) = 0;
 };
 
+/**
+ * The persisted fields of a flow file record. Repositories decode records into these to inspect
+ * or rewrite them without creating the resource claim that a FlowFileRecord holds.
+ */
+struct FlowFileRecordFields {
+  FlowFileRecordFields()
+      : event_time(0),
+        entry_date(0),
+        lineage_start_date(0),
+        size(0),
+        offset(0) {
+  }
+  uint64_t event_time;
+  uint64_t entry_date;
+  uint64_t lineage_start_date;
+  std::string uuid;
+  std::string connection;
+  std::map<std::string, std::string> attributes;
+  std::string content_path;
+  uint64_t size;
+  uint64_t offset;
+};
+
+/**
+ * The fields of a compact record located in the buffer they were read from, so that a repository
+ * can compare a record with the one stored before it without decoding either. Strings point into
+ * that buffer, except for a binary connection identifier, which is unparsed into the view.
+ */
+struct FlowFileRecordView {
+  struct String {
+    const char *data;
+    size_t length;
+  };
+  FlowFileRecordView()
+      : event_time(0),
+        entry_date(0),
+        lineage_start_date(0),
+        size(0),
+        offset(0) {
+  }
+  uint64_t event_time;
+  uint64_t entry_date;
+  uint64_t lineage_start_date;
+  String connection;
+  std::vector<std::pair<String, String>> attributes;
+  String content_path;
+  uint64_t size;
+  uint64_t offset;
+  char connection_buffer[37];
+};
+
 class FlowFileRecord : public core::FlowFile, public io::Serializable {
  public:
   // Constructor
@@ -139,8 +193,18 @@ class FlowFileRecord : public core::FlowFile, public io::Serializable {
 
   //! Serialize and Persistent to the repository
   bool Serialize();
-  //! DeSerialize
+  //! Serialize into the stream without persisting, e.g. for Repository::MultiPut
+  bool Serialize(io::DataStream &outStream);
+  //! Serialize the fields into the stream in the same format
+  static bool Serialize(const FlowFileRecordFields &fields, io::DataStream &outStream);
+  //! DeSerialize, accepting both the compact and the legacy record format
   bool DeSerialize(const uint8_t *buffer, const int bufferSize);
+  //! DeSerialize into fields, accepting both the compact and the legacy record format
+  static bool DeSerialize(const uint8_t *buffer, const int bufferSize, FlowFileRecordFields &fields);
+  //! DeSerialize from decoded fields, which are moved from
+  void DeSerialize(FlowFileRecordFields &fields);
+  //! Locates the fields of a compact record without copying them; any other format is rejected
+  static bool View(const uint8_t *buffer, const int bufferSize, FlowFileRecordView &view);
   //! DeSerialize
   bool DeSerialize(io::DataStream &stream) {
     return DeSerialize(stream.getBuffer(), stream.getSize());
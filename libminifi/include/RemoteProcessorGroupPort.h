@@ -86,6 +86,7 @@ class RemoteProcessorGroupPort : public core::Processor {
         timeout_(0),
         http_enabled_(false),
         bypass_rest_api_(false),
+        use_compression_(false),
         ssl_service(nullptr),
         logger_(logging::LoggerFactory<RemoteProcessorGroupPort>::getLogger()) {
     client_type_ = sitetosite::CLIENT_TYPE::RAW;
@@ -178,6 +179,11 @@ class RemoteProcessorGroupPort : public core::Processor {
     client_type_ = sitetosite::HTTP;
   }
 
+  // compress the data packets sent or received through this port
+  void setUseCompression(bool use_compression) {
+    use_compression_ = use_compression;
+  }
+
  protected:
 
   /**
@@ -220,12 +226,16 @@ class RemoteProcessorGroupPort : public core::Processor {
 
   bool bypass_rest_api_;
 
+  bool use_compression_;
+
   sitetosite::CLIENT_TYPE client_type_;
 
   // Remote Site2Site Info
   bool site2site_secure_;
   std::vector<sitetosite::PeerStatus> peers_;
   std::atomic<int> peer_index_;
+  // weights clients towards the less loaded peers
+  sitetosite::PeerSelector peer_selector_;
   std::mutex peer_mutex_;
   std::string rest_user_name_;
   std::string rest_password_;
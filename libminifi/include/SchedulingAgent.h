@@ -29,6 +29,7 @@
 #include <thread>
 #include "utils/TimeUtil.h"
 #include "utils/ThreadPool.h"
+#include "utils/StringUtils.h"
 #include "utils/BackTrace.h"
 #include "core/Core.h"
 #include "core/logging/LoggerConfiguration.h"
@@ -106,6 +107,34 @@ class SingleRunMonitor : public TimerAwareMonitor {
   }
 };
 
+/**
+ * Parks the worker of a processor once its incoming connections are empty. The
+ * processor's work listener wakes it up when a flow file is queued. Processors that
+ * ask to be triggered when empty at runtime, e.g. to serve work they have in flight,
+ * are not parked until they stop asking.
+ */
+class IdleParkingMonitor : public TimerAwareMonitor {
+ public:
+  IdleParkingMonitor(std::atomic<bool> *run_monitor, const std::shared_ptr<core::Processor> &processor)
+      : TimerAwareMonitor(run_monitor),
+        processor_(processor) {
+  }
+  virtual bool isParked(const uint64_t &result) {
+    if (processor_->isYield() || processor_->getTriggerWhenEmpty()) {
+      return false;
+    }
+    // armed before checking, so that a flow file queued in between still wakes us up
+    processor_->armWorkListener();
+    if (processor_->flowFilesQueued()) {
+      processor_->disarmWorkListener();
+      return false;
+    }
+    return true;
+  }
+ protected:
+  std::shared_ptr<core::Processor> processor_;
+};
+
 // SchedulingAgent Class
 class SchedulingAgent {
  public:
@@ -130,6 +159,23 @@ class SchedulingAgent {
      */
     auto csThreads = configure_->getInt(Configure::nifi_flow_engine_threads, 2);
     auto pool = utils::ThreadPool<uint64_t>(csThreads, false, controller_service_provider, "SchedulingAgent");
+    bool work_stealing = false;
+    bool pin_threads = false;
+    std::string value;
+    if (configure_->get(Configure::nifi_flow_engine_work_stealing, value)) {
+      utils::StringUtils::StringToBool(value, work_stealing);
+    }
+    if (configure_->get(Configure::nifi_flow_engine_thread_affinity, value)) {
+      utils::StringUtils::StringToBool(value, pin_threads);
+    }
+    pool.setWorkStealing(work_stealing, pin_threads);
+    if (configure_->get(Configure::nifi_flow_engine_park_timeout, value)) {
+      int64_t park_timeout = 0;
+      core::TimeUnit unit;
+      if (core::Property::StringToTime(value, park_timeout, unit) && core::Property::ConvertTimeUnitToMS(park_timeout, unit, park_timeout) && park_timeout > 0) {
+        pool.setParkTimeout(park_timeout);
+      }
+    }
     thread_pool_ = std::move(pool);
     thread_pool_.start();
   }
@@ -158,6 +204,13 @@ class SchedulingAgent {
     return thread_pool_.getTraces();
   }
 
+  /**
+   * @return whether processors without incoming work are parked until a flow file is queued for them.
+   */
+  bool isParkingEnabled() const {
+    return thread_pool_.isWorkStealing() && thread_pool_.getParkTimeout() > 0;
+  }
+
  public:
   virtual std::future<uint64_t> enableControllerService(std::shared_ptr<core::controller::ControllerServiceNode> &serviceNode);
   virtual std::future<uint64_t> disableControllerService(std::shared_ptr<core::controller::ControllerServiceNode> &serviceNode);
@@ -0,0 +1,36 @@
+#ifndef AGENT_BUILD_H
+#define AGENT_BUILD_H
+
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+
+class AgentBuild {
+ public:
+  static constexpr const char* VERSION = "0.7.0";
+  static constexpr const char* BUILD_IDENTIFIER = "MP6c04DAkHC0iVzKlp2DBarN";
+  static constexpr const char* BUILD_REV = "";
+  static constexpr const char* BUILD_DATE = "1792235256";
+  static constexpr const char* COMPILER = "/usr/bin/c++";
+  static constexpr const char* COMPILER_VERSION = "12.2.0";
+  static constexpr const char* COMPILER_FLAGS = "-include limits -include cstdint -std=c++11 -DOPENSSL_SUPPORT -DDISABLE_CURL";
+  static std::vector<std::string> getExtensions() {
+  	static std::vector<std::string> extensions;
+  	if (extensions.empty()){
+      extensions.push_back("minifi-standard-processors");
+      extensions.push_back("minifi-archive-extensions");
+      extensions.push_back("minifi-system");
+    }
+  	return extensions;
+  }
+};
+
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* AGENT_BUILD_H */
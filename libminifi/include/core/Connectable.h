@@ -22,6 +22,7 @@
 #include <set>
 #include "Core.h"
 #include <condition_variable>
+#include <functional>
 #include "core/logging/Logger.h"
 #include "Relationship.h"
 #include "Scheduling.h"
@@ -74,8 +75,10 @@ class Connectable : public CoreComponent {
    */
   std::set<std::shared_ptr<Connectable>> getOutGoingConnections(const std::string &relationship) const;
 
-  void put(std::shared_ptr<Connectable> flow) {
-
+  /**
+   * Queues a flow file; connections override this, so the repository can restore flow files into them.
+   */
+  virtual void put(std::shared_ptr<Connectable> flow) {
   }
 
   /**
@@ -121,6 +124,22 @@ class Connectable : public CoreComponent {
 
   void notifyWork();
 
+  /**
+   * Sets the listener that a parked scheduler uses to be woken up, or nullptr to remove it.
+   */
+  void setWorkListener(std::function<void()> listener);
+
+  /**
+   * Arms the work listener: the next notifyWork calls it once.
+   */
+  void armWorkListener() {
+    work_listener_armed_ = true;
+  }
+
+  void disarmWorkListener() {
+    work_listener_armed_ = false;
+  }
+
   /**
    * Determines if work is available by this connectable
    * @return boolean if work is available.
@@ -186,6 +205,10 @@ class Connectable : public CoreComponent {
   std::condition_variable work_condition_;
   // version under which this connectable was created.
   std::shared_ptr<state::FlowIdentifier> connectable_version_;
+  // whether notifyWork calls the work listener
+  std::atomic<bool> work_listener_armed_;
+  std::mutex work_listener_mutex_;
+  std::function<void()> work_listener_;
 
  private:
   std::shared_ptr<logging::Logger> logger_;
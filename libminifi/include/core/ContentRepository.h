@@ -52,6 +52,15 @@ class ContentRepository : public StreamManager<minifi::ResourceClaim>, public Me
    */
   virtual void stop() = 0;
 
+  /**
+   * Stores length bytes of the source file, starting at offset, as the claim's content without passing
+   * them through a stream, where the repository supports it.
+   * @return false if the content was not stored; callers then write it through a stream instead.
+   */
+  virtual bool importFile(const std::string &source, uint64_t offset, uint64_t length, const std::shared_ptr<minifi::ResourceClaim> &claim) {
+    return false;
+  }
+
   /**
    * Removes an item if it was orphan
    */
@@ -18,6 +18,10 @@
 #ifndef RECORD_H
 #define RECORD_H
 
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
 #include "utils/TimeUtil.h"
 #include "ResourceClaim.h"
 #include "Connectable.h"
@@ -119,6 +123,18 @@ class FlowFile : public core::Connectable, public ReferenceContainer {
    */
   void setLineageStartDate(const uint64_t date);
 
+  /**
+   * Get the date at which this record was last queued
+   * @return last queue date uint64_t
+   */
+  uint64_t getLastQueueDate();
+
+  /**
+   * Sets the date at which this record was last queued
+   * @param date new last queue date
+   */
+  void setLastQueueDate(const uint64_t date);
+
   void setLineageIdentifiers(std::set<std::string> lineage_Identifiers) {
     lineage_Identifiers_ = lineage_Identifiers;
   }
@@ -150,25 +166,25 @@ class FlowFile : public core::Connectable, public ReferenceContainer {
   /**
    * setAttribute, if attribute already there, update it, else, add it
    */
-  void setAttribute(const std::string &key, const std::string &value) {
-    attributes_[key] = value;
-  }
+  void setAttribute(const std::string &key, const std::string &value);
 
   /**
    * Returns the map of attributes
    * @return attributes.
    */
-  std::map<std::string, std::string> getAttributes() {
-    return attributes_;
-  }
+  std::map<std::string, std::string> getAttributes();
 
   /**
-   * Returns the map of attributes
+   * Returns the map of attributes, which is no longer shared with other flow files
    * @return attributes.
    */
-  std::map<std::string, std::string> *getAttributesPtr() {
-    return &attributes_;
-  }
+  std::map<std::string, std::string> *getAttributesPtr();
+
+  /**
+   * Takes over the attributes of parent, keeping the attributes of this flow file that parent does
+   * not have. The attribute map is shared with parent until either flow file modifies it.
+   */
+  void inheritAttributes(const FlowFile &parent);
 
   /**
    * adds an attribute if it does not exist
@@ -220,6 +236,14 @@ class FlowFile : public core::Connectable, public ReferenceContainer {
     return true;
   }
 
+  /**
+   * Returns the identifier in its binary form, which is cheaper to compare and hash than the
+   * string returned by getUUIDStr().
+   */
+  const utils::Identifier &getUUID() const {
+    return uuid_;
+  }
+
   // Check whether it is still being penalized
   bool isPenalized() {
     return (penaltyExpiration_ms_ > 0 ? penaltyExpiration_ms_ > getTimeMillis() : false);
@@ -307,8 +331,15 @@ class FlowFile : public core::Connectable, public ReferenceContainer {
   uint64_t offset_;
   // Penalty expiration
   uint64_t penaltyExpiration_ms_;
-  // Attributes key/values pairs for the flow record
-  std::map<std::string, std::string> attributes_;
+  /**
+   * Returns the attribute map for modification, copying it first if another flow file shares it.
+   */
+  std::map<std::string, std::string> &mutableAttributes();
+
+  // Attributes key/values pairs for the flow record, shared with copies and children of this flow
+  // file until one of them modifies it. The uuid attribute is only stored when it differs from the
+  // identifier of the flow file, which lets children share the map of their parent.
+  std::shared_ptr<std::map<std::string, std::string>> attributes_;
   // Pointer to the associated content resource claim
   std::shared_ptr<ResourceClaim> claim_;
   // Pointers to stashed content resource claims
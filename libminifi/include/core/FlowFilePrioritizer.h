@@ -0,0 +1,94 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_CORE_FLOWFILEPRIORITIZER_H_
+#define LIBMINIFI_INCLUDE_CORE_FLOWFILEPRIORITIZER_H_
+
+#include <memory>
+#include <string>
+#include "core/FlowFile.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+/**
+ * Purpose: Determines the order in which flow files are dequeued from a connection.
+ *
+ * Names follow the NiFi prioritizer classes so that the 'queue prioritizer class'
+ * of a connection can be given either as the simple or the fully qualified name.
+ */
+class FlowFilePrioritizer {
+ public:
+  virtual ~FlowFilePrioritizer() {
+  }
+
+  /**
+   * @return true if lhs should be dequeued before rhs.
+   */
+  virtual bool isHigherPriority(const std::shared_ptr<core::FlowFile> &lhs, const std::shared_ptr<core::FlowFile> &rhs) = 0;
+
+  /**
+   * Creates a prioritizer from its class name.
+   * @param name simple or fully qualified prioritizer class name
+   * @return prioritizer or nullptr when the name is empty, FirstInFirstOutPrioritizer or unknown.
+   * A null prioritizer selects the unordered, lock-free path of the connection queue.
+   */
+  static std::shared_ptr<FlowFilePrioritizer> create(const std::string &name);
+};
+
+/**
+ * Dequeues flow files with the oldest entry date first.
+ */
+class OldestFlowFileFirstPrioritizer : public FlowFilePrioritizer {
+ public:
+  virtual bool isHigherPriority(const std::shared_ptr<core::FlowFile> &lhs, const std::shared_ptr<core::FlowFile> &rhs) {
+    return lhs->getEntryDate() < rhs->getEntryDate();
+  }
+};
+
+/**
+ * Dequeues flow files with the newest entry date first.
+ */
+class NewestFlowFileFirstPrioritizer : public FlowFilePrioritizer {
+ public:
+  virtual bool isHigherPriority(const std::shared_ptr<core::FlowFile> &lhs, const std::shared_ptr<core::FlowFile> &rhs) {
+    return lhs->getEntryDate() > rhs->getEntryDate();
+  }
+};
+
+/**
+ * Dequeues flow files based on their 'priority' attribute. As in NiFi, numeric
+ * priorities sort before non-numeric ones, lower values are dequeued first and
+ * flow files without the attribute are dequeued last.
+ */
+class PriorityAttributePrioritizer : public FlowFilePrioritizer {
+ public:
+  static const char *PRIORITY_ATTRIBUTE;
+
+  virtual bool isHigherPriority(const std::shared_ptr<core::FlowFile> &lhs, const std::shared_ptr<core::FlowFile> &rhs);
+};
+
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_CORE_FLOWFILEPRIORITIZER_H_ */
@@ -0,0 +1,161 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_CORE_FLOWFILEQUEUE_H_
+#define LIBMINIFI_INCLUDE_CORE_FLOWFILEQUEUE_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "concurrentqueue.h"
+#include "core/FlowFile.h"
+#include "core/FlowFilePrioritizer.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+/**
+ * Purpose: Multi-producer/multi-consumer queue backing a Connection.
+ *
+ * Design: Active flow files are kept in a lock-free moodycamel queue when no
+ * prioritizer is configured; with a prioritizer they are kept in a binary heap
+ * ordered by it. Penalized flow files never sit in the active queue: they are
+ * parked in a separate heap keyed on the penalty expiration and are moved back
+ * once the penalty has expired, so a penalized flow file no longer blocks the
+ * ones queued behind it. Consumers only touch the penalty heap's lock when the
+ * earliest penalty is due.
+ *
+ * Without a prioritizer ordering is FIFO per producer, as with the ThreadPool.
+ */
+class FlowFileQueue {
+ public:
+  FlowFileQueue();
+
+  /**
+   * Sets the prioritizer. Must be called before the queue is used
+   * concurrently, i.e. while the flow is being configured.
+   * @param prioritizer prioritizer, or nullptr for the lock-free unordered path
+   */
+  void setPrioritizer(const std::shared_ptr<FlowFilePrioritizer> &prioritizer);
+
+  std::shared_ptr<FlowFilePrioritizer> getPrioritizer() const {
+    return prioritizer_;
+  }
+
+  /**
+   * Enqueues the flow file, parking it in the penalty heap if it is penalized.
+   */
+  void push(const std::shared_ptr<FlowFile> &flow);
+
+  /**
+   * Dequeues the next flow file that is not penalized.
+   * @param flow dequeued flow file
+   * @return true if a flow file was dequeued.
+   */
+  bool tryPop(std::shared_ptr<FlowFile> &flow);
+
+  /**
+   * Dequeues up to max_count flow files that are not penalized. With a
+   * prioritizer the heap lock is taken once for the whole batch.
+   * @param flows vector to which the dequeued flow files are appended.
+   * @param max_count maximum number of flow files to dequeue.
+   * @param max_bytes stop once the dequeued flow files reach this size, 0 for no limit.
+   * At least one flow file is dequeued if available, regardless of its size.
+   * @return number of flow files dequeued.
+   */
+  size_t tryPop(std::vector<std::shared_ptr<FlowFile>> &flows, size_t max_count, uint64_t max_bytes);
+
+  /**
+   * Removes every flow file, penalized or not.
+   * @param flows vector to which the removed flow files are appended.
+   */
+  void drain(std::vector<std::shared_ptr<FlowFile>> &flows);
+
+  /**
+   * @return number of queued flow files, including penalized ones.
+   */
+  uint64_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  /**
+   * @return number of queued flow files that are currently penalized.
+   */
+  uint64_t getPenalizedCount() const {
+    return penalized_size_;
+  }
+
+  /**
+   * @return true if a flow file can be dequeued now.
+   */
+  bool isWorkAvailable() const;
+
+ private:
+  struct PrioritizedEntry {
+    std::shared_ptr<FlowFile> flow;
+    // insertion sequence, keeps flow files of equal priority in FIFO order
+    uint64_t sequence;
+  };
+
+  void pushActive(const std::shared_ptr<FlowFile> &flow);
+
+  bool popActive(std::shared_ptr<FlowFile> &flow);
+
+  // appends up to max_count active flow files to flows, regardless of penalties
+  size_t popActive(std::vector<std::shared_ptr<FlowFile>> &flows, size_t max_count, uint64_t max_bytes);
+
+  void pushPenalized(const std::shared_ptr<FlowFile> &flow);
+
+  void releaseExpiredPenalties(uint64_t now);
+
+  // comparator for std::push_heap/pop_heap; the top of the heap is the entry that is not "less" than any other
+  bool isLowerPriority(const PrioritizedEntry &lhs, const PrioritizedEntry &rhs) const;
+
+  std::shared_ptr<FlowFilePrioritizer> prioritizer_;
+
+  // active flow files when no prioritizer is set
+  moodycamel::ConcurrentQueue<std::shared_ptr<FlowFile>> queue_;
+
+  // active flow files when a prioritizer is set
+  std::mutex prioritized_mutex_;
+  std::vector<PrioritizedEntry> prioritized_;
+  uint64_t sequence_;
+
+  // penalized flow files, min heap on the penalty expiration
+  std::mutex penalty_mutex_;
+  std::vector<std::shared_ptr<FlowFile>> penalized_;
+  std::atomic<uint64_t> next_penalty_expiration_;
+
+  std::atomic<uint64_t> size_;
+  std::atomic<uint64_t> penalized_size_;
+};
+
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_CORE_FLOWFILEQUEUE_H_ */
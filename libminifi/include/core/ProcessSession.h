@@ -25,6 +25,7 @@
 #include <mutex>
 #include <queue>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "Exception.h"
@@ -73,6 +74,14 @@ class ProcessSession : public ReferenceContainer {
   //
   // Get the FlowFile from the highest priority queue
   virtual std::shared_ptr<core::FlowFile> get();
+  /**
+   * Gets up to max_count FlowFiles, polling each incoming connection in one pass
+   * rather than one FlowFile per call.
+   * @param max_count maximum number of FlowFiles to return
+   * @param max_bytes stop once the returned FlowFiles reach this size, 0 for no limit
+   * @return FlowFiles added to this session, empty if no work is available.
+   */
+  std::vector<std::shared_ptr<core::FlowFile>> get(size_t max_count, uint64_t max_bytes = 0);
   // Create a new UUID FlowFile with no content resource claim and without
   // parent
   std::shared_ptr<core::FlowFile> create();
@@ -146,24 +155,33 @@ class ProcessSession : public ReferenceContainer {
   ProcessSession &operator=(const ProcessSession &parent) = delete;
 
  protected:
+  // FlowFiles of the current process session, keyed by their binary identifier. The maps that commit
+  // iterates are ordered, so that FlowFiles are enqueued in the order of their time based identifiers.
+  typedef std::map<utils::Identifier, std::shared_ptr<core::FlowFile>> FlowFileMap;
   // FlowFiles being modified by current process session
-  std::map<std::string, std::shared_ptr<core::FlowFile>> _updatedFlowFiles;
+  FlowFileMap _updatedFlowFiles;
   // Copy of the original FlowFiles being modified by current process session as
   // above
-  std::map<std::string, std::shared_ptr<core::FlowFile>> _originalFlowFiles;
+  FlowFileMap _originalFlowFiles;
   // FlowFiles being added by current process session
-  std::map<std::string, std::shared_ptr<core::FlowFile>> _addedFlowFiles;
+  FlowFileMap _addedFlowFiles;
   // FlowFiles being deleted by current process session
-  std::map<std::string, std::shared_ptr<core::FlowFile>> _deletedFlowFiles;
+  std::unordered_map<utils::Identifier, std::shared_ptr<core::FlowFile>, utils::IdentifierHash> _deletedFlowFiles;
   // FlowFiles being transfered to the relationship
-  std::map<std::string, Relationship> _transferRelationship;
+  std::unordered_map<utils::Identifier, Relationship, utils::IdentifierHash> _transferRelationship;
   // FlowFiles being cloned for multiple connections per relationship
-  std::map<std::string, std::shared_ptr<core::FlowFile>> _clonedFlowFiles;
+  FlowFileMap _clonedFlowFiles;
 
  private:
   // Clone the flow file during transfer to multiple connections for a
   // relationship
   std::shared_ptr<core::FlowFile> cloneDuringTransfer(std::shared_ptr<core::FlowFile> &parent);
+  // Persist the FlowFiles about to be enqueued with a single repository write
+  void persistFlowFiles(const std::map<std::shared_ptr<Connection>, std::vector<std::shared_ptr<FlowFile>>> &connectionQueues);
+  // Track a FlowFile polled from an incoming connection
+  void track(const std::shared_ptr<core::FlowFile> &flow);
+  // Report expired FlowFiles to provenance
+  void expire(const std::set<std::shared_ptr<core::FlowFile>> &expired);
   // ProcessContext
   std::shared_ptr<ProcessContext> process_context_;
   // Logger
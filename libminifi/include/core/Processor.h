@@ -34,6 +34,7 @@
 #include "Core.h"
 #include <utils/Id.h>
 #include "Connectable.h"
+#include "ProcessorMetrics.h"
 #include "ConfigurableComponent.h"
 #include "io/StreamFactory.h"
 #include "Property.h"
@@ -257,6 +258,13 @@ class Processor : public Connectable, public ConfigurableComponent, public std::
   // Check all incoming connections for work
   bool isWorkAvailable();
 
+  /**
+   * Returns the throughput and latency counters of this processor.
+   */
+  ProcessorMetrics &getProcessorMetrics() {
+    return processor_metrics_;
+  }
+
   void setStreamFactory(std::shared_ptr<minifi::io::StreamFactory> stream_factory) {
     stream_factory_ = stream_factory;
   }
@@ -292,8 +300,17 @@ class Processor : public Connectable, public ConfigurableComponent, public std::
 
   std::string cron_period_;
 
+  // Throughput and latency counters
+  ProcessorMetrics processor_metrics_;
+
  private:
 
+  /**
+   * Whether another trigger fits into the run duration that started at start: the processor is
+   * still running, not yielding and not backpressured, and has work left.
+   */
+  bool isWithinRunDuration(std::chrono::steady_clock::time_point start);
+
   // Mutex for protection
   std::mutex mutex_;
   // Yield Expiration
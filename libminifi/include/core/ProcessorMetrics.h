@@ -0,0 +1,115 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_CORE_PROCESSORMETRICS_H_
+#define LIBMINIFI_INCLUDE_CORE_PROCESSORMETRICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include "utils/LatencyHistogram.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+/**
+ * Purpose: Throughput and latency counters of a single processor.
+ *
+ * Design: Triggers are recorded by the scheduling agent and the flow files that a session took from
+ * or handed to connections when it commits. All counters are atomics, so recording never blocks
+ * the processor.
+ */
+class ProcessorMetrics {
+ public:
+  ProcessorMetrics()
+      : invocations_(0),
+        flow_files_in_(0),
+        bytes_in_(0),
+        flow_files_out_(0),
+        bytes_out_(0) {
+  }
+
+  /**
+   * Records one scheduled trigger of the processor.
+   * @param nanos time spent in onTrigger
+   */
+  void recordTrigger(uint64_t nanos) {
+    invocations_.fetch_add(1, std::memory_order_relaxed);
+    trigger_time_.record(nanos);
+  }
+
+  /**
+   * Records flow files taken from incoming connections by a committed session.
+   */
+  void recordIncoming(uint64_t flow_files, uint64_t bytes) {
+    flow_files_in_.fetch_add(flow_files, std::memory_order_relaxed);
+    bytes_in_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  /**
+   * Records flow files handed to outgoing connections by a committed session.
+   */
+  void recordOutgoing(uint64_t flow_files, uint64_t bytes) {
+    flow_files_out_.fetch_add(flow_files, std::memory_order_relaxed);
+    bytes_out_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  uint64_t getInvocations() const {
+    return invocations_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getFlowFilesIn() const {
+    return flow_files_in_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getBytesIn() const {
+    return bytes_in_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getFlowFilesOut() const {
+    return flow_files_out_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getBytesOut() const {
+    return bytes_out_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the histogram of onTrigger times in nanoseconds.
+   */
+  const utils::LatencyHistogram &getTriggerTime() const {
+    return trigger_time_;
+  }
+
+ private:
+  std::atomic<uint64_t> invocations_;
+  std::atomic<uint64_t> flow_files_in_;
+  std::atomic<uint64_t> bytes_in_;
+  std::atomic<uint64_t> flow_files_out_;
+  std::atomic<uint64_t> bytes_out_;
+  utils::LatencyHistogram trigger_time_;
+};
+
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_CORE_PROCESSORMETRICS_H_ */
@@ -36,6 +36,7 @@
 #include "core/logging/LoggerConfiguration.h"
 #include "core/Property.h"
 #include "ResourceClaim.h"
+#include "io/DataStream.h"
 #include "io/Serializable.h"
 #include "utils/TimeUtil.h"
 #include "utils/StringUtils.h"
@@ -90,6 +91,20 @@ class Repository : public virtual core::SerializableComponent, public core::Trac
   virtual bool Put(std::string key, const uint8_t *buf, size_t bufLen) {
     return true;
   }
+
+  /**
+   * Stores several serialized records at once. Repositories that can persist
+   * them atomically in a single write should override this.
+   * @param data pairs of key and serialized record
+   * @return true if every record was stored.
+   */
+  virtual bool MultiPut(const std::vector<std::pair<std::string, std::unique_ptr<io::DataStream>>> &data) {
+    bool stored = true;
+    for (const auto &item : data) {
+      stored &= Put(item.first, item.second->getBuffer(), item.second->getSize());
+    }
+    return stored;
+  }
   // Delete
   virtual bool Delete(std::string key) {
     return true;
@@ -111,6 +126,15 @@ class Repository : public virtual core::SerializableComponent, public core::Trac
     return false;
   }
 
+  /**
+   * Returns whether a record is stored under key. Repositories that can answer without reading
+   * the record should override this.
+   */
+  virtual bool Contains(const std::string &key) {
+    std::string value;
+    return Get(key, value);
+  }
+
   // Run function for the thread
   virtual void run() {
     // no op
@@ -0,0 +1,111 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_CORE_LOGGING_ASYNCSINK_H_
+#define LIBMINIFI_INCLUDE_CORE_LOGGING_ASYNCSINK_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "spdlog/spdlog.h"
+#include "spdlog/details/mpmc_bounded_q.h"
+#include "spdlog/sinks/sink.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+namespace logging {
+
+/**
+ * What a logging thread does when the queue of an async sink is full.
+ */
+enum class AsyncOverflowPolicy {
+  // wait for the writer to make room
+  BLOCK,
+  // discard the record; the writer reports how many were discarded
+  DROP
+};
+
+/**
+ * Purpose: Moves writing log records off the logging threads.
+ *
+ * Design: Records are formatted on the logging thread, as for every other sink, and handed to a
+ * bounded lock free ring buffer. A single writer thread drains it into the wrapped sink, so slow
+ * file or console output no longer stalls the processors that log. Flushes requested by loggers
+ * are deferred until the writer has caught up with the queue.
+ */
+class AsyncSink : public spdlog::sinks::sink {
+ public:
+  /**
+   * @param delegate sink that the writer thread logs to
+   * @param queue_size capacity of the ring buffer, rounded up to a power of two
+   * @param policy what to do when the ring buffer is full
+   */
+  AsyncSink(const std::shared_ptr<spdlog::sinks::sink> &delegate, size_t queue_size, AsyncOverflowPolicy policy);
+
+  virtual ~AsyncSink();
+
+  virtual void log(const spdlog::details::log_msg &msg);
+
+  virtual void flush();
+
+  /**
+   * Returns the number of records discarded because the queue was full.
+   */
+  uint64_t getDropped() const {
+    return dropped_total_;
+  }
+
+ private:
+  struct Record {
+    spdlog::level::level_enum level;
+    std::string formatted;
+  };
+
+  static size_t roundUpToPowerOfTwo(size_t size);
+
+  void run();
+
+  void write(Record &record);
+
+  std::shared_ptr<spdlog::sinks::sink> delegate_;
+  AsyncOverflowPolicy policy_;
+  spdlog::details::mpmc_bounded_queue<Record> queue_;
+  std::atomic<bool> running_;
+  std::atomic<bool> flush_requested_;
+  std::atomic<bool> sleeping_;
+  std::atomic<uint64_t> dropped_;
+  std::atomic<uint64_t> dropped_total_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::thread writer_;
+};
+
+} /* namespace logging */
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_CORE_LOGGING_ASYNCSINK_H_ */
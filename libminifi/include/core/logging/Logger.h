@@ -18,6 +18,7 @@
 #ifndef __LOGGER_H__
 #define __LOGGER_H__
 
+#include <atomic>
 #include <mutex>
 #include <memory>
 #include <sstream>
@@ -215,12 +216,7 @@ class Logger : public BaseLogger {
         logger_level = spdlog::level::level_enum::warn;
         break;
     }
-
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!delegate_->should_log(logger_level)) {
-      return false;
-    }
-    return true;
+    return std::atomic_load(&delegate_)->should_log(logger_level);
   }
 
  protected:
@@ -257,6 +253,13 @@ class Logger : public BaseLogger {
         : delegate_(delegate), controller_(nullptr) {
     }
 
+  /**
+   * Replaces the spdlog logger that messages are written to.
+   */
+  void set_delegate(std::shared_ptr<spdlog::logger> delegate) {
+    std::atomic_store(&delegate_, delegate);
+  }
+
 
   std::shared_ptr<spdlog::logger> delegate_;
   std::shared_ptr<LoggerControl> controller_;
@@ -267,12 +270,13 @@ class Logger : public BaseLogger {
   inline void log(spdlog::level::level_enum level, const char * const format, const Args& ... args) {
     if (controller_ && !controller_->is_enabled())
          return;
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!delegate_->should_log(level)) {
+    // the delegate is swapped atomically on reconfiguration, so logging threads never contend on a lock here
+    const auto delegate = std::atomic_load(&delegate_);
+    if (!delegate->should_log(level)) {
       return;
     }
     const auto str = format_string(format, conditional_conversion(args)...);
-    delegate_->log(level, str);
+    delegate->log(level, str);
   }
 
   Logger(Logger const&);
@@ -289,6 +293,23 @@ class Logger : public BaseLogger {
 
 #define LOG_WARN(x) LogBuilder(x.get(),logging::LOG_LEVEL::warn)
 
+/**
+ * printf style counterparts of the log_* functions that do not evaluate their arguments when the
+ * level is disabled. Use them where building the arguments costs something, e.g. per flow file.
+ */
+#define LOGGER_LOG(logger, level, function, ...) \
+  do { \
+    if ((logger)->should_log(org::apache::nifi::minifi::core::logging::LOG_LEVEL::level)) { \
+      (logger)->function(__VA_ARGS__); \
+    } \
+  } while (0)
+
+#define LOG_TRACE_F(logger, ...) LOGGER_LOG(logger, trace, log_trace, __VA_ARGS__)
+
+#define LOG_DEBUG_F(logger, ...) LOGGER_LOG(logger, debug, log_debug, __VA_ARGS__)
+
+#define LOG_INFO_F(logger, ...) LOGGER_LOG(logger, info, log_info, __VA_ARGS__)
+
 } /* namespace logging */
 } /* namespace core */
 } /* namespace minifi */
@@ -228,6 +228,22 @@ class AtomicEntry {
     return true;
   }
 
+  /**
+   * Copies the key of the current value into the argument without taking the value.
+   * @param key key of the current value
+   * @return true if this atomic entry has a value.
+   */
+  bool getKey(T &key) {
+    try_lock();
+    if (!has_value_) {
+      try_unlock();
+      return false;
+    }
+    key = value_.getKey();
+    try_unlock();
+    return true;
+  }
+
   /**
    * Moved the value into the argument
    * @param value the previous value will be moved into this parameter
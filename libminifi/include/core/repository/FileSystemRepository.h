@@ -51,6 +51,8 @@ class FileSystemRepository : public core::ContentRepository, public core::CoreCo
 
   virtual std::shared_ptr<io::BaseMemoryMap> mmap(const std::shared_ptr<minifi::ResourceClaim> &claim, size_t mapSize, bool readOnly);
 
+  virtual bool importFile(const std::string &source, uint64_t offset, uint64_t length, const std::shared_ptr<minifi::ResourceClaim> &claim);
+
   virtual bool close(const std::shared_ptr<minifi::ResourceClaim> &claim) { return remove(claim); }
   virtual bool remove(const std::shared_ptr<minifi::ResourceClaim> &claim);
 
@@ -0,0 +1,163 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_CORE_REPOSITORY_SLABCONTENTREPOSITORY_H_
+#define LIBMINIFI_INCLUDE_CORE_REPOSITORY_SLABCONTENTREPOSITORY_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "../ContentRepository.h"
+#include "core/Core.h"
+#include "core/logging/LoggerConfiguration.h"
+#include "properties/Configure.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+namespace repository {
+
+/**
+ * SlabContentRepository is a content repository that packs small claims into
+ * large append-only segment files on the local file system.
+ *
+ * Design: A claim is written to memory and appended to the active segment as
+ * one record when its stream is closed, so storing it costs a single write
+ * rather than creating a file. Claims larger than the max claim size are
+ * spilled to a file of their own, as with the FileSystemRepository, which is
+ * also where claims that are not in a segment are looked up. Removing a claim
+ * appends a tombstone; a full segment is deleted once none of its claims is
+ * live anymore. The index from claim to (segment, offset, length) is kept in
+ * memory and rebuilt by scanning the segments on initialization.
+ */
+class SlabContentRepository : public core::ContentRepository, public core::CoreComponent {
+ public:
+  static const uint64_t DEFAULT_SEGMENT_SIZE = 64 * 1024 * 1024;
+  static const uint64_t DEFAULT_MAX_CLAIM_SIZE = 1024 * 1024;
+
+  SlabContentRepository(std::string name = getClassName<SlabContentRepository>());
+
+  virtual ~SlabContentRepository();
+
+  virtual bool initialize(const std::shared_ptr<minifi::Configure> &configuration);
+
+  virtual void stop();
+
+  bool exists(const std::shared_ptr<minifi::ResourceClaim> &streamId);
+
+  virtual std::shared_ptr<io::BaseStream> write(const std::shared_ptr<minifi::ResourceClaim> &claim, bool append = false);
+
+  virtual std::shared_ptr<io::BaseStream> read(const std::shared_ptr<minifi::ResourceClaim> &claim);
+
+  /**
+   * Read only maps of claims in a segment map the segment directly. Writable maps
+   * are kept in memory and stored as a new record when unmapped.
+   */
+  virtual std::shared_ptr<io::BaseMemoryMap> mmap(const std::shared_ptr<minifi::ResourceClaim> &claim, size_t mapSize, bool readOnly);
+
+  virtual bool close(const std::shared_ptr<minifi::ResourceClaim> &claim) {
+    return remove(claim);
+  }
+
+  virtual bool remove(const std::shared_ptr<minifi::ResourceClaim> &claim);
+
+  /**
+   * @return number of segment files, for tests and metrics.
+   */
+  size_t getSegmentCount();
+
+  /**
+   * Segment file, shared with the streams reading from it so that it stays
+   * open while they do, even if the segment is deleted in the meantime.
+   */
+  class SegmentFile;
+
+  /**
+   * Appends a record of the claim's content, replacing the previous one.
+   * @return false if the record could not be written.
+   */
+  bool store(const std::string &claim_path, const uint8_t *data, size_t size);
+
+  /**
+   * Records that the claim's content was written to a file of its own.
+   */
+  void storedToFile(const std::string &claim_path);
+
+  uint64_t getMaxClaimSize() const {
+    return max_claim_size_;
+  }
+
+ private:
+  struct Location {
+    uint64_t segment;
+    // offset of the content within the segment file
+    uint64_t offset;
+    uint64_t length;
+  };
+
+  struct Segment {
+    std::shared_ptr<SegmentFile> file;
+    // claims whose latest record is in this segment
+    uint64_t live_claims;
+    // records in this segment that supersede or remove records of older segments
+    // must outlive them, or those would be revived by the next scan
+    uint64_t pins;
+    // segments holding records that supersede records of this one
+    std::map<uint64_t, uint64_t> pinned_segments;
+  };
+
+  bool findLocation(const std::string &claim_path, Location &location, std::shared_ptr<SegmentFile> &file);
+
+  // expects mutex_ to be held
+  bool appendRecord(const std::string &claim_path, const uint8_t *data, uint64_t size, bool tombstone, Location &location);
+
+  // points the claim at location, or drops it if null, on behalf of a record in segment holder;
+  // expects mutex_ to be held
+  void replaceLocation(const std::string &claim_path, uint64_t holder, const Location *location);
+
+  // expects mutex_ to be held
+  bool openSegment(uint64_t id);
+
+  // expects mutex_ to be held
+  void scanSegment(uint64_t id);
+
+  // expects mutex_ to be held
+  void reclaim(uint64_t id);
+
+  std::string getSegmentPath(uint64_t id) const;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Location> index_;
+  std::map<uint64_t, Segment> segments_;
+  uint64_t active_segment_;
+  uint64_t segment_size_;
+  uint64_t max_claim_size_;
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+} /* namespace repository */
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_CORE_REPOSITORY_SLABCONTENTREPOSITORY_H_ */
@@ -19,9 +19,12 @@
 #define LIBMINIFI_INCLUDE_CORE_REPOSITORY_VolatileRepository_H_
 
 #include "core/Repository.h"
+#include <array>
 #include <chrono>
+#include <functional>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include "core/SerializableComponent.h"
 #include "core/Core.h"
 #include "Connection.h"
@@ -43,7 +46,10 @@ namespace repository {
 #endif
 /**
  * Flow File repository
- * Design: Extends Repository and implements the run function, using RocksDB as the primary substrate.
+ * Design: Extends Repository and implements the run function, keeping entries in a fixed set of
+ * atomic slots. A striped hash index maps keys to their slots so that lookups and deletions do not
+ * scan the slots, and empty slots are kept on a free list. Entries are only evicted, oldest slot
+ * first, once every slot is in use.
  */
 template<typename T>
 class VolatileRepository : public core::Repository, public std::enable_shared_from_this<VolatileRepository<T>> {
@@ -130,8 +136,75 @@ class VolatileRepository : public core::Repository, public std::enable_shared_fr
     return current_size_;
   }
 
+  /**
+   * Rounds the size of a buffer up to the allocator size class that backs it, so that max.bytes
+   * bounds the memory actually held rather than the sum of the requested lengths.
+   * @param size requested buffer size
+   * @return size accounted against the repository
+   */
+  static size_t getAccountedSize(size_t size) {
+    if (size <= 128) {
+      return (size + 15) & ~static_cast<size_t>(15);
+    }
+    // four size classes per power of two
+    size_t bits = 0;
+    for (size_t remaining = size - 1; remaining > 0; remaining >>= 1) {
+      bits++;
+    }
+    const size_t granularity = static_cast<size_t>(1) << (bits - 3);
+    return (size + granularity - 1) & ~(granularity - 1);
+  }
+
  protected:
 
+  static const size_t INDEX_STRIPES = 64;
+
+  /**
+   * Part of the key index. Slots referenced by a stripe are only modified while holding its mutex.
+   */
+  struct IndexStripe {
+    std::mutex mutex_;
+    std::unordered_map<T, uint32_t> slots_;
+  };
+
+  IndexStripe &getStripe(const T &key) {
+    return index_[std::hash<T>()(key) % INDEX_STRIPES];
+  }
+
+  /**
+   * Takes a slot from the free list, evicting the entry of the next occupied slot
+   * when the repository is full.
+   * @return index of a slot that is owned by the caller until it is indexed or released.
+   */
+  uint32_t acquireSlot();
+
+  /**
+   * Returns an empty slot to the free list.
+   */
+  void releaseSlot(uint32_t slot) {
+    std::lock_guard<std::mutex> lock(free_mutex_);
+    free_slots_.push_back(slot);
+  }
+
+  /**
+   * Subtracts reclaimed bytes from the current size.
+   */
+  void reclaim(size_t size) {
+    /**
+     * this is okay since current_size_ is really an estimate.
+     * we don't need precise counts.
+     */
+    size_t current = current_size_.load();
+    while (!current_size_.compare_exchange_weak(current, current < size ? 0 : current - size)) {
+    }
+  }
+
+  /**
+   * Moves the value of an indexed key out of the repository. The caller must hold the key's stripe lock.
+   * @return true if the key was found.
+   */
+  bool take(IndexStripe &stripe, const T &key, RepoValue<T> &value);
+
   virtual void emplace(RepoValue<T> &old_value) {
     std::lock_guard<std::mutex> lock(purge_mutex_);
     purge_list_.push_back(old_value.getKey());
@@ -152,11 +225,17 @@ class VolatileRepository : public core::Repository, public std::enable_shared_fr
   std::map<std::string, std::shared_ptr<minifi::Connection>> connectionMap;
   // current size of the volatile repo.
   std::atomic<size_t> current_size_;
-  // current index.
-  std::atomic<uint16_t> current_index_;
+  // next slot considered for eviction once the free list is exhausted.
+  std::atomic<uint32_t> current_index_;
   // value vector that exists for non blocking iteration over
   // objects that store data for this repo instance.
   std::vector<AtomicEntry<T>*> value_vector_;
+  // index from key to slot in value_vector_
+  std::array<IndexStripe, INDEX_STRIPES> index_;
+
+  std::mutex free_mutex_;
+  // slots that hold no value
+  std::vector<uint32_t> free_slots_;
 
   // max count we are allowed to store.
   uint32_t max_count_;
@@ -229,6 +308,65 @@ bool VolatileRepository<T>::initialize(const std::shared_ptr<Configure> &configu
   for (uint32_t i = 0; i < max_count_; i++) {
     value_vector_.emplace_back(new AtomicEntry<T>(&current_size_, &max_size_));
   }
+  std::lock_guard<std::mutex> lock(free_mutex_);
+  free_slots_.reserve(max_count_);
+  // hand out the lowest slots first
+  for (uint32_t i = max_count_; i > 0; i--) {
+    free_slots_.push_back(i - 1);
+  }
+  return true;
+}
+
+template<typename T>
+uint32_t VolatileRepository<T>::acquireSlot() {
+  {
+    std::lock_guard<std::mutex> lock(free_mutex_);
+    if (!free_slots_.empty()) {
+      uint32_t slot = free_slots_.back();
+      free_slots_.pop_back();
+      return slot;
+    }
+  }
+  // the repository is full, so evict the entries in slot order as the ring buffer always has.
+  while (true) {
+    uint32_t slot = current_index_.fetch_add(1) % max_count_;
+    T key;
+    if (!value_vector_.at(slot)->getKey(key)) {
+      // free or held by another writer
+      continue;
+    }
+    auto &stripe = getStripe(key);
+    RepoValue<T> old_value;
+    {
+      std::lock_guard<std::mutex> lock(stripe.mutex_);
+      auto it = stripe.slots_.find(key);
+      if (it == stripe.slots_.end() || it->second != slot) {
+        continue;
+      }
+      stripe.slots_.erase(it);
+      value_vector_.at(slot)->getValue(old_value);
+    }
+    logger_->log_debug("Evicting repo value at %u out of %u", slot, max_count_);
+    reclaim(getAccountedSize(old_value.getBufferSize()));
+    std::lock_guard<std::mutex> lock(mutex_);
+    emplace(old_value);
+    return slot;
+  }
+}
+
+template<typename T>
+bool VolatileRepository<T>::take(IndexStripe &stripe, const T &key, RepoValue<T> &value) {
+  auto it = stripe.slots_.find(key);
+  if (it == stripe.slots_.end()) {
+    return false;
+  }
+  uint32_t slot = it->second;
+  stripe.slots_.erase(it);
+  if (!value_vector_.at(slot)->getValue(key, value)) {
+    return false;
+  }
+  reclaim(getAccountedSize(value.getBufferSize()));
+  releaseSlot(slot);
   return true;
 }
 
@@ -241,43 +379,41 @@ template<typename T>
 bool VolatileRepository<T>::Put(T key, const uint8_t *buf, size_t bufLen) {
   RepoValue<T> new_value(key, buf, bufLen);
 
-  const size_t size = new_value.size();
-  bool updated = false;
-  size_t reclaimed_size = 0;
+  const size_t size = getAccountedSize(new_value.size());
+  auto &stripe = getStripe(key);
   RepoValue<T> old_value;
-  do {
-    uint16_t private_index = current_index_.fetch_add(1);
-    // round robin through the beginning
-    if (private_index >= max_count_) {
-      uint16_t new_index = 0;
-      if (current_index_.compare_exchange_weak(new_index, 0)) {
-        private_index = 0;
-      } else {
-        continue;
+  size_t reclaimed_size = 0;
+  uint32_t slot = 0;
+  bool acquired = false;
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(stripe.mutex_);
+      auto it = stripe.slots_.find(key);
+      if (it != stripe.slots_.end()) {
+        // replace the existing entry in place
+        while (!value_vector_.at(it->second)->setRepoValue(new_value, old_value, reclaimed_size)) {
+        }
+        reclaim(getAccountedSize(reclaimed_size));
+        current_size_ += size;
+        if (acquired) {
+          releaseSlot(slot);
+        }
+        return true;
       }
-    }
-
-    updated = value_vector_.at(private_index)->setRepoValue(new_value, old_value, reclaimed_size);
-    logger_->log_debug("Set repo value at %u out of %u updated %u current_size %u, adding %u to  %u", private_index, max_count_, updated == true, reclaimed_size, size, current_size_.load());
-    if (updated && reclaimed_size > 0) {
-      std::lock_guard<std::mutex> lock(mutex_);
-      emplace(old_value);
-    }
-    if (reclaimed_size > 0) {
-      /**
-       * this is okay since current_size_ is really an estimate.
-       * we don't need precise counts.
-       */
-      if (current_size_ < reclaimed_size) {
-        current_size_ = 0;
-      } else {
-        current_size_ -= reclaimed_size;
+      if (acquired) {
+        while (!value_vector_.at(slot)->setRepoValue(new_value, old_value, reclaimed_size)) {
+        }
+        stripe.slots_[key] = slot;
+        current_size_ += size;
+        break;
       }
     }
-  } while (!updated);
-  current_size_ += size;
+    // acquiring may evict an entry of another stripe, so it happens without holding our lock.
+    slot = acquireSlot();
+    acquired = true;
+  }
 
-  logger_->log_debug("VolatileRepository -- put %u %u", current_size_.load(), current_index_.load());
+  logger_->log_debug("VolatileRepository -- put %u at %u", current_size_.load(), slot);
   return true;
 }
 /**
@@ -287,17 +423,17 @@ bool VolatileRepository<T>::Put(T key, const uint8_t *buf, size_t bufLen) {
 template<typename T>
 bool VolatileRepository<T>::Delete(T key) {
   logger_->log_debug("Delete from volatile");
-  for (auto ent : value_vector_) {
-    // let the destructor do the cleanup
-    RepoValue<T> value;
-    if (ent->getValue(key, value)) {
-      current_size_ -= value.size();
-      logger_->log_debug("Delete and pushed into purge_list from volatile");
-      emplace(value);
-      return true;
+  auto &stripe = getStripe(key);
+  RepoValue<T> value;
+  {
+    std::lock_guard<std::mutex> lock(stripe.mutex_);
+    if (!take(stripe, key, value)) {
+      return false;
     }
   }
-  return false;
+  logger_->log_debug("Delete and pushed into purge_list from volatile");
+  emplace(value);
+  return true;
 }
 /**
  * Sets the value from the provided key. Once the item is retrieved
@@ -306,39 +442,36 @@ bool VolatileRepository<T>::Delete(T key) {
  */
 template<typename T>
 bool VolatileRepository<T>::Get(const T &key, std::string &value) {
-
-  for (auto ent : value_vector_) {
-    // let the destructor do the cleanup
-    RepoValue<T> repo_value;
-    if (ent->getValue(key, repo_value)) {
-      current_size_ -= value.size();
-      repo_value.emplace(value);
-      return true;
+  auto &stripe = getStripe(key);
+  RepoValue<T> repo_value;
+  {
+    std::lock_guard<std::mutex> lock(stripe.mutex_);
+    if (!take(stripe, key, repo_value)) {
+      return false;
     }
   }
-  return false;
+  repo_value.emplace(value);
+  return true;
 }
 
 template<typename T>
 bool VolatileRepository<T>::DeSerialize(std::vector<std::shared_ptr<core::SerializableComponent>> &store, size_t &max_size, std::function<std::shared_ptr<core::SerializableComponent>()> lambda) {
   size_t requested_batch = max_size;
   max_size = 0;
-  for (auto ent : value_vector_) {
-    // let the destructor do the cleanup
-    RepoValue<T> repo_value;
-
-    if (ent->getValue(repo_value)) {
+  for (auto &stripe : index_) {
+    std::lock_guard<std::mutex> lock(stripe.mutex_);
+    while (!stripe.slots_.empty() && max_size < requested_batch) {
+      // let the destructor do the cleanup
+      RepoValue<T> repo_value;
+      const T key = stripe.slots_.begin()->first;
+      if (!take(stripe, key, repo_value)) {
+        continue;
+      }
       std::shared_ptr<core::SerializableComponent> newComponent = lambda();
       // we've taken ownership of this repo value
       newComponent->DeSerialize(repo_value.getBuffer(), repo_value.getBufferSize());
-
       store.push_back(newComponent);
-
-      current_size_ -= repo_value.getBufferSize();
-
-      if (max_size++ >= requested_batch) {
-        break;
-      }
+      max_size++;
     }
   }
   if (max_size > 0) {
@@ -352,17 +485,18 @@ template<typename T>
 bool VolatileRepository<T>::DeSerialize(std::vector<std::shared_ptr<core::SerializableComponent>> &store, size_t &max_size) {
   logger_->log_debug("VolatileRepository -- DeSerialize %u", current_size_.load());
   max_size = 0;
-  for (auto ent : value_vector_) {
-    // let the destructor do the cleanup
-    RepoValue<T> repo_value;
-
-    if (ent->getValue(repo_value)) {
+  for (auto &stripe : index_) {
+    std::lock_guard<std::mutex> lock(stripe.mutex_);
+    while (!stripe.slots_.empty() && max_size < store.size()) {
+      // let the destructor do the cleanup
+      RepoValue<T> repo_value;
+      const T key = stripe.slots_.begin()->first;
+      if (!take(stripe, key, repo_value)) {
+        continue;
+      }
       // we've taken ownership of this repo value
       store.at(max_size)->DeSerialize(repo_value.getBuffer(), repo_value.getBufferSize());
-      current_size_ -= repo_value.getBufferSize();
-      if (max_size++ >= store.size()) {
-        break;
-      }
+      max_size++;
     }
   }
   if (max_size > 0) {
@@ -0,0 +1,200 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_CORE_STATE_NODES_STATISTICSNODES_H_
+#define LIBMINIFI_INCLUDE_CORE_STATE_NODES_STATISTICSNODES_H_
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../nodes/MetricsBase.h"
+#include "Connection.h"
+#include "core/Processor.h"
+#include "utils/LatencyHistogram.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace state {
+namespace response {
+
+/**
+ * Serializes the mean, the 50th, 90th and 99th percentiles and the maximum of a histogram.
+ */
+inline SerializedResponseNode serializeHistogram(const std::string &name, const utils::LatencyHistogram &histogram) {
+  SerializedResponseNode parent;
+  parent.name = name;
+  const std::pair<std::string, uint64_t> values[] = { { "mean", histogram.getMean() }, { "p50", histogram.getPercentile(50) }, { "p90", histogram.getPercentile(90) }, {
+      "p99", histogram.getPercentile(99) }, { "max", histogram.getMax() } };
+  for (const auto &value : values) {
+    SerializedResponseNode child;
+    child.name = value.first;
+    child.value = value.second;
+    parent.children.push_back(child);
+  }
+  return parent;
+}
+
+inline SerializedResponseNode serializeCounter(const std::string &name, uint64_t value) {
+  SerializedResponseNode counter;
+  counter.name = name;
+  counter.value = value;
+  return counter;
+}
+
+/**
+ * Justification and Purpose: Provides throughput and onTrigger latency per processor so that the
+ * C2 server can tell which processor is the bottleneck of a flow.
+ */
+class ProcessorStatistics : public ResponseNode {
+ public:
+
+  ProcessorStatistics(const std::string &name, utils::Identifier & uuid)
+      : ResponseNode(name, uuid) {
+  }
+
+  ProcessorStatistics(const std::string &name)
+      : ResponseNode(name) {
+  }
+
+  ProcessorStatistics()
+      : ResponseNode("ProcessorStatistics") {
+  }
+
+  virtual std::string getName() const {
+    return "ProcessorStatistics";
+  }
+
+  void addProcessor(const std::shared_ptr<core::Processor> &processor) {
+    if (nullptr != processor) {
+      processors.insert(std::make_pair(processor->getName(), processor));
+    }
+  }
+
+  std::vector<SerializedResponseNode> serialize() {
+    std::vector<SerializedResponseNode> serialized;
+    for (const auto &proc : processors) {
+      const auto &metrics = proc.second->getProcessorMetrics();
+      SerializedResponseNode parent;
+      parent.name = proc.first;
+      parent.children.push_back(serializeCounter("invocations", metrics.getInvocations()));
+      parent.children.push_back(serializeCounter("flowfilesin", metrics.getFlowFilesIn()));
+      parent.children.push_back(serializeCounter("bytesin", metrics.getBytesIn()));
+      parent.children.push_back(serializeCounter("flowfilesout", metrics.getFlowFilesOut()));
+      parent.children.push_back(serializeCounter("bytesout", metrics.getBytesOut()));
+      parent.children.push_back(serializeHistogram("ontriggernanos", metrics.getTriggerTime()));
+      serialized.push_back(parent);
+    }
+    return serialized;
+  }
+
+ protected:
+  std::map<std::string, std::shared_ptr<core::Processor>> processors;
+};
+
+/**
+ * Justification and Purpose: Provides the enqueue and dequeue rates and the queue wait times per
+ * connection. Rates are flow files per second since the previous serialization.
+ */
+class ConnectionStatistics : public ResponseNode {
+ public:
+
+  ConnectionStatistics(const std::string &name, utils::Identifier & uuid)
+      : ResponseNode(name, uuid) {
+  }
+
+  ConnectionStatistics(const std::string &name)
+      : ResponseNode(name) {
+  }
+
+  ConnectionStatistics()
+      : ResponseNode("ConnectionStatistics") {
+  }
+
+  virtual std::string getName() const {
+    return "ConnectionStatistics";
+  }
+
+  void addConnection(const std::shared_ptr<minifi::Connection> &connection) {
+    if (nullptr != connection) {
+      connections.insert(std::make_pair(connection->getName(), connection));
+    }
+  }
+
+  std::vector<SerializedResponseNode> serialize() {
+    std::vector<SerializedResponseNode> serialized;
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    for (const auto &conn : connections) {
+      const auto &metrics = conn.second->getConnectionMetrics();
+      const uint64_t enqueued = metrics.getEnqueued();
+      const uint64_t dequeued = metrics.getDequeued();
+
+      uint64_t enqueue_rate = 0;
+      uint64_t dequeue_rate = 0;
+      auto previous = snapshots_.find(conn.first);
+      if (previous != snapshots_.end()) {
+        const uint64_t millis = std::chrono::duration_cast<std::chrono::milliseconds>(now - previous->second.time).count();
+        if (millis > 0) {
+          enqueue_rate = (enqueued - previous->second.enqueued) * 1000 / millis;
+          dequeue_rate = (dequeued - previous->second.dequeued) * 1000 / millis;
+        }
+      }
+      snapshots_[conn.first] = Snapshot { enqueued, dequeued, now };
+
+      SerializedResponseNode parent;
+      parent.name = conn.first;
+      parent.children.push_back(serializeCounter("enqueued", enqueued));
+      parent.children.push_back(serializeCounter("enqueuedbytes", metrics.getEnqueuedBytes()));
+      parent.children.push_back(serializeCounter("dequeued", dequeued));
+      parent.children.push_back(serializeCounter("dequeuedbytes", metrics.getDequeuedBytes()));
+      parent.children.push_back(serializeCounter("enqueuerate", enqueue_rate));
+      parent.children.push_back(serializeCounter("dequeuerate", dequeue_rate));
+      parent.children.push_back(serializeHistogram("queuewaitmillis", metrics.getQueueWait()));
+      serialized.push_back(parent);
+    }
+    return serialized;
+  }
+
+ protected:
+  std::map<std::string, std::shared_ptr<minifi::Connection>> connections;
+
+ private:
+  struct Snapshot {
+    uint64_t enqueued;
+    uint64_t dequeued;
+    std::chrono::steady_clock::time_point time;
+  };
+
+  std::mutex mutex_;
+  // counters at the previous serialization, from which the rates are computed
+  std::map<std::string, Snapshot> snapshots_;
+};
+
+} /* namespace metrics */
+} /* namespace state */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_CORE_STATE_NODES_STATISTICSNODES_H_ */
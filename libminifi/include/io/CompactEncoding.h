@@ -0,0 +1,192 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_IO_COMPACTENCODING_H_
+#define LIBMINIFI_INCLUDE_IO_COMPACTENCODING_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+/**
+ * Purpose: Writes integers as unsigned LEB128 varints and strings prefixed with their varint
+ * length into a caller provided span.
+ *
+ * Design: The caller computes the encoded size up front with the size functions, reserves the
+ * span once and writes into it directly, so no intermediate buffer or per byte append is needed.
+ * Writes past the end of the span are discarded and reported by ok().
+ */
+class CompactWriter {
+ public:
+  CompactWriter(uint8_t *begin, size_t size)
+      : pos_(begin),
+        end_(begin + size),
+        overflow_(false) {
+  }
+
+  static size_t varintSize(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+      value >>= 7;
+      size++;
+    }
+    return size;
+  }
+
+  static size_t stringSize(const std::string &value) {
+    return varintSize(value.length()) + value.length();
+  }
+
+  void writeByte(uint8_t value) {
+    if (pos_ >= end_) {
+      overflow_ = true;
+      return;
+    }
+    *pos_++ = value;
+  }
+
+  void writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+      writeByte(static_cast<uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    writeByte(static_cast<uint8_t>(value));
+  }
+
+  void writeBytes(const uint8_t *value, size_t length) {
+    if (static_cast<size_t>(end_ - pos_) < length) {
+      overflow_ = true;
+      return;
+    }
+    memcpy(pos_, value, length);
+    pos_ += length;
+  }
+
+  void writeString(const std::string &value) {
+    writeVarint(value.length());
+    writeBytes(reinterpret_cast<const uint8_t*>(value.data()), value.length());
+  }
+
+  /**
+   * Returns whether everything written fit into the span.
+   */
+  bool ok() const {
+    return !overflow_;
+  }
+
+  /**
+   * Returns whether the span has been filled exactly.
+   */
+  bool complete() const {
+    return !overflow_ && pos_ == end_;
+  }
+
+ private:
+  uint8_t *pos_;
+  uint8_t *end_;
+  bool overflow_;
+};
+
+/**
+ * Purpose: Reads what CompactWriter wrote. Every read returns false once the span is exhausted
+ * or a varint is malformed.
+ */
+class CompactReader {
+ public:
+  CompactReader(const uint8_t *begin, size_t size)
+      : pos_(begin),
+        end_(begin + size) {
+  }
+
+  bool readByte(uint8_t &value) {
+    if (pos_ >= end_) {
+      return false;
+    }
+    value = *pos_++;
+    return true;
+  }
+
+  bool readVarint(uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t byte;
+      if (!readByte(byte)) {
+        return false;
+      }
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool readBytes(uint8_t *value, size_t length) {
+    if (static_cast<size_t>(end_ - pos_) < length) {
+      return false;
+    }
+    memcpy(value, pos_, length);
+    pos_ += length;
+    return true;
+  }
+
+  bool readString(std::string &value) {
+    uint64_t length;
+    if (!readVarint(length) || static_cast<uint64_t>(end_ - pos_) < length) {
+      return false;
+    }
+    value.assign(reinterpret_cast<const char*>(pos_), length);
+    pos_ += length;
+    return true;
+  }
+
+  /**
+   * Points value at the string in the span instead of copying it.
+   */
+  bool readString(const char *&value, size_t &length) {
+    uint64_t encoded;
+    if (!readVarint(encoded) || static_cast<uint64_t>(end_ - pos_) < encoded) {
+      return false;
+    }
+    value = reinterpret_cast<const char*>(pos_);
+    length = encoded;
+    pos_ += encoded;
+    return true;
+  }
+
+  size_t remaining() const {
+    return end_ - pos_;
+  }
+
+ private:
+  const uint8_t *pos_;
+  const uint8_t *end_;
+};
+
+} /* namespace io */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_IO_COMPACTENCODING_H_ */
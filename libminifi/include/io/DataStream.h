@@ -89,6 +89,16 @@ class DataStream {
    */
   virtual int writeData(uint8_t *value, int size);
 
+  /**
+   * Grows the buffer by size bytes and returns where they start, so that a caller that knows the
+   * size of what it writes can serialize in place.
+   */
+  uint8_t *extend(size_t size) {
+    const size_t offset = buffer.size();
+    buffer.resize(offset + size);
+    return buffer.data() + offset;
+  }
+
   /**
    * Reads a system word
    * @param value value to write
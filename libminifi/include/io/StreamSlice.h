@@ -0,0 +1,84 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_IO_STREAMSLICE_H_
+#define LIBMINIFI_INCLUDE_IO_STREAMSLICE_H_
+
+#include <memory>
+#include <vector>
+#include "BaseStream.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+/**
+ * Purpose: Read only view of a region of another stream.
+ *
+ * Design: Flow files may reference a part of a claim that is shared with other flow files. The
+ * slice positions the underlying stream at the start of the region and bounds reads and the size
+ * to its length, so readers see exactly the flow file's content.
+ */
+class StreamSlice : public BaseStream {
+ public:
+  StreamSlice(const std::shared_ptr<BaseStream> &stream, uint64_t offset, uint64_t size);
+
+  virtual ~StreamSlice() {
+  }
+
+  /**
+   * Skip to the specified offset within the slice.
+   * @param offset offset to which we will skip
+   */
+  virtual void seek(uint64_t offset);
+
+  virtual const uint64_t getSize() const {
+    return size_;
+  }
+
+  virtual int readData(std::vector<uint8_t> &buf, int buflen);
+
+  virtual int readData(uint8_t *buf, int buflen);
+
+  virtual int writeData(std::vector<uint8_t> &buf, int buflen) {
+    return -1;
+  }
+
+  virtual int writeData(uint8_t *value, int size) {
+    return -1;
+  }
+
+  const uint8_t *getBuffer() const {
+    throw std::runtime_error("Stream does not support this operation");
+  }
+
+ private:
+  std::shared_ptr<BaseStream> stream_;
+  uint64_t offset_;
+  uint64_t size_;
+  uint64_t position_;
+};
+
+} /* namespace io */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_IO_STREAMSLICE_H_ */
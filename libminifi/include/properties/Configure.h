@@ -45,6 +45,9 @@ class Configure : public Properties {
   static const char *nifi_flow_configuration_file_exit_failure;
   static const char *nifi_flow_configuration_file_backup_update;
   static const char *nifi_flow_engine_threads;
+  static const char *nifi_flow_engine_work_stealing;
+  static const char *nifi_flow_engine_thread_affinity;
+  static const char *nifi_flow_engine_park_timeout;
   static const char *nifi_administrative_yield_duration;
   static const char *nifi_bored_yield_duration;
   static const char *nifi_graceful_shutdown_seconds;
@@ -63,9 +66,13 @@ class Configure : public Properties {
   static const char *nifi_provenance_repository_enable;
   static const char *nifi_flowfile_repository_max_storage_time;
   static const char *nifi_dbcontent_repository_directory_default;
+  static const char *nifi_content_repository_slab_segment_size;
+  static const char *nifi_content_repository_slab_max_claim_size;
   static const char *nifi_flowfile_repository_max_storage_size;
   static const char *nifi_flowfile_repository_directory_default;
   static const char *nifi_flowfile_repository_enable;
+  static const char *nifi_flowfile_repository_sync_writes;
+  static const char *nifi_flowfile_repository_max_deltas;
   static const char *nifi_remote_input_secure;
   static const char *nifi_remote_input_http;
   static const char *nifi_security_need_ClientAuth;
@@ -26,6 +26,7 @@
 #include <mutex>
 #include <atomic>
 #include <memory>
+#include <vector>
 #include "io/EndianCheck.h"
 
 #include "core/Property.h"
@@ -118,7 +119,7 @@ class PeerStatus {
     return peer_;
   }
 
-  uint32_t getFlowFileCount() {
+  uint32_t getFlowFileCount() const {
     return flow_file_count_;
   }
 
@@ -131,16 +132,55 @@ class PeerStatus {
   bool query_for_peers_;
 };
 
+/**
+ * Purpose: Chooses the peer for the next site to site client.
+ *
+ * Design: Peers are weighted by the share of the cluster's queued flow files they do not hold,
+ * as reported in their status, so that lightly loaded peers receive more clients. Picks follow
+ * a smooth weighted round robin, which interleaves peers instead of handing out each peer's
+ * share in a row. Every peer keeps a weight of at least one.
+ */
+class PeerSelector {
+ public:
+  PeerSelector() = default;
+
+  /**
+   * Recomputes the weights from the reported flow file counts.
+   */
+  void update(const std::vector<PeerStatus> &peers);
+
+  /**
+   * @return index of the next peer, or -1 if there are none.
+   */
+  int next();
+
+ private:
+  std::vector<int64_t> weights_;
+  std::vector<int64_t> current_weights_;
+  int64_t total_weight_ = 0;
+};
+
 static const char MAGIC_BYTES[] = { 'N', 'i', 'F', 'i' };
 
 // Site2SitePeer Class
 class SiteToSitePeer : public org::apache::nifi::minifi::io::BaseStream {
  public:
 
+  // writes are sent once this many bytes are buffered
+  static const size_t WRITE_BUFFER_SIZE = 64 * 1024;
+  // uncompressed size of the chunks of a compressed data packet
+  static const size_t COMPRESSION_CHUNK_SIZE = 64 * 1024;
+
   SiteToSitePeer()
       : stream_(nullptr),
         host_(""),
         port_(-1),
+        corked_(false),
+        compressing_(false),
+        chunk_written_(false),
+        decompressing_(false),
+        decompressed_eos_(false),
+        decompressed_position_(0),
         logger_(logging::LoggerFactory<SiteToSitePeer>::getLogger()) {
 
   }
@@ -158,6 +198,12 @@ class SiteToSitePeer : public org::apache::nifi::minifi::io::BaseStream {
         port_(port),
         timeout_(30000),
         yield_expiration_(0),
+        corked_(false),
+        compressing_(false),
+        chunk_written_(false),
+        decompressing_(false),
+        decompressed_eos_(false),
+        decompressed_position_(0),
         logger_(logging::LoggerFactory<SiteToSitePeer>::getLogger()) {
     url_ = "nifi://" + host_ + ":" + std::to_string(port_);
     yield_expiration_ = 0;
@@ -171,6 +217,12 @@ class SiteToSitePeer : public org::apache::nifi::minifi::io::BaseStream {
         port_(std::move(ss.port_)),
         local_network_interface_(std::move(ss.local_network_interface_)),
         proxy_(std::move(ss.proxy_)),
+        corked_(false),
+        compressing_(false),
+        chunk_written_(false),
+        decompressing_(false),
+        decompressed_eos_(false),
+        decompressed_position_(0),
         logger_(std::move(ss.logger_)) {
     yield_expiration_.store(ss.yield_expiration_);
     timeout_.store(ss.timeout_);
@@ -292,50 +344,116 @@ class SiteToSitePeer : public org::apache::nifi::minifi::io::BaseStream {
     return stream_.get();
   }
 
+  /**
+   * Buffers subsequent writes so that the many small fields of a transaction leave in few
+   * large writes. The buffer is sent when it fills up, before any read, so that a response is
+   * never awaited for data still held back, and by uncork().
+   */
+  void cork() {
+    corked_ = true;
+  }
+
+  /**
+   * Sends the buffered writes and stops buffering.
+   * @return 0 on success, -1 if the buffered data could not be written.
+   */
+  int uncork() {
+    corked_ = false;
+    return flush();
+  }
+
   int write(uint8_t value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
-    return Serializable::write(value, stream_.get());
+    return buffered(Serializable::write(value, writeStream()));
   }
   int write(char value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
-    return Serializable::write(value, stream_.get());
+    return buffered(Serializable::write(value, writeStream()));
   }
   int write(uint32_t value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
-    return Serializable::write(value, stream_.get());
+    return buffered(Serializable::write(value, writeStream()));
   }
   int write(uint16_t value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
-    return Serializable::write(value, stream_.get());
+    return buffered(Serializable::write(value, writeStream()));
+  }
+  /**
+   * Compresses the data written until endCompression() into the chunked deflate format used
+   * by the site to site protocol for the data packets of a transaction.
+   */
+  void beginCompression() {
+    compressing_ = true;
+    chunk_written_ = false;
   }
+
+  /**
+   * Writes the rest of the compressed data and the end of stream marker.
+   * @return 0 on success, -1 otherwise.
+   */
+  int endCompression();
+
+  /**
+   * Decompresses the data read through read(uint8_t*, int), as the transaction stream does,
+   * until the end of the compressed data packet, after which reads are plain again.
+   */
+  void beginDecompression() {
+    decompressing_ = true;
+    decompressed_eos_ = false;
+    decompressed_buffer_.clear();
+    decompressed_position_ = 0;
+  }
+
   int write(uint8_t *value, int len) {
-    return Serializable::write(value, len, stream_.get());
+    if (corked_ && !compressing_ && len >= static_cast<int>(WRITE_BUFFER_SIZE)) {
+      // large blocks, typically content, are written as they are rather than copied
+      if (flush() < 0)
+        return -1;
+      return Serializable::write(value, len, stream_.get());
+    }
+    return buffered(Serializable::write(value, len, writeStream()));
   }
   int write(uint64_t value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
-    return Serializable::write(value, stream_.get());
+    return buffered(Serializable::write(value, writeStream()));
   }
   int write(bool value) {
     uint8_t temp = value;
-    return Serializable::write(temp, stream_.get());
+    return buffered(Serializable::write(temp, writeStream()));
   }
   int writeUTF(std::string str, bool widen = false) {
-    return Serializable::writeUTF(str, stream_.get(), widen);
+    return buffered(Serializable::writeUTF(str, writeStream(), widen));
   }
   int read(uint8_t &value) {
+    if (flush() < 0)
+      return -1;
     return Serializable::read(value, stream_.get());
   }
   int read(uint16_t &value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
+    if (flush() < 0)
+      return -1;
     return Serializable::read(value, stream_.get());
   }
   int read(char &value) {
+    if (flush() < 0)
+      return -1;
     return Serializable::read(value, stream_.get());
   }
   int read(uint8_t *value, int len) {
+    if (flush() < 0)
+      return -1;
+    if (decompressing_)
+      return readDecompressed(value, len);
     return Serializable::read(value, len, stream_.get());
   }
   int read(uint32_t &value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
+    if (flush() < 0)
+      return -1;
     return Serializable::read(value, stream_.get());
   }
   int read(uint64_t &value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
+    if (flush() < 0)
+      return -1;
     return Serializable::read(value, stream_.get());
   }
   int readUTF(std::string &str, bool widen = false) {
+    if (flush() < 0)
+      return -1;
     return org::apache::nifi::minifi::io::Serializable::readUTF(str, stream_.get(), widen);
   }
   // open connection to the peer
@@ -354,6 +472,11 @@ class SiteToSitePeer : public org::apache::nifi::minifi::io::BaseStream {
     yield_expiration_ = 0;
     timeout_ = 30000;  // 30 seconds
     url_ = "nifi://" + host_ + ":" + std::to_string(port_);
+    corked_ = false;
+    write_buffer_.initialize();
+    compressing_ = false;
+    compress_buffer_.initialize();
+    decompressing_ = false;
 
     return *this;
   }
@@ -365,6 +488,35 @@ class SiteToSitePeer : public org::apache::nifi::minifi::io::BaseStream {
 
  private:
 
+  org::apache::nifi::minifi::io::DataStream *writeStream() {
+    if (compressing_)
+      return &compress_buffer_;
+    return corked_ ? &write_buffer_ : stream_.get();
+  }
+
+  // passes through the result of a write, compressing or sending the buffers once they are full
+  int buffered(int ret) {
+    if (ret < 0)
+      return ret;
+    if (compressing_) {
+      if (compress_buffer_.getSize() >= COMPRESSION_CHUNK_SIZE && compressChunk() < 0)
+        return -1;
+    } else if (corked_ && write_buffer_.getSize() >= WRITE_BUFFER_SIZE && flush() < 0) {
+      return -1;
+    }
+    return ret;
+  }
+
+  int flush();
+
+  // writes the data in compress_buffer_ as one compressed chunk
+  int compressChunk();
+
+  // reads and inflates the next compressed chunk
+  int decompressChunk();
+
+  int readDecompressed(uint8_t *value, int len);
+
   std::unique_ptr<org::apache::nifi::minifi::io::DataStream> stream_;
 
   std::string host_;
@@ -387,6 +539,20 @@ class SiteToSitePeer : public org::apache::nifi::minifi::io::BaseStream {
   std::atomic<uint64_t> yield_expiration_;
   // Yield Expiration per destination PortID
   std::map<std::string, uint64_t> yield_expiration_PortIdMap;
+  // whether writes are buffered in write_buffer_
+  bool corked_;
+  org::apache::nifi::minifi::io::DataStream write_buffer_;
+  // whether writes are collected in compress_buffer_ and sent as compressed chunks
+  bool compressing_;
+  // whether a chunk of the current compressed packet was written
+  bool chunk_written_;
+  org::apache::nifi::minifi::io::DataStream compress_buffer_;
+  // whether reads are served from decompressed_buffer_
+  bool decompressing_;
+  // whether the last chunk of the compressed packet was read
+  bool decompressed_eos_;
+  std::vector<uint8_t> decompressed_buffer_;
+  size_t decompressed_position_;
   // Logger
   std::shared_ptr<logging::Logger> logger_;
 };
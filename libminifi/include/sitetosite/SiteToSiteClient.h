@@ -59,6 +59,7 @@ class SiteToSiteClient : public core::Connectable {
       : core::Connectable("SitetoSiteClient"),
         peer_state_(IDLE),
         _batchSendNanos(5000000000),
+        use_compression_(false),
         ssl_context_service_(nullptr),
         logger_(logging::LoggerFactory<SiteToSiteClient>::getLogger()) {
     _supportedVersion[0] = 5;
@@ -81,6 +82,17 @@ class SiteToSiteClient : public core::Connectable {
     ssl_context_service_ = context_service;
   }
 
+  /**
+   * Requests that the data packets of transactions be compressed.
+   */
+  void setUseCompression(bool use_compression) {
+    use_compression_ = use_compression;
+  }
+
+  bool getUseCompression() const {
+    return use_compression_;
+  }
+
   /**
    * Creates a transaction using the transaction ID and the direction
    * @param transactionID transaction identifier
@@ -257,6 +269,9 @@ class SiteToSiteClient : public core::Connectable {
   // BATCH_SEND_NANOS
   uint64_t _batchSendNanos;
 
+  // whether data packets are compressed
+  bool use_compression_;
+
   /***
    * versioning
    */
@@ -311,11 +326,12 @@ class ReadCallback : public InputStreamCallback {
   DataPacket *_packet;
   int64_t process(std::shared_ptr<io::BaseStream> stream) {
     _packet->_size = 0;
-    uint8_t buffer[8192] = { 0 };
+    // blocks of this size bypass the peer's write buffer
+    std::vector<uint8_t> buffer(SiteToSitePeer::WRITE_BUFFER_SIZE);
     int readSize;
     size_t size = 0;
     do {
-      readSize = stream->read(buffer, 8192);
+      readSize = stream->read(buffer.data(), buffer.size());
 
       if (readSize == 0) {
         break;
@@ -323,7 +339,7 @@ class ReadCallback : public InputStreamCallback {
       if (readSize < 0) {
         return -1;
       }
-      int ret = _packet->transaction_->getStream().writeData(buffer, readSize);
+      int ret = _packet->transaction_->getStream().writeData(buffer.data(), readSize);
       if (ret != readSize) {
         logging::LOG_INFO(_packet->logger_reference_) << "Site2Site Send Flow Size " << readSize << " Failed " << ret;
         return -1;
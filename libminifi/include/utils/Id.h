@@ -18,6 +18,7 @@
 #define LIBMINIFI_INCLUDE_UTILS_ID_H_
 
 #include <cstddef>
+#include <cstring>
 #include <atomic>
 #include <memory>
 #include <string>
@@ -38,33 +39,34 @@ namespace nifi {
 namespace minifi {
 namespace utils {
 
-template<typename T, typename C>
+template<typename T>
 class IdentifierBase {
  public:
 
-  IdentifierBase(T myid) {
+  IdentifierBase(T myid)
+      : set_(true) {
     copyInto(myid);
   }
 
-  IdentifierBase(const IdentifierBase &other) {
+  IdentifierBase(const IdentifierBase &other)
+      : set_(other.set_) {
     copyInto(other.id_);
   }
 
-  IdentifierBase(IdentifierBase &&other)
-      : converted_(std::move(other.converted_)) {
-    copyInto(other.id_);
-  }
-
-  IdentifierBase() {
+  IdentifierBase()
+      : set_(false) {
+    memset(id_, 0, sizeof(T));
   }
 
   IdentifierBase &operator=(const IdentifierBase &other) {
     copyInto(other.id_);
+    set_ = other.set_;
     return *this;
   }
 
   IdentifierBase &operator=(T o) {
     copyInto(o);
+    set_ = true;
     return *this;
   }
 
@@ -72,30 +74,26 @@ class IdentifierBase {
     copyOutOf(other);
   }
 
-  C convert() const {
-    return converted_;
-  }
-
  protected:
 
-  void copyInto(const IdentifierBase &other) {
-    memcpy(id_, other.id_, sizeof(T));
-  }
-
   void copyInto(const void *other) {
     memcpy(id_, other, sizeof(T));
   }
 
-  void copyOutOf(void *other) {
+  void copyOutOf(void *other) const {
     memcpy(other, id_, sizeof(T));
   }
 
-  C converted_;
-
   T id_;
+
+  bool set_;
 };
 
-class Identifier : public IdentifierBase<UUID_FIELD, std::string> {
+/**
+ * Holds a uuid in its 16 byte binary form. The text form is only produced by to_string(), so that
+ * identifiers can be generated, copied, compared and hashed without allocating.
+ */
+class Identifier : public IdentifierBase<UUID_FIELD> {
  public:
   Identifier(UUID_FIELD u);
   Identifier();
@@ -119,15 +117,24 @@ class Identifier : public IdentifierBase<UUID_FIELD, std::string> {
 
   bool operator!=(const Identifier &other) const;
   bool operator==(const Identifier &other) const;
+  bool operator<(const Identifier &other) const;
 
   std::string to_string() const;
 
   const unsigned char * const toArray() const;
 
  protected:
+  friend struct IdentifierHash;
 
-  void build_string();
+  // text of an identifier assigned from a string that is not a uuid
+  std::string text_;
+};
 
+/**
+ * Hash for keying unordered containers on identifiers.
+ */
+struct IdentifierHash {
+  size_t operator()(const Identifier &identifier) const;
 };
 
 class IdGenerator {
@@ -145,10 +152,20 @@ class IdGenerator {
   uint64_t getRandomDeviceSegment(int numBits) const;
  private:
   IdGenerator();
+  /**
+   * Generates a time based (version 1) uuid without taking a lock. The clock sequence and node
+   * are fixed for the lifetime of the generator, and the timestamp is advanced atomically so that
+   * uuids generated in the same 100 ns interval stay distinct.
+   */
+  void generateTime(UUID_FIELD output);
   int implementation_;
   std::shared_ptr<minifi::core::logging::Logger> logger_;
   unsigned char deterministic_prefix_[8];
   std::atomic<uint64_t> incrementor_;
+  // clock sequence and node of the time based uuids
+  unsigned char clock_sequence_and_node_[8];
+  // timestamp of the last time based uuid
+  std::atomic<uint64_t> last_timestamp_;
 };
 
 class NonRepeatingStringGenerator {
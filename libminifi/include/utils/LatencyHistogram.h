@@ -0,0 +1,144 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_UTILS_LATENCYHISTOGRAM_H_
+#define LIBMINIFI_INCLUDE_UTILS_LATENCYHISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Purpose: Lock free histogram of latencies or other non negative values.
+ *
+ * Design: Values are counted in HDR style buckets: every power of two is split into eight linear
+ * sub buckets, so any recorded value is reported with a relative error below 12.5% while the whole
+ * uint64_t range fits into a fixed array of atomic counters. Recording is a handful of relaxed
+ * atomic operations, so it may be done on every trigger or dequeue.
+ */
+class LatencyHistogram {
+ public:
+  LatencyHistogram()
+      : count_(0),
+        sum_(0),
+        max_(0) {
+    for (auto &bucket : buckets_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  LatencyHistogram(const LatencyHistogram &other) = delete;
+  LatencyHistogram &operator=(const LatencyHistogram &other) = delete;
+
+  void record(uint64_t value) {
+    buckets_[getBucket(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  uint64_t getCount() const {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getSum() const {
+    return sum_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getMax() const {
+    return max_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getMean() const {
+    uint64_t count = getCount();
+    return count == 0 ? 0 : getSum() / count;
+  }
+
+  /**
+   * Returns the value below or at which the given percentage of the recorded values lie,
+   * as the upper bound of the bucket that holds it.
+   * @param percentile percentile between 0 and 100
+   */
+  uint64_t getPercentile(double percentile) const {
+    uint64_t count = getCount();
+    if (count == 0) {
+      return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * count + 0.5);
+    if (rank == 0) {
+      rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+      seen += buckets_[i].load(std::memory_order_relaxed);
+      if (seen >= rank) {
+        uint64_t upper = getBucketUpperBound(i);
+        uint64_t max = getMax();
+        return upper < max ? upper : max;
+      }
+    }
+    return getMax();
+  }
+
+ private:
+  static const size_t SUB_BUCKET_BITS = 3;
+  static const size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  // values below SUB_BUCKETS are exact, every further power of two gets SUB_BUCKETS buckets
+  static const size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  static size_t getBucket(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+      return static_cast<size_t>(value);
+    }
+    size_t magnitude = 0;
+    for (uint64_t remaining = value >> 1; remaining > 0; remaining >>= 1) {
+      magnitude++;
+    }
+    size_t sub_bucket = static_cast<size_t>(value >> (magnitude - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return (magnitude - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub_bucket;
+  }
+
+  static uint64_t getBucketUpperBound(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+      return bucket;
+    }
+    size_t shift = bucket / SUB_BUCKETS - 1;
+    uint64_t lower = static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    return lower + ((static_cast<uint64_t>(1) << shift) - 1);
+  }
+
+  std::array<std::atomic<uint64_t>, BUCKETS> buckets_;
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> max_;
+};
+
+} /* namespace utils */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_UTILS_LATENCYHISTOGRAM_H_ */
@@ -17,19 +17,29 @@
 #ifndef LIBMINIFI_INCLUDE_THREAD_POOL_H
 #define LIBMINIFI_INCLUDE_THREAD_POOL_H
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
+#include <limits>
 #include <sstream>
 #include <iostream>
 #include <atomic>
 #include <mutex>
 #include <map>
+#include <set>
 #include <vector>
 #include <queue>
 #include <future>
 #include <thread>
 #include <functional>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include "BackTrace.h"
+#include "utils/TimerWheel.h"
+#include "utils/TimeUtil.h"
 #include "core/expect.h"
 #include "controllers/ThreadManagementService.h"
 #include "concurrentqueue.h"
@@ -66,6 +76,13 @@ class AfterExecute {
    * @return milliseconds since epoch after which we are eligible to re-run this task.
    */
   virtual int64_t wait_time() = 0;
+  /**
+   * Whether the task may be parked until it is woken up, rather than re-run after the wait time.
+   * The wait time still bounds how long the task stays parked if parking is not supported.
+   */
+  virtual bool isParked(const T &result) {
+    return false;
+  }
 };
 
 /**
@@ -79,6 +96,7 @@ class Worker {
   explicit Worker(std::function<T()> &task, const std::string &identifier, std::unique_ptr<AfterExecute<T>> run_determinant)
       : identifier_(identifier),
         time_slice_(0),
+        parked_(false),
         task(task),
         run_determinant_(std::move(run_determinant)) {
     promise = std::make_shared<std::promise<T>>();
@@ -87,6 +105,7 @@ class Worker {
   explicit Worker(std::function<T()> &task, const std::string &identifier)
       : identifier_(identifier),
         time_slice_(0),
+        parked_(false),
         task(task),
         run_determinant_(nullptr) {
     promise = std::make_shared<std::promise<T>>();
@@ -94,7 +113,8 @@ class Worker {
 
   explicit Worker(const std::string identifier = "")
       : identifier_(identifier),
-        time_slice_(0) {
+        time_slice_(0),
+        parked_(false) {
   }
 
   virtual ~Worker() {
@@ -107,6 +127,7 @@ class Worker {
   Worker(Worker &&other)
       : identifier_(std::move(other.identifier_)),
         time_slice_(std::move(other.time_slice_)),
+        parked_(other.parked_),
         task(std::move(other.task)),
         run_determinant_(std::move(other.run_determinant_)),
         promise(other.promise) {
@@ -126,6 +147,7 @@ class Worker {
       return false;
     }
     time_slice_ = increment_time(run_determinant_->wait_time());
+    parked_ = run_determinant_->isParked(result);
     return true;
   }
 
@@ -141,6 +163,13 @@ class Worker {
     return run_determinant_->wait_time();
   }
 
+  /**
+   * @return whether the last run asked for the task to be parked until it is woken up.
+   */
+  bool isParked() const {
+    return parked_;
+  }
+
   Worker<T>(const Worker<T>&) = delete;
   Worker<T>& operator =(const Worker<T>&) = delete;
 
@@ -161,6 +190,7 @@ class Worker {
 
   std::string identifier_;
   uint64_t time_slice_;
+  bool parked_;
   std::function<T()> task;
   std::unique_ptr<AfterExecute<T>> run_determinant_;
   std::shared_ptr<std::promise<T>> promise;
@@ -179,6 +209,7 @@ Worker<T>& Worker<T>::operator =(Worker<T> && other) {
   task = std::move(other.task);
   promise = other.promise;
   time_slice_ = std::move(other.time_slice_);
+  parked_ = other.parked_;
   identifier_ = std::move(other.identifier_);
   run_determinant_ = std::move(other.run_determinant_);
   return *this;
@@ -194,17 +225,21 @@ class WorkerThread {
   explicit WorkerThread(std::thread thread, const std::string &name = "NamelessWorker")
       : is_running_(false),
         thread_(std::move(thread)),
-        name_(name) {
+        name_(name),
+        index_(0) {
 
   }
   WorkerThread(const std::string &name = "NamelessWorker")
       : is_running_(false),
-        name_(name) {
+        name_(name),
+        index_(0) {
 
   }
   std::atomic<bool> is_running_;
   std::thread thread_;
   std::string name_;
+  // local queue of the thread when work stealing
+  int index_;
 };
 
 /**
@@ -212,6 +247,13 @@ class WorkerThread {
  * Purpose: Provides a thread pool with basic functionality similar to
  * ThreadPoolExecutor
  * Design: Locked control over a manager thread that controls the worker threads
+ *
+ * Workers are either taken from one shared queue, or, with work stealing enabled,
+ * from a deque per worker thread: threads run the tasks of their own deque and
+ * steal from the others once it is empty, and renewed tasks that are not yet due
+ * wait in a timer wheel rather than being re-queued until their time slice comes.
+ * Tasks that ask to be parked are taken off the queues altogether until they are
+ * woken up or the park timeout elapses.
  */
 template<typename T>
 class ThreadPool {
@@ -225,7 +267,14 @@ class ThreadPool {
         adjust_threads_(false),
         running_(false),
         controller_service_provider_(controller_service_provider),
-        name_(name) {
+        name_(name),
+        work_stealing_(false),
+        pin_threads_(false),
+        park_timeout_millis_(0),
+        next_queue_(0),
+        queued_tasks_(0),
+        next_timer_deadline_(std::numeric_limits<uint64_t>::max()),
+        park_generation_(0) {
     current_workers_ = 0;
     task_count_ = 0;
     thread_manager_ = nullptr;
@@ -239,7 +288,14 @@ class ThreadPool {
         running_(false),
         controller_service_provider_(std::move(other.controller_service_provider_)),
         thread_manager_(std::move(other.thread_manager_)),
-        name_(std::move(other.name_)) {
+        name_(std::move(other.name_)),
+        work_stealing_(other.work_stealing_),
+        pin_threads_(other.pin_threads_),
+        park_timeout_millis_(other.park_timeout_millis_.load()),
+        next_queue_(0),
+        queued_tasks_(0),
+        next_timer_deadline_(std::numeric_limits<uint64_t>::max()),
+        park_generation_(0) {
     current_workers_ = 0;
     task_count_ = 0;
   }
@@ -269,7 +325,8 @@ class ThreadPool {
    * Returns true if a task is running.
    */
   bool isRunning(const std::string &identifier) {
-    return task_status_[identifier] == true;
+    std::unique_lock<std::mutex> lock(worker_queue_mutex_);
+    return isTaskActive(identifier);
   }
 
   std::vector<BackTrace> getTraces() {
@@ -312,6 +369,47 @@ class ThreadPool {
       start();
   }
 
+  /**
+   * Selects the work stealing engine. Restarts the thread pool if it is running.
+   * @param work_stealing use a deque per worker thread with work stealing and a
+   * timer wheel for delayed tasks instead of the shared queue
+   * @param pin_threads pin each worker thread to a core; only supported on Linux
+   */
+  void setWorkStealing(bool work_stealing, bool pin_threads = false) {
+    std::lock_guard<std::recursive_mutex> lock(manager_mutex_);
+    bool was_running = running_;
+    if (was_running) {
+      shutdown();
+    }
+    work_stealing_ = work_stealing;
+    pin_threads_ = pin_threads;
+    if (was_running)
+      start();
+  }
+
+  bool isWorkStealing() const {
+    return work_stealing_;
+  }
+
+  /**
+   * Sets how long the work stealing engine keeps a parked task off the queues
+   * when it is not woken up. 0 disables parking.
+   */
+  void setParkTimeout(uint64_t park_timeout_millis) {
+    park_timeout_millis_ = park_timeout_millis;
+  }
+
+  uint64_t getParkTimeout() const {
+    return park_timeout_millis_;
+  }
+
+  /**
+   * Requeues the parked tasks with the provided identifier. If none is parked the
+   * next one that asks to be parked is requeued right away, so a wake up that
+   * races with parking is not lost.
+   */
+  void wake(const std::string &identifier);
+
   ThreadPool<T> operator=(const ThreadPool<T> &other) = delete;
   ThreadPool(const ThreadPool<T> &other) = delete;
 
@@ -334,6 +432,10 @@ class ThreadPool {
     controller_service_provider_ = std::move(other.controller_service_provider_);
     thread_manager_ = std::move(other.thread_manager_);
 
+    work_stealing_ = other.work_stealing_;
+    pin_threads_ = other.pin_threads_;
+    park_timeout_millis_ = other.park_timeout_millis_.load();
+
     adjust_threads_ = false;
 
     if (!running_) {
@@ -358,7 +460,224 @@ class ThreadPool {
   void drain() {
     while (current_workers_ > 0) {
       tasks_available_.notify_one();
+      work_available_.notify_one();
+    }
+  }
+
+  /**
+   * Worker queued by the work stealing engine.
+   */
+  struct ScheduledTask {
+    Worker<T> worker;
+    // shared by the tasks of an identifier, cleared by stopTasks; nullptr for the
+    // park timeout of the identifier's parked tasks
+    std::shared_ptr<std::atomic<bool>> active;
+    // park generation the park timeout belongs to
+    uint64_t park_generation;
+  };
+
+  /**
+   * Tasks of an identifier parked until they are woken up. They share one park timeout,
+   * which is ignored when it fires after the generation was woken up.
+   */
+  struct ParkedTasks {
+    std::vector<ScheduledTask> tasks;
+    uint64_t generation;
+  };
+
+  /**
+   * Deque of a worker thread. The owner takes from the front, thieves from the back.
+   */
+  struct LocalQueue {
+    std::mutex mutex;
+    std::deque<ScheduledTask> tasks;
+  };
+
+  // expects worker_queue_mutex_ to be held
+  bool isTaskActive(const std::string &identifier) {
+    auto status = task_status_.find(identifier);
+    return status != task_status_.end() && status->second->load();
+  }
+
+  std::function<void()> createRunner(const std::shared_ptr<WorkerThread> &thread) {
+    if (work_stealing_) {
+      return std::bind(&ThreadPool::run_stealing_tasks, this, thread);
+    }
+    return std::bind(&ThreadPool::run_tasks, this, thread);
+  }
+
+  /**
+   * Creates a local queue per worker thread. Only called while no worker thread runs.
+   */
+  void createLocalQueues() {
+    size_t count = max_worker_threads_ > 0 ? max_worker_threads_ : 1;
+    while (local_queues_.size() < count) {
+      local_queues_.emplace_back(new LocalQueue());
+    }
+    int index;
+    while (free_queue_indices_.try_dequeue(index)) {
+    }
+  }
+
+  void pushLocal(size_t index, ScheduledTask &&task) {
+    {
+      std::lock_guard<std::mutex> lock(local_queues_[index]->mutex);
+      local_queues_[index]->tasks.push_back(std::move(task));
+    }
+    queued_tasks_++;
+  }
+
+  bool popLocal(size_t index, ScheduledTask &task) {
+    std::lock_guard<std::mutex> lock(local_queues_[index]->mutex);
+    auto &tasks = local_queues_[index]->tasks;
+    if (tasks.empty()) {
+      return false;
+    }
+    task = std::move(tasks.front());
+    tasks.pop_front();
+    queued_tasks_--;
+    return true;
+  }
+
+  /**
+   * Takes a task from the back of another thread's deque, skipping deques whose owner holds the lock.
+   */
+  bool steal(size_t index, ScheduledTask &task) {
+    for (size_t i = 1; i < local_queues_.size() && queued_tasks_ > 0; i++) {
+      auto &victim = local_queues_[(index + i) % local_queues_.size()];
+      std::unique_lock<std::mutex> lock(victim->mutex, std::try_to_lock);
+      if (!lock.owns_lock() || victim->tasks.empty()) {
+        continue;
+      }
+      task = std::move(victim->tasks.back());
+      victim->tasks.pop_back();
+      queued_tasks_--;
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * Parks a renewed task in the timer wheel until its time slice.
+   */
+  void delay(uint64_t time_slice, ScheduledTask &&task) {
+    bool earliest = false;
+    {
+      std::lock_guard<std::mutex> lock(timer_mutex_);
+      earliest = time_slice < next_timer_deadline_;
+      timer_wheel_.schedule(time_slice, std::move(task));
+      next_timer_deadline_ = timer_wheel_.getNextDeadline();
+    }
+    if (earliest) {
+      // an idle thread may be sleeping past the new deadline
+      notifyIdle(false);
+    }
+  }
+
+  /**
+   * Takes a task that asked to be parked off the queues until it is woken up.
+   */
+  void park(size_t index, ScheduledTask &&task) {
+    std::string identifier = task.worker.getIdentifier();
+    bool parked = false;
+    // the first task parked for the identifier arms the park timeout of its generation
+    bool arm_timeout = false;
+    uint64_t generation = 0;
+    {
+      std::lock_guard<std::mutex> lock(park_mutex_);
+      if (pending_wakes_.erase(identifier) == 0) {
+        auto entry = parked_.find(identifier);
+        if (entry == parked_.end()) {
+          generation = ++park_generation_;
+          entry = parked_.insert(std::make_pair(identifier, ParkedTasks { std::vector<ScheduledTask>(), generation })).first;
+          arm_timeout = true;
+        }
+        entry->second.tasks.push_back(std::move(task));
+        parked = true;
+      }
+    }
+    if (!parked) {
+      pushLocal(index, std::move(task));
+    } else if (arm_timeout) {
+      delay(getTimeMillis() + park_timeout_millis_, ScheduledTask { Worker<T>(identifier), nullptr, generation });
+    }
+  }
+
+  /**
+   * Requeues the parked tasks of the identifier.
+   * @param remember whether to requeue the next task that asks to be parked if none is parked now
+   * @param generation park generation whose timeout fired, or 0 to requeue whatever is parked
+   */
+  void unpark(const std::string &identifier, bool remember, uint64_t generation = 0);
+
+  /**
+   * Moves the tasks whose time slice has come to the deque of the given thread.
+   */
+  void releaseTimers(size_t index) {
+    uint64_t now = getTimeMillis();
+    if (next_timer_deadline_ > now) {
+      return;
+    }
+    std::vector<ScheduledTask> expired;
+    {
+      std::unique_lock<std::mutex> lock(timer_mutex_, std::try_to_lock);
+      if (!lock.owns_lock()) {
+        // another thread is releasing them
+        return;
+      }
+      timer_wheel_.advance(now, expired);
+      next_timer_deadline_ = timer_wheel_.getNextDeadline();
+    }
+    for (auto &task : expired) {
+      pushLocal(index, std::move(task));
+    }
+    if (expired.size() > 1) {
+      notifyIdle(true);
+    }
+  }
+
+  void notifyIdle(bool all) {
+    {
+      // pairs with the check in waitForWork so the notification cannot be missed
+      std::lock_guard<std::mutex> lock(idle_mutex_);
+    }
+    if (all) {
+      work_available_.notify_all();
+    } else {
+      work_available_.notify_one();
+    }
+  }
+
+  /**
+   * Sleeps until a task is queued or the earliest delayed task is due.
+   */
+  void waitForWork() {
+    std::unique_lock<std::mutex> lock(idle_mutex_);
+    if (queued_tasks_ > 0 || !running_) {
+      return;
+    }
+    uint64_t now = getTimeMillis();
+    uint64_t deadline = next_timer_deadline_;
+    if (deadline <= now) {
+      return;
     }
+    auto wait = std::chrono::milliseconds(std::min<uint64_t>(deadline - now, 100));
+    work_available_.wait_for(lock, wait);
+  }
+
+  bool pinThread(size_t index) {
+#ifdef __linux__
+    unsigned int cores = std::thread::hardware_concurrency();
+    if (cores == 0) {
+      return false;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(index % cores, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus) == 0;
+#else
+    return false;
+#endif
   }
 // determines if threads are detached
   bool daemon_threads_;
@@ -388,13 +707,33 @@ class ThreadPool {
 // notification for available work
   std::condition_variable tasks_available_;
 // map to identify if a task should be
-  std::map<std::string, bool> task_status_;
+  std::map<std::string, std::shared_ptr<std::atomic<bool>>> task_status_;
 // manager mutex
   std::recursive_mutex manager_mutex_;
 // work queue mutex
   std::mutex worker_queue_mutex_;
   // thread pool name
   std::string name_;
+  // work stealing engine
+  bool work_stealing_;
+  bool pin_threads_;
+  std::atomic<uint64_t> park_timeout_millis_;
+  std::vector<std::unique_ptr<LocalQueue>> local_queues_;
+  // local queues of threads that were removed by the thread manager
+  moodycamel::ConcurrentQueue<int> free_queue_indices_;
+  std::atomic<size_t> next_queue_;
+  std::atomic<int64_t> queued_tasks_;
+  std::mutex timer_mutex_;
+  TimerWheel<ScheduledTask> timer_wheel_;
+  std::atomic<uint64_t> next_timer_deadline_;
+  std::mutex park_mutex_;
+  std::map<std::string, ParkedTasks> parked_;
+  // last park generation handed out, guarded by park_mutex_
+  uint64_t park_generation_;
+  // identifiers woken up while none of their tasks was parked
+  std::set<std::string> pending_wakes_;
+  std::mutex idle_mutex_;
+  std::condition_variable work_available_;
 
   /**
    * Call for the manager to start worker threads
@@ -410,15 +749,38 @@ class ThreadPool {
    * Runs worker tasks
    */
   void run_tasks(std::shared_ptr<WorkerThread> thread);
+
+  /**
+   * Runs worker tasks with work stealing
+   */
+  void run_stealing_tasks(std::shared_ptr<WorkerThread> thread);
 };
 
 template<typename T>
 bool ThreadPool<T>::execute(Worker<T> &&task, std::future<T> &future) {
+  std::shared_ptr<std::atomic<bool>> active;
   {
     std::unique_lock<std::mutex> lock(worker_queue_mutex_);
-    task_status_[task.getIdentifier()] = true;
+    auto &status = task_status_[task.getIdentifier()];
+    // a new flag for a stopped identifier, so that its stopped work stealing tasks stay stopped
+    if (status == nullptr || !status->load()) {
+      status = std::make_shared<std::atomic<bool>>(true);
+    }
+    active = status;
   }
   future = std::move(task.getPromise()->get_future());
+  if (work_stealing_) {
+    {
+      std::lock_guard<std::recursive_mutex> lock(manager_mutex_);
+      if (local_queues_.empty()) {
+        createLocalQueues();
+      }
+      pushLocal(next_queue_++ % local_queues_.size(), ScheduledTask { std::move(task), active, 0 });
+    }
+    notifyIdle(false);
+    task_count_++;
+    return true;
+  }
   bool enqueued = worker_queue_.enqueue(std::move(task));
   if (running_) {
     tasks_available_.notify_one();
@@ -435,7 +797,8 @@ void ThreadPool<T>::manageWorkers() {
     std::stringstream thread_name;
     thread_name << name_ << " #" << i;
     auto worker_thread = std::make_shared<WorkerThread>(thread_name.str());
-    worker_thread->thread_ = createThread(std::bind(&ThreadPool::run_tasks, this, worker_thread));
+    worker_thread->index_ = i;
+    worker_thread->thread_ = createThread(createRunner(worker_thread));
     thread_queue_.push_back(worker_thread);
     current_workers_++;
   }
@@ -462,7 +825,10 @@ void ThreadPool<T>::manageWorkers() {
         } else if (thread_manager_->canIncrease() && max_worker_threads_ - current_workers_ > 0) {  // increase slowly
           std::unique_lock<std::mutex> lock(worker_queue_mutex_);
           auto worker_thread = std::make_shared<WorkerThread>();
-          worker_thread->thread_ = createThread(std::bind(&ThreadPool::run_tasks, this, worker_thread));
+          int index = 0;
+          free_queue_indices_.try_dequeue(index);
+          worker_thread->index_ = index;
+          worker_thread->thread_ = createThread(createRunner(worker_thread));
           if (daemon_threads_) {
             worker_thread->thread_.detach();
           }
@@ -551,7 +917,7 @@ void ThreadPool<T>::run_tasks(std::shared_ptr<WorkerThread> thread) {
         continue;
       } else {
         std::unique_lock<std::mutex> lock(worker_queue_mutex_);
-        if (!task_status_[task.getIdentifier()]) {
+        if (!isTaskActive(task.getIdentifier())) {
           continue;
         }
       }
@@ -572,7 +938,7 @@ void ThreadPool<T>::run_tasks(std::shared_ptr<WorkerThread> thread) {
       if (wait_to_run) {
         {
           std::unique_lock<std::mutex> lock(worker_queue_mutex_);
-          if (!task_status_[task.getIdentifier()]) {
+          if (!isTaskActive(task.getIdentifier())) {
             continue;
           }
           // put it on the priority queue
@@ -590,7 +956,7 @@ void ThreadPool<T>::run_tasks(std::shared_ptr<WorkerThread> thread) {
       if (UNLIKELY(task_count_ > current_workers_)) {
         // even if we have more work to do we will not
         std::unique_lock<std::mutex> lock(worker_queue_mutex_);
-        if (!task_status_[task.getIdentifier()]) {
+        if (!isTaskActive(task.getIdentifier())) {
           continue;
         }
 
@@ -602,6 +968,91 @@ void ThreadPool<T>::run_tasks(std::shared_ptr<WorkerThread> thread) {
   }
   current_workers_--;
 }
+
+template<typename T>
+void ThreadPool<T>::run_stealing_tasks(std::shared_ptr<WorkerThread> thread) {
+  thread->is_running_ = true;
+  const size_t index = thread->index_;
+  if (pin_threads_) {
+    pinThread(index);
+  }
+  while (running_.load()) {
+    if (UNLIKELY(thread_reduction_count_ > 0)) {
+      if (--thread_reduction_count_ >= 0) {
+        // the remaining tasks of our deque are stolen by the other threads
+        free_queue_indices_.enqueue(thread->index_);
+        deceased_thread_queue_.enqueue(thread);
+        thread->is_running_ = false;
+        break;
+      } else {
+        thread_reduction_count_++;
+      }
+    }
+    releaseTimers(index);
+    ScheduledTask task;
+    if (!popLocal(index, task) && !steal(index, task)) {
+      waitForWork();
+      continue;
+    }
+    if (task.active == nullptr) {
+      // park timeout; stale when its generation was already woken up
+      unpark(task.worker.getIdentifier(), false, task.park_generation);
+      continue;
+    }
+    if (!task.active->load()) {
+      continue;
+    }
+    if (!task.worker.run()) {
+      continue;
+    }
+    if (task.worker.isParked() && park_timeout_millis_ > 0) {
+      park(index, std::move(task));
+      continue;
+    }
+    uint64_t time_slice = task.worker.getTimeSlice();
+    if (time_slice > 1) {
+      uint64_t now = getTimeMillis();
+      // as with the shared queue, run it again right away when within 10% of the wait time
+      if (time_slice > now && (double) (time_slice - now) > (double) task.worker.getWaitTime() * .10) {
+        delay(time_slice, std::move(task));
+        continue;
+      }
+    }
+    pushLocal(index, std::move(task));
+  }
+  current_workers_--;
+}
+
+template<typename T>
+void ThreadPool<T>::wake(const std::string &identifier) {
+  unpark(identifier, true);
+}
+
+template<typename T>
+void ThreadPool<T>::unpark(const std::string &identifier, bool remember, uint64_t generation) {
+  std::vector<ScheduledTask> woken;
+  {
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    auto parked = parked_.find(identifier);
+    if (parked == parked_.end()) {
+      if (remember) {
+        pending_wakes_.insert(identifier);
+      }
+      return;
+    }
+    if (generation != 0 && parked->second.generation != generation) {
+      // the tasks this timeout was armed for were woken up and parked again since
+      return;
+    }
+    woken = std::move(parked->second.tasks);
+    parked_.erase(parked);
+  }
+  for (auto &task : woken) {
+    pushLocal(next_queue_++ % local_queues_.size(), std::move(task));
+  }
+  notifyIdle(woken.size() > 1);
+}
+
 template<typename T>
 void ThreadPool<T>::start() {
   if (nullptr != controller_service_provider_) {
@@ -612,6 +1063,9 @@ void ThreadPool<T>::start() {
   }
   std::lock_guard<std::recursive_mutex> lock(manager_mutex_);
   if (!running_) {
+    if (work_stealing_) {
+      createLocalQueues();
+    }
     running_ = true;
     manager_thread_ = std::move(std::thread(&ThreadPool::manageWorkers, this));
     if (worker_queue_.size_approx() > 0) {
@@ -623,7 +1077,13 @@ void ThreadPool<T>::start() {
 template<typename T>
 void ThreadPool<T>::stopTasks(const std::string &identifier) {
   std::unique_lock<std::mutex> lock(worker_queue_mutex_);
-  task_status_[identifier] = false;
+  auto status = task_status_.find(identifier);
+  if (status != task_status_.end()) {
+    status->second->store(false);
+  }
+  std::lock_guard<std::mutex> park_lock(park_mutex_);
+  parked_.erase(identifier);
+  pending_wakes_.erase(identifier);
 }
 
 template<typename T>
@@ -648,6 +1108,20 @@ void ThreadPool<T>::shutdown() {
         Worker<T> task;
         worker_queue_.try_dequeue(task);
       }
+      for (auto &local_queue : local_queues_) {
+        local_queue->tasks.clear();
+      }
+      queued_tasks_ = 0;
+    }
+    {
+      std::lock_guard<std::mutex> lock(timer_mutex_);
+      timer_wheel_.clear();
+      next_timer_deadline_ = std::numeric_limits<uint64_t>::max();
+    }
+    {
+      std::lock_guard<std::mutex> lock(park_mutex_);
+      parked_.clear();
+      pending_wakes_.clear();
     }
   }
 }
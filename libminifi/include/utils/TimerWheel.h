@@ -0,0 +1,174 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_UTILS_TIMERWHEEL_H_
+#define LIBMINIFI_INCLUDE_UTILS_TIMERWHEEL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Purpose: Hashed timer wheel holding items until a deadline in milliseconds.
+ *
+ * Design: Items are hashed into one of a fixed number of slots by their deadline tick, and every slot
+ * remembers the earliest deadline it holds. Advancing the wheel only visits the slots of the ticks that
+ * elapsed since the last advance and skips those whose earliest deadline is still ahead, so scheduling
+ * is O(1) and expiring is bounded by the elapsed ticks and the slot count rather than by the number of
+ * pending items. Items more than one revolution away stay in their slot until a later pass reaches
+ * their deadline.
+ *
+ * Not thread safe; callers guard it.
+ */
+template<typename T>
+class TimerWheel {
+ public:
+  explicit TimerWheel(uint64_t tick_millis = 1, size_t slot_count = 1024)
+      : tick_millis_(std::max<uint64_t>(tick_millis, 1)),
+        slots_(std::max<size_t>(slot_count, 1)),
+        current_tick_(0),
+        next_deadline_(std::numeric_limits<uint64_t>::max()),
+        size_(0) {
+  }
+
+  /**
+   * Schedules the item. Items whose deadline already passed go into the slot of the tick after the last
+   * visited one, so they expire on the first advance that reaches a new tick.
+   * @param deadline milliseconds since epoch.
+   */
+  void schedule(uint64_t deadline, T &&item) {
+    uint64_t tick = std::max(deadline / tick_millis_, current_tick_ + 1);
+    auto &slot = slots_[tick % slots_.size()];
+    slot.entries.push_back(Entry { deadline, std::move(item) });
+    slot.min_deadline = std::min(slot.min_deadline, deadline);
+    next_deadline_ = std::min(next_deadline_, deadline);
+    ++size_;
+  }
+
+  /**
+   * Moves every item whose deadline is at or before now into expired.
+   * @param now milliseconds since epoch.
+   * @return number of expired items.
+   */
+  size_t advance(uint64_t now, std::vector<T> &expired) {
+    uint64_t now_tick = now / tick_millis_;
+    if (current_tick_ == 0) {
+      // first advance; slots behind now may still hold past deadlines
+      current_tick_ = now_tick > slots_.size() ? now_tick - slots_.size() : 0;
+    }
+    if (next_deadline_ > now) {
+      // nothing is due; skip the empty ticks, stopping short of the earliest deadline's slot
+      current_tick_ = std::max(current_tick_, std::min(now_tick, next_deadline_ / tick_millis_ - 1));
+      return 0;
+    }
+    if (now_tick <= current_tick_) {
+      return 0;
+    }
+    size_t count = 0;
+    // a full revolution visits every slot, so there is no need to go further
+    uint64_t last_tick = std::min(now_tick, current_tick_ + slots_.size());
+    for (uint64_t tick = current_tick_ + 1; tick <= last_tick; tick++) {
+      auto &slot = slots_[tick % slots_.size()];
+      if (slot.min_deadline > now) {
+        continue;
+      }
+      auto &entries = slot.entries;
+      slot.min_deadline = std::numeric_limits<uint64_t>::max();
+      for (size_t i = 0; i < entries.size();) {
+        if (entries[i].deadline <= now) {
+          expired.push_back(std::move(entries[i].item));
+          if (i + 1 != entries.size()) {
+            entries[i] = std::move(entries.back());
+          }
+          entries.pop_back();
+          ++count;
+        } else {
+          slot.min_deadline = std::min(slot.min_deadline, entries[i].deadline);
+          ++i;
+        }
+      }
+    }
+    current_tick_ = now_tick;
+    size_ -= count;
+    next_deadline_ = std::numeric_limits<uint64_t>::max();
+    for (const auto &slot : slots_) {
+      next_deadline_ = std::min(next_deadline_, slot.min_deadline);
+    }
+    return count;
+  }
+
+  /**
+   * @return the earliest deadline of the scheduled items, or the maximum value if there are none.
+   */
+  uint64_t getNextDeadline() const {
+    return next_deadline_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  void clear() {
+    for (auto &slot : slots_) {
+      slot.entries.clear();
+      slot.min_deadline = std::numeric_limits<uint64_t>::max();
+    }
+    next_deadline_ = std::numeric_limits<uint64_t>::max();
+    size_ = 0;
+  }
+
+ private:
+  struct Entry {
+    uint64_t deadline;
+    T item;
+  };
+
+  struct Slot {
+    Slot()
+        : min_deadline(std::numeric_limits<uint64_t>::max()) {
+    }
+    std::vector<Entry> entries;
+    uint64_t min_deadline;
+  };
+
+  uint64_t tick_millis_;
+  std::vector<Slot> slots_;
+  // last tick whose slot was visited
+  uint64_t current_tick_;
+  uint64_t next_deadline_;
+  size_t size_;
+};
+
+} /* namespace utils */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_UTILS_TIMERWHEEL_H_ */
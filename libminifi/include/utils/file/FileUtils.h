@@ -19,6 +19,8 @@
 
 #include <sstream>
 #include <fstream>
+#include <algorithm>
+#include <vector>
 #ifdef BOOST_VERSION
 #include <boost/filesystem.hpp>
 #else
@@ -56,6 +58,16 @@
 #ifdef __APPLE__
 #include <mach-o/dyld.h>
 #endif
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+// from linux/fs.h, which cannot be included here as it defines BLOCK_SIZE
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+#endif
 
 #include "core/logging/LoggerConfiguration.h"
 #include "utils/StringUtils.h"
@@ -289,6 +301,80 @@ class FileUtils {
     return 0;
   }
 
+  /**
+   * Copies length bytes of path_from, starting at offset, into a new file at dest_path. On Linux the data
+   * is not copied through user space: a whole file is cloned when the file system supports reflinks, and
+   * copy_file_range or sendfile are used otherwise.
+   * @return number of bytes copied, or -1 on failure, including a region beyond the end of path_from.
+   */
+  static int64_t copy_file_region(const std::string &path_from, uint64_t offset, uint64_t length, const std::string &dest_path) {
+#ifdef __linux__
+    int src = open(path_from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (src < 0) {
+      return -1;
+    }
+    int dest = open(dest_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (dest < 0) {
+      ::close(src);
+      return -1;
+    }
+    struct stat src_stat;
+    if (fstat(src, &src_stat) != 0 || offset + length > static_cast<uint64_t>(src_stat.st_size)) {
+      ::close(src);
+      ::close(dest);
+      return -1;
+    }
+    uint64_t copied = 0;
+    if (offset == 0 && length == static_cast<uint64_t>(src_stat.st_size) && length > 0 && ioctl(dest, FICLONE, src) == 0) {
+      copied = length;
+    }
+    bool kernel_copy = true;
+    while (copied < length) {
+      ssize_t ret = -1;
+      loff_t src_offset = offset + copied;
+#ifdef __NR_copy_file_range
+      if (kernel_copy) {
+        ret = syscall(__NR_copy_file_range, src, &src_offset, nullptr, dest, nullptr, length - copied, 0);
+        if (ret < 0) {
+          // not supported for this pair of files or kernel; sendfile reports real I/O errors
+          kernel_copy = false;
+          src_offset = offset + copied;
+        }
+      }
+#else
+      kernel_copy = false;
+#endif
+      if (!kernel_copy) {
+        off_t sendfile_offset = offset + copied;
+        ret = sendfile(dest, src, &sendfile_offset, length - copied);
+      }
+      if (ret <= 0) {
+        break;
+      }
+      copied += ret;
+    }
+    ::close(src);
+    if (::close(dest) != 0 || copied < length) {
+      return -1;
+    }
+    return copied;
+#else
+    std::ifstream src(path_from, std::ios::binary);
+    if (!src.is_open())
+      return -1;
+    src.seekg(offset);
+    std::ofstream dest(dest_path, std::ios::binary);
+    std::vector<char> buffer(4096);
+    uint64_t copied = 0;
+    while (copied < length && src.good()) {
+      src.read(buffer.data(), std::min<uint64_t>(buffer.size(), length - copied));
+      dest.write(buffer.data(), src.gcount());
+      copied += src.gcount();
+    }
+    return dest.good() && copied == length ? copied : -1;
+#endif
+  }
+
   static void addFilesMatchingExtension(const std::shared_ptr<logging::Logger> &logger, const std::string &originalPath, const std::string &extension, std::vector<std::string> &accruedFiles) {
 #ifndef WIN32
 
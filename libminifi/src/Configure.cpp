@@ -28,6 +28,9 @@ const char *Configure::nifi_flow_configuration_file = "nifi.flow.configuration.f
 const char *Configure::nifi_flow_configuration_file_exit_failure = "nifi.flow.configuration.file.exit.onfailure";
 const char *Configure::nifi_flow_configuration_file_backup_update = "nifi.flow.configuration.backup.on.update";
 const char *Configure::nifi_flow_engine_threads = "nifi.flow.engine.threads";
+const char *Configure::nifi_flow_engine_work_stealing = "nifi.flow.engine.work.stealing";
+const char *Configure::nifi_flow_engine_thread_affinity = "nifi.flow.engine.thread.affinity";
+const char *Configure::nifi_flow_engine_park_timeout = "nifi.flow.engine.park.timeout";
 const char *Configure::nifi_administrative_yield_duration = "nifi.administrative.yield.duration";
 const char *Configure::nifi_bored_yield_duration = "nifi.bored.yield.duration";
 const char *Configure::nifi_graceful_shutdown_seconds = "nifi.flowcontroller.graceful.shutdown.period";
@@ -46,7 +49,11 @@ const char *Configure::nifi_provenance_repository_directory_default = "nifi.prov
 const char *Configure::nifi_flowfile_repository_max_storage_size = "nifi.flowfile.repository.max.storage.size";
 const char *Configure::nifi_flowfile_repository_max_storage_time = "nifi.flowfile.repository.max.storage.time";
 const char *Configure::nifi_flowfile_repository_directory_default = "nifi.flowfile.repository.directory.default";
+const char *Configure::nifi_flowfile_repository_sync_writes = "nifi.flowfile.repository.sync.writes";
+const char *Configure::nifi_flowfile_repository_max_deltas = "nifi.flowfile.repository.max.deltas";
 const char *Configure::nifi_dbcontent_repository_directory_default = "nifi.database.content.repository.directory.default";
+const char *Configure::nifi_content_repository_slab_segment_size = "nifi.content.repository.slab.segment.size";
+const char *Configure::nifi_content_repository_slab_max_claim_size = "nifi.content.repository.slab.max.claim.size";
 const char *Configure::nifi_remote_input_secure = "nifi.remote.input.secure";
 const char *Configure::nifi_remote_input_http = "nifi.remote.input.http.enabled";
 const char *Configure::nifi_security_need_ClientAuth = "nifi.security.need.ClientAuth";
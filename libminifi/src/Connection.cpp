@@ -28,6 +28,7 @@
 #include <chrono>
 #include <thread>
 #include <iostream>
+#include <utility>
 #include "core/FlowFile.h"
 #include "Connection.h"
 #include "core/Processor.h"
@@ -108,14 +109,10 @@ Connection::Connection(const std::shared_ptr<core::Repository> &flow_repository,
 }
 
 bool Connection::isEmpty() {
-  std::lock_guard<std::mutex> lock(mutex_);
-
   return queue_.empty();
 }
 
 bool Connection::isFull() {
-  std::lock_guard<std::mutex> lock(mutex_);
-
   if (max_queue_size_ <= 0 && max_data_queue_size_ <= 0)
     // No back pressure setting
     return false;
@@ -130,15 +127,13 @@ bool Connection::isFull() {
 }
 
 void Connection::put(std::shared_ptr<core::FlowFile> flow) {
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-
-    queue_.push(flow);
+  queued_data_size_ += flow->getSize();
+  flow->setLastQueueDate(getTimeMillis());
+  connection_metrics_.recordEnqueue(1, flow->getSize());
 
-    queued_data_size_ += flow->getSize();
+  queue_.push(flow);
 
-    logger_->log_debug("Enqueue flow file UUID %s to connection %s", flow->getUUIDStr(), name_);
-  }
+  LOG_DEBUG_F(logger_, "Enqueue flow file UUID %s to connection %s", flow->getUUIDStr(), name_);
 
   if (!flow->isStored()) {
     // Save to the flowfile repo
@@ -150,71 +145,143 @@ void Connection::put(std::shared_ptr<core::FlowFile> flow) {
 
   // Notify receiving processor that work may be available
   if (dest_connectable_) {
-    logger_->log_debug("Notifying %s that %s was inserted", dest_connectable_->getName(), flow->getUUIDStr());
+    LOG_DEBUG_F(logger_, "Notifying %s that %s was inserted", dest_connectable_->getName(), flow->getUUIDStr());
     dest_connectable_->notifyWork();
   }
 }
 
-std::shared_ptr<core::FlowFile> Connection::poll(std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
-  std::lock_guard<std::mutex> lock(mutex_);
+void Connection::serializeFlowFiles(const std::shared_ptr<core::Repository> &flow_repository, const std::shared_ptr<core::ContentRepository> &content_repo,
+                                    const std::vector<std::shared_ptr<core::FlowFile>> &flows, const std::string &connection_uuid, FlowFileBatch &batch) {
+  for (const auto &flow : flows) {
+    if (flow->isStored()) {
+      continue;
+    }
+    std::unique_ptr<io::DataStream> stream(new io::DataStream());
+    std::shared_ptr<core::FlowFile> record = flow;
+    FlowFileRecord event(flow_repository, content_repo, record, connection_uuid);
+    if (event.Serialize(*stream)) {
+      batch.data.emplace_back(flow->getUUIDStr(), std::move(stream));
+      batch.flow_files.push_back(flow);
+    }
+  }
+}
+
+bool Connection::storeFlowFiles(const std::shared_ptr<core::Repository> &flow_repository, FlowFileBatch &batch) {
+  if (batch.data.empty()) {
+    return true;
+  }
+  if (!flow_repository->MultiPut(batch.data)) {
+    return false;
+  }
+  for (const auto &flow : batch.flow_files) {
+    flow->setStoredToRepository(true);
+  }
+  return true;
+}
 
-  while (!queue_.empty()) {
-    std::shared_ptr<core::FlowFile> item = queue_.front();
-    queue_.pop();
+void Connection::multiPut(std::vector<std::shared_ptr<core::FlowFile>> &flows) {
+  FlowFileBatch batch;
+  serializeFlowFiles(flow_repository_, content_repo_, flows, this->uuidStr_, batch);
+  storeFlowFiles(flow_repository_, batch);
+
+  uint64_t now = getTimeMillis();
+  uint64_t bytes = 0;
+  for (auto &flow : flows) {
+    queued_data_size_ += flow->getSize();
+    bytes += flow->getSize();
+    flow->setLastQueueDate(now);
+    queue_.push(flow);
+    LOG_DEBUG_F(logger_, "Enqueue flow file UUID %s to connection %s", flow->getUUIDStr(), name_);
+  }
+  connection_metrics_.recordEnqueue(flows.size(), bytes);
+
+  // Notify receiving processor that work may be available
+  if (dest_connectable_ && !flows.empty()) {
+    logger_->log_debug("Notifying %s that %d flow files were inserted", dest_connectable_->getName(), flows.size());
+    dest_connectable_->notifyWork();
+  }
+}
+
+std::shared_ptr<core::FlowFile> Connection::poll(std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
+  std::shared_ptr<core::FlowFile> item;
+  // penalized flow files are kept aside by the queue, so they never stall the ones behind them
+  while (queue_.tryPop(item)) {
     queued_data_size_ -= item->getSize();
 
-    if (expired_duration_ > 0) {
-      // We need to check for flow expiration
-      if (getTimeMillis() > (item->getEntryDate() + expired_duration_)) {
+    if (expired_duration_ > 0 && getTimeMillis() > (item->getEntryDate() + expired_duration_)) {
+      // Flow record expired
+      expiredFlowRecords.insert(item);
+      LOG_DEBUG_F(logger_, "Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
+      if (flow_repository_->Delete(item->getUUIDStr())) {
+        item->setStoredToRepository(false);
+      }
+      continue;
+    }
+    std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
+    item->setOriginalConnection(connectable);
+    recordDequeue(item, getTimeMillis());
+    LOG_DEBUG_F(logger_, "Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
+    return item;
+  }
+
+  return NULL;
+}
+
+size_t Connection::poll(size_t max_count, uint64_t max_bytes, std::vector<std::shared_ptr<core::FlowFile>> &flows, std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
+  std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
+  std::vector<std::shared_ptr<core::FlowFile>> items;
+  size_t polled = 0;
+  uint64_t polled_bytes = 0;
+  // keep going while expired flow files leave room in the batch
+  while (polled < max_count && (max_bytes == 0 || polled_bytes < max_bytes)) {
+    items.clear();
+    if (queue_.tryPop(items, max_count - polled, max_bytes == 0 ? 0 : max_bytes - polled_bytes) == 0) {
+      break;
+    }
+
+    uint64_t now = getTimeMillis();
+    for (auto &item : items) {
+      queued_data_size_ -= item->getSize();
+
+      if (expired_duration_ > 0 && now > (item->getEntryDate() + expired_duration_)) {
         // Flow record expired
         expiredFlowRecords.insert(item);
-        logger_->log_debug("Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
+        LOG_DEBUG_F(logger_, "Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
         if (flow_repository_->Delete(item->getUUIDStr())) {
           item->setStoredToRepository(false);
         }
-      } else {
-        // Flow record not expired
-        if (item->isPenalized()) {
-          // Flow record was penalized
-          queue_.push(item);
-          queued_data_size_ += item->getSize();
-          break;
-        }
-        std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
-        item->setOriginalConnection(connectable);
-        logger_->log_debug("Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
-        return item;
-      }
-    } else {
-      // Flow record not expired
-      if (item->isPenalized()) {
-        // Flow record was penalized
-        queue_.push(item);
-        queued_data_size_ += item->getSize();
-        break;
+        continue;
       }
-      std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
       item->setOriginalConnection(connectable);
-      logger_->log_debug("Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
-      return item;
+      recordDequeue(item, now);
+      polled_bytes += item->getSize();
+      flows.push_back(std::move(item));
+      ++polled;
     }
   }
+  if (polled > 0) {
+    logger_->log_debug("Dequeue %llu flow files from connection %s", polled, name_);
+  }
 
-  return NULL;
+  return polled;
+}
+
+void Connection::recordDequeue(const std::shared_ptr<core::FlowFile> &flow, uint64_t now) {
+  uint64_t queued = flow->getLastQueueDate();
+  connection_metrics_.recordDequeue(flow->getSize(), now > queued ? now - queued : 0);
 }
 
 void Connection::drain() {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::shared_ptr<core::FlowFile>> items;
+  queue_.drain(items);
 
-  while (!queue_.empty()) {
-    std::shared_ptr<core::FlowFile> item = queue_.front();
-    queue_.pop();
-    logger_->log_debug("Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
+  for (const auto &item : items) {
+    LOG_DEBUG_F(logger_, "Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
     if (flow_repository_->Delete(item->getUUIDStr())) {
       item->setStoredToRepository(false);
     }
+    queued_data_size_ -= item->getSize();
   }
-  queued_data_size_ = 0;
   logger_->log_debug("Drain connection %s", name_);
 }
 
@@ -45,6 +45,14 @@ uint64_t EventDrivenSchedulingAgent::run(const std::shared_ptr<core::Processor>
       return this->bored_yield_duration_;
     }
 
+    if (isParkingEnabled()) {
+      // rather than blocking a pool thread, return and let the worker be parked until work arrives
+      if (!processor->isWorkAvailable()) {
+        return 1000;
+      }
+      continue;
+    }
+
     // Block until work is available
 
     processor->waitForWork(1000);
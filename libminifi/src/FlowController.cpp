@@ -38,6 +38,7 @@
 #include "core/state/nodes/FlowInformation.h"
 #include "core/state/nodes/ProcessMetrics.h"
 #include "core/state/nodes/QueueMetrics.h"
+#include "core/state/nodes/StatisticsNodes.h"
 #include "core/state/nodes/RepositoryMetrics.h"
 #include "core/state/nodes/SystemMetrics.h"
 #include "core/state/ProcessorController.h"
@@ -469,13 +470,24 @@ void FlowController::initializeC2() {
 
   if (root_ != nullptr) {
     std::shared_ptr<state::response::QueueMetrics> queueMetrics = std::make_shared<state::response::QueueMetrics>();
+    std::shared_ptr<state::response::ConnectionStatistics> connectionStatistics = std::make_shared<state::response::ConnectionStatistics>();
 
     std::map<std::string, std::shared_ptr<Connection>> connections;
     root_->getConnections(connections);
     for (auto con : connections) {
       queueMetrics->addConnection(con.second);
+      connectionStatistics->addConnection(con.second);
     }
     device_information_[queueMetrics->getName()] = queueMetrics;
+    device_information_[connectionStatistics->getName()] = connectionStatistics;
+
+    std::shared_ptr<state::response::ProcessorStatistics> processorStatistics = std::make_shared<state::response::ProcessorStatistics>();
+    std::vector<std::shared_ptr<core::Processor>> all_processors;
+    root_->getAllProcessors(all_processors);
+    for (const auto &processor : all_processors) {
+      processorStatistics->addProcessor(processor);
+    }
+    device_information_[processorStatistics->getName()] = processorStatistics;
 
     std::shared_ptr<state::response::RepositoryMetrics> repoMetrics = std::make_shared<state::response::RepositoryMetrics>();
 
@@ -634,8 +646,12 @@ void FlowController::loadC2ResponseConfiguration(const std::string &prefix) {
 
               if (nullptr == ptr) {
                 auto metric = component_metrics_.find(clazz);
+                auto device_metric = device_information_.find(clazz);
                 if (metric != component_metrics_.end()) {
                   ptr = metric->second;
+                } else if (device_metric != device_information_.end()) {
+                  // flow wide metrics such as the queue and processor statistics
+                  ptr = device_metric->second;
                 } else {
                   logger_->log_error("No metric defined for %s", clazz);
                   continue;
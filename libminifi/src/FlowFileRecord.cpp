@@ -20,16 +20,19 @@
 #include "FlowFileRecord.h"
 #include <time.h>
 #include <cstdio>
+#include <cstring>
 #include <vector>
 #include <queue>
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <iostream>
 #include <fstream>
 #include "core/logging/LoggerConfiguration.h"
 #include "core/Relationship.h"
 #include "core/Repository.h"
+#include "io/CompactEncoding.h"
 
 namespace org {
 namespace apache {
@@ -51,7 +54,6 @@ FlowFileRecord::FlowFileRecord(std::shared_ptr<core::Repository> flow_repository
   // Populate the default attributes
   addKeyedAttribute(FILENAME, std::to_string(getTimeNano()));
   addKeyedAttribute(PATH, DEFAULT_FLOWFILE_PATH);
-  addKeyedAttribute(UUID, getUUIDStr());
   // Populate the attributes from the input
   std::map<std::string, std::string>::iterator it;
   for (it = attributes.begin(); it != attributes.end(); it++) {
@@ -77,7 +79,7 @@ FlowFileRecord::FlowFileRecord(std::shared_ptr<core::Repository> flow_repository
   lineage_start_date_ = event->getlineageStartDate();
   lineage_Identifiers_ = event->getlineageIdentifiers();
   uuidStr_ = event->getUUIDStr();
-  attributes_ = event->getAttributes();
+  inheritAttributes(*event);
   size_ = event->getSize();
   offset_ = event->getOffset();
   event->getUUID(uuid_);
@@ -133,11 +135,10 @@ FlowFileRecord::~FlowFileRecord() {
 void FlowFileRecord::releaseClaim(std::shared_ptr<ResourceClaim> claim) {
   // Decrease the flow file record owned count for the resource claim
   claim_->decreaseFlowFileRecordOwnedCount();
-  std::string value;
   logger_->log_debug("Delete Resource Claim %s, %s, attempt %llu", getUUIDStr(), claim_->getContentFullPath(), claim_->getFlowFileRecordOwnedCount());
   if (claim_->getFlowFileRecordOwnedCount() <= 0) {
     // we cannot rely on the stored variable here since we aren't guaranteed atomicity
-    if (flow_repository_ != nullptr && !flow_repository_->Get(uuidStr_, value)) {
+    if (flow_repository_ != nullptr && !flow_repository_->Contains(uuidStr_)) {
       logger_->log_debug("Delete Resource Claim %s", claim_->getContentFullPath());
       content_repo_->remove(claim_);
     }
@@ -218,146 +219,325 @@ bool FlowFileRecord::DeSerialize(std::string key) {
 bool FlowFileRecord::Serialize() {
   io::DataStream outStream;
 
-  int ret;
-
-  ret = write(this->event_time_, &outStream);
-  if (ret != 8) {
+  if (!Serialize(outStream)) {
     return false;
   }
 
-  ret = write(this->entry_date_, &outStream);
-  if (ret != 8) {
+  if (flow_repository_->Put(uuidStr_, const_cast<uint8_t*>(outStream.getBuffer()), outStream.getSize())) {
+    logger_->log_debug("NiFi FlowFile Store event %s size %llu success", uuidStr_, outStream.getSize());
+    return true;
+  } else {
+    logger_->log_error("NiFi FlowFile Store event %s size %llu fail", uuidStr_, outStream.getSize());
     return false;
   }
+}
+
+namespace {
+/**
+ * Compact records start with a marker that a legacy record, which starts with the big endian
+ * event time in milliseconds, cannot start with, followed by the format version. The fields are
+ * written as varints, identifiers as 16 raw bytes, and attribute keys that appear in
+ * FlowAttributeKeyArray as their index into it.
+ */
+const uint8_t COMPACT_RECORD_MARKER = 0xFF;
+const uint8_t COMPACT_RECORD_VERSION = 1;
+
+// written before an identifier that is stored as its 16 bytes rather than as a string
+const uint8_t BINARY_IDENTIFIER = 1;
+const uint8_t STRING_IDENTIFIER = 0;
+const size_t IDENTIFIER_SIZE = 16;
+const size_t IDENTIFIER_STRING_LENGTH = 36;
+
+// attribute keys are written as their index into FlowAttributeKeyArray plus one, or as 0 followed by the key
+const uint64_t LITERAL_ATTRIBUTE_KEY = 0;
+
+int keyIndex(const std::string &key) {
+  for (int i = 0; i < MAX_FLOW_ATTRIBUTES; i++) {
+    if (key == FlowAttributeKeyArray[i]) {
+      return i;
+    }
+  }
+  return -1;
+}
 
-  ret = write(this->lineage_start_date_, &outStream);
-  if (ret != 8) {
+// only lower case identifiers are stored as bytes, since they are unparsed in lower case
+bool toBinaryIdentifier(const std::string &id, UUID_FIELD binary) {
+  if (id.length() != IDENTIFIER_STRING_LENGTH) {
     return false;
   }
+  for (const char c : id) {
+    if (c >= 'A' && c <= 'F') {
+      return false;
+    }
+  }
+  return uuid_parse(id.c_str(), binary) == 0;
+}
+
+size_t identifierSize(bool binary, const std::string &id) {
+  return 1 + (binary ? IDENTIFIER_SIZE : io::CompactWriter::stringSize(id));
+}
+
+void writeIdentifier(io::CompactWriter &writer, bool binary, const UUID_FIELD bytes, const std::string &id) {
+  if (binary) {
+    writer.writeByte(BINARY_IDENTIFIER);
+    writer.writeBytes(bytes, IDENTIFIER_SIZE);
+  } else {
+    writer.writeByte(STRING_IDENTIFIER);
+    writer.writeString(id);
+  }
+}
 
-  ret = writeUTF(this->uuidStr_, &outStream);
-  if (ret <= 0) {
+bool readIdentifier(io::CompactReader &reader, std::string &id) {
+  uint8_t kind;
+  if (!reader.readByte(kind)) {
+    return false;
+  }
+  if (kind == STRING_IDENTIFIER) {
+    return reader.readString(id);
+  }
+  UUID_FIELD bytes;
+  if (kind != BINARY_IDENTIFIER || !reader.readBytes(bytes, IDENTIFIER_SIZE)) {
     return false;
   }
+  char unparsed[IDENTIFIER_STRING_LENGTH + 1];
+  uuid_unparse_lower(bytes, unparsed);
+  id.assign(unparsed, IDENTIFIER_STRING_LENGTH);
+  return true;
+}
+
+bool writeCompact(io::DataStream &outStream, uint64_t event_time, uint64_t entry_date, uint64_t lineage_start_date, const std::string &uuid_str, const std::string &uuid_connection,
+                  const std::map<std::string, std::string> &attributes, const std::string &content_path, uint64_t content_size, uint64_t offset) {
+  UUID_FIELD uuid;
+  UUID_FIELD connection;
+  const bool binary_uuid = toBinaryIdentifier(uuid_str, uuid);
+  const bool binary_connection = toBinaryIdentifier(uuid_connection, connection);
+
+  // size the record first so that it is written into the stream in place
+  size_t size = 2;
+  size += io::CompactWriter::varintSize(event_time);
+  size += io::CompactWriter::varintSize(entry_date);
+  size += io::CompactWriter::varintSize(lineage_start_date);
+  size += identifierSize(binary_uuid, uuid_str);
+  size += identifierSize(binary_connection, uuid_connection);
+  size += io::CompactWriter::varintSize(attributes.size());
+  for (const auto &attribute : attributes) {
+    const int index = keyIndex(attribute.first);
+    size += index >= 0 ? io::CompactWriter::varintSize(index + 1) : 1 + io::CompactWriter::stringSize(attribute.first);
+    size += io::CompactWriter::stringSize(attribute.second);
+  }
+  size += io::CompactWriter::stringSize(content_path);
+  size += io::CompactWriter::varintSize(content_size);
+  size += io::CompactWriter::varintSize(offset);
+
+  io::CompactWriter writer(outStream.extend(size), size);
+  writer.writeByte(COMPACT_RECORD_MARKER);
+  writer.writeByte(COMPACT_RECORD_VERSION);
+  writer.writeVarint(event_time);
+  writer.writeVarint(entry_date);
+  writer.writeVarint(lineage_start_date);
+  writeIdentifier(writer, binary_uuid, uuid, uuid_str);
+  writeIdentifier(writer, binary_connection, connection, uuid_connection);
+  writer.writeVarint(attributes.size());
+  for (const auto &attribute : attributes) {
+    const int index = keyIndex(attribute.first);
+    if (index >= 0) {
+      writer.writeVarint(index + 1);
+    } else {
+      writer.writeVarint(LITERAL_ATTRIBUTE_KEY);
+      writer.writeString(attribute.first);
+    }
+    writer.writeString(attribute.second);
+  }
+  writer.writeString(content_path);
+  writer.writeVarint(content_size);
+  writer.writeVarint(offset);
+  return writer.complete();
+}
 
-  ret = writeUTF(this->uuid_connection_, &outStream);
-  if (ret <= 0) {
+bool decodeCompact(const uint8_t *buffer, const int bufferSize, FlowFileRecordFields &fields) {
+  io::CompactReader reader(buffer, bufferSize);
+  uint8_t marker;
+  uint8_t version;
+  if (!reader.readByte(marker) || !reader.readByte(version) || version != COMPACT_RECORD_VERSION) {
     return false;
   }
-  // write flow attributes
-  uint32_t numAttributes = this->attributes_.size();
-  ret = write(numAttributes, &outStream);
-  if (ret != 4) {
+  uint64_t numAttributes;
+  if (!reader.readVarint(fields.event_time) || !reader.readVarint(fields.entry_date) || !reader.readVarint(fields.lineage_start_date) || !readIdentifier(reader, fields.uuid)
+      || !readIdentifier(reader, fields.connection) || !reader.readVarint(numAttributes)) {
     return false;
   }
 
-  for (auto itAttribute : attributes_) {
-    ret = writeUTF(itAttribute.first, &outStream, true);
-    if (ret <= 0) {
+  for (uint64_t i = 0; i < numAttributes; i++) {
+    uint64_t index;
+    std::string key;
+    if (!reader.readVarint(index)) {
+      return false;
+    }
+    if (index == LITERAL_ATTRIBUTE_KEY) {
+      if (!reader.readString(key)) {
+        return false;
+      }
+    } else if (index <= MAX_FLOW_ATTRIBUTES) {
+      key = FlowAttributeKeyArray[index - 1];
+    } else {
       return false;
     }
-    ret = writeUTF(itAttribute.second, &outStream, true);
-    if (ret <= 0) {
+    if (!reader.readString(fields.attributes[key])) {
       return false;
     }
   }
 
-  ret = writeUTF(this->content_full_fath_, &outStream);
-  if (ret <= 0) {
-    return false;
-  }
+  return reader.readString(fields.content_path) && reader.readVarint(fields.size) && reader.readVarint(fields.offset);
+}
 
-  ret = write(this->size_, &outStream);
-  if (ret != 8) {
+// points id at an identifier stored as a string, or unparses a binary one into buffer
+bool viewIdentifier(io::CompactReader &reader, FlowFileRecordView::String &id, char *buffer) {
+  uint8_t kind;
+  if (!reader.readByte(kind)) {
     return false;
   }
-
-  ret = write(this->offset_, &outStream);
-  if (ret != 8) {
-    return false;
+  if (kind == STRING_IDENTIFIER) {
+    return reader.readString(id.data, id.length);
   }
-
-  if (flow_repository_->Put(uuidStr_, const_cast<uint8_t*>(outStream.getBuffer()), outStream.getSize())) {
-    logger_->log_debug("NiFi FlowFile Store event %s size %llu success", uuidStr_, outStream.getSize());
-    return true;
-  } else {
-    logger_->log_error("NiFi FlowFile Store event %s size %llu fail", uuidStr_, outStream.getSize());
+  UUID_FIELD bytes;
+  if (kind != BINARY_IDENTIFIER || !reader.readBytes(bytes, IDENTIFIER_SIZE)) {
     return false;
   }
-
+  uuid_unparse_lower(bytes, buffer);
+  id.data = buffer;
+  id.length = IDENTIFIER_STRING_LENGTH;
   return true;
 }
 
-bool FlowFileRecord::DeSerialize(const uint8_t *buffer, const int bufferSize) {
-  int ret;
-
-  io::DataStream outStream(buffer, bufferSize);
-
-  ret = read(this->event_time_, &outStream);
-  if (ret != 8) {
+bool viewCompact(const uint8_t *buffer, const int bufferSize, FlowFileRecordView &view) {
+  io::CompactReader reader(buffer, bufferSize);
+  uint8_t marker;
+  uint8_t version;
+  if (!reader.readByte(marker) || marker != COMPACT_RECORD_MARKER || !reader.readByte(version) || version != COMPACT_RECORD_VERSION) {
     return false;
   }
-
-  ret = read(this->entry_date_, &outStream);
-  if (ret != 8) {
+  FlowFileRecordView::String uuid;
+  char uuid_buffer[IDENTIFIER_STRING_LENGTH + 1];
+  uint64_t numAttributes;
+  if (!reader.readVarint(view.event_time) || !reader.readVarint(view.entry_date) || !reader.readVarint(view.lineage_start_date) || !viewIdentifier(reader, uuid, uuid_buffer)
+      || !viewIdentifier(reader, view.connection, view.connection_buffer) || !reader.readVarint(numAttributes) || numAttributes > reader.remaining()) {
     return false;
   }
 
-  ret = read(this->lineage_start_date_, &outStream);
-  if (ret != 8) {
-    return false;
+  view.attributes.resize(numAttributes);
+  for (auto &attribute : view.attributes) {
+    uint64_t index;
+    if (!reader.readVarint(index)) {
+      return false;
+    }
+    if (index == LITERAL_ATTRIBUTE_KEY) {
+      if (!reader.readString(attribute.first.data, attribute.first.length)) {
+        return false;
+      }
+    } else if (index <= MAX_FLOW_ATTRIBUTES) {
+      attribute.first.data = FlowAttributeKeyArray[index - 1];
+      attribute.first.length = strlen(attribute.first.data);
+    } else {
+      return false;
+    }
+    if (!reader.readString(attribute.second.data, attribute.second.length)) {
+      return false;
+    }
   }
 
-  ret = readUTF(this->uuidStr_, &outStream);
-  if (ret <= 0) {
+  return reader.readString(view.content_path.data, view.content_path.length) && reader.readVarint(view.size) && reader.readVarint(view.offset);
+}
+
+// reads records written before the compact format was introduced
+bool decodeLegacy(const uint8_t *buffer, const int bufferSize, FlowFileRecordFields &fields) {
+  io::Serializable serializable;
+  io::DataStream stream(buffer, bufferSize);
+
+  if (serializable.read(fields.event_time, &stream) != 8 || serializable.read(fields.entry_date, &stream) != 8 || serializable.read(fields.lineage_start_date, &stream) != 8) {
     return false;
   }
 
-  ret = readUTF(this->uuid_connection_, &outStream);
-  if (ret <= 0) {
+  if (serializable.readUTF(fields.uuid, &stream) <= 0 || serializable.readUTF(fields.connection, &stream) <= 0) {
     return false;
   }
 
   // read flow attributes
   uint32_t numAttributes = 0;
-  ret = read(numAttributes, &outStream);
-  if (ret != 4) {
+  if (serializable.read(numAttributes, &stream) != 4) {
     return false;
   }
 
   for (uint32_t i = 0; i < numAttributes; i++) {
     std::string key;
-    ret = readUTF(key, &outStream, true);
-    if (ret <= 0) {
+    if (serializable.readUTF(key, &stream, true) <= 0) {
       return false;
     }
     std::string value;
-    ret = readUTF(value, &outStream, true);
-    if (ret <= 0) {
+    if (serializable.readUTF(value, &stream, true) <= 0) {
       return false;
     }
-    this->attributes_[key] = value;
+    fields.attributes[key] = value;
   }
 
-  ret = readUTF(this->content_full_fath_, &outStream);
-  if (ret <= 0) {
+  if (serializable.readUTF(fields.content_path, &stream) <= 0) {
     return false;
   }
 
-  ret = read(this->size_, &outStream);
-  if (ret != 8) {
-    return false;
+  return serializable.read(fields.size, &stream) == 8 && serializable.read(fields.offset, &stream) == 8;
+}
+}  // namespace
+
+bool FlowFileRecord::Serialize(io::DataStream &outStream) {
+  return writeCompact(outStream, event_time_, entry_date_, lineage_start_date_, uuidStr_, uuid_connection_, *attributes_, content_full_fath_, size_, offset_);
+}
+
+bool FlowFileRecord::Serialize(const FlowFileRecordFields &fields, io::DataStream &outStream) {
+  return writeCompact(outStream, fields.event_time, fields.entry_date, fields.lineage_start_date, fields.uuid, fields.connection, fields.attributes, fields.content_path, fields.size,
+                      fields.offset);
+}
+
+bool FlowFileRecord::DeSerialize(const uint8_t *buffer, const int bufferSize, FlowFileRecordFields &fields) {
+  if (bufferSize > 0 && buffer[0] == COMPACT_RECORD_MARKER) {
+    return decodeCompact(buffer, bufferSize, fields);
   }
+  return decodeLegacy(buffer, bufferSize, fields);
+}
 
-  ret = read(this->offset_, &outStream);
-  if (ret != 8) {
+bool FlowFileRecord::View(const uint8_t *buffer, const int bufferSize, FlowFileRecordView &view) {
+  return viewCompact(buffer, bufferSize, view);
+}
+
+bool FlowFileRecord::DeSerialize(const uint8_t *buffer, const int bufferSize) {
+  FlowFileRecordFields fields;
+  if (!DeSerialize(buffer, bufferSize, fields)) {
     return false;
   }
+  DeSerialize(fields);
+  return true;
+}
+
+void FlowFileRecord::DeSerialize(FlowFileRecordFields &fields) {
+  event_time_ = fields.event_time;
+  entry_date_ = fields.entry_date;
+  lineage_start_date_ = fields.lineage_start_date;
+  uuidStr_ = std::move(fields.uuid);
+  uuid_ = uuidStr_;
+  uuid_connection_ = std::move(fields.connection);
+  std::map<std::string, std::string> &attributes = mutableAttributes();
+  for (auto &attribute : fields.attributes) {
+    // records written before the identifier was implied still carry it
+    if (attribute.first == FlowAttributeKey(UUID) && attribute.second == uuidStr_) {
+      continue;
+    }
+    attributes[attribute.first] = std::move(attribute.second);
+  }
+  content_full_fath_ = std::move(fields.content_path);
+  size_ = fields.size;
+  offset_ = fields.offset;
 
   if (nullptr == claim_) {
     claim_ = std::make_shared<ResourceClaim>(content_full_fath_, content_repo_, true);
   }
-  return true;
 }
 
 } /* namespace minifi */
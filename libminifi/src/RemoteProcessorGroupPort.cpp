@@ -71,18 +71,17 @@ std::unique_ptr<sitetosite::SiteToSiteClient> RemoteProcessorGroupPort::getNextP
           sitetosite::SiteToSiteClientConfiguration config(stream_factory_, std::make_shared<sitetosite::Peer>(protocol_uuid_, rpg.host_, rpg.port_, ssl_service != nullptr), this->getInterface(),
                                                            client_type_);
           config.setHTTPProxy(this->proxy_);
+          config.setUseCompression(use_compression_);
           nextProtocol = sitetosite::createClient(config);
         }
       } else if (peer_index_ >= 0) {
         std::lock_guard<std::mutex> lock(peer_mutex_);
+        peer_index_ = peer_selector_.next();
         logger_->log_debug("Creating client from peer %ll", peer_index_.load());
         sitetosite::SiteToSiteClientConfiguration config(stream_factory_, peers_[this->peer_index_].getPeer(), local_network_interface_, client_type_);
         config.setSecurityContext(ssl_service);
-        peer_index_++;
-        if (peer_index_ >= static_cast<int>(peers_.size())) {
-          peer_index_ = 0;
-        }
         config.setHTTPProxy(this->proxy_);
+        config.setUseCompression(use_compression_);
         nextProtocol = sitetosite::createClient(config);
       } else {
         logger_->log_debug("Refreshing the peer list since there are none configured.");
@@ -186,14 +185,12 @@ void RemoteProcessorGroupPort::onSchedule(const std::shared_ptr<core::ProcessCon
       count = max_concurrent_tasks_;
     for (uint32_t i = 0; i < count; i++) {
       std::unique_ptr<sitetosite::SiteToSiteClient> nextProtocol = nullptr;
+      peer_index_ = peer_selector_.next();
       sitetosite::SiteToSiteClientConfiguration config(stream_factory_, peers_[this->peer_index_].getPeer(), this->getInterface(), client_type_);
       config.setSecurityContext(ssl_service);
-      peer_index_++;
-      if (peer_index_ >= static_cast<int>(peers_.size())) {
-        peer_index_ = 0;
-      }
       logger_->log_trace("Creating client");
       config.setHTTPProxy(this->proxy_);
+      config.setUseCompression(use_compression_);
       nextProtocol = sitetosite::createClient(config);
       logger_->log_trace("Created client, moving into available protocols");
       returnProtocol(std::move(nextProtocol));
@@ -379,9 +376,12 @@ void RemoteProcessorGroupPort::refreshPeerList() {
     protocol->getPeerList(peers_);
 
   logging::LOG_INFO(logger_) << "Have " << peers_.size() << " peers";
+  for (const auto &peer : peers_) {
+    logger_->log_debug("Peer %s:%d has %u flow files", peer.getPeer()->getHost(), peer.getPeer()->getPort(), peer.getFlowFileCount());
+  }
+  peer_selector_.update(peers_);
 
-  if (peers_.size() > 0)
-    peer_index_ = 0;
+  peer_index_ = peers_.empty() ? -1 : 0;
 }
 
 } /* namespace minifi */
@@ -105,6 +105,7 @@ bool SchedulingAgent::onTrigger(const std::shared_ptr<core::Processor> &processo
   }
 
   processor->incrementActiveTasks();
+  const auto start = std::chrono::steady_clock::now();
   try {
     processor->onTrigger(processContext, sessionFactory);
     processor->decrementActiveTask();
@@ -121,6 +122,7 @@ bool SchedulingAgent::onTrigger(const std::shared_ptr<core::Processor> &processo
     processor->yield(admin_yield_duration_);
     processor->decrementActiveTask();
   }
+  processor->getProcessorMetrics().recordTrigger(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
 
   return false;
 }
@@ -77,6 +77,15 @@ void ThreadedSchedulingAgent::schedule(std::shared_ptr<core::Processor> processo
   std::vector<std::thread *> threads;
 
   ThreadedSchedulingAgent *agent = this;
+  // processors that only act on incoming flow files are parked while their connections are empty
+  bool park_when_idle = isParkingEnabled() && processor->hasIncomingConnections() && !processor->getTriggerWhenEmpty()
+      && (processor->getSchedulingStrategy() == core::TIMER_DRIVEN || processor->getSchedulingStrategy() == core::EVENT_DRIVEN);
+  if (park_when_idle) {
+    std::string identifier = processor->getUUIDStr();
+    processor->setWorkListener([agent, identifier]() {
+      agent->thread_pool_.wake(identifier);
+    });
+  }
   for (int i = 0; i < processor->getMaxConcurrentTasks(); i++) {
     // reference the disable function from serviceNode
     processor->incrementActiveTasks();
@@ -86,7 +95,8 @@ void ThreadedSchedulingAgent::schedule(std::shared_ptr<core::Processor> processo
     };
 
     // create a functor that will be submitted to the thread pool.
-    std::unique_ptr<TimerAwareMonitor> monitor = std::unique_ptr<TimerAwareMonitor>(new TimerAwareMonitor(&running_));
+    std::unique_ptr<TimerAwareMonitor> monitor = std::unique_ptr<TimerAwareMonitor>(
+        park_when_idle ? new IdleParkingMonitor(&running_, processor) : new TimerAwareMonitor(&running_));
     utils::Worker<uint64_t> functor(f_ex, processor->getUUIDStr(), std::move(monitor));
     // move the functor into the thread pool. While a future is returned
     // we aren't terribly concerned with the result.
@@ -112,6 +122,7 @@ void ThreadedSchedulingAgent::unschedule(std::shared_ptr<core::Processor> proces
   }
 
   thread_pool_.stopTasks(processor->getUUIDStr());
+  processor->setWorkListener(nullptr);
 
   processor->clearActiveTask();
 
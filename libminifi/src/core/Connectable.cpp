@@ -34,6 +34,7 @@ Connectable::Connectable(const std::string &name, const utils::Identifier &uuid)
     : CoreComponent(name, uuid),
       max_concurrent_tasks_(1),
       connectable_version_(nullptr),
+      work_listener_armed_(false),
       logger_(logging::LoggerFactory<Connectable>::getLogger()) {
 }
 
@@ -41,6 +42,7 @@ Connectable::Connectable(const std::string &name)
     : CoreComponent(name),
       max_concurrent_tasks_(1),
       connectable_version_(nullptr),
+      work_listener_armed_(false),
       logger_(logging::LoggerFactory<Connectable>::getLogger()) {
 }
 
@@ -48,6 +50,7 @@ Connectable::Connectable(const Connectable &&other)
     : CoreComponent(std::move(other)),
       max_concurrent_tasks_(std::move(other.max_concurrent_tasks_)),
       connectable_version_(std::move(other.connectable_version_)),
+      work_listener_armed_(false),
       logger_(std::move(other.logger_)) {
   has_work_ = other.has_work_.load();
   strategy_ = other.strategy_.load();
@@ -138,7 +141,14 @@ void Connectable::waitForWork(uint64_t timeoutMs) {
 }
 
 void Connectable::notifyWork() {
-  // Do nothing if we are not event-driven
+  if (work_listener_armed_ && work_listener_armed_.exchange(false)) {
+    std::lock_guard<std::mutex> lock(work_listener_mutex_);
+    if (work_listener_) {
+      work_listener_();
+    }
+  }
+
+  // Do nothing else if we are not event-driven
   if (strategy_ != EVENT_DRIVEN) {
     return;
   }
@@ -152,6 +162,14 @@ void Connectable::notifyWork() {
   }
 }
 
+void Connectable::setWorkListener(std::function<void()> listener) {
+  std::lock_guard<std::mutex> lock(work_listener_mutex_);
+  work_listener_ = std::move(listener);
+  if (work_listener_ == nullptr) {
+    work_listener_armed_ = false;
+  }
+}
+
 std::set<std::shared_ptr<Connectable>> Connectable::getOutGoingConnections(const std::string &relationship) const {
   std::set<std::shared_ptr<Connectable>> empty;
 
@@ -17,10 +17,13 @@
  */
 
 #include "core/FlowFile.h"
+#include <atomic>
+#include <map>
 #include <memory>
 #include <string>
 #include <set>
 #include "core/logging/LoggerConfiguration.h"
+#include "FlowFileRecord.h"
 #include "utils/Id.h"
 
 namespace org {
@@ -41,6 +44,7 @@ FlowFile::FlowFile()
       last_queue_date_(0),
       penaltyExpiration_ms_(0),
       event_time_(0),
+      attributes_(std::make_shared<std::map<std::string, std::string>>()),
       claim_(nullptr),
       marked_delete_(false),
       connection_(nullptr),
@@ -146,10 +150,13 @@ std::set<std::string> &FlowFile::getlineageIdentifiers() {
 }
 
 bool FlowFile::getAttribute(std::string key, std::string &value) {
-  auto it = attributes_.find(key);
-  if (it != attributes_.end()) {
+  auto it = attributes_->find(key);
+  if (it != attributes_->end()) {
     value = it->second;
     return true;
+  } else if (key == FlowAttributeKey(UUID)) {
+    value = uuidStr_;
+    return true;
   } else {
     return false;
   }
@@ -165,9 +172,9 @@ uint64_t FlowFile::getOffset() {
 }
 
 bool FlowFile::removeAttribute(const std::string key) {
-  auto it = attributes_.find(key);
-  if (it != attributes_.end()) {
-    attributes_.erase(key);
+  auto it = attributes_->find(key);
+  if (it != attributes_->end()) {
+    mutableAttributes().erase(key);
     return true;
   } else {
     return false;
@@ -175,9 +182,9 @@ bool FlowFile::removeAttribute(const std::string key) {
 }
 
 bool FlowFile::updateAttribute(const std::string key, const std::string value) {
-  auto it = attributes_.find(key);
-  if (it != attributes_.end()) {
-    attributes_[key] = value;
+  auto it = attributes_->find(key);
+  if (it != attributes_->end() || key == FlowAttributeKey(UUID)) {
+    setAttribute(key, value);
     return true;
   } else {
     return false;
@@ -185,20 +192,74 @@ bool FlowFile::updateAttribute(const std::string key, const std::string value) {
 }
 
 bool FlowFile::addAttribute(const std::string &key, const std::string &value) {
-  auto it = attributes_.find(key);
-  if (it != attributes_.end()) {
+  auto it = attributes_->find(key);
+  if (it != attributes_->end() || key == FlowAttributeKey(UUID)) {
     // attribute already there in the map
     return false;
   } else {
-    attributes_[key] = value;
+    mutableAttributes()[key] = value;
     return true;
   }
 }
 
+void FlowFile::setAttribute(const std::string &key, const std::string &value) {
+  if (key == FlowAttributeKey(UUID) && value == uuidStr_) {
+    // the identifier is implied
+    removeAttribute(key);
+    return;
+  }
+  mutableAttributes()[key] = value;
+}
+
+std::map<std::string, std::string> FlowFile::getAttributes() {
+  std::map<std::string, std::string> attributes = *attributes_;
+  attributes.insert(std::make_pair(FlowAttributeKey(UUID), uuidStr_));
+  return attributes;
+}
+
+std::map<std::string, std::string> *FlowFile::getAttributesPtr() {
+  // the caller may modify the map directly, so it cannot stay shared
+  std::map<std::string, std::string> &attributes = mutableAttributes();
+  attributes.insert(std::make_pair(FlowAttributeKey(UUID), uuidStr_));
+  return &attributes;
+}
+
+void FlowFile::inheritAttributes(const FlowFile &parent) {
+  std::shared_ptr<std::map<std::string, std::string>> inherited = parent.attributes_;
+  for (const auto &attribute : *attributes_) {
+    if (inherited->find(attribute.first) == inherited->end()) {
+      if (inherited == parent.attributes_) {
+        inherited = std::make_shared<std::map<std::string, std::string>>(*parent.attributes_);
+      }
+      inherited->insert(attribute);
+    }
+  }
+  attributes_ = inherited;
+}
+
+std::map<std::string, std::string> &FlowFile::mutableAttributes() {
+  if (attributes_.use_count() > 1) {
+    attributes_ = std::make_shared<std::map<std::string, std::string>>(*attributes_);
+  } else {
+    // use_count() is a relaxed load; the fence pairs with the release of the last other owner,
+    // so its reads of the map are complete before this flow file writes to it
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  return *attributes_;
+}
+
 void FlowFile::setLineageStartDate(const uint64_t date) {
   lineage_start_date_ = date;
 }
 
+uint64_t FlowFile::getLastQueueDate() {
+  return last_queue_date_;
+}
+
+void FlowFile::setLastQueueDate(const uint64_t date) {
+  last_queue_date_ = date;
+}
+
 /**
  * Sets the original connection with a shared pointer.
  * @param connection shared connection.
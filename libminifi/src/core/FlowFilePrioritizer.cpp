@@ -0,0 +1,84 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "core/FlowFilePrioritizer.h"
+#include <cstdlib>
+#include <cerrno>
+#include <memory>
+#include <string>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+const char *PriorityAttributePrioritizer::PRIORITY_ATTRIBUTE = "priority";
+
+namespace {
+
+bool toPriority(const std::string &value, long long &priority) {  // NOLINT
+  if (value.empty()) {
+    return false;
+  }
+  char *end = nullptr;
+  errno = 0;
+  priority = std::strtoll(value.c_str(), &end, 10);
+  return errno == 0 && end != nullptr && *end == '\0';
+}
+
+}  // namespace
+
+bool PriorityAttributePrioritizer::isHigherPriority(const std::shared_ptr<core::FlowFile> &lhs, const std::shared_ptr<core::FlowFile> &rhs) {
+  std::string lhs_value, rhs_value;
+  bool lhs_set = lhs->getAttribute(PRIORITY_ATTRIBUTE, lhs_value);
+  bool rhs_set = rhs->getAttribute(PRIORITY_ATTRIBUTE, rhs_value);
+  if (!lhs_set || !rhs_set) {
+    return lhs_set && !rhs_set;
+  }
+  long long lhs_priority = 0, rhs_priority = 0;  // NOLINT
+  bool lhs_numeric = toPriority(lhs_value, lhs_priority);
+  bool rhs_numeric = toPriority(rhs_value, rhs_priority);
+  if (lhs_numeric && rhs_numeric) {
+    return lhs_priority < rhs_priority;
+  } else if (lhs_numeric != rhs_numeric) {
+    return lhs_numeric;
+  }
+  return lhs_value < rhs_value;
+}
+
+std::shared_ptr<FlowFilePrioritizer> FlowFilePrioritizer::create(const std::string &name) {
+  std::string class_name = name;
+  auto separator = class_name.find_last_of('.');
+  if (separator != std::string::npos) {
+    class_name = class_name.substr(separator + 1);
+  }
+  if (class_name == "OldestFlowFileFirstPrioritizer") {
+    return std::make_shared<OldestFlowFileFirstPrioritizer>();
+  } else if (class_name == "NewestFlowFileFirstPrioritizer") {
+    return std::make_shared<NewestFlowFileFirstPrioritizer>();
+  } else if (class_name == "PriorityAttributePrioritizer") {
+    return std::make_shared<PriorityAttributePrioritizer>();
+  }
+  return nullptr;
+}
+
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
@@ -0,0 +1,236 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "core/FlowFileQueue.h"
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "utils/TimeUtil.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+namespace {
+
+bool expiresLater(const std::shared_ptr<FlowFile> &lhs, const std::shared_ptr<FlowFile> &rhs) {
+  return lhs->getPenaltyExpiration() > rhs->getPenaltyExpiration();
+}
+
+}  // namespace
+
+FlowFileQueue::FlowFileQueue()
+    : prioritizer_(nullptr),
+      sequence_(0),
+      next_penalty_expiration_(std::numeric_limits<uint64_t>::max()),
+      size_(0),
+      penalized_size_(0) {
+}
+
+void FlowFileQueue::setPrioritizer(const std::shared_ptr<FlowFilePrioritizer> &prioritizer) {
+  std::vector<std::shared_ptr<FlowFile>> active;
+  std::shared_ptr<FlowFile> flow;
+  while (popActive(flow)) {
+    active.push_back(flow);
+  }
+  prioritizer_ = prioritizer;
+  for (const auto &item : active) {
+    pushActive(item);
+  }
+}
+
+void FlowFileQueue::push(const std::shared_ptr<FlowFile> &flow) {
+  ++size_;
+  if (flow->isPenalized()) {
+    pushPenalized(flow);
+  } else {
+    pushActive(flow);
+  }
+}
+
+bool FlowFileQueue::tryPop(std::shared_ptr<FlowFile> &flow) {
+  uint64_t now = getTimeMillis();
+  if (next_penalty_expiration_ <= now) {
+    releaseExpiredPenalties(now);
+  }
+  std::shared_ptr<FlowFile> item;
+  while (popActive(item)) {
+    if (item->isPenalized()) {
+      // penalized after it was queued; park it so it does not block the flow files behind it
+      pushPenalized(item);
+      continue;
+    }
+    --size_;
+    flow = item;
+    return true;
+  }
+  return false;
+}
+
+size_t FlowFileQueue::tryPop(std::vector<std::shared_ptr<FlowFile>> &flows, size_t max_count, uint64_t max_bytes) {
+  uint64_t now = getTimeMillis();
+  if (next_penalty_expiration_ <= now) {
+    releaseExpiredPenalties(now);
+  }
+  size_t popped = 0;
+  uint64_t bytes = 0;
+  std::vector<std::shared_ptr<FlowFile>> batch;
+  while (popped < max_count && (max_bytes == 0 || bytes < max_bytes)) {
+    batch.clear();
+    if (popActive(batch, max_count - popped, max_bytes == 0 ? 0 : max_bytes - bytes) == 0) {
+      break;
+    }
+    for (auto &item : batch) {
+      if (item->isPenalized()) {
+        pushPenalized(item);
+        continue;
+      }
+      bytes += item->getSize();
+      flows.push_back(std::move(item));
+      ++popped;
+    }
+  }
+  size_ -= popped;
+  return popped;
+}
+
+void FlowFileQueue::drain(std::vector<std::shared_ptr<FlowFile>> &flows) {
+  uint64_t drained = 0;
+  std::shared_ptr<FlowFile> flow;
+  while (popActive(flow)) {
+    flows.push_back(flow);
+    ++drained;
+  }
+  {
+    std::lock_guard<std::mutex> lock(penalty_mutex_);
+    drained += penalized_.size();
+    penalized_size_ -= penalized_.size();
+    flows.insert(flows.end(), penalized_.begin(), penalized_.end());
+    penalized_.clear();
+    next_penalty_expiration_ = std::numeric_limits<uint64_t>::max();
+  }
+  size_ -= drained;
+}
+
+bool FlowFileQueue::isWorkAvailable() const {
+  return size_ > penalized_size_ || next_penalty_expiration_ <= getTimeMillis();
+}
+
+void FlowFileQueue::pushActive(const std::shared_ptr<FlowFile> &flow) {
+  if (nullptr == prioritizer_) {
+    queue_.enqueue(flow);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(prioritized_mutex_);
+  prioritized_.push_back(PrioritizedEntry { flow, sequence_++ });
+  std::push_heap(prioritized_.begin(), prioritized_.end(), [this](const PrioritizedEntry &lhs, const PrioritizedEntry &rhs) {
+    return isLowerPriority(lhs, rhs);
+  });
+}
+
+bool FlowFileQueue::popActive(std::shared_ptr<FlowFile> &flow) {
+  if (nullptr == prioritizer_) {
+    return queue_.try_dequeue(flow);
+  }
+  std::lock_guard<std::mutex> lock(prioritized_mutex_);
+  if (prioritized_.empty()) {
+    return false;
+  }
+  std::pop_heap(prioritized_.begin(), prioritized_.end(), [this](const PrioritizedEntry &lhs, const PrioritizedEntry &rhs) {
+    return isLowerPriority(lhs, rhs);
+  });
+  flow = std::move(prioritized_.back().flow);
+  prioritized_.pop_back();
+  return true;
+}
+
+size_t FlowFileQueue::popActive(std::vector<std::shared_ptr<FlowFile>> &flows, size_t max_count, uint64_t max_bytes) {
+  if (nullptr == prioritizer_) {
+    if (max_bytes == 0) {
+      size_t offset = flows.size();
+      flows.resize(offset + max_count);
+      size_t count = queue_.try_dequeue_bulk(flows.begin() + offset, max_count);
+      flows.resize(offset + count);
+      return count;
+    }
+    size_t count = 0;
+    uint64_t bytes = 0;
+    std::shared_ptr<FlowFile> flow;
+    while (count < max_count && bytes < max_bytes && queue_.try_dequeue(flow)) {
+      bytes += flow->getSize();
+      flows.push_back(std::move(flow));
+      ++count;
+    }
+    return count;
+  }
+  std::lock_guard<std::mutex> lock(prioritized_mutex_);
+  size_t count = 0;
+  uint64_t bytes = 0;
+  while (count < max_count && (max_bytes == 0 || bytes < max_bytes) && !prioritized_.empty()) {
+    std::pop_heap(prioritized_.begin(), prioritized_.end(), [this](const PrioritizedEntry &lhs, const PrioritizedEntry &rhs) {
+      return isLowerPriority(lhs, rhs);
+    });
+    bytes += prioritized_.back().flow->getSize();
+    flows.push_back(std::move(prioritized_.back().flow));
+    prioritized_.pop_back();
+    ++count;
+  }
+  return count;
+}
+
+void FlowFileQueue::pushPenalized(const std::shared_ptr<FlowFile> &flow) {
+  std::lock_guard<std::mutex> lock(penalty_mutex_);
+  penalized_.push_back(flow);
+  std::push_heap(penalized_.begin(), penalized_.end(), expiresLater);
+  ++penalized_size_;
+  next_penalty_expiration_ = penalized_.front()->getPenaltyExpiration();
+}
+
+void FlowFileQueue::releaseExpiredPenalties(uint64_t now) {
+  std::vector<std::shared_ptr<FlowFile>> released;
+  {
+    std::lock_guard<std::mutex> lock(penalty_mutex_);
+    while (!penalized_.empty() && penalized_.front()->getPenaltyExpiration() <= now) {
+      std::pop_heap(penalized_.begin(), penalized_.end(), expiresLater);
+      released.push_back(std::move(penalized_.back()));
+      penalized_.pop_back();
+    }
+    penalized_size_ -= released.size();
+    next_penalty_expiration_ = penalized_.empty() ? std::numeric_limits<uint64_t>::max() : penalized_.front()->getPenaltyExpiration();
+  }
+  for (const auto &flow : released) {
+    pushActive(flow);
+  }
+}
+
+bool FlowFileQueue::isLowerPriority(const PrioritizedEntry &lhs, const PrioritizedEntry &rhs) const {
+  if (prioritizer_->isHigherPriority(rhs.flow, lhs.flow)) {
+    return true;
+  } else if (prioritizer_->isHigherPriority(lhs.flow, rhs.flow)) {
+    return false;
+  }
+  return lhs.sequence > rhs.sequence;
+}
+
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
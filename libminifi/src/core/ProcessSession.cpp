@@ -20,8 +20,11 @@
 #include "core/ProcessSession.h"
 #include <time.h>
 #include <uuid/uuid.h>
+#include <algorithm>
 #include <chrono>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <queue>
@@ -29,8 +32,11 @@
 #include <string>
 #include <thread>
 #include <vector>
+#include <mio/mmap.hpp>
 #include "core/ProcessSessionReadCallback.h"
+#include "core/Processor.h"
 #include "io/BaseMemoryMap.h"
+#include "io/StreamSlice.h"
 /* This implementation is only for native Windows systems.  */
 #if (defined _WIN32 || defined __WIN32__) && !defined __CYGWIN__
 #define _WINSOCKAPI_
@@ -59,6 +65,43 @@ namespace core {
 
 std::shared_ptr<utils::IdGenerator> ProcessSession::id_generator_ = utils::IdGenerator::getIdGenerator();
 
+namespace {
+
+/**
+ * Writes the content of a flow file followed by the content of the callback, so that appending
+ * to a slice or to a claim shared with other flow files goes to a claim of its own.
+ */
+class CopyAndAppendCallback : public OutputStreamCallback {
+ public:
+  CopyAndAppendCallback(std::shared_ptr<io::BaseStream> content, OutputStreamCallback *append)
+      : content_(std::move(content)),
+        append_(append) {
+  }
+
+  int64_t process(std::shared_ptr<io::BaseStream> stream) {
+    uint8_t buffer[4096];
+    int64_t size = 0;
+    int read;
+    while ((read = content_->readData(buffer, sizeof(buffer))) > 0) {
+      if (stream->writeData(buffer, read) != read) {
+        return -1;
+      }
+      size += read;
+    }
+    if (read < 0) {
+      return -1;
+    }
+    int64_t appended = append_->process(stream);
+    return appended < 0 ? appended : size + appended;
+  }
+
+ private:
+  std::shared_ptr<io::BaseStream> content_;
+  OutputStreamCallback *append_;
+};
+
+}  // namespace
+
 ProcessSession::~ProcessSession() { removeReferences(); }
 
 std::shared_ptr<core::FlowFile> ProcessSession::create() {
@@ -75,8 +118,8 @@ std::shared_ptr<core::FlowFile> ProcessSession::create() {
     record->setAttribute(attr, flow_version->getFlowId());
   }
 
-  _addedFlowFiles[record->getUUIDStr()] = record;
-  logger_->log_debug("Create FlowFile with UUID %s", record->getUUIDStr());
+  _addedFlowFiles[record->getUUID()] = record;
+  LOG_DEBUG_F(logger_, "Create FlowFile with UUID %s", record->getUUIDStr());
   std::stringstream details;
   details << process_context_->getProcessorNode()->getName() << " creates flow record " << record->getUUIDStr();
   provenance_report_->create(record, details.str());
@@ -84,7 +127,7 @@ std::shared_ptr<core::FlowFile> ProcessSession::create() {
   return record;
 }
 
-void ProcessSession::add(const std::shared_ptr<core::FlowFile> &record) { _addedFlowFiles[record->getUUIDStr()] = record; }
+void ProcessSession::add(const std::shared_ptr<core::FlowFile> &record) { _addedFlowFiles[record->getUUID()] = record; }
 
 std::shared_ptr<core::FlowFile> ProcessSession::create(const std::shared_ptr<core::FlowFile> &parent) {
   std::map<std::string, std::string> empty;
@@ -98,20 +141,17 @@ std::shared_ptr<core::FlowFile> ProcessSession::create(const std::shared_ptr<cor
       std::string attr = FlowAttributeKey(FLOW_ID);
       record->setAttribute(attr, flow_version->getFlowId());
     }
-    _addedFlowFiles[record->getUUIDStr()] = record;
-    logger_->log_debug("Create FlowFile with UUID %s", record->getUUIDStr());
+    _addedFlowFiles[record->getUUID()] = record;
+    LOG_DEBUG_F(logger_, "Create FlowFile with UUID %s", record->getUUIDStr());
   }
 
   if (record) {
-    // Copy attributes
-    std::map<std::string, std::string> parentAttributes = parent->getAttributes();
-    std::map<std::string, std::string>::iterator it;
-    for (it = parentAttributes.begin(); it != parentAttributes.end(); it++) {
-      if (it->first == FlowAttributeKey(ALTERNATE_IDENTIFIER) || it->first == FlowAttributeKey(DISCARD_REASON) || it->first == FlowAttributeKey(UUID))
-        // Do not copy special attributes from parent
-        continue;
-      record->setAttribute(it->first, it->second);
-    }
+    // Copy attributes, sharing the map of the parent
+    record->inheritAttributes(*parent);
+    // Do not copy special attributes from parent
+    record->removeAttribute(FlowAttributeKey(ALTERNATE_IDENTIFIER));
+    record->removeAttribute(FlowAttributeKey(DISCARD_REASON));
+    record->removeAttribute(FlowAttributeKey(UUID));
     record->setLineageStartDate(parent->getlineageStartDate());
     record->setLineageIdentifiers(parent->getlineageIdentifiers());
     parent->getlineageIdentifiers().insert(parent->getUUIDStr());
@@ -122,7 +162,7 @@ std::shared_ptr<core::FlowFile> ProcessSession::create(const std::shared_ptr<cor
 std::shared_ptr<core::FlowFile> ProcessSession::clone(const std::shared_ptr<core::FlowFile> &parent) {
   std::shared_ptr<core::FlowFile> record = this->create(parent);
   if (record) {
-    logger_->log_debug("Cloned parent flow files %s to %s", parent->getUUIDStr(), record->getUUIDStr());
+    LOG_DEBUG_F(logger_, "Cloned parent flow files %s to %s", parent->getUUIDStr(), record->getUUIDStr());
     // Copy Resource Claim
     std::shared_ptr<ResourceClaim> parent_claim = parent->getResourceClaim();
     record->setResourceClaim(parent_claim);
@@ -148,17 +188,14 @@ std::shared_ptr<core::FlowFile> ProcessSession::cloneDuringTransfer(std::shared_
       std::string attr = FlowAttributeKey(FLOW_ID);
       record->setAttribute(attr, flow_version->getFlowId());
     }
-    this->_clonedFlowFiles[record->getUUIDStr()] = record;
-    logger_->log_debug("Clone FlowFile with UUID %s during transfer", record->getUUIDStr());
-    // Copy attributes
-    std::map<std::string, std::string> parentAttributes = parent->getAttributes();
-    std::map<std::string, std::string>::iterator it;
-    for (it = parentAttributes.begin(); it != parentAttributes.end(); it++) {
-      if (it->first == FlowAttributeKey(ALTERNATE_IDENTIFIER) || it->first == FlowAttributeKey(DISCARD_REASON) || it->first == FlowAttributeKey(UUID))
-        // Do not copy special attributes from parent
-        continue;
-      record->setAttribute(it->first, it->second);
-    }
+    this->_clonedFlowFiles[record->getUUID()] = record;
+    LOG_DEBUG_F(logger_, "Clone FlowFile with UUID %s during transfer", record->getUUIDStr());
+    // Copy attributes, sharing the map of the parent
+    record->inheritAttributes(*parent);
+    // Do not copy special attributes from parent
+    record->removeAttribute(FlowAttributeKey(ALTERNATE_IDENTIFIER));
+    record->removeAttribute(FlowAttributeKey(DISCARD_REASON));
+    record->removeAttribute(FlowAttributeKey(UUID));
     record->setLineageStartDate(parent->getlineageStartDate());
 
     record->setLineageIdentifiers(parent->getlineageIdentifiers());
@@ -181,14 +218,14 @@ std::shared_ptr<core::FlowFile> ProcessSession::cloneDuringTransfer(std::shared_
 std::shared_ptr<core::FlowFile> ProcessSession::clone(const std::shared_ptr<core::FlowFile> &parent, int64_t offset, int64_t size) {
   std::shared_ptr<core::FlowFile> record = this->create(parent);
   if (record) {
-    logger_->log_debug("Cloned parent flow files %s to %s, with %u:%u", parent->getUUIDStr(), record->getUUIDStr(), offset, size);
+    LOG_DEBUG_F(logger_, "Cloned parent flow files %s to %s, with %u:%u", parent->getUUIDStr(), record->getUUIDStr(), offset, size);
     if (parent->getResourceClaim()) {
       if ((uint64_t)(offset + size) > parent->getSize()) {
         // Set offset and size
         logger_->log_error("clone offset %ll and size %ll exceed parent size %llu", offset, size, parent->getSize());
         // Remove the Add FlowFile for the session
-        std::map<std::string, std::shared_ptr<core::FlowFile>>::iterator it = this->_addedFlowFiles.find(record->getUUIDStr());
-        if (it != this->_addedFlowFiles.end()) this->_addedFlowFiles.erase(record->getUUIDStr());
+        auto it = this->_addedFlowFiles.find(record->getUUID());
+        if (it != this->_addedFlowFiles.end()) this->_addedFlowFiles.erase(record->getUUID());
         return nullptr;
       }
       record->setOffset(parent->getOffset() + offset);
@@ -209,13 +246,13 @@ void ProcessSession::remove(const std::shared_ptr<core::FlowFile> &flow) {
   flow->setDeleted(true);
   if (flow->getResourceClaim() != nullptr) {
     flow->getResourceClaim()->decreaseFlowFileRecordOwnedCount();
-    logger_->log_debug("Auto terminated %s %llu %s", flow->getResourceClaim()->getContentFullPath(),
-                       flow->getResourceClaim()->getFlowFileRecordOwnedCount(), flow->getUUIDStr());
+    LOG_DEBUG_F(logger_, "Auto terminated %s %llu %s", flow->getResourceClaim()->getContentFullPath(),
+                         flow->getResourceClaim()->getFlowFileRecordOwnedCount(), flow->getUUIDStr());
   } else {
     logger_->log_debug("Flow does not contain content. no resource claim to decrement.");
   }
   process_context_->getFlowFileRepository()->Delete(flow->getUUIDStr());
-  _deletedFlowFiles[flow->getUUIDStr()] = flow;
+  _deletedFlowFiles[flow->getUUID()] = flow;
   std::string reason = process_context_->getProcessorNode()->getName() + " drop flow record " + flow->getUUIDStr();
   provenance_report_->drop(flow, reason);
 }
@@ -244,7 +281,7 @@ void ProcessSession::penalize(const std::shared_ptr<core::FlowFile> &flow) {
 void ProcessSession::transfer(const std::shared_ptr<core::FlowFile> &flow, Relationship relationship) {
   logging::LOG_INFO(logger_) << "Transferring " << flow->getUUIDStr() << " from " << process_context_->getProcessorNode()->getName()
                              << " to relationship " << relationship.getName();
-  _transferRelationship[flow->getUUIDStr()] = relationship;
+  _transferRelationship[flow->getUUID()] = relationship;
 }
 
 void ProcessSession::write(const std::shared_ptr<core::FlowFile> &flow, OutputStreamCallback *callback) {
@@ -360,10 +397,29 @@ void ProcessSession::append(const std::shared_ptr<core::FlowFile> &flow, OutputS
 
   try {
     uint64_t startTime = getTimeMillis();
-    std::shared_ptr<io::BaseStream> stream = process_context_->getContentRepository()->write(claim, true);
-    if (nullptr == stream) {
-      rollback();
-      return;
+    bool shared = claim->getFlowFileRecordOwnedCount() > 1 || flow->getOffset() > 0;
+    std::shared_ptr<io::BaseStream> stream = nullptr;
+    if (!shared) {
+      stream = process_context_->getContentRepository()->write(claim, true);
+      if (nullptr == stream) {
+        rollback();
+        return;
+      }
+      // the claim holds more than this flow file, e.g. the records of a delimited import
+      shared = stream->getSize() != flow->getSize();
+    }
+    if (shared) {
+      // appending in place would change the content of the other flow files of the claim
+      if (stream != nullptr) {
+        stream->closeStream();
+      }
+      std::shared_ptr<io::BaseStream> content = process_context_->getContentRepository()->read(claim);
+      if (nullptr == content) {
+        rollback();
+        return;
+      }
+      CopyAndAppendCallback copy(std::make_shared<io::StreamSlice>(content, flow->getOffset(), flow->getSize()), callback);
+      return write(flow, &copy);
     }
     // Call the callback to write the content
 
@@ -396,7 +452,7 @@ void ProcessSession::read(const std::shared_ptr<core::FlowFile> &flow, InputStre
 
     if (flow->getResourceClaim() == nullptr) {
       // No existed claim for read, we throw exception
-      logger_->log_debug("For %s, no resource claim but size is %d", flow->getUUIDStr(), flow->getSize());
+      LOG_DEBUG_F(logger_, "For %s, no resource claim but size is %d", flow->getUUIDStr(), flow->getSize());
       if (flow->getSize() == 0) {
         return;
       }
@@ -412,7 +468,12 @@ void ProcessSession::read(const std::shared_ptr<core::FlowFile> &flow, InputStre
       return;
     }
 
-    stream->seek(flow->getOffset());
+    if (flow->getOffset() > 0 || flow->getSize() < stream->getSize()) {
+      // the flow file references a part of a shared claim
+      stream = std::make_shared<io::StreamSlice>(stream, flow->getOffset(), flow->getSize());
+    } else {
+      stream->seek(flow->getOffset());
+    }
 
     if (callback->process(stream) < 0) {
       rollback();
@@ -476,7 +537,7 @@ void ProcessSession::importFrom(io::DataStream &stream, const std::shared_ptr<co
     }
     flow->setResourceClaim(claim);
 
-    logger_->log_debug("Import offset %llu length %llu into content %s for FlowFile UUID %s", flow->getOffset(), flow->getSize(),
+    LOG_DEBUG_F(logger_, "Import offset %llu length %llu into content %s for FlowFile UUID %s", flow->getOffset(), flow->getSize(),
                        flow->getResourceClaim()->getContentFullPath(), flow->getUUIDStr());
 
     content_stream->closeStream();
@@ -511,42 +572,59 @@ void ProcessSession::import(std::string source, const std::shared_ptr<core::Flow
     std::ifstream input;
     input.open(source.c_str(), std::fstream::in | std::fstream::binary);
     claim->increaseFlowFileRecordOwnedCount();
-    std::shared_ptr<io::BaseStream> stream = process_context_->getContentRepository()->write(claim);
-    if (nullptr == stream) {
-      claim->decreaseFlowFileRecordOwnedCount();
-      rollback();
-      return;
-    }
     if (input.is_open() && input.good()) {
       bool invalidWrite = false;
-      // Open the source file and stream to the flow file
-      if (offset != 0) {
-        input.seekg(offset);
-        if (!input.good()) {
-          logger_->log_error(
-              "Seeking to %d failed for file %s (does file/filesystem support "
-              "seeking?)",
-              offset, source);
-          invalidWrite = true;
-        }
+      uint64_t importSize = 0;
+      input.seekg(0, input.end);
+      std::streamoff sourceSize = input.tellg();
+      // sources that cannot seek, such as pipes, are streamed below
+      input.clear();
+      if (sourceSize >= 0) {
+        input.seekg(0, input.beg);
       }
-      while (input.good()) {
-        input.read(reinterpret_cast<char *>(charBuffer.data()), size);
-        if (input) {
-          if (stream->write(charBuffer.data(), size) < 0) {
+      // let the repository copy a regular file without passing it through a stream
+      bool imported = sourceSize >= 0 && offset <= static_cast<uint64_t>(sourceSize)
+          && process_context_->getContentRepository()->importFile(source, offset, sourceSize - offset, claim);
+      if (imported) {
+        importSize = sourceSize - offset;
+      } else {
+        std::shared_ptr<io::BaseStream> stream = process_context_->getContentRepository()->write(claim);
+        if (nullptr == stream) {
+          claim->decreaseFlowFileRecordOwnedCount();
+          rollback();
+          return;
+        }
+        // Open the source file and stream to the flow file
+        if (offset != 0) {
+          input.seekg(offset);
+          if (!input.good()) {
+            logger_->log_error(
+                "Seeking to %d failed for file %s (does file/filesystem support "
+                "seeking?)",
+                offset, source);
             invalidWrite = true;
-            break;
           }
-        } else {
-          if (stream->write(reinterpret_cast<uint8_t *>(charBuffer.data()), input.gcount()) < 0) {
-            invalidWrite = true;
-            break;
+        }
+        while (input.good()) {
+          input.read(reinterpret_cast<char *>(charBuffer.data()), size);
+          if (input) {
+            if (stream->write(charBuffer.data(), size) < 0) {
+              invalidWrite = true;
+              break;
+            }
+          } else {
+            if (stream->write(reinterpret_cast<uint8_t *>(charBuffer.data()), input.gcount()) < 0) {
+              invalidWrite = true;
+              break;
+            }
           }
         }
+        importSize = stream->getSize();
+        stream->closeStream();
       }
 
       if (!invalidWrite) {
-        flow->setSize(stream->getSize());
+        flow->setSize(importSize);
         flow->setOffset(0);
         if (flow->getResourceClaim() != nullptr) {
           // Remove the old claim
@@ -560,7 +638,6 @@ void ProcessSession::import(std::string source, const std::shared_ptr<core::Flow
             "%s",
             flow->getOffset(), flow->getSize(), flow->getResourceClaim()->getContentFullPath(), flow->getUUIDStr());
 
-        stream->closeStream();
         input.close();
         if (!keepSource) std::remove(source.c_str());
         std::stringstream details;
@@ -568,7 +645,6 @@ void ProcessSession::import(std::string source, const std::shared_ptr<core::Flow
         auto endTime = getTimeMillis();
         provenance_report_->modifyContent(flow, details.str(), endTime - startTime);
       } else {
-        stream->closeStream();
         input.close();
         throw Exception(FILE_OPERATION_EXCEPTION, "File Import Error");
       }
@@ -594,102 +670,82 @@ void ProcessSession::import(std::string source, const std::shared_ptr<core::Flow
 
 void ProcessSession::import(const std::string& source, std::vector<std::shared_ptr<FlowFileRecord>> &flows, uint64_t offset, char inputDelimiter) {
   std::shared_ptr<ResourceClaim> claim;
-  std::shared_ptr<io::BaseStream> stream;
-  std::shared_ptr<FlowFileRecord> flowFile;
+  std::vector<std::shared_ptr<FlowFileRecord>> imported;
 
-  std::vector<uint8_t> buffer(getpagesize());
   try {
     try {
-      std::ifstream input;
       logger_->log_debug("Opening %s", source);
-      input.open(source.c_str(), std::fstream::in | std::fstream::binary);
+      std::ifstream input(source.c_str(), std::fstream::in | std::fstream::binary | std::fstream::ate);
       if (!input.is_open() || !input.good()) {
-        input.close();
         throw Exception(FILE_OPERATION_EXCEPTION, "File Import Error");
       }
-      if (offset != 0U) {
-        input.seekg(offset, input.beg);
-        if (!input.good()) {
-          logger_->log_error("Seeking to %lu failed for file %s (does file/filesystem support seeking?)", offset, source);
-          throw Exception(FILE_OPERATION_EXCEPTION, "File Import Error");
-        }
+      std::streamoff sourceSize = input.tellg();
+      input.close();
+      if (sourceSize < 0 || offset > static_cast<uint64_t>(sourceSize)) {
+        logger_->log_error("Seeking to %lu failed for file %s (does file/filesystem support seeking?)", offset, source);
+        throw Exception(FILE_OPERATION_EXCEPTION, "File Import Error");
+      }
+      if (offset == static_cast<uint64_t>(sourceSize)) {
+        logger_->log_trace("Finished reading input %s", source);
+        return;
       }
-      uint64_t startTime = 0U;
-      while (input.good()) {
-        input.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
-        std::streamsize read = input.gcount();
-        if (read < 0) {
-          throw Exception(FILE_OPERATION_EXCEPTION, "std::ifstream::gcount returned negative value");
-        }
-        if (read == 0) {
-          logger_->log_trace("Finished reading input %s", source);
-          break;
-        }
-        uint8_t* begin = buffer.data();
-        uint8_t* end = begin + read;
-        while (true) {
-          uint8_t* delimiterPos = std::find(begin, end, static_cast<uint8_t>(inputDelimiter));
-          int len = delimiterPos - begin;
-
-          /*
-           * We do not want to process the rest of the buffer after the last delimiter if
-           *  - we have reached EOF in the file (we would discard it anyway)
-           *  - there is nothing to process (the last character in the buffer is a delimiter)
-           */
-          if (delimiterPos == end && (input.eof() || len == 0)) {
-            break;
-          }
 
-          /* Create claim and stream if needed and append data */
-          if (claim == nullptr) {
-            startTime = getTimeMillis();
-            claim = std::make_shared<ResourceClaim>(process_context_->getContentRepository());
-          }
-          if (stream == nullptr) {
-            stream = process_context_->getContentRepository()->write(claim);
-          }
-          if (stream == nullptr) {
-            logger_->log_error("Stream is null");
-            rollback();
-            return;
-          }
-          if (stream->write(begin, len) != len) {
-            logger_->log_error("Error while writing");
-            stream->closeStream();
-            throw Exception(FILE_OPERATION_EXCEPTION, "File Export Error creating Flowfile");
-          }
+      /* Map the source rather than reading it, so that records are found without copying them */
+      std::error_code error;
+      mio::mmap_source mapped;
+      mapped.map(source, offset, sourceSize - offset, error);
+      if (error) {
+        logger_->log_error("Could not map %s: %s", source, error.message());
+        throw Exception(FILE_OPERATION_EXCEPTION, "File Import Error");
+      }
+      const char* begin = mapped.data();
+      const char* end = begin + mapped.size();
 
-          /* Create a FlowFile if we reached a delimiter */
-          if (delimiterPos == end) {
-            break;
-          }
-          flowFile = std::static_pointer_cast<FlowFileRecord>(create());
-          flowFile->setSize(stream->getSize());
-          flowFile->setOffset(0);
-          if (flowFile->getResourceClaim() != nullptr) {
-            /* Remove the old claim */
-            flowFile->getResourceClaim()->decreaseFlowFileRecordOwnedCount();
-            flowFile->clearResourceClaim();
-          }
-          flowFile->setResourceClaim(claim);
-          claim->increaseFlowFileRecordOwnedCount();
-          logger_->log_debug("Import offset %u length %u into content %s for FlowFile UUID %s", flowFile->getOffset(), flowFile->getSize(),
-                             flowFile->getResourceClaim()->getContentFullPath(), flowFile->getUUIDStr());
+      /* Anything after the last delimiter is an incomplete record, which is left in the source */
+      auto lastDelimiter = std::find(std::reverse_iterator<const char*>(end), std::reverse_iterator<const char*>(begin), inputDelimiter);
+      if (lastDelimiter == std::reverse_iterator<const char*>(begin)) {
+        logger_->log_trace("Finished reading input %s", source);
+        return;
+      }
+      uint64_t contentSize = lastDelimiter.base() - begin;
+
+      /* Store every complete record in one claim; each FlowFile references its slice of it */
+      uint64_t startTime = getTimeMillis();
+      claim = std::make_shared<ResourceClaim>(process_context_->getContentRepository());
+      if (!process_context_->getContentRepository()->importFile(source, offset, contentSize, claim)) {
+        std::shared_ptr<io::BaseStream> stream = process_context_->getContentRepository()->write(claim);
+        if (stream == nullptr) {
+          logger_->log_error("Stream is null");
+          rollback();
+          return;
+        }
+        if (stream->write(reinterpret_cast<uint8_t*>(const_cast<char*>(begin)), contentSize) != static_cast<int>(contentSize)) {
+          logger_->log_error("Error while writing");
           stream->closeStream();
-          std::string details = process_context_->getProcessorNode()->getName() + " modify flow record content " + flowFile->getUUIDStr();
-          uint64_t endTime = getTimeMillis();
-          provenance_report_->modifyContent(flowFile, details, endTime - startTime);
-          flows.push_back(flowFile);
-
-          /* Reset these to start processing the next FlowFile with a clean slate */
-          flowFile.reset();
-          stream.reset();
-          claim.reset();
-
-          /* Skip delimiter */
-          begin = delimiterPos + 1;
+          throw Exception(FILE_OPERATION_EXCEPTION, "File Export Error creating Flowfile");
         }
+        stream->closeStream();
       }
+
+      const char* recordEnd = begin + contentSize;
+      for (const char* record = begin; record < recordEnd;) {
+        const char* delimiterPos = std::find(record, recordEnd, inputDelimiter);
+        std::shared_ptr<FlowFileRecord> flowFile = std::static_pointer_cast<FlowFileRecord>(create());
+        flowFile->setSize(delimiterPos - record);
+        flowFile->setOffset(record - begin);
+        flowFile->setResourceClaim(claim);
+        claim->increaseFlowFileRecordOwnedCount();
+        imported.push_back(flowFile);
+        logger_->log_debug("Import offset %u length %u into content %s for FlowFile UUID %s", flowFile->getOffset(), flowFile->getSize(),
+                           flowFile->getResourceClaim()->getContentFullPath(), flowFile->getUUIDStr());
+        std::string details = process_context_->getProcessorNode()->getName() + " modify flow record content " + flowFile->getUUIDStr();
+        uint64_t endTime = getTimeMillis();
+        provenance_report_->modifyContent(flowFile, details, endTime - startTime);
+
+        /* Skip delimiter */
+        record = delimiterPos + 1;
+      }
+      flows.insert(flows.end(), imported.begin(), imported.end());
     } catch (std::exception &exception) {
       logger_->log_debug("Caught Exception %s", exception.what());
       throw;
@@ -698,9 +754,11 @@ void ProcessSession::import(const std::string& source, std::vector<std::shared_p
       throw;
     }
   } catch (...) {
-    if (flowFile != nullptr && claim != nullptr && flowFile->getResourceClaim() == claim) {
-      flowFile->getResourceClaim()->decreaseFlowFileRecordOwnedCount();
-      flowFile->clearResourceClaim();
+    for (const auto &flowFile : imported) {
+      if (flowFile->getResourceClaim() == claim) {
+        flowFile->getResourceClaim()->decreaseFlowFileRecordOwnedCount();
+        flowFile->clearResourceClaim();
+      }
     }
     throw;
   }
@@ -791,7 +849,7 @@ void ProcessSession::commit() {
     for (auto &&it : _updatedFlowFiles) {
       std::shared_ptr<core::FlowFile> record = it.second;
       if (record->isDeleted()) continue;
-      std::map<std::string, Relationship>::iterator itRelationship = this->_transferRelationship.find(record->getUUIDStr());
+      auto itRelationship = this->_transferRelationship.find(record->getUUID());
       if (itRelationship != _transferRelationship.end()) {
         Relationship relationship = itRelationship->second;
         // Find the relationship, we need to find the connections for that
@@ -837,7 +895,7 @@ void ProcessSession::commit() {
     for (const auto it : _addedFlowFiles) {
       std::shared_ptr<core::FlowFile> record = it.second;
       if (record->isDeleted()) continue;
-      std::map<std::string, Relationship>::iterator itRelationship = this->_transferRelationship.find(record->getUUIDStr());
+      auto itRelationship = this->_transferRelationship.find(record->getUUID());
       if (itRelationship != _transferRelationship.end()) {
         Relationship relationship = itRelationship->second;
         // Find the relationship, we need to find the connections for that
@@ -880,9 +938,9 @@ void ProcessSession::commit() {
       }
     }
 
-    std::shared_ptr<Connection> connection = nullptr;
     // Complete process the added and update flow files for the session, send
     // the flow file to its queue
+    std::map<std::shared_ptr<Connection>, std::vector<std::shared_ptr<FlowFile>>> connectionQueues;
     for (const auto &it : _updatedFlowFiles) {
       std::shared_ptr<core::FlowFile> record = it.second;
       logger_->log_trace("See %s in %s", record->getUUIDStr(), "_updatedFlowFiles");
@@ -890,8 +948,8 @@ void ProcessSession::commit() {
         continue;
       }
 
-      connection = std::static_pointer_cast<Connection>(record->getConnection());
-      if ((connection) != nullptr) connection->put(record);
+      std::shared_ptr<Connection> connection = std::static_pointer_cast<Connection>(record->getConnection());
+      if ((connection) != nullptr) connectionQueues[connection].push_back(record);
     }
     for (const auto &it : _addedFlowFiles) {
       std::shared_ptr<core::FlowFile> record = it.second;
@@ -899,8 +957,8 @@ void ProcessSession::commit() {
       if (record->isDeleted()) {
         continue;
       }
-      connection = std::static_pointer_cast<Connection>(record->getConnection());
-      if ((connection) != nullptr) connection->put(record);
+      std::shared_ptr<Connection> connection = std::static_pointer_cast<Connection>(record->getConnection());
+      if ((connection) != nullptr) connectionQueues[connection].push_back(record);
     }
     // Process the clone flow files
     for (const auto &it : _clonedFlowFiles) {
@@ -909,8 +967,31 @@ void ProcessSession::commit() {
       if (record->isDeleted()) {
         continue;
       }
-      connection = std::static_pointer_cast<Connection>(record->getConnection());
-      if ((connection) != nullptr) connection->put(record);
+      std::shared_ptr<Connection> connection = std::static_pointer_cast<Connection>(record->getConnection());
+      if ((connection) != nullptr) connectionQueues[connection].push_back(record);
+    }
+
+    // persist everything this session enqueues with one repository write
+    persistFlowFiles(connectionQueues);
+
+    uint64_t flow_files_out = 0;
+    uint64_t bytes_out = 0;
+    for (auto &queue : connectionQueues) {
+      for (const auto &record : queue.second) {
+        bytes_out += record->getSize();
+      }
+      flow_files_out += queue.second.size();
+      queue.first->multiPut(queue.second);
+    }
+
+    auto processor = std::dynamic_pointer_cast<Processor>(process_context_->getProcessorNode()->getProcessor());
+    if (processor != nullptr) {
+      uint64_t bytes_in = 0;
+      for (const auto &it : _originalFlowFiles) {
+        bytes_in += it.second->getSize();
+      }
+      processor->getProcessorMetrics().recordIncoming(_originalFlowFiles.size(), bytes_in);
+      processor->getProcessorMetrics().recordOutgoing(flow_files_out, bytes_out);
     }
 
     // All done
@@ -975,32 +1056,9 @@ std::shared_ptr<core::FlowFile> ProcessSession::get() {
   do {
     std::set<std::shared_ptr<core::FlowFile>> expired;
     std::shared_ptr<core::FlowFile> ret = current->poll(expired);
-    if (expired.size() > 0) {
-      // Remove expired flow record
-      for (std::set<std::shared_ptr<core::FlowFile>>::iterator it = expired.begin(); it != expired.end(); ++it) {
-        std::shared_ptr<core::FlowFile> record = *it;
-        std::stringstream details;
-        details << process_context_->getProcessorNode()->getName() << " expire flow record " << record->getUUIDStr();
-        provenance_report_->expire(record, details.str());
-      }
-    }
+    expire(expired);
     if (ret) {
-      // add the flow record to the current process session update map
-      ret->setDeleted(false);
-      _updatedFlowFiles[ret->getUUIDStr()] = ret;
-      std::map<std::string, std::string> empty;
-      std::shared_ptr<core::FlowFile> snapshot =
-          std::make_shared<FlowFileRecord>(process_context_->getFlowFileRepository(), process_context_->getContentRepository(), empty);
-      auto flow_version = process_context_->getProcessorNode()->getFlowIdentifier();
-      if (flow_version != nullptr) {
-        auto flow_id = flow_version->getFlowId();
-        std::string attr = FlowAttributeKey(FLOW_ID);
-        snapshot->setAttribute(attr, flow_version->getFlowId());
-      }
-      logger_->log_debug("Create Snapshot FlowFile with UUID %s", snapshot->getUUIDStr());
-      snapshot = ret;
-      // save a snapshot
-      _originalFlowFiles[snapshot->getUUIDStr()] = snapshot;
+      track(ret);
       return ret;
     }
     current = std::static_pointer_cast<Connection>(process_context_->getProcessorNode()->getNextIncomingConnection());
@@ -1009,6 +1067,76 @@ std::shared_ptr<core::FlowFile> ProcessSession::get() {
   return NULL;
 }
 
+std::vector<std::shared_ptr<core::FlowFile>> ProcessSession::get(size_t max_count, uint64_t max_bytes) {
+  std::vector<std::shared_ptr<core::FlowFile>> flows;
+  std::shared_ptr<Connectable> first = process_context_->getProcessorNode()->getNextIncomingConnection();
+
+  if (first == NULL || max_count == 0) {
+    logger_->log_trace("Get is null for %s", process_context_->getProcessorNode()->getName());
+    return flows;
+  }
+
+  flows.reserve(max_count);
+  std::shared_ptr<Connection> current = std::static_pointer_cast<Connection>(first);
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  uint64_t bytes = 0;
+
+  do {
+    size_t offset = flows.size();
+    current->poll(max_count - offset, max_bytes == 0 ? 0 : max_bytes - bytes, flows, expired);
+    for (size_t i = offset; i < flows.size(); i++) {
+      bytes += flows[i]->getSize();
+      track(flows[i]);
+    }
+    if (flows.size() >= max_count || (max_bytes > 0 && bytes >= max_bytes)) {
+      break;
+    }
+    current = std::static_pointer_cast<Connection>(process_context_->getProcessorNode()->getNextIncomingConnection());
+  } while (current != NULL && current != first);
+
+  expire(expired);
+
+  return flows;
+}
+
+void ProcessSession::persistFlowFiles(const std::map<std::shared_ptr<Connection>, std::vector<std::shared_ptr<FlowFile>>> &connectionQueues) {
+  auto flowFileRepo = process_context_->getFlowFileRepository();
+  if (nullptr == flowFileRepo) {
+    return;
+  }
+  Connection::FlowFileBatch batch;
+  for (const auto &queue : connectionQueues) {
+    Connection::serializeFlowFiles(flowFileRepo, process_context_->getContentRepository(), queue.second, queue.first->getUUIDStr(), batch);
+  }
+  if (batch.data.empty()) {
+    return;
+  }
+  if (Connection::storeFlowFiles(flowFileRepo, batch)) {
+    logger_->log_debug("Stored %llu flow files for %s in one batch", batch.data.size(), process_context_->getProcessorNode()->getName());
+  } else {
+    // the connections will retry storing the flow files
+    logger_->log_warn("Could not store %llu flow files for %s in one batch", batch.data.size(), process_context_->getProcessorNode()->getName());
+  }
+}
+
+void ProcessSession::track(const std::shared_ptr<core::FlowFile> &flow) {
+  // add the flow record to the current process session update map
+  flow->setDeleted(false);
+  const utils::Identifier &uuid = flow->getUUID();
+  _updatedFlowFiles[uuid] = flow;
+  // the polled record itself serves as the snapshot for rollback
+  _originalFlowFiles[uuid] = flow;
+}
+
+void ProcessSession::expire(const std::set<std::shared_ptr<core::FlowFile>> &expired) {
+  // Remove expired flow records
+  for (const auto &record : expired) {
+    std::stringstream details;
+    details << process_context_->getProcessorNode()->getName() << " expire flow record " << record->getUUIDStr();
+    provenance_report_->expire(record, details.str());
+  }
+}
+
 } /* namespace core */
 } /* namespace minifi */
 } /* namespace nifi */
@@ -232,10 +232,14 @@ bool Processor::flowFilesOutGoingFull() {
 
 void Processor::onTrigger(ProcessContext *context, ProcessSessionFactory *sessionFactory) {
   auto session = sessionFactory->createSession();
+  const auto start = std::chrono::steady_clock::now();
 
   try {
-    // Call the virtual trigger function
-    onTrigger(context, session.get());
+    // Call the virtual trigger function. Within the run duration all triggers share the session
+    // so their work is committed at once.
+    do {
+      onTrigger(context, session.get());
+    } while (isWithinRunDuration(start));
     session->commit();
   } catch (std::exception &exception) {
     logger_->log_debug("Caught Exception %s", exception.what());
@@ -250,10 +254,14 @@ void Processor::onTrigger(ProcessContext *context, ProcessSessionFactory *sessio
 
 void Processor::onTrigger(const std::shared_ptr<ProcessContext> &context, const std::shared_ptr<ProcessSessionFactory> &sessionFactory) {
   auto session = sessionFactory->createSession();
+  const auto start = std::chrono::steady_clock::now();
 
   try {
-    // Call the virtual trigger function
-    onTrigger(context, session);
+    // Call the virtual trigger function. Within the run duration all triggers share the session
+    // so their work is committed at once.
+    do {
+      onTrigger(context, session);
+    } while (isWithinRunDuration(start));
     session->commit();
   } catch (std::exception &exception) {
     logger_->log_debug("Caught Exception %s", exception.what());
@@ -266,6 +274,20 @@ void Processor::onTrigger(const std::shared_ptr<ProcessContext> &context, const
   }
 }
 
+bool Processor::isWithinRunDuration(std::chrono::steady_clock::time_point start) {
+  const uint64_t run_duration = run_duration_nano_;
+  if (run_duration == 0 || !isRunning() || isYield()) {
+    return false;
+  }
+  if (static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()) >= run_duration) {
+    return false;
+  }
+  if (!getTriggerWhenEmpty() && hasIncomingConnections() && !flowFilesQueued()) {
+    return false;
+  }
+  return !flowFilesOutGoingFull();
+}
+
 bool Processor::isWorkAvailable() {
   // We have work if any incoming connection has work
   bool hasWork = false;
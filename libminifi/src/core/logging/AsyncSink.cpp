@@ -0,0 +1,142 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/logging/AsyncSink.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+namespace logging {
+
+namespace {
+// longest the writer sleeps before looking at the queue again
+const std::chrono::milliseconds IDLE_WAIT(10);
+
+const std::string ASYNC_SINK_NAME = "AsyncSink";
+}  // namespace
+
+AsyncSink::AsyncSink(const std::shared_ptr<spdlog::sinks::sink> &delegate, size_t queue_size, AsyncOverflowPolicy policy)
+    : delegate_(delegate),
+      policy_(policy),
+      queue_(roundUpToPowerOfTwo(queue_size)),
+      running_(true),
+      flush_requested_(false),
+      sleeping_(false),
+      dropped_(0),
+      dropped_total_(0) {
+  writer_ = std::thread(&AsyncSink::run, this);
+}
+
+AsyncSink::~AsyncSink() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  wake_.notify_one();
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+}
+
+size_t AsyncSink::roundUpToPowerOfTwo(size_t size) {
+  size_t result = 2;
+  while (result < size) {
+    result <<= 1;
+  }
+  return result;
+}
+
+void AsyncSink::log(const spdlog::details::log_msg &msg) {
+  Record record;
+  record.level = msg.level;
+  record.formatted.assign(msg.formatted.data(), msg.formatted.size());
+  while (!queue_.enqueue(std::move(record))) {
+    if (policy_ == AsyncOverflowPolicy::DROP) {
+      dropped_++;
+      dropped_total_++;
+      return;
+    }
+    if (sleeping_) {
+      wake_.notify_one();
+    }
+    std::this_thread::yield();
+  }
+  if (sleeping_) {
+    wake_.notify_one();
+  }
+}
+
+void AsyncSink::flush() {
+  // the writer flushes the delegate once it has drained the queue
+  flush_requested_ = true;
+}
+
+void AsyncSink::write(Record &record) {
+  spdlog::details::log_msg msg(&ASYNC_SINK_NAME, record.level);
+  msg.formatted << record.formatted;
+  delegate_->log(msg);
+}
+
+void AsyncSink::run() {
+  Record record;
+  while (true) {
+    // read before draining so that everything logged before the destructor ran is written
+    const bool stopping = !running_;
+    bool wrote = false;
+    while (queue_.dequeue(record)) {
+      write(record);
+      wrote = true;
+    }
+    uint64_t dropped = dropped_.exchange(0);
+    if (dropped > 0) {
+      Record report;
+      report.level = spdlog::level::warn;
+      report.formatted = "Dropped " + std::to_string(dropped) + " log messages because the async log queue was full" + spdlog::details::os::eol;
+      write(report);
+      wrote = true;
+    }
+    if (stopping) {
+      delegate_->flush();
+      return;
+    }
+    if (flush_requested_.exchange(false)) {
+      delegate_->flush();
+    }
+    if (!wrote) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      sleeping_ = true;
+      if (running_) {
+        wake_.wait_for(lock, IDLE_WAIT);
+      }
+      sleeping_ = false;
+    }
+  }
+}
+
+} /* namespace logging */
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
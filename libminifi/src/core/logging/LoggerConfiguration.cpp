@@ -28,6 +28,7 @@
 #include <string>
 
 #include "core/Core.h"
+#include "core/logging/AsyncSink.h"
 #include "utils/StringUtils.h"
 
 #include "spdlog/spdlog.h"
@@ -168,6 +169,36 @@ std::shared_ptr<internal::LoggerNamespace> LoggerConfiguration::initialize_names
     }
   }
 
+  std::string async_str;
+  bool async_enabled = false;
+  if (logger_properties->get("async.enabled", async_str)) {
+    utils::StringUtils::StringToBool(async_str, async_enabled);
+  }
+  if (async_enabled) {
+    size_t queue_size = 8192;
+    std::string queue_size_str;
+    if (logger_properties->get("async.queue_size", queue_size_str)) {
+      try {
+        queue_size = std::stoul(queue_size_str);
+      } catch (const std::invalid_argument &ia) {
+      } catch (const std::out_of_range &oor) {
+      }
+    }
+    AsyncOverflowPolicy policy = AsyncOverflowPolicy::BLOCK;
+    std::string policy_str;
+    if (logger_properties->get("async.overflow_policy", policy_str)) {
+      std::transform(policy_str.begin(), policy_str.end(), policy_str.begin(), ::tolower);
+      if ("drop" == utils::StringUtils::trim(policy_str)) {
+        policy = AsyncOverflowPolicy::DROP;
+      }
+    }
+    for (auto &sink : sink_map) {
+      if (nullptr != sink.second && nullptr == std::dynamic_pointer_cast<spdlog::sinks::null_sink_st>(sink.second)) {
+        sink.second = std::make_shared<AsyncSink>(sink.second, queue_size, policy);
+      }
+    }
+  }
+
   std::shared_ptr<internal::LoggerNamespace> root_namespace = std::make_shared<internal::LoggerNamespace>();
   std::string logger_type = "logger";
   for (auto const & logger_key : logger_properties->get_keys_of_type(logger_type)) {
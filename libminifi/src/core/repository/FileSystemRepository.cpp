@@ -50,6 +50,15 @@ std::shared_ptr<io::BaseMemoryMap> FileSystemRepository::mmap(const std::shared_
   return std::make_shared<io::FileMemoryMap>(claim->getContentFullPath(), mapSize, readOnly);
 }
 
+bool FileSystemRepository::importFile(const std::string &source, uint64_t offset, uint64_t length, const std::shared_ptr<minifi::ResourceClaim> &claim) {
+  if (utils::file::FileUtils::copy_file_region(source, offset, length, claim->getContentFullPath()) != static_cast<int64_t>(length)) {
+    logger_->log_debug("Could not copy %llu bytes of %s into %s", length, source, claim->getContentFullPath());
+    std::remove(claim->getContentFullPath().c_str());
+    return false;
+  }
+  return true;
+}
+
 bool FileSystemRepository::exists(const std::shared_ptr<minifi::ResourceClaim> &streamId) {
   std::ifstream file(streamId->getContentFullPath());
   return file.good();
@@ -0,0 +1,652 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "core/repository/SlabContentRepository.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <mio/mmap.hpp>
+#include "core/Property.h"
+#include "io/FileMemoryMap.h"
+#include "io/FileStream.h"
+#include "utils/file/FileUtils.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+namespace repository {
+
+class SlabContentRepository::SegmentFile {
+ public:
+  SegmentFile(int fd, const std::string &path, uint64_t size)
+      : fd_(fd),
+        path_(path),
+        size_(size) {
+  }
+
+  ~SegmentFile() {
+    ::close(fd_);
+  }
+
+  int getDescriptor() const {
+    return fd_;
+  }
+
+  const std::string &getPath() const {
+    return path_;
+  }
+
+  // guarded by the repository's mutex
+  uint64_t getSize() const {
+    return size_;
+  }
+
+  void setSize(uint64_t size) {
+    size_ = size;
+  }
+
+ private:
+  int fd_;
+  std::string path_;
+  uint64_t size_;
+};
+
+namespace {
+
+/**
+ * Record layout in a segment: key length (uint32), key, type (uint8), content length (uint64), content.
+ */
+const uint8_t RECORD_CLAIM = 0;
+const uint8_t RECORD_TOMBSTONE = 1;
+
+const char *SEGMENT_EXTENSION = ".slab";
+
+/**
+ * Reads a claim's content from its segment.
+ */
+class SlabReadStream : public io::BaseStream {
+ public:
+  SlabReadStream(const std::shared_ptr<SlabContentRepository::SegmentFile> &file, uint64_t offset, uint64_t length)
+      : file_(file),
+        offset_(offset),
+        length_(length),
+        position_(0) {
+  }
+
+  virtual void seek(uint64_t offset) {
+    position_ = std::min(offset, length_);
+  }
+
+  virtual const uint64_t getSize() const {
+    return length_;
+  }
+
+  virtual int readData(std::vector<uint8_t> &buf, int buflen) {
+    if (static_cast<int>(buf.capacity()) < buflen) {
+      buf.resize(buflen);
+    }
+    int ret = readData(reinterpret_cast<uint8_t*>(&buf[0]), buflen);
+    if (ret >= 0 && ret < buflen) {
+      buf.resize(ret);
+    }
+    return ret;
+  }
+
+  virtual int readData(uint8_t *buf, int buflen) {
+    if (buf == nullptr || buflen < 0) {
+      return -1;
+    }
+    size_t count = std::min<uint64_t>(buflen, length_ - position_);
+    size_t total = 0;
+    while (total < count) {
+      ssize_t ret = ::pread(file_->getDescriptor(), buf + total, count - total, offset_ + position_ + total);
+      if (ret <= 0) {
+        return total > 0 ? static_cast<int>(total) : -1;
+      }
+      total += ret;
+    }
+    position_ += total;
+    return static_cast<int>(total);
+  }
+
+  virtual int writeData(std::vector<uint8_t> &buf, int buflen) {
+    return -1;
+  }
+
+  virtual int writeData(uint8_t *value, int size) {
+    return -1;
+  }
+
+  const uint8_t *getBuffer() const {
+    throw std::runtime_error("Stream does not support this operation");
+  }
+
+ private:
+  std::shared_ptr<SlabContentRepository::SegmentFile> file_;
+  uint64_t offset_;
+  uint64_t length_;
+  uint64_t position_;
+};
+
+/**
+ * Buffers a claim's content and stores it as one record when closed. Content
+ * beyond the repository's max claim size is spilled to a file of its own.
+ */
+class SlabWriteStream : public io::BaseStream {
+ public:
+  SlabWriteStream(SlabContentRepository *repository, const std::string &claim_path)
+      : repository_(repository),
+        claim_path_(claim_path),
+        closed_(false) {
+  }
+
+  virtual ~SlabWriteStream() {
+    closeStream();
+  }
+
+  virtual void closeStream() {
+    if (closed_) {
+      return;
+    }
+    closed_ = true;
+    if (file_ != nullptr) {
+      file_->closeStream();
+      repository_->storedToFile(claim_path_);
+    } else {
+      uint64_t size = DataStream::getSize();
+      repository_->store(claim_path_, size > 0 ? DataStream::getBuffer() : nullptr, size);
+    }
+  }
+
+  virtual const uint64_t getSize() const {
+    return file_ != nullptr ? file_->getSize() : DataStream::getSize();
+  }
+
+  virtual int writeData(std::vector<uint8_t> &buf, int buflen) {
+    if (static_cast<int>(buf.capacity()) < buflen) {
+      return -1;
+    }
+    return writeData(reinterpret_cast<uint8_t *>(&buf[0]), buflen);
+  }
+
+  virtual int writeData(uint8_t *value, int size) {
+    if (closed_ || value == nullptr) {
+      return -1;
+    }
+    if (file_ != nullptr) {
+      return file_->writeData(value, size);
+    }
+    DataStream::writeData(value, size);
+    if (DataStream::getSize() > repository_->getMaxClaimSize()) {
+      file_ = std::make_shared<io::FileStream>(claim_path_, false);
+      if (file_->writeData(const_cast<uint8_t*>(DataStream::getBuffer()), DataStream::getSize()) < 0) {
+        return -1;
+      }
+      DataStream::initialize();
+    }
+    return size;
+  }
+
+  virtual int readData(std::vector<uint8_t> &buf, int buflen) {
+    return -1;
+  }
+
+  virtual int readData(uint8_t *buf, int buflen) {
+    return -1;
+  }
+
+ private:
+  SlabContentRepository *repository_;
+  std::string claim_path_;
+  std::shared_ptr<io::FileStream> file_;
+  bool closed_;
+};
+
+/**
+ * Read only map of a claim's content within its segment.
+ */
+class SegmentMemoryMap : public io::BaseMemoryMap {
+ public:
+  SegmentMemoryMap(const std::shared_ptr<SlabContentRepository::SegmentFile> &file, uint64_t offset, size_t length)
+      : file_(file) {
+    if (length > 0) {
+      std::error_code error;
+      mmap_.map(file_->getDescriptor(), offset, length, error);
+      if (error) {
+        throw std::runtime_error("Failed to map segment " + file_->getPath() + ": " + error.message());
+      }
+    }
+  }
+
+  virtual ~SegmentMemoryMap() {
+    unmap();
+  }
+
+  virtual void *getData() {
+    return mmap_.is_mapped() ? const_cast<char *>(mmap_.data()) : nullptr;
+  }
+
+  virtual size_t getSize() {
+    return mmap_.size();
+  }
+
+  virtual void *resize(size_t new_size) {
+    throw std::runtime_error("Cannot resize read-only mmap");
+  }
+
+  virtual void unmap() {
+    mmap_.unmap();
+  }
+
+ private:
+  std::shared_ptr<SlabContentRepository::SegmentFile> file_;
+  mio::mmap_source mmap_;
+};
+
+/**
+ * Writable map of a claim, kept in memory and stored as a new record when unmapped.
+ */
+class SlabMemoryMap : public io::BaseMemoryMap {
+ public:
+  SlabMemoryMap(SlabContentRepository *repository, const std::shared_ptr<minifi::ResourceClaim> &claim, size_t map_size)
+      : repository_(repository),
+        claim_(claim),
+        mapped_(true) {
+    buf_.resize(map_size);
+  }
+
+  virtual ~SlabMemoryMap() {
+    unmap();
+  }
+
+  virtual void *getData() {
+    return mapped_ ? reinterpret_cast<void *>(buf_.data()) : nullptr;
+  }
+
+  virtual size_t getSize() {
+    return buf_.size();
+  }
+
+  virtual void *resize(size_t new_size) {
+    buf_.resize(new_size);
+    return getData();
+  }
+
+  virtual void unmap() {
+    if (mapped_) {
+      mapped_ = false;
+      auto stream = repository_->write(claim_, false);
+      if (!buf_.empty() && stream->writeData(buf_.data(), buf_.size()) < 0) {
+        throw std::runtime_error("Failed to write memory map data to " + claim_->getContentFullPath());
+      }
+      stream->closeStream();
+    }
+  }
+
+ private:
+  SlabContentRepository *repository_;
+  std::shared_ptr<minifi::ResourceClaim> claim_;
+  std::vector<uint8_t> buf_;
+  bool mapped_;
+};
+
+}  // namespace
+
+SlabContentRepository::SlabContentRepository(std::string name)
+    : core::CoreComponent(name),
+      active_segment_(0),
+      segment_size_(DEFAULT_SEGMENT_SIZE),
+      max_claim_size_(DEFAULT_MAX_CLAIM_SIZE),
+      logger_(logging::LoggerFactory<SlabContentRepository>::getLogger()) {
+}
+
+SlabContentRepository::~SlabContentRepository() {
+}
+
+bool SlabContentRepository::initialize(const std::shared_ptr<minifi::Configure> &configuration) {
+  std::string value;
+  if (configuration->get(Configure::nifi_dbcontent_repository_directory_default, value)) {
+    directory_ = value;
+  } else {
+    directory_ = configuration->getHome() + "/contentrepository";
+  }
+  if (configuration->get(Configure::nifi_content_repository_slab_segment_size, value)) {
+    core::Property::StringToInt(value, segment_size_);
+  }
+  if (configuration->get(Configure::nifi_content_repository_slab_max_claim_size, value)) {
+    core::Property::StringToInt(value, max_claim_size_);
+  }
+  utils::file::FileUtils::create_dir(directory_);
+  utils::file::FileUtils::create_dir(directory_ + "/slabs");
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  segments_.clear();
+  std::vector<uint64_t> ids;
+  DIR *dir = opendir((directory_ + "/slabs").c_str());
+  if (dir != nullptr) {
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+      std::string file_name = entry->d_name;
+      size_t extension = file_name.rfind(SEGMENT_EXTENSION);
+      if (extension != std::string::npos && extension > 0 && extension + strlen(SEGMENT_EXTENSION) == file_name.size()) {
+        try {
+          ids.push_back(std::stoull(file_name.substr(0, extension)));
+        } catch (const std::exception &) {
+          logger_->log_warn("Ignoring unexpected file %s in the content repository", file_name);
+        }
+      }
+    }
+    closedir(dir);
+  }
+  std::sort(ids.begin(), ids.end());
+  for (auto id : ids) {
+    scanSegment(id);
+  }
+  if (!openSegment(ids.empty() ? 1 : ids.back() + 1)) {
+    return false;
+  }
+  for (auto id : ids) {
+    reclaim(id);
+  }
+  logger_->log_debug("Content repository %s holds %llu claims in %llu segments", directory_, index_.size(), segments_.size());
+  return true;
+}
+
+void SlabContentRepository::stop() {
+}
+
+std::string SlabContentRepository::getSegmentPath(uint64_t id) const {
+  return directory_ + "/slabs/" + std::to_string(id) + SEGMENT_EXTENSION;
+}
+
+bool SlabContentRepository::openSegment(uint64_t id) {
+  std::string path = getSegmentPath(id);
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    logger_->log_error("Could not open content repository segment %s", path);
+    return false;
+  }
+  struct stat file_stat;
+  uint64_t size = ::fstat(fd, &file_stat) == 0 ? file_stat.st_size : 0;
+  Segment segment;
+  segment.file = std::make_shared<SegmentFile>(fd, path, size);
+  segment.live_claims = 0;
+  segment.pins = 0;
+  segments_[id] = segment;
+  active_segment_ = id;
+  return true;
+}
+
+void SlabContentRepository::scanSegment(uint64_t id) {
+  std::string path = getSegmentPath(id);
+  std::ifstream segment_stream(path, std::ios::in | std::ios::binary);
+  if (!openSegment(id)) {
+    return;
+  }
+  uint64_t record_start = 0;
+  std::string key;
+  while (true) {
+    uint32_t key_length = 0;
+    uint8_t type = 0;
+    uint64_t length = 0;
+    if (!segment_stream.read(reinterpret_cast<char *>(&key_length), sizeof(key_length))) {
+      break;
+    }
+    key.resize(key_length);
+    if (!segment_stream.read(&key[0], key_length) || !segment_stream.read(reinterpret_cast<char *>(&type), sizeof(type))
+        || !segment_stream.read(reinterpret_cast<char *>(&length), sizeof(length))) {
+      break;
+    }
+    uint64_t offset = record_start + sizeof(key_length) + key_length + sizeof(type) + sizeof(length);
+    if (offset + length > segments_[id].file->getSize()) {
+      break;
+    }
+    if (type == RECORD_CLAIM) {
+      Location location { id, offset, length };
+      replaceLocation(key, id, &location);
+    } else {
+      replaceLocation(key, id, nullptr);
+    }
+    segment_stream.seekg(length, std::ios::cur);
+    record_start = offset + length;
+  }
+  auto &segment = segments_[id];
+  if (record_start < segment.file->getSize()) {
+    // the last record was not completely written
+    logger_->log_warn("Truncating incomplete record at %llu in %s", record_start, path);
+    if (::ftruncate(segment.file->getDescriptor(), record_start) == 0) {
+      segment.file->setSize(record_start);
+    }
+  }
+}
+
+bool SlabContentRepository::appendRecord(const std::string &claim_path, const uint8_t *data, uint64_t size, bool tombstone, Location &location) {
+  if (segments_[active_segment_].file->getSize() >= segment_size_) {
+    uint64_t full_segment = active_segment_;
+    if (!openSegment(active_segment_ + 1)) {
+      return false;
+    }
+    reclaim(full_segment);
+  }
+  auto &file = segments_[active_segment_].file;
+  uint32_t key_length = claim_path.size();
+  uint8_t type = tombstone ? RECORD_TOMBSTONE : RECORD_CLAIM;
+  std::vector<uint8_t> header(sizeof(key_length) + key_length + sizeof(type) + sizeof(size));
+  uint8_t *position = header.data();
+  memcpy(position, &key_length, sizeof(key_length));
+  position += sizeof(key_length);
+  memcpy(position, claim_path.data(), key_length);
+  position += key_length;
+  memcpy(position, &type, sizeof(type));
+  position += sizeof(type);
+  memcpy(position, &size, sizeof(size));
+
+  struct iovec parts[2];
+  parts[0].iov_base = header.data();
+  parts[0].iov_len = header.size();
+  parts[1].iov_base = const_cast<uint8_t *>(data);
+  parts[1].iov_len = size;
+  ssize_t expected = header.size() + size;
+  ssize_t written = ::writev(file->getDescriptor(), parts, size > 0 ? 2 : 1);
+  if (written != expected) {
+    logger_->log_error("Could not append %s to %s", claim_path, file->getPath());
+    if (::ftruncate(file->getDescriptor(), file->getSize()) != 0) {
+      logger_->log_error("Could not truncate %s", file->getPath());
+    }
+    return false;
+  }
+  location.segment = active_segment_;
+  location.offset = file->getSize() + header.size();
+  location.length = size;
+  file->setSize(file->getSize() + expected);
+  return true;
+}
+
+void SlabContentRepository::replaceLocation(const std::string &claim_path, uint64_t holder, const Location *location) {
+  auto existing = index_.find(claim_path);
+  if (existing != index_.end()) {
+    uint64_t previous_id = existing->second.segment;
+    auto &previous = segments_[previous_id];
+    previous.live_claims--;
+    if (previous_id != holder) {
+      previous.pinned_segments[holder]++;
+      segments_[holder].pins++;
+    }
+    if (location != nullptr) {
+      existing->second = *location;
+    } else {
+      index_.erase(existing);
+    }
+    reclaim(previous_id);
+  } else if (location != nullptr) {
+    index_[claim_path] = *location;
+  }
+  if (location != nullptr) {
+    segments_[location->segment].live_claims++;
+  }
+}
+
+void SlabContentRepository::reclaim(uint64_t id) {
+  auto segment = segments_.find(id);
+  if (id == active_segment_ || segment == segments_.end() || segment->second.live_claims > 0 || segment->second.pins > 0) {
+    return;
+  }
+  logger_->log_debug("Deleting content repository segment %s", segment->second.file->getPath());
+  std::remove(segment->second.file->getPath().c_str());
+  auto pinned_segments = std::move(segment->second.pinned_segments);
+  segments_.erase(segment);
+  for (const auto &pinned : pinned_segments) {
+    auto holder = segments_.find(pinned.first);
+    if (holder != segments_.end()) {
+      holder->second.pins -= pinned.second;
+      reclaim(pinned.first);
+    }
+  }
+}
+
+bool SlabContentRepository::findLocation(const std::string &claim_path, Location &location, std::shared_ptr<SegmentFile> &file) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto existing = index_.find(claim_path);
+  if (existing == index_.end()) {
+    return false;
+  }
+  location = existing->second;
+  file = segments_[location.segment].file;
+  return true;
+}
+
+bool SlabContentRepository::store(const std::string &claim_path, const uint8_t *data, size_t size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Location location;
+  if (!appendRecord(claim_path, data, size, false, location)) {
+    return false;
+  }
+  replaceLocation(claim_path, location.segment, &location);
+  return true;
+}
+
+void SlabContentRepository::storedToFile(const std::string &claim_path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_.find(claim_path) != index_.end()) {
+    Location location;
+    if (appendRecord(claim_path, nullptr, 0, true, location)) {
+      replaceLocation(claim_path, location.segment, nullptr);
+    }
+  }
+}
+
+bool SlabContentRepository::exists(const std::shared_ptr<minifi::ResourceClaim> &streamId) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index_.find(streamId->getContentFullPath()) != index_.end()) {
+      return true;
+    }
+  }
+  std::ifstream file(streamId->getContentFullPath());
+  return file.good();
+}
+
+std::shared_ptr<io::BaseStream> SlabContentRepository::write(const std::shared_ptr<minifi::ResourceClaim> &claim, bool append) {
+  const std::string claim_path = claim->getContentFullPath();
+  Location location;
+  std::shared_ptr<SegmentFile> file;
+  bool in_segment = append && findLocation(claim_path, location, file);
+  if (append && !in_segment) {
+    // the claim is in a file of its own, if it exists at all
+    return std::make_shared<io::FileStream>(claim_path, true);
+  }
+  auto stream = std::make_shared<SlabWriteStream>(this, claim_path);
+  if (in_segment) {
+    SlabReadStream existing(file, location.offset, location.length);
+    std::vector<uint8_t> buffer;
+    if (location.length > 0 && (existing.readData(buffer, location.length) != static_cast<int>(location.length) || stream->writeData(buffer, location.length) < 0)) {
+      return nullptr;
+    }
+  }
+  return stream;
+}
+
+std::shared_ptr<io::BaseStream> SlabContentRepository::read(const std::shared_ptr<minifi::ResourceClaim> &claim) {
+  Location location;
+  std::shared_ptr<SegmentFile> file;
+  if (findLocation(claim->getContentFullPath(), location, file)) {
+    return std::make_shared<SlabReadStream>(file, location.offset, location.length);
+  }
+  return std::make_shared<io::FileStream>(claim->getContentFullPath(), 0, false);
+}
+
+std::shared_ptr<io::BaseMemoryMap> SlabContentRepository::mmap(const std::shared_ptr<minifi::ResourceClaim> &claim, size_t mapSize, bool readOnly) {
+  Location location;
+  std::shared_ptr<SegmentFile> file;
+  bool in_segment = findLocation(claim->getContentFullPath(), location, file);
+  if (readOnly) {
+    if (in_segment) {
+      return std::make_shared<SegmentMemoryMap>(file, location.offset, std::min<uint64_t>(mapSize, location.length));
+    }
+    return std::make_shared<io::FileMemoryMap>(claim->getContentFullPath(), mapSize, true);
+  }
+  if (!in_segment && mapSize > max_claim_size_) {
+    return std::make_shared<io::FileMemoryMap>(claim->getContentFullPath(), mapSize, false);
+  }
+  auto map = std::make_shared<SlabMemoryMap>(this, claim, mapSize);
+  if (in_segment) {
+    SlabReadStream existing(file, location.offset, location.length);
+    existing.readData(reinterpret_cast<uint8_t *>(map->getData()), std::min<uint64_t>(mapSize, location.length));
+  }
+  return map;
+}
+
+bool SlabContentRepository::remove(const std::shared_ptr<minifi::ResourceClaim> &claim) {
+  const std::string claim_path = claim->getContentFullPath();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index_.find(claim_path) != index_.end()) {
+      Location location;
+      if (!appendRecord(claim_path, nullptr, 0, true, location)) {
+        return false;
+      }
+      replaceLocation(claim_path, location.segment, nullptr);
+      return true;
+    }
+  }
+  std::remove(claim_path.c_str());
+  return true;
+}
+
+size_t SlabContentRepository::getSegmentCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return segments_.size();
+}
+
+} /* namespace repository */
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
@@ -666,6 +666,16 @@ void YamlConfiguration::parseConnectionYaml(YAML::Node *connectionsNode, core::P
           }
         }
 
+        if (connectionNode["queue prioritizer class"]) {
+          std::string prioritizer_class = connectionNode["queue prioritizer class"].as<std::string>();
+          auto prioritizer = core::FlowFilePrioritizer::create(prioritizer_class);
+          if (nullptr == prioritizer && !prioritizer_class.empty() && prioritizer_class.find("FirstInFirstOutPrioritizer") == std::string::npos) {
+            logger_->log_warn("parseConnection: unknown queue prioritizer class %s, flow files will not be prioritized", prioritizer_class);
+          }
+          logger_->log_debug("parseConnection: queue prioritizer class => [%s]", prioritizer_class);
+          connection->setPrioritizer(prioritizer);
+        }
+
         if (connection) {
           parent->addConnection(connection);
         }
@@ -716,6 +726,13 @@ void YamlConfiguration::parsePortYaml(YAML::Node *portNode, core::ProcessGroup *
       port->setHTTPProxy(parent->getHTTPProxy());
   }
   // else defaults to RAW
+  if (inputPortsObj["use compression"]) {
+    bool use_compression = false;
+    if (utils::StringUtils::StringToBool(inputPortsObj["use compression"].as<std::string>(), use_compression)) {
+      port->setUseCompression(use_compression);
+    }
+    logger_->log_debug("parsePortYaml: use compression => [%d]", use_compression);
+  }
 
   // handle port properties
   YAML::Node nodeVal = portNode->as<YAML::Node>();
@@ -34,7 +34,7 @@ namespace io {
 int DataStream::writeData(uint8_t *value, int size) {
   if (value == nullptr)
     return 0;
-  std::copy(value, value + size, std::back_inserter(buffer));
+  buffer.insert(buffer.end(), value, value + size);
   return size;
 }
 
@@ -0,0 +1,75 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "io/StreamSlice.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+StreamSlice::StreamSlice(const std::shared_ptr<BaseStream> &stream, uint64_t offset, uint64_t size)
+    : stream_(stream),
+      offset_(offset),
+      size_(size),
+      position_(0) {
+  stream_->seek(offset_);
+}
+
+void StreamSlice::seek(uint64_t offset) {
+  position_ = std::min(offset, size_);
+  stream_->seek(offset_ + position_);
+}
+
+int StreamSlice::readData(std::vector<uint8_t> &buf, int buflen) {
+  if (buflen < 0) {
+    return -1;
+  }
+  if (buf.size() < static_cast<size_t>(buflen)) {
+    buf.resize(buflen);
+  }
+  int ret = readData(buf.data(), buflen);
+  if (ret >= 0 && ret < buflen) {
+    buf.resize(ret);
+  }
+  return ret;
+}
+
+int StreamSlice::readData(uint8_t *buf, int buflen) {
+  if (buf == nullptr || buflen < 0) {
+    return -1;
+  }
+  int len = static_cast<int>(std::min<uint64_t>(buflen, size_ - position_));
+  if (len == 0) {
+    return 0;
+  }
+  int ret = stream_->readData(buf, len);
+  if (ret > 0) {
+    position_ += ret;
+  }
+  return ret;
+}
+
+} /* namespace io */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
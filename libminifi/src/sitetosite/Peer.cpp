@@ -18,11 +18,14 @@
  * limitations under the License.
  */
 #include <stdio.h>
+#include <zlib.h>
 #include <chrono>
 #include <thread>
 #include <random>
 #include <memory>
 #include <iostream>
+#include <algorithm>
+#include <vector>
 
 #include "sitetosite/Peer.h"
 #include "io/ClientSocket.h"
@@ -64,10 +67,157 @@ bool SiteToSitePeer::Open() {
 }
 
 void SiteToSitePeer::Close() {
+  // data buffered for a connection that is going away is discarded
+  corked_ = false;
+  write_buffer_.initialize();
+  compressing_ = false;
+  compress_buffer_.initialize();
+  decompressing_ = false;
   if (stream_ != nullptr)
     stream_->closeStream();
 }
 
+int SiteToSitePeer::flush() {
+  int size = write_buffer_.getSize();
+  if (size == 0)
+    return 0;
+  int ret = stream_->writeData(const_cast<uint8_t*>(write_buffer_.getBuffer()), size);
+  // keeps the capacity for the next batch of writes
+  write_buffer_.initialize();
+  return ret == size ? 0 : -1;
+}
+
+namespace {
+// precedes the header of every compressed chunk
+const uint8_t SYNC_BYTES[] = { 'S', 'Y', 'N', 'C' };
+// compression level of NiFi's CompressionOutputStream
+const int COMPRESSION_LEVEL = 1;
+// bounds the buffers allocated for the chunks of a peer
+const uint32_t MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+}  // namespace
+
+int SiteToSitePeer::compressChunk() {
+  uLong size = compress_buffer_.getSize();
+  if (size == 0)
+    return 0;
+  uLongf compressed_size = compressBound(size);
+  std::vector<uint8_t> compressed(compressed_size);
+  if (compress2(compressed.data(), &compressed_size, compress_buffer_.getBuffer(), size, COMPRESSION_LEVEL) != Z_OK)
+    return -1;
+  compress_buffer_.initialize();
+  // the chunk itself is written as it is
+  compressing_ = false;
+  int ret = 0;
+  // a chunk following another one is announced by a 1, the end of the packet by a 0
+  if (chunk_written_)
+    ret = write(static_cast<uint8_t>(1));
+  chunk_written_ = true;
+  if (ret >= 0)
+    ret = write(const_cast<uint8_t*>(SYNC_BYTES), sizeof(SYNC_BYTES));
+  if (ret >= 0)
+    ret = write(static_cast<uint32_t>(size));
+  if (ret >= 0)
+    ret = write(static_cast<uint32_t>(compressed_size));
+  if (ret >= 0)
+    ret = write(compressed.data(), compressed_size);
+  compressing_ = true;
+  return ret < 0 ? -1 : 0;
+}
+
+int SiteToSitePeer::endCompression() {
+  int ret = compressChunk();
+  compressing_ = false;
+  if (ret < 0 || write(static_cast<uint8_t>(0)) != 1)
+    return -1;
+  return 0;
+}
+
+int SiteToSitePeer::decompressChunk() {
+  uint8_t sync[sizeof(SYNC_BYTES)];
+  if (Serializable::read(sync, sizeof(sync), stream_.get()) != sizeof(sync) || !std::equal(sync, sync + sizeof(sync), SYNC_BYTES)) {
+    logger_->log_error("Site2Site expected a compressed chunk from %s", url_);
+    return -1;
+  }
+  uint32_t size;
+  uint32_t compressed_size;
+  if (Serializable::read(size, stream_.get()) != 4 || Serializable::read(compressed_size, stream_.get()) != 4)
+    return -1;
+  if (size > MAX_CHUNK_SIZE || compressed_size > MAX_CHUNK_SIZE) {
+    logger_->log_error("Site2Site compressed chunk of %u bytes from %s is too large", size, url_);
+    return -1;
+  }
+  std::vector<uint8_t> compressed(compressed_size);
+  if (compressed_size > 0 && Serializable::read(compressed.data(), compressed_size, stream_.get()) != static_cast<int>(compressed_size))
+    return -1;
+  decompressed_buffer_.resize(size);
+  uLongf decompressed_size = size;
+  if (uncompress(decompressed_buffer_.data(), &decompressed_size, compressed.data(), compressed_size) != Z_OK || decompressed_size != size) {
+    logger_->log_error("Site2Site could not decompress chunk from %s", url_);
+    return -1;
+  }
+  decompressed_position_ = 0;
+  uint8_t more;
+  if (Serializable::read(more, stream_.get()) != 1 || more > 1)
+    return -1;
+  decompressed_eos_ = more == 0;
+  return 0;
+}
+
+int SiteToSitePeer::readDecompressed(uint8_t *value, int len) {
+  int copied = 0;
+  while (copied < len) {
+    if (decompressed_position_ == decompressed_buffer_.size()) {
+      if (decompressed_eos_)
+        break;
+      if (decompressChunk() < 0) {
+        decompressing_ = false;
+        return -1;
+      }
+      continue;
+    }
+    size_t available = std::min<size_t>(len - copied, decompressed_buffer_.size() - decompressed_position_);
+    std::copy(decompressed_buffer_.begin() + decompressed_position_, decompressed_buffer_.begin() + decompressed_position_ + available, value + copied);
+    decompressed_position_ += available;
+    copied += available;
+  }
+  if (decompressed_eos_ && decompressed_position_ == decompressed_buffer_.size()) {
+    // the packet is complete, what follows is not compressed
+    decompressing_ = false;
+  }
+  return copied;
+}
+
+void PeerSelector::update(const std::vector<PeerStatus> &peers) {
+  weights_.clear();
+  current_weights_.assign(peers.size(), 0);
+  total_weight_ = 0;
+  uint64_t total_flow_files = 0;
+  for (const auto &peer : peers) {
+    total_flow_files += peer.getFlowFileCount();
+  }
+  for (const auto &peer : peers) {
+    int64_t weight = 1;
+    if (total_flow_files > 0) {
+      weight += (total_flow_files - peer.getFlowFileCount()) * 100 / total_flow_files;
+    }
+    weights_.push_back(weight);
+    total_weight_ += weight;
+  }
+}
+
+int PeerSelector::next() {
+  if (weights_.empty())
+    return -1;
+  int selected = 0;
+  for (size_t i = 0; i < weights_.size(); i++) {
+    current_weights_[i] += weights_[i];
+    if (current_weights_[i] > current_weights_[selected])
+      selected = i;
+  }
+  current_weights_[selected] -= total_weight_;
+  return selected;
+}
+
 } /* namespace sitetosite */
 } /* namespace minifi */
 } /* namespace nifi */
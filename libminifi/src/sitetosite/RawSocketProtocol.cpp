@@ -246,7 +246,7 @@ bool RawSiteToSiteClient::handShake() {
   }
 
   std::map<std::string, std::string> properties;
-  properties[HandShakePropertyStr[GZIP]] = "false";
+  properties[HandShakePropertyStr[GZIP]] = use_compression_ ? "true" : "false";
   properties[HandShakePropertyStr[PORT_IDENTIFIER]] = port_id_str_;
   properties[HandShakePropertyStr[REQUEST_EXPIRATION_MILLIS]] = std::to_string(_timeOut);
   if (_currentVersion >= 5) {
@@ -141,6 +141,9 @@ bool SiteToSiteClient::transferFlowFiles(const std::shared_ptr<core::ProcessCont
   uint64_t startSendingNanos = getTimeNano();
 
   try {
+    // the peer does not answer until the transaction is finished, so the records are
+    // streamed in large writes rather than a write per field
+    peer_->cork();
     while (continueTransaction) {
       uint64_t startTime = getTimeMillis();
       std::string payload;
@@ -171,6 +174,9 @@ bool SiteToSiteClient::transferFlowFiles(const std::shared_ptr<core::ProcessCont
       }
     }  // while true
 
+    if (peer_->uncork() < 0) {
+      throw Exception(SITE2SITE_EXCEPTION, "Send Failed");
+    }
     if (!confirm(transactionID)) {
       throw Exception(SITE2SITE_EXCEPTION, "Confirm Failed for " + transactionID);
     }
@@ -442,6 +448,10 @@ int16_t SiteToSiteClient::send(std::string transactionID, DataPacket *packet, co
       return -1;
     }
   }
+  if (use_compression_) {
+    // each data packet is compressed on its own; the responses around it are not
+    peer_->beginCompression();
+  }
   // start to read the packet
   uint32_t numAttributes = packet->_attributes.size();
   ret = transaction->getStream().write(numAttributes);
@@ -501,6 +511,10 @@ int16_t SiteToSiteClient::send(std::string transactionID, DataPacket *packet, co
     packet->_size += len;
   }
 
+  if (use_compression_ && peer_->endCompression() < 0) {
+    return -1;
+  }
+
   transaction->current_transfers_++;
   transaction->total_transfers_++;
   transaction->_state = DATA_EXCHANGED;
@@ -577,6 +591,10 @@ bool SiteToSiteClient::receive(std::string transactionID, DataPacket *packet, bo
     return true;
   }
 
+  if (use_compression_) {
+    // decompression ends by itself with the packet's content
+    peer_->beginDecompression();
+  }
   // start to read the packet
   uint32_t numAttributes;
   ret = transaction->getStream().read(numAttributes);
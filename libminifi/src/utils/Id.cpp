@@ -26,6 +26,7 @@
 #include <cmath>
 #include <memory>
 #include <string>
+#include <utility>
 #include "core/logging/LoggerConfiguration.h"
 #include "utils/StringUtils.h"
 
@@ -37,87 +38,109 @@ namespace utils {
 
 Identifier::Identifier(UUID_FIELD u)
     : IdentifierBase(u) {
-  build_string();
 }
 
 Identifier::Identifier()
     : IdentifierBase() {
 }
 
-Identifier::Identifier(const Identifier &other) {
-  if (!other.convert().empty()) {
-    copyInto(other);
-    build_string();
-  }
+Identifier::Identifier(const Identifier &other)
+    : IdentifierBase(other),
+      text_(other.text_) {
 }
 
 Identifier::Identifier(Identifier &&other)
-    : IdentifierBase(std::move(other)) {
+    : IdentifierBase(other),
+      text_(std::move(other.text_)) {
 }
 
-Identifier::Identifier(const IdentifierBase &other) {
-  if (!other.convert().empty()) {
-    copyInto(other);
-    build_string();
-  }
+Identifier::Identifier(const IdentifierBase &other)
+    : IdentifierBase(other) {
 }
 
 Identifier &Identifier::operator=(const Identifier &other) {
-  if (!other.convert().empty()) {
+  if (other != nullptr) {
     IdentifierBase::operator =(other);
-    build_string();
+    text_ = other.text_;
   }
   return *this;
 }
 
 Identifier &Identifier::operator=(const IdentifierBase &other) {
-  if (!other.convert().empty()) {
+  if (Identifier(other) != nullptr) {
     IdentifierBase::operator =(other);
-    build_string();
+    text_.clear();
   }
   return *this;
 }
 
 Identifier &Identifier::operator=(UUID_FIELD o) {
   IdentifierBase::operator=(o);
-  build_string();
+  text_.clear();
   return *this;
 }
 
 Identifier &Identifier::operator=(std::string id) {
-  uuid_parse(id.c_str(), id_);
-  converted_ = id;
+  if (uuid_parse(id.c_str(), id_) == 0) {
+    set_ = true;
+    text_.clear();
+  } else {
+    // not a uuid; keep the text so that it can still be compared and printed
+    memset(id_, 0, sizeof(id_));
+    set_ = !id.empty();
+    text_ = std::move(id);
+  }
   return *this;
 }
 
 bool Identifier::operator==(const std::nullptr_t nullp) const {
-  return converted_.empty();
+  return !set_;
 }
 
 bool Identifier::operator!=(const std::nullptr_t nullp) const {
-  return !converted_.empty();
+  return set_;
 }
 
 bool Identifier::operator!=(const Identifier &other) const {
-  return converted_ != other.converted_;
+  return !(*this == other);
 }
 
 bool Identifier::operator==(const Identifier &other) const {
-  return converted_ == other.converted_;
+  return set_ == other.set_ && memcmp(id_, other.id_, sizeof(id_)) == 0 && text_ == other.text_;
+}
+
+bool Identifier::operator<(const Identifier &other) const {
+  if (set_ != other.set_) {
+    return !set_;
+  }
+  int compared = memcmp(id_, other.id_, sizeof(id_));
+  return compared < 0 || (compared == 0 && text_ < other.text_);
 }
 
 std::string Identifier::to_string() const {
-  return convert();
+  if (!set_ || !text_.empty()) {
+    return text_;
+  }
+  char uuidStr[37] = { 0 };
+  uuid_unparse_lower(id_, uuidStr);
+  return uuidStr;
 }
 
 const unsigned char * const Identifier::toArray() const {
   return id_;
 }
 
-void Identifier::build_string() {
-  char uuidStr[37] = { 0 };
-  uuid_unparse_lower(id_, uuidStr);
-  converted_ = uuidStr;
+size_t IdentifierHash::operator()(const Identifier &identifier) const {
+  uint64_t high;
+  uint64_t low;
+  memcpy(&high, identifier.toArray(), sizeof(high));
+  memcpy(&low, identifier.toArray() + sizeof(high), sizeof(low));
+  // time based uuids differ in their first half and minifi uids in their second, so both are mixed
+  size_t hash = static_cast<size_t>(high ^ (low * 0x9E3779B97F4A7C15ULL));
+  if (!identifier.text_.empty()) {
+    hash ^= std::hash<std::string>()(identifier.text_);
+  }
+  return hash;
 }
 
 uint64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
@@ -130,7 +153,15 @@ NonRepeatingStringGenerator::NonRepeatingStringGenerator()
 IdGenerator::IdGenerator()
     : implementation_(UUID_TIME_IMPL),
       logger_(logging::LoggerFactory<IdGenerator>::getLogger()),
-      incrementor_(0) {
+      incrementor_(0),
+      last_timestamp_(0) {
+  // a random clock sequence and node keep the uuids of concurrently running agents apart
+  UUID_FIELD random_uuid;
+  uuid_generate_random(random_uuid);
+  std::memcpy(clock_sequence_and_node_, random_uuid + 8, sizeof(clock_sequence_and_node_));
+  // RFC 4122 variant, and the multicast bit that marks a node that is not a MAC address
+  clock_sequence_and_node_[0] = (clock_sequence_and_node_[0] & 0x3F) | 0x80;
+  clock_sequence_and_node_[2] |= 0x01;
 }
 
 uint64_t IdGenerator::getDeviceSegmentFromString(const std::string& str, int numBits) const {
@@ -206,12 +237,12 @@ void IdGenerator::initialize(const std::shared_ptr<Properties> & properties) {
       }
       incrementor_ = 0;
     } else if ("time" == implementation_str) {
-      logging::LOG_DEBUG(logger_) << "Using uuid_generate_time implementation for uids.";
+      logging::LOG_DEBUG(logger_) << "Using time based implementation for uids.";
     } else {
-      logging::LOG_DEBUG(logger_) << "Invalid value for uid.implementation (" << implementation_str << "). Using uuid_generate_time implementation for uids.";
+      logging::LOG_DEBUG(logger_) << "Invalid value for uid.implementation (" << implementation_str << "). Using time based implementation for uids.";
     }
   } else {
-    logging::LOG_DEBUG(logger_) << "Using uuid_generate_time implementation for uids.";
+    logging::LOG_DEBUG(logger_) << "Using time based implementation for uids.";
   }
 }
 
@@ -239,12 +270,35 @@ void IdGenerator::generate(Identifier &ident) {
     }
       break;
     default:
-      uuid_generate_time(output);
+      generateTime(output);
       break;
   }
   ident = output;
 }
 
+void IdGenerator::generateTime(UUID_FIELD output) {
+  // 100 ns intervals between the start of the Gregorian calendar and the Unix epoch
+  static const uint64_t GREGORIAN_OFFSET = 0x01B21DD213814000ULL;
+  const uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count() / 100 + GREGORIAN_OFFSET;
+  uint64_t last = last_timestamp_.load();
+  uint64_t timestamp;
+  do {
+    timestamp = (std::max)(now, last + 1);
+  } while (!last_timestamp_.compare_exchange_weak(last, timestamp));
+
+  const uint32_t time_low = static_cast<uint32_t>(timestamp);
+  const uint16_t time_mid = static_cast<uint16_t>(timestamp >> 32);
+  const uint16_t time_high_and_version = static_cast<uint16_t>((timestamp >> 48) & 0x0FFF) | 0x1000;
+  for (int i = 0; i < 4; i++) {
+    output[i] = (time_low >> ((3 - i) * 8)) & UNSIGNED_CHAR_MAX;
+  }
+  output[4] = time_mid >> 8;
+  output[5] = time_mid & UNSIGNED_CHAR_MAX;
+  output[6] = time_high_and_version >> 8;
+  output[7] = time_high_and_version & UNSIGNED_CHAR_MAX;
+  std::memcpy(output + 8, clock_sequence_and_node_, sizeof(clock_sequence_and_node_));
+}
+
 } /* namespace utils */
 } /* namespace minifi */
 } /* namespace nifi */
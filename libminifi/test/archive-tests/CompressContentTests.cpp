@@ -933,3 +933,216 @@ TEST_CASE("DecompressFileXYLZMA", "[compressfiletest8]") {
   }
 }
 
+TEST_CASE("CompressFileGZipParallel", "[compressfiletest9]") {
+  try {
+    std::ofstream expectfile;
+    expectfile.open(EXPECT_COMPRESS_CONTENT);
+
+    for (int i = 0; i < 100000; i++) {
+      expectfile << std::to_string(rand_r(&globalSeed)%100);
+    }
+    expectfile.close();
+
+    TestController testController;
+    LogTestController::getInstance().setTrace<org::apache::nifi::minifi::processors::CompressContent>();
+    LogTestController::getInstance().setTrace<org::apache::nifi::minifi::processors::LogAttribute>();
+    LogTestController::getInstance().setTrace<core::ProcessSession>();
+    LogTestController::getInstance().setTrace<core::ProcessContext>();
+    LogTestController::getInstance().setTrace<core::repository::VolatileContentRepository>();
+    LogTestController::getInstance().setTrace<org::apache::nifi::minifi::Connection>();
+    LogTestController::getInstance().setTrace<org::apache::nifi::minifi::core::Connectable>();
+
+    std::shared_ptr<TestRepository> repo = std::make_shared<TestRepository>();
+
+    std::shared_ptr<core::Processor> processor = std::make_shared<org::apache::nifi::minifi::processors::CompressContent>("compresscontent");
+    std::shared_ptr<core::Processor> logAttributeProcessor = std::make_shared<org::apache::nifi::minifi::processors::LogAttribute>("logattribute");
+    processor->initialize();
+    utils::Identifier processoruuid;
+    REQUIRE(true == processor->getUUID(processoruuid));
+    utils::Identifier logAttributeuuid;
+    REQUIRE(true == logAttributeProcessor->getUUID(logAttributeuuid));
+
+    std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+    // std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::FileSystemRepository>();
+
+    content_repo->initialize(std::make_shared<org::apache::nifi::minifi::Configure>());
+    // connection from compress processor to log attribute
+    std::shared_ptr<minifi::Connection> connection = std::make_shared<minifi::Connection>(repo, content_repo, "logattributeconnection");
+    connection->addRelationship(core::Relationship("success", "compress successful output"));
+    connection->setSource(processor);
+    connection->setDestination(logAttributeProcessor);
+    connection->setSourceUUID(processoruuid);
+    connection->setDestinationUUID(logAttributeuuid);
+    processor->addConnection(connection);
+    // connection to compress processor
+    std::shared_ptr<minifi::Connection> compressconnection = std::make_shared<minifi::Connection>(repo, content_repo, "compressconnection");
+    compressconnection->setDestination(processor);
+    compressconnection->setDestinationUUID(processoruuid);
+    processor->addConnection(compressconnection);
+
+    std::set<core::Relationship> autoTerminatedRelationships;
+    core::Relationship failure("failure", "");
+    autoTerminatedRelationships.insert(failure);
+    processor->setAutoTerminatedRelationships(autoTerminatedRelationships);
+
+    processor->incrementActiveTasks();
+    processor->setScheduledState(core::ScheduledState::RUNNING);
+    logAttributeProcessor->incrementActiveTasks();
+    logAttributeProcessor->setScheduledState(core::ScheduledState::RUNNING);
+
+    std::shared_ptr<core::ProcessorNode> node = std::make_shared<core::ProcessorNode>(processor);
+    std::shared_ptr<core::controller::ControllerServiceProvider> controller_services_provider = nullptr;
+    auto context = std::make_shared<core::ProcessContext>(node, controller_services_provider, repo, repo, content_repo);
+    context->setProperty(org::apache::nifi::minifi::processors::CompressContent::CompressMode, MODE_COMPRESS);
+    context->setProperty(org::apache::nifi::minifi::processors::CompressContent::CompressFormat, COMPRESSION_FORMAT_GZIP);
+    context->setProperty(org::apache::nifi::minifi::processors::CompressContent::CompressLevel, "9");
+    context->setProperty(org::apache::nifi::minifi::processors::CompressContent::UpdateFileName, "true");
+    context->setProperty(org::apache::nifi::minifi::processors::CompressContent::CompressThreads, "4");
+    context->setProperty(org::apache::nifi::minifi::processors::CompressContent::BlockSize, "16 KB");
+
+    core::ProcessSession sessionGenFlowFile(context);
+    std::shared_ptr<core::Connectable> income = node->getNextIncomingConnection();
+    std::shared_ptr<minifi::Connection> income_connection = std::static_pointer_cast<minifi::Connection>(income);
+    std::shared_ptr<core::FlowFile> flow = std::static_pointer_cast < core::FlowFile > (sessionGenFlowFile.create());
+    sessionGenFlowFile.import(EXPECT_COMPRESS_CONTENT, flow, true, 0);
+    income_connection->put(flow);
+
+    REQUIRE(processor->getName() == "compresscontent");
+    auto factory = std::make_shared<core::ProcessSessionFactory>(context);
+    processor->onSchedule(context, factory);
+    auto session = std::make_shared<core::ProcessSession>(context);
+    processor->onTrigger(context, session);
+    session->commit();
+
+    // validate the compress content
+    std::set<std::shared_ptr<core::FlowFile>> expiredFlowRecords;
+    std::shared_ptr<core::FlowFile> flow1 = connection->poll(expiredFlowRecords);
+    REQUIRE(flow1->getSize() > 0);
+    {
+      REQUIRE(flow1->getSize() != flow->getSize());
+      REQUIRE(LogTestController::getInstance().contains("gzip blocks of up to 16384 bytes"));
+      std::string mime;
+      flow1->getAttribute(FlowAttributeKey(org::apache::nifi::minifi::MIME_TYPE), mime);
+      REQUIRE(mime == "application/gzip");
+      ReadCallback callback(flow1->getSize());
+      sessionGenFlowFile.read(flow1, &callback);
+      callback.archive_read();
+      std::string flowFileName = std::string(EXPECT_COMPRESS_CONTENT);
+      std::ifstream file1;
+      file1.open(flowFileName, std::ios::in);
+      std::string contents((std::istreambuf_iterator<char>(file1)), std::istreambuf_iterator<char>());
+      std::string expectContents(reinterpret_cast<char *> (callback.archive_buffer_), callback.archive_buffer_size_);
+      REQUIRE(expectContents == contents);
+      file1.close();
+    }
+    LogTestController::getInstance().reset();
+  } catch (...) {
+  }
+}
+
+#if defined(LZ4_SUPPORT) || defined(ZSTD_SUPPORT)
+/**
+ * Runs a CompressContent with the given mode and format on flow and returns what it routed to success.
+ */
+static std::shared_ptr<core::FlowFile> runCompressContent(const std::shared_ptr<TestRepository> &repo, const std::shared_ptr<core::ContentRepository> &content_repo,
+                                                          const std::shared_ptr<core::FlowFile> &flow, const std::string &mode, const std::string &format, const std::string &threads) {
+  std::shared_ptr<core::Processor> processor = std::make_shared<org::apache::nifi::minifi::processors::CompressContent>("compresscontent");
+  processor->initialize();
+  utils::Identifier processoruuid;
+  REQUIRE(true == processor->getUUID(processoruuid));
+  std::shared_ptr<minifi::Connection> connection = std::make_shared<minifi::Connection>(repo, content_repo, "successconnection");
+  connection->addRelationship(core::Relationship("success", "compress successful output"));
+  connection->setSource(processor);
+  connection->setSourceUUID(processoruuid);
+  processor->addConnection(connection);
+  std::shared_ptr<minifi::Connection> compressconnection = std::make_shared<minifi::Connection>(repo, content_repo, "compressconnection");
+  compressconnection->setDestination(processor);
+  compressconnection->setDestinationUUID(processoruuid);
+  processor->addConnection(compressconnection);
+
+  std::set<core::Relationship> autoTerminatedRelationships;
+  autoTerminatedRelationships.insert(core::Relationship("failure", ""));
+  processor->setAutoTerminatedRelationships(autoTerminatedRelationships);
+  processor->incrementActiveTasks();
+  processor->setScheduledState(core::ScheduledState::RUNNING);
+
+  std::shared_ptr<core::ProcessorNode> node = std::make_shared<core::ProcessorNode>(processor);
+  std::shared_ptr<core::controller::ControllerServiceProvider> controller_services_provider = nullptr;
+  auto context = std::make_shared<core::ProcessContext>(node, controller_services_provider, repo, repo, content_repo);
+  context->setProperty(org::apache::nifi::minifi::processors::CompressContent::CompressMode, mode);
+  context->setProperty(org::apache::nifi::minifi::processors::CompressContent::CompressFormat, format);
+  context->setProperty(org::apache::nifi::minifi::processors::CompressContent::CompressLevel, "3");
+  context->setProperty(org::apache::nifi::minifi::processors::CompressContent::CompressThreads, threads);
+  compressconnection->put(flow);
+
+  auto factory = std::make_shared<core::ProcessSessionFactory>(context);
+  processor->onSchedule(context, factory);
+  auto session = std::make_shared<core::ProcessSession>(context);
+  processor->onTrigger(context, session);
+  session->commit();
+
+  std::set<std::shared_ptr<core::FlowFile>> expiredFlowRecords;
+  return connection->poll(expiredFlowRecords);
+}
+
+/**
+ * Compresses the expected content with format, decompresses the result and returns the content that came back.
+ */
+static std::string roundTrip(const std::string &format, const std::string &mime, const std::string &threads) {
+  std::shared_ptr<TestRepository> repo = std::make_shared<TestRepository>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(std::make_shared<org::apache::nifi::minifi::Configure>());
+  std::shared_ptr<core::ProcessorNode> node = std::make_shared<core::ProcessorNode>(std::make_shared<core::Processor>("generate"));
+  std::shared_ptr<core::controller::ControllerServiceProvider> controller_services_provider = nullptr;
+  core::ProcessSession sessionGenFlowFile(std::make_shared<core::ProcessContext>(node, controller_services_provider, repo, repo, content_repo));
+  std::shared_ptr<core::FlowFile> flow = std::static_pointer_cast < core::FlowFile > (sessionGenFlowFile.create());
+  sessionGenFlowFile.import(EXPECT_COMPRESS_CONTENT, flow, true, 0);
+
+  std::shared_ptr<core::FlowFile> compressed = runCompressContent(repo, content_repo, flow, MODE_COMPRESS, format, threads);
+  REQUIRE(compressed);
+  REQUIRE(compressed->getSize() > 0);
+  REQUIRE(compressed->getSize() < flow->getSize());
+  std::string compressedMime;
+  compressed->getAttribute(FlowAttributeKey(org::apache::nifi::minifi::MIME_TYPE), compressedMime);
+  REQUIRE(mime == compressedMime);
+
+  // the format is taken from the mime type, as a flow would
+  std::shared_ptr<core::FlowFile> decompressed = runCompressContent(repo, content_repo, compressed, MODE_DECOMPRESS, COMPRESSION_FORMAT_ATTRIBUTE, "1");
+  REQUIRE(decompressed);
+  ReadCallback callback(decompressed->getSize());
+  sessionGenFlowFile.read(decompressed, &callback);
+  return std::string(reinterpret_cast<char *>(callback.buffer_), decompressed->getSize());
+}
+
+static std::string writeExpectContent() {
+  std::ofstream expectfile;
+  expectfile.open(EXPECT_COMPRESS_CONTENT);
+  for (int i = 0; i < 100000; i++) {
+    expectfile << std::to_string(rand_r(&globalSeed)%100);
+  }
+  expectfile.close();
+  std::ifstream file1(EXPECT_COMPRESS_CONTENT, std::ios::in);
+  return std::string((std::istreambuf_iterator<char>(file1)), std::istreambuf_iterator<char>());
+}
+#endif
+
+#ifdef LZ4_SUPPORT
+TEST_CASE("CompressFileLZ4RoundTrip", "[compressfiletest10]") {
+  TestController testController;
+  std::string contents = writeExpectContent();
+  REQUIRE(contents == roundTrip(COMPRESSION_FORMAT_LZ4, "application/x-lz4", "1"));
+}
+#endif
+
+#ifdef ZSTD_SUPPORT
+TEST_CASE("CompressFileZstdRoundTrip", "[compressfiletest11]") {
+  TestController testController;
+  LogTestController::getInstance().setTrace<org::apache::nifi::minifi::processors::CompressContent>();
+  std::string contents = writeExpectContent();
+  REQUIRE(contents == roundTrip(COMPRESSION_FORMAT_ZSTD, "application/zstd", "1"));
+  // workers only change how the frame is produced, not what it decodes to
+  REQUIRE(contents == roundTrip(COMPRESSION_FORMAT_ZSTD, "application/zstd", "4"));
+  REQUIRE_FALSE(LogTestController::getInstance().contains("Compress Content processing fail"));
+  LogTestController::getInstance().reset();
+}
+#endif
@@ -112,3 +112,40 @@ TEST_CASE("Test GET Body", "[ListenHTTPGETBody]") {  // NOLINT
   std::string response_body(body_chars.data(), body_chars.size());
   REQUIRE("Hello response body\n" == response_body);
 }
+
+TEST_CASE("Test buffered POST", "[ListenHTTPBufferedPOST]") {  // NOLINT
+  TestController testController;
+
+  LogTestController::getInstance().setTrace<TestPlan>();
+  LogTestController::getInstance().setTrace<processors::ListenHTTP>();
+  LogTestController::getInstance().setTrace<processors::ListenHTTP::Handler>();
+
+  auto plan = testController.createPlan();
+  auto listen = plan->addProcessor("ListenHTTP", "ListenHTTP");
+  plan->setProperty(listen, "Listening Port", "0");
+  plan->setProperty(listen, "Buffer Size", "1");
+  listen->setAutoTerminatedRelationships({{"success", ""}});
+
+  plan->runNextProcessor();  // Listen, starts the server
+
+  auto raw_ptr = dynamic_cast<org::apache::nifi::minifi::processors::ListenHTTP*>(listen.get());
+  std::string protocol = std::string("http") + (raw_ptr->isSecure() ? "s" : "");
+  std::string portstr = raw_ptr->getPort();
+  REQUIRE(LogTestController::getInstance().contains("Listening on port " + portstr));
+
+  utils::HTTPClient client(protocol + "://localhost:" + portstr + "/contentListener");
+  client.set_request_method("POST");
+  client.setPostFields("buffered payload");
+  REQUIRE(client.submit());
+  REQUIRE(200 == client.getResponseCode());
+
+  // the buffer holds a single flow file until the processor commits it
+  utils::HTTPClient rejected(protocol + "://localhost:" + portstr + "/contentListener");
+  rejected.set_request_method("POST");
+  rejected.setPostFields("rejected payload");
+  rejected.submit();
+  REQUIRE(503 == rejected.getResponseCode());
+
+  plan->runCurrentProcessor();
+  REQUIRE(LogTestController::getInstance().contains("ListenHTTP committing 1 buffered FlowFiles"));
+}
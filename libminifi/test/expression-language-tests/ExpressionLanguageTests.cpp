@@ -567,6 +567,21 @@ TEST_CASE("Find 3", "[expressionLanguageFind3]") {  // NOLINT
   REQUIRE("true" == expr({flow_file_a}).asString());
 }
 
+TEST_CASE("Find Dynamic Pattern", "[expressionLanguageFindDynamicPattern]") {  // NOLINT
+  auto expr = expression::compile("${attr:find(${pattern})}");
+
+  auto flow_file_a = std::make_shared<MockFlowFile>();
+  flow_file_a->addAttribute("attr", "a brand new filename.txt");
+  flow_file_a->addAttribute("pattern", "[Bb]rand");
+  REQUIRE("true" == expr({flow_file_a}).asString());
+  REQUIRE("true" == expr({flow_file_a}).asString());
+
+  auto flow_file_b = std::make_shared<MockFlowFile>();
+  flow_file_b->addAttribute("attr", "a brand new filename.txt");
+  flow_file_b->addAttribute("pattern", "Brand");
+  REQUIRE("false" == expr({flow_file_b}).asString());
+}
+
 TEST_CASE("IndexOf", "[expressionLanguageIndexOf]") {  // NOLINT
   auto expr = expression::compile("${attr:indexOf('a.*txt')}");
 
@@ -1320,6 +1335,21 @@ TEST_CASE("UUID", "[expressionUuid]") {  // NOLINT
   REQUIRE(36 == expr({flow_file_a}).asString().length());
 }
 
+TEST_CASE("UUID Literal Arguments", "[expressionUuidLiteral]") {  // NOLINT
+  auto expr = expression::compile("${UUID():append('')}");
+
+  auto flow_file_a = std::make_shared<MockFlowFile>();
+  REQUIRE(expr({flow_file_a}).asString() != expr({flow_file_a}).asString());
+}
+
+TEST_CASE("Literal Folding", "[expressionLiteralFolding]") {  // NOLINT
+  auto expr = expression::compile("${literal(2):plus(3):toRadix(2)}-${attr:append(${literal('x'):toUpper()})}");
+
+  auto flow_file_a = std::make_shared<MockFlowFile>();
+  flow_file_a->addAttribute("attr", "a");
+  REQUIRE("101-aX" == expr({flow_file_a}).asString());
+}
+
 TEST_CASE("Trim", "[expressionTrim]") {  // NOLINT
   auto expr = expression::compile("${message:trim()}");
 
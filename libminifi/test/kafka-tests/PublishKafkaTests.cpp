@@ -0,0 +1,157 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <GenerateFlowFile.h>
+#include <LogAttribute.h>
+
+#include "../TestBase.h"
+#include "core/ProcessSessionFactory.h"
+
+#include "PublishKafka.h"
+
+namespace {
+
+// nothing listens on this port, so no message is ever acknowledged
+const char *UNREACHABLE_BROKER = "localhost:1";
+
+/**
+ * Builds Generate -> PublishKafka -> (failure) LogAttribute against a broker that cannot be reached.
+ */
+struct PublishPlan {
+  PublishPlan(TestController &testController, const std::string &flow_files, const std::string &message_timeout)
+      : plan_(testController.createPlan()) {
+    LogTestController::getInstance().setTrace<TestPlan>();
+    LogTestController::getInstance().setTrace<processors::PublishKafka>();
+    generate_ = plan_->addProcessor("GenerateFlowFile", "Generate");
+    plan_->setProperty(generate_, "Batch Size", flow_files);
+    plan_->setProperty(generate_, "File Size", "10 B");
+    publish_ = plan_->addProcessor("PublishKafka", "PublishKafka", core::Relationship("success", "description"), true);
+    publish_->setAutoTerminatedRelationships({ { "success", "" } });
+    plan_->setProperty(publish_, "Known Brokers", UNREACHABLE_BROKER);
+    plan_->setProperty(publish_, "Topic Name", "test");
+    plan_->setProperty(publish_, "Client Name", "minifi");
+    plan_->setProperty(publish_, "FlowFiles Per Trigger", "10");
+    plan_->setProperty(publish_, "message.timeout.ms", message_timeout, true);
+    failure_ = plan_->addProcessor("LogAttribute", "Failure", core::Relationship("failure", "description"), true);
+  }
+
+  std::function<void(const std::shared_ptr<core::ProcessContext>, const std::shared_ptr<core::ProcessSession>)> trigger() {
+    auto publish = publish_;
+    return [publish](const std::shared_ptr<core::ProcessContext> context, const std::shared_ptr<core::ProcessSession> session) {
+      publish->onTrigger(context, std::make_shared<core::ProcessSessionFactory>(context));
+    };
+  }
+
+  /**
+   * Triggers PublishKafka until its batches are routed or the timeout elapses.
+   */
+  bool completeBatches(std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (publish_->getTriggerWhenEmpty() && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      plan_->runCurrentProcessor(trigger());
+    }
+    return !publish_->getTriggerWhenEmpty();
+  }
+
+  /**
+   * Takes the flow files queued for the current processor.
+   */
+  static std::function<void(const std::shared_ptr<core::ProcessContext>, const std::shared_ptr<core::ProcessSession>)> count(size_t &queued) {
+    return [&queued](const std::shared_ptr<core::ProcessContext> context, const std::shared_ptr<core::ProcessSession> session) {
+      for (const auto &flow_file : session->get(100)) {
+        session->remove(flow_file);
+        queued++;
+      }
+    };
+  }
+
+  std::shared_ptr<TestPlan> plan_;
+  std::shared_ptr<core::Processor> generate_;
+  std::shared_ptr<core::Processor> publish_;
+  std::shared_ptr<core::Processor> failure_;
+};
+
+}  // namespace
+
+TEST_CASE("PublishKafka routes a batch once every message is reported", "[PublishKafkaBatch]") {
+  TestController testController;
+  PublishPlan publish_plan(testController, "3", "1000");
+
+  publish_plan.plan_->runNextProcessor();  // Generate
+  publish_plan.plan_->runNextProcessor(publish_plan.trigger());  // PublishKafka
+
+  // all three flow files went out with one trigger and wait for their reports in one batch
+  REQUIRE(publish_plan.publish_->getTriggerWhenEmpty());
+  REQUIRE(LogTestController::getInstance().contains("Produced flow with length 10 to kafka topic test"));
+
+  REQUIRE(publish_plan.completeBatches(std::chrono::seconds(10)));
+  REQUIRE(LogTestController::getInstance().contains("Kafka did not accept all messages of flow file"));
+
+  size_t failed = 0;
+  publish_plan.plan_->runNextProcessor(PublishPlan::count(failed));  // Failure
+  REQUIRE(3 == failed);
+  LogTestController::getInstance().reset();
+}
+
+TEST_CASE("PublishKafka routes a partially produced flow file to failure", "[PublishKafkaPartial]") {
+  TestController testController;
+  PublishPlan publish_plan(testController, "1", "1000");
+  // the producer queue holds one message, so only the first of the three segments is accepted
+  publish_plan.plan_->setProperty(publish_plan.publish_, "Max Flow Segment Size", "4");
+  publish_plan.plan_->setProperty(publish_plan.publish_, "Queue Max Message", "1");
+
+  publish_plan.plan_->runNextProcessor();  // Generate
+  publish_plan.plan_->runNextProcessor(publish_plan.trigger());  // PublishKafka
+  REQUIRE(LogTestController::getInstance().contains("Failed to send flow to kafka topic test"));
+  // the segment that was accepted is still outstanding
+  REQUIRE(publish_plan.publish_->getTriggerWhenEmpty());
+
+  REQUIRE(publish_plan.completeBatches(std::chrono::seconds(10)));
+
+  size_t failed = 0;
+  publish_plan.plan_->runNextProcessor(PublishPlan::count(failed));  // Failure
+  REQUIRE(1 == failed);
+  LogTestController::getInstance().reset();
+}
+
+TEST_CASE("PublishKafka rolls back the batches pending when stopped", "[PublishKafkaStop]") {
+  TestController testController;
+  PublishPlan publish_plan(testController, "2", "60000");
+
+  publish_plan.plan_->runNextProcessor();  // Generate
+  publish_plan.plan_->runNextProcessor(publish_plan.trigger());  // PublishKafka
+  REQUIRE(publish_plan.publish_->getTriggerWhenEmpty());
+
+  publish_plan.publish_->setScheduledState(core::ScheduledState::STOPPED);
+  REQUIRE(LogTestController::getInstance().contains("1 batches were not delivered to Kafka before stopping, rolling them back"));
+  REQUIRE_FALSE(publish_plan.publish_->getTriggerWhenEmpty());
+
+  // the flow files are back in the incoming connection rather than routed
+  size_t queued = 0;
+  publish_plan.plan_->runCurrentProcessor(PublishPlan::count(queued));
+  REQUIRE(2 == queued);
+  size_t failed = 0;
+  publish_plan.plan_->runNextProcessor(PublishPlan::count(failed));  // Failure
+  REQUIRE(0 == failed);
+  LogTestController::getInstance().reset();
+}
@@ -0,0 +1,117 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../TestBase.h"
+#include "ConsumeMQTT.h"
+
+namespace {
+
+// allocated like the messages of the MQTT client, since the processor frees them with MQTTClient_freeMessage
+MQTTClient_message *createMessage(const std::string &payload, int qos) {
+  MQTTClient_message initializer = MQTTClient_message_initializer;
+  auto message = static_cast<MQTTClient_message*>(malloc(sizeof(MQTTClient_message)));
+  *message = initializer;
+  message->payload = malloc(payload.length());
+  memcpy(message->payload, payload.data(), payload.length());
+  message->payloadlen = payload.length();
+  message->qos = qos;
+  return message;
+}
+
+/**
+ * Exposes the batching of ConsumeMQTT without a broker.
+ */
+class TestConsumeMQTT : public processors::ConsumeMQTT {
+ public:
+  explicit TestConsumeMQTT(const std::string &name)
+      : ConsumeMQTT(name) {
+  }
+
+  // does not create a client, so no broker is contacted
+  void onSchedule(core::ProcessContext *context, core::ProcessSessionFactory *sessionFactory) {
+  }
+
+  void transfer(const std::shared_ptr<core::ProcessSession> &session, std::deque<ReceivedMessage> &msg_queue) {
+    transferBatch(session, msg_queue);
+  }
+};
+
+}  // namespace
+
+TEST_CASE("ConsumeMQTT appends length prefixed records", "[ConsumeMQTTRecord]") {
+  MQTTClient_message *message = createMessage("abc", 1);
+  std::vector<uint8_t> buffer;
+  processors::ConsumeMQTT::appendRecord(buffer, "t/1", message);
+  std::vector<uint8_t> expected = { 0, 3, 't', '/', '1', 1, 0, 0, 0, 3, 'a', 'b', 'c' };
+  REQUIRE(expected == buffer);
+
+  // records follow each other without a separator
+  processors::ConsumeMQTT::appendRecord(buffer, "", message);
+  std::vector<uint8_t> second = { 0, 0, 1, 0, 0, 0, 3, 'a', 'b', 'c' };
+  expected.insert(expected.end(), second.begin(), second.end());
+  REQUIRE(expected == buffer);
+  MQTTClient_freeMessage(&message);
+}
+
+TEST_CASE("ConsumeMQTT unescapes the message demarcator", "[ConsumeMQTTDemarcator]") {
+  REQUIRE("\n" == processors::ConsumeMQTT::unescapeDemarcator("\\n"));
+  REQUIRE("a\r\nb\t" == processors::ConsumeMQTT::unescapeDemarcator("a\\r\\nb\\t"));
+  REQUIRE("\\" == processors::ConsumeMQTT::unescapeDemarcator("\\\\"));
+  REQUIRE("\\n" == processors::ConsumeMQTT::unescapeDemarcator("\\\\n"));
+  // unknown escapes and a trailing backslash are kept as they are
+  REQUIRE("\\x|\\" == processors::ConsumeMQTT::unescapeDemarcator("\\x|\\"));
+  REQUIRE("" == processors::ConsumeMQTT::unescapeDemarcator(""));
+}
+
+TEST_CASE("ConsumeMQTT starts a demarcated flow file when the topic or QoS changes", "[ConsumeMQTTDemarcated]") {
+  TestController testController;
+  LogTestController::getInstance().setDebug<processors::ConsumeMQTT>();
+  auto plan = testController.createPlan();
+  auto consume = std::make_shared<TestConsumeMQTT>("ConsumeMQTT");
+  plan->addProcessor(consume, "ConsumeMQTT");
+
+  // batches are packed as in the Demarcated mode unless the Records mode is configured
+  std::deque<processors::ConsumeMQTT::ReceivedMessage> msg_queue;
+  msg_queue.push_back({ "t/1", createMessage("a", 0) });
+  msg_queue.push_back({ "t/1", createMessage("b", 0) });
+  msg_queue.push_back({ "t/2", createMessage("c", 0) });
+  msg_queue.push_back({ "t/2", createMessage("d", 1) });
+
+  plan->runNextProcessor([&](const std::shared_ptr<core::ProcessContext> context, const std::shared_ptr<core::ProcessSession> session) {
+    while (!msg_queue.empty()) {
+      consume->transfer(session, msg_queue);
+    }
+  });
+
+  REQUIRE(LogTestController::getInstance().contains("ConsumeMQTT packed 2 messages"));
+  size_t created = 0;
+  for (const auto &event : plan->getProvenanceRecords()) {
+    if (event->getEventType() == provenance::ProvenanceEventRecord::CREATE) {
+      created++;
+    }
+  }
+  REQUIRE(3 == created);
+  LogTestController::getInstance().reset();
+}
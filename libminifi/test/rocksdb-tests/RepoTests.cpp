@@ -21,6 +21,7 @@
 #include <chrono>
 #include <thread>
 #include <map>
+#include <set>
 #include "../unit/ProvenanceTestHelper.h"
 #include "provenance/Provenance.h"
 #include "FlowFileRecord.h"
@@ -251,3 +252,166 @@ TEST_CASE("Test Validate Checkpoint ", "[TestFFR5]") {
   LogTestController::getInstance().reset();
 }
 
+
+TEST_CASE("Test Repo MultiPut", "[TestFFR6]") {
+  LogTestController::getInstance().setDebug<core::repository::FlowFileRepository>();
+  TestController testController;
+  char format[] = "/tmp/testRepo.XXXXXX";
+  char *dir = testController.createTempDirectory(format);
+  std::shared_ptr<core::repository::FlowFileRepository> repository = std::make_shared<core::repository::FlowFileRepository>("ff", dir, 0, 0, 1);
+
+  auto configuration = std::make_shared<org::apache::nifi::minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_flowfile_repository_sync_writes, "true");
+  repository->initialize(configuration);
+
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  std::vector<std::string> uuids;
+  std::vector<std::pair<std::string, std::unique_ptr<minifi::io::DataStream>>> flowData;
+  for (int i = 0; i < 10; i++) {
+    minifi::FlowFileRecord record(repository, content_repo);
+    record.addAttribute("index", std::to_string(i));
+    std::unique_ptr<minifi::io::DataStream> stream(new minifi::io::DataStream());
+    REQUIRE(true == record.Serialize(*stream));
+    uuids.push_back(record.getUUIDStr());
+    flowData.emplace_back(record.getUUIDStr(), std::move(stream));
+  }
+
+  REQUIRE(true == repository->MultiPut(flowData));
+  REQUIRE(0 < repository->getRepoSize());
+
+  repository->stop();
+
+  for (int i = 0; i < 10; i++) {
+    minifi::FlowFileRecord record(repository, content_repo);
+    REQUIRE(true == record.DeSerialize(uuids[i]));
+    std::string value;
+    REQUIRE(true == record.getAttribute("index", value));
+    REQUIRE(std::to_string(i) == value);
+  }
+
+  utils::file::FileUtils::delete_dir(FLOWFILE_CHECKPOINT_DIRECTORY, true);
+
+  LogTestController::getInstance().reset();
+}
+
+TEST_CASE("Test Repo Delta Records", "[TestFFR7]") {
+  TestController testController;
+  char format[] = "/tmp/testRepo.XXXXXX";
+  char *dir = testController.createTempDirectory(format);
+  std::shared_ptr<core::repository::FlowFileRepository> repository = std::make_shared<core::repository::FlowFileRepository>("ff", dir, 0, 0, 1);
+
+  auto configuration = std::make_shared<org::apache::nifi::minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_flowfile_repository_max_deltas, "2");
+  repository->initialize(configuration);
+
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  minifi::FlowFileRecord record(repository, content_repo);
+  std::string uuid = record.getUUIDStr();
+  for (int i = 0; i < 40; i++) {
+    record.addAttribute("key" + std::to_string(i), "value" + std::to_string(i));
+  }
+  record.setUuidConnection("first");
+  REQUIRE(true == record.Serialize());
+  std::string full;
+  REQUIRE(true == repository->Get(uuid, full));
+
+  // every following hop only changes the connection and a few attributes
+  for (int hop = 0; hop < 5; hop++) {
+    record.setUuidConnection("hop" + std::to_string(hop));
+    record.updateAttribute("key0", "hop" + std::to_string(hop));
+    record.removeAttribute("key" + std::to_string(hop + 1));
+    REQUIRE(true == record.Serialize());
+
+    minifi::FlowFileRecord stored(repository, content_repo);
+    REQUIRE(true == stored.DeSerialize(uuid));
+    REQUIRE("hop" + std::to_string(hop) == stored.getConnectionUuid());
+    REQUIRE(record.getAttributes() == stored.getAttributes());
+  }
+  REQUIRE(repository->getRepoSize() < 3 * full.size());
+
+  repository->stop();
+
+  utils::file::FileUtils::delete_dir(FLOWFILE_CHECKPOINT_DIRECTORY, true);
+}
+
+TEST_CASE("Test Repo Delta Records Restore", "[TestFFR8]") {
+  TestController testController;
+  utils::file::FileUtils::delete_dir(FLOWFILE_CHECKPOINT_DIRECTORY, true);
+  char format[] = "/tmp/testRepo.XXXXXX";
+  char *dir = testController.createTempDirectory(format);
+
+  auto configuration = std::make_shared<org::apache::nifi::minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_flowfile_repository_max_deltas, "3");
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+
+  std::string uuid;
+  {
+    std::shared_ptr<core::repository::FlowFileRepository> repository = std::make_shared<core::repository::FlowFileRepository>("ff", dir, 0, 0, 1);
+    repository->initialize(configuration);
+    minifi::FlowFileRecord record(repository, content_repo);
+    uuid = record.getUUIDStr();
+    for (int i = 0; i < 20; i++) {
+      record.addAttribute("key" + std::to_string(i), "value" + std::to_string(i));
+    }
+    record.setUuidConnection("first");
+    REQUIRE(true == record.Serialize());
+    std::string full;
+    REQUIRE(true == repository->Get(uuid, full));
+    REQUIRE(full.size() == repository->getRepoSize());
+
+    // two hops are stored as deltas
+    for (int hop = 0; hop < 2; hop++) {
+      record.setUuidConnection("hop" + std::to_string(hop));
+      record.updateAttribute("key0", "hop" + std::to_string(hop));
+      record.removeAttribute("key" + std::to_string(hop + 1));
+      REQUIRE(true == record.Serialize());
+    }
+    REQUIRE(full.size() < repository->getRepoSize());
+    REQUIRE(repository->getRepoSize() < 2 * full.size());
+    repository->stop();
+  }
+
+  // recovery replays the deltas onto the full record
+  std::shared_ptr<core::repository::FlowFileRepository> repository = std::make_shared<core::repository::FlowFileRepository>("ff", dir, 0, 0, 1);
+  repository->initialize(configuration);
+  std::shared_ptr<minifi::Connection> connection = std::make_shared<minifi::Connection>(repository, content_repo, "hop1");
+  std::map<std::string, std::shared_ptr<core::Connectable>> connectionMap;
+  connectionMap["hop1"] = connection;
+  repository->setConnectionMap(connectionMap);
+  repository->loadComponent(content_repo);
+  repository->start();
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  repository->stop();
+
+  REQUIRE(1 == connection->getQueueSize());
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  auto restored = std::static_pointer_cast<minifi::FlowFileRecord>(connection->poll(expired));
+  REQUIRE(uuid == restored->getUUIDStr());
+  REQUIRE("hop1" == restored->getConnectionUuid());
+  std::string value;
+  REQUIRE(true == restored->getAttribute("key0", value));
+  REQUIRE("hop1" == value);
+  REQUIRE(false == restored->getAttribute("key1", value));
+  REQUIRE(false == restored->getAttribute("key2", value));
+  REQUIRE(true == restored->getAttribute("key3", value));
+  REQUIRE("value3" == value);
+
+  // the next hop continues from the recovered deltas
+  restored->setUuidConnection("hop2");
+  restored->updateAttribute("key0", "hop2");
+  REQUIRE(true == restored->Serialize());
+  minifi::FlowFileRecord stored(repository, content_repo);
+  REQUIRE(true == stored.DeSerialize(uuid));
+  REQUIRE("hop2" == stored.getConnectionUuid());
+  REQUIRE(true == stored.getAttribute("key0", value));
+  REQUIRE("hop2" == value);
+
+  // the one after it rewrites the full record, which releases the recovered record and its deltas
+  restored->setUuidConnection("hop3");
+  REQUIRE(true == restored->Serialize());
+  std::string full;
+  REQUIRE(true == repository->Get(uuid, full));
+  REQUIRE(full.size() == repository->getRepoSize());
+
+  utils::file::FileUtils::delete_dir(FLOWFILE_CHECKPOINT_DIRECTORY, true);
+}
@@ -17,10 +17,13 @@
  */
 
 #include <uuid/uuid.h>
+#include <algorithm>
 #include <fstream>
 #include <map>
 #include <memory>
 #include <set>
+#include <string>
+#include <vector>
 #include <iostream>
 #include <GenerateFlowFile.h>
 #include <UpdateAttribute.h>
@@ -471,3 +474,282 @@ TEST_CASE("Test Exec 3", "[ExecuteSQL3]") {  // NOLINT
   // Verify output state
   REQUIRE(LogTestController::getInstance().contains("key:text_col value:bbbb"));
 }
+
+TEST_CASE("Test Put Batch", "[PutSQLPutBatch]") {  // NOLINT
+  TestController testController;
+
+  LogTestController::getInstance().setTrace<TestPlan>();
+  LogTestController::getInstance().setTrace<processors::GenerateFlowFile>();
+  LogTestController::getInstance().setTrace<processors::PutSQL>();
+
+  auto plan = testController.createPlan();
+  auto repo = std::make_shared<TestRepository>();
+
+  // Define directory for test db
+  std::string test_dir("/tmp/gt.XXXXXX");
+  REQUIRE(testController.createTempDirectory(&test_dir[0]) != nullptr);
+
+  // Define test db file
+  std::string test_db(test_dir);
+  test_db.append("/test.db");
+
+  // Create test db
+  {
+    minifi::sqlite::SQLiteConnection db(test_db);
+    auto stmt = db.prepare("CREATE TABLE test_table (int_col INTEGER, text_col TEXT);");
+    stmt.step();
+    REQUIRE(stmt.is_ok());
+  }
+
+  // Build MiNiFi processing graph
+  auto generate = plan->addProcessor(
+      "GenerateFlowFile",
+      "Generate");
+  plan->setProperty(
+      generate,
+      "Batch Size",
+      "5");
+  auto put = plan->addProcessor(
+      "PutSQL",
+      "PutSQL",
+      core::Relationship("success", "description"),
+      true);
+  plan->setProperty(
+      put,
+      "Connection URL",
+      "sqlite://" + test_db);
+  plan->setProperty(
+      put,
+      "SQL Statement",
+      "INSERT INTO test_table (int_col, text_col) VALUES (42, 'asdf')");
+  plan->setProperty(
+      put,
+      "Batch Size",
+      "10");
+  plan->setProperty(
+      put,
+      "Enable WAL",
+      "true");
+
+  plan->runNextProcessor();  // Generate
+  plan->runNextProcessor();  // PutSQL
+
+  REQUIRE(LogTestController::getInstance().contains("Processed 5 in batch"));
+
+  // Verify output state
+  {
+    minifi::sqlite::SQLiteConnection db(test_db);
+    auto stmt = db.prepare("SELECT COUNT(*), SUM(int_col) FROM test_table WHERE text_col = 'asdf';");
+    stmt.step();
+    REQUIRE(stmt.is_ok());
+    REQUIRE(5 == stmt.column_int64(0));
+    REQUIRE(210 == stmt.column_int64(1));
+
+    auto journal_mode = db.prepare("PRAGMA journal_mode;");
+    journal_mode.step();
+    REQUIRE(journal_mode.is_ok());
+    REQUIRE("wal" == journal_mode.column_text(0));
+  }
+}
+
+namespace {
+
+/**
+ * Routes the given relationship of processor to a connection without a destination, so the test can poll it.
+ */
+std::shared_ptr<minifi::Connection> addOutput(const std::shared_ptr<TestPlan> &plan, const std::shared_ptr<core::Processor> &processor, const std::string &relationship) {
+  auto connection = std::make_shared<minifi::Connection>(plan->getFlowRepo(), plan->getContentRepo(), processor->getName() + "-" + relationship);
+  connection->addRelationship(core::Relationship(relationship, "description"));
+  connection->setSource(processor);
+  utils::Identifier uuid;
+  processor->getUUID(uuid);
+  connection->setSourceUUID(uuid);
+  processor->addConnection(connection);
+  return connection;
+}
+
+/**
+ * Creates one flow file per value, carrying it as the first SQL argument.
+ */
+std::function<void(const std::shared_ptr<core::ProcessContext>, const std::shared_ptr<core::ProcessSession>)> generate(const std::vector<std::string> &values) {
+  return [values](const std::shared_ptr<core::ProcessContext> context, const std::shared_ptr<core::ProcessSession> session) {
+    for (const auto &value : values) {
+      auto flow_file = session->create();
+      session->putAttribute(flow_file, "sql.args.1.value", value);
+      session->transfer(flow_file, core::Relationship("success", "description"));
+    }
+  };
+}
+
+/**
+ * Takes the flow files queued for the current processor and collects their first SQL argument, sorted.
+ */
+std::function<void(const std::shared_ptr<core::ProcessContext>, const std::shared_ptr<core::ProcessSession>)> collect(std::vector<std::string> &values) {
+  return [&values](const std::shared_ptr<core::ProcessContext> context, const std::shared_ptr<core::ProcessSession> session) {
+    while (auto flow_file = session->get()) {
+      std::string value;
+      flow_file->getAttribute("sql.args.1.value", value);
+      values.push_back(value);
+      session->remove(flow_file);
+    }
+    std::sort(values.begin(), values.end());
+  };
+}
+
+std::vector<std::string> drain(const std::shared_ptr<minifi::Connection> &connection) {
+  std::vector<std::string> values;
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  while (auto flow_file = connection->poll(expired)) {
+    std::string value;
+    flow_file->getAttribute("sql.args.1.value", value);
+    values.push_back(value);
+  }
+  std::sort(values.begin(), values.end());
+  return values;
+}
+
+}  // namespace
+
+TEST_CASE("Test Put Batch With Failing Statement", "[PutSQLPutBatchFailure]") {  // NOLINT
+  TestController testController;
+
+  LogTestController::getInstance().setTrace<TestPlan>();
+  LogTestController::getInstance().setTrace<processors::PutSQL>();
+
+  auto plan = testController.createPlan();
+
+  std::string test_dir("/tmp/gt.XXXXXX");
+  REQUIRE(testController.createTempDirectory(&test_dir[0]) != nullptr);
+  std::string test_db(test_dir);
+  test_db.append("/test.db");
+
+  {
+    minifi::sqlite::SQLiteConnection db(test_db);
+    auto stmt = db.prepare("CREATE TABLE test_table (int_col INTEGER UNIQUE);");
+    stmt.step();
+    REQUIRE(stmt.is_ok());
+  }
+
+  plan->addProcessor("GenerateFlowFile", "Generate");
+  auto put = plan->addProcessor("PutSQL", "PutSQL", core::Relationship("success", "description"), true);
+  plan->setProperty(put, "Connection URL", "sqlite://" + test_db);
+  plan->setProperty(put, "SQL Statement", "INSERT INTO test_table (int_col) VALUES (?)");
+  plan->setProperty(put, "Batch Size", "10");
+  plan->addProcessor("LogAttribute", "Success", core::Relationship("success", "description"), true);
+  auto failure = addOutput(plan, put, "failure");
+  auto retry = addOutput(plan, put, "retry");
+
+  plan->runNextProcessor(generate({ "1", "2", "2", "3" }));  // Generate
+  plan->runNextProcessor();  // PutSQL
+
+  // the duplicate is rolled back to its savepoint, the rest of the batch is committed
+  REQUIRE(LogTestController::getInstance().contains("Processed 4 in batch"));
+  {
+    minifi::sqlite::SQLiteConnection db(test_db);
+    auto stmt = db.prepare("SELECT COUNT(*), SUM(int_col) FROM test_table;");
+    stmt.step();
+    REQUIRE(stmt.is_ok());
+    REQUIRE(3 == stmt.column_int64(0));
+    REQUIRE(6 == stmt.column_int64(1));
+  }
+
+  REQUIRE(std::vector<std::string>{ "2" } == drain(failure));
+  REQUIRE(drain(retry).empty());
+  std::vector<std::string> succeeded;
+  plan->runNextProcessor(collect(succeeded));  // Success
+  REQUIRE((std::vector<std::string>{ "1", "2", "3" } == succeeded));
+  LogTestController::getInstance().reset();
+}
+
+TEST_CASE("Test Put Batch With Failing Commit", "[PutSQLPutBatchRetry]") {  // NOLINT
+  TestController testController;
+
+  LogTestController::getInstance().setTrace<TestPlan>();
+  LogTestController::getInstance().setTrace<processors::PutSQL>();
+
+  auto plan = testController.createPlan();
+
+  std::string test_dir("/tmp/gt.XXXXXX");
+  REQUIRE(testController.createTempDirectory(&test_dir[0]) != nullptr);
+  std::string test_db(test_dir);
+  test_db.append("/test.db");
+
+  minifi::sqlite::SQLiteConnection reader(test_db);
+  {
+    auto stmt = reader.prepare("CREATE TABLE test_table (int_col INTEGER);");
+    stmt.step();
+    REQUIRE(stmt.is_ok());
+  }
+
+  plan->addProcessor("GenerateFlowFile", "Generate");
+  auto put = plan->addProcessor("PutSQL", "PutSQL", core::Relationship("success", "description"), true);
+  plan->setProperty(put, "Connection URL", "sqlite://" + test_db);
+  plan->setProperty(put, "SQL Statement", "INSERT INTO test_table (int_col) VALUES (?)");
+  plan->setProperty(put, "Batch Size", "10");
+  plan->addProcessor("LogAttribute", "Success", core::Relationship("success", "description"), true);
+  auto failure = addOutput(plan, put, "failure");
+  auto retry = addOutput(plan, put, "retry");
+
+  // an open read transaction keeps the journal from being committed, although every statement succeeds
+  reader.begin();
+  {
+    auto stmt = reader.prepare("SELECT COUNT(*) FROM test_table;");
+    stmt.step();
+    REQUIRE(stmt.is_row());
+  }
+
+  plan->runNextProcessor(generate({ "1", "2", "3" }));  // Generate
+  plan->runNextProcessor();  // PutSQL
+
+  REQUIRE_FALSE(LogTestController::getInstance().contains("Processed 3 in batch"));
+  reader.rollback();
+  {
+    auto stmt = reader.prepare("SELECT COUNT(*) FROM test_table;");
+    stmt.step();
+    REQUIRE(stmt.is_row());
+    REQUIRE(0 == stmt.column_int64(0));
+  }
+
+  REQUIRE((std::vector<std::string>{ "1", "2", "3" } == drain(retry)));
+  REQUIRE(drain(failure).empty());
+  std::vector<std::string> succeeded;
+  plan->runNextProcessor(collect(succeeded));  // Success
+  REQUIRE(succeeded.empty());
+  LogTestController::getInstance().reset();
+}
+
+TEST_CASE("Test Statement Cache", "[SQLiteStatementCache]") {  // NOLINT
+  TestController testController;
+
+  // Define directory for test db
+  std::string test_dir("/tmp/gt.XXXXXX");
+  REQUIRE(testController.createTempDirectory(&test_dir[0]) != nullptr);
+
+  std::string test_db(test_dir);
+  test_db.append("/test.db");
+
+  minifi::sqlite::SQLiteConnection db(test_db);
+  db.set_statement_cache_size(2);
+
+  auto first = db.prepare_cached("SELECT ?;");
+  first->bind_text(1, "first");
+  first->step();
+  REQUIRE(first->is_row());
+  REQUIRE("first" == first->column_text(0));
+
+  // a cached statement comes back reset and without bindings
+  auto again = db.prepare_cached("SELECT ?;");
+  REQUIRE(first == again);
+  again->step();
+  REQUIRE(again->is_row());
+  REQUIRE(again->column_is_null(0));
+
+  db.prepare_cached("SELECT 1;");
+  db.prepare_cached("SELECT 2;");
+  REQUIRE(first != db.prepare_cached("SELECT ?;"));
+
+  db.begin();
+  REQUIRE(db.in_transaction());
+  db.rollback();
+  REQUIRE(!db.in_transaction());
+}
@@ -21,6 +21,7 @@
 #include "../../include/core/state/nodes/ProcessMetrics.h"
 #include "../../include/core/state/nodes/QueueMetrics.h"
 #include "../../include/core/state/nodes/RepositoryMetrics.h"
+#include "../../include/core/state/nodes/StatisticsNodes.h"
 #include "../../include/core/state/nodes/SystemMetrics.h"
 #include "../TestBase.h"
 #include "io/ClientSocket.h"
@@ -106,6 +107,89 @@ TEST_CASE("QueueMetricsTestConnections", "[c2m3]") {
   REQUIRE("1024" == queuedmax.value.to_string());
 }
 
+TEST_CASE("ConnectionStatisticsTestConnections", "[c2m6]") {
+  minifi::state::response::ConnectionStatistics metrics;
+
+  REQUIRE("ConnectionStatistics" == metrics.getName());
+
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  std::shared_ptr<minifi::Connection> connection = std::make_shared<minifi::Connection>(repo, content_repo, "testconnection");
+
+  metrics.addConnection(connection);
+
+  std::shared_ptr<core::FlowFile> flow = std::make_shared<minifi::FlowFileRecord>(repo, content_repo);
+  flow->setSize(42);
+  connection->put(flow);
+  std::shared_ptr<core::FlowFile> empty = std::make_shared<minifi::FlowFileRecord>(repo, content_repo);
+  connection->put(empty);
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  REQUIRE(nullptr != connection->poll(expired));
+
+  REQUIRE(1 == metrics.serialize().size());
+
+  minifi::state::response::SerializedResponseNode resp = metrics.serialize().at(0);
+
+  REQUIRE("testconnection" == resp.name);
+  REQUIRE(7 == resp.children.size());
+
+  REQUIRE("enqueued" == resp.children.at(0).name);
+  REQUIRE("2" == resp.children.at(0).value.to_string());
+  REQUIRE("enqueuedbytes" == resp.children.at(1).name);
+  REQUIRE("42" == resp.children.at(1).value.to_string());
+  REQUIRE("dequeued" == resp.children.at(2).name);
+  REQUIRE("1" == resp.children.at(2).value.to_string());
+  REQUIRE("dequeuedbytes" == resp.children.at(3).name);
+  REQUIRE("enqueuerate" == resp.children.at(4).name);
+  REQUIRE("dequeuerate" == resp.children.at(5).name);
+
+  minifi::state::response::SerializedResponseNode wait = resp.children.at(6);
+  REQUIRE("queuewaitmillis" == wait.name);
+  REQUIRE(5 == wait.children.size());
+  REQUIRE("p99" == wait.children.at(3).name);
+}
+
+TEST_CASE("ProcessorStatisticsTestProcessors", "[c2m7]") {
+  minifi::state::response::ProcessorStatistics metrics;
+
+  REQUIRE("ProcessorStatistics" == metrics.getName());
+  REQUIRE(0 == metrics.serialize().size());
+
+  std::shared_ptr<core::Processor> processor = std::make_shared<core::Processor>("testprocessor");
+  processor->getProcessorMetrics().recordTrigger(1000);
+  processor->getProcessorMetrics().recordTrigger(3000);
+  processor->getProcessorMetrics().recordIncoming(2, 100);
+  processor->getProcessorMetrics().recordOutgoing(1, 50);
+  metrics.addProcessor(processor);
+
+  REQUIRE(1 == metrics.serialize().size());
+
+  minifi::state::response::SerializedResponseNode resp = metrics.serialize().at(0);
+
+  REQUIRE("testprocessor" == resp.name);
+  REQUIRE(6 == resp.children.size());
+
+  REQUIRE("invocations" == resp.children.at(0).name);
+  REQUIRE("2" == resp.children.at(0).value.to_string());
+  REQUIRE("flowfilesin" == resp.children.at(1).name);
+  REQUIRE("2" == resp.children.at(1).value.to_string());
+  REQUIRE("bytesin" == resp.children.at(2).name);
+  REQUIRE("100" == resp.children.at(2).value.to_string());
+  REQUIRE("flowfilesout" == resp.children.at(3).name);
+  REQUIRE("1" == resp.children.at(3).value.to_string());
+  REQUIRE("bytesout" == resp.children.at(4).name);
+  REQUIRE("50" == resp.children.at(4).value.to_string());
+
+  minifi::state::response::SerializedResponseNode trigger = resp.children.at(5);
+  REQUIRE("ontriggernanos" == trigger.name);
+  REQUIRE("mean" == trigger.children.at(0).name);
+  REQUIRE("2000" == trigger.children.at(0).value.to_string());
+  REQUIRE("max" == trigger.children.at(4).name);
+  REQUIRE("3000" == trigger.children.at(4).value.to_string());
+}
+
 TEST_CASE("RepositorymetricsNoRepo", "[c2m4]") {
   minifi::state::response::RepositoryMetrics metrics;
 
@@ -16,6 +16,7 @@
  * limitations under the License.
  */
 #include "io/FileStream.h"
+#include "io/StreamSlice.h"
 #include <string>
 #include <vector>
 #include <iostream>
@@ -242,3 +243,33 @@ TEST_CASE("TestFileExceedSize", "[TestLoader]") {
 
   unlink(ss.str().c_str());
 }
+
+TEST_CASE("TestFileSlice", "[TestFiles]") {
+  TestController testController;
+  char format[] = "/tmp/gt.XXXXXX";
+  char *dir = testController.createTempDirectory(format);
+
+  std::stringstream ss;
+  ss << dir << "/" << "tstFile.ext";
+  std::string path = ss.str();
+  {
+    std::ofstream file(path);
+    file << "first\nsecond\nthird\n";
+  }
+
+  auto stream = std::make_shared<minifi::io::FileStream>(path, 0, false);
+  minifi::io::StreamSlice slice(stream, 6, 6);
+  REQUIRE(slice.getSize() == 6);
+
+  uint8_t buffer[64];
+  REQUIRE(slice.read(buffer, 64) == 6);
+  REQUIRE(std::string(reinterpret_cast<char*>(buffer), 6) == "second");
+  REQUIRE(slice.read(buffer, 64) == 0);
+
+  slice.seek(3);
+  std::vector<uint8_t> readBuffer;
+  REQUIRE(slice.readData(readBuffer, 64) == 3);
+  REQUIRE(std::string(readBuffer.begin(), readBuffer.end()) == "ond");
+
+  unlink(ss.str().c_str());
+}
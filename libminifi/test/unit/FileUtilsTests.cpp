@@ -132,3 +132,33 @@ TEST_CASE("TestFileUtils::get_executable_dir", "[TestGetExecutableDir]") {
   std::cerr << "Executable dir: " << executable_dir << std::endl;
   REQUIRE(FileUtils::get_parent_path(executable_path) == executable_dir);
 }
+
+TEST_CASE("TestFileUtils::copy_file_region", "[TestCopyFileRegion]") {
+  TestController testController;
+  char format[] = "/tmp/gt.XXXXXX";
+  std::string dir = testController.createTempDirectory(format);
+  std::string source = FileUtils::concat_path(dir, "source");
+  std::string dest = FileUtils::concat_path(dir, "dest");
+  std::string content;
+  for (int i = 0; i < 10000; i++) {
+    content += std::to_string(i) + "\n";
+  }
+  {
+    std::ofstream os(source, std::ios::binary);
+    os << content;
+  }
+
+  auto readDest = [&dest]() {
+    std::ifstream is(dest, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+  };
+
+  REQUIRE(FileUtils::copy_file_region(source, 0, content.size(), dest) == static_cast<int64_t>(content.size()));
+  REQUIRE(readDest() == content);
+
+  REQUIRE(FileUtils::copy_file_region(source, 100, 5000, dest) == 5000);
+  REQUIRE(readDest() == content.substr(100, 5000));
+
+  REQUIRE(FileUtils::copy_file_region(source, 0, content.size() + 1, dest) == -1);
+  REQUIRE(FileUtils::copy_file_region(FileUtils::concat_path(dir, "missing"), 0, 1, dest) == -1);
+}
@@ -0,0 +1,89 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+#include "../TestBase.h"
+#include "FlowFileRecord.h"
+
+namespace {
+
+std::shared_ptr<minifi::FlowFileRecord> createFlowFile(const std::map<std::string, std::string> &attributes = { }) {
+  return std::make_shared<minifi::FlowFileRecord>(nullptr, nullptr, attributes);
+}
+
+}  // namespace
+
+TEST_CASE("FlowFileUuidAttributeIsImplied", "[FFA1]") {
+  auto flow_file = createFlowFile({ { "uuid", "ignored" } });
+  std::string value;
+  REQUIRE(flow_file->getAttribute("uuid", value));
+  REQUIRE(flow_file->getUUIDStr() == value);
+  REQUIRE(flow_file->getUUIDStr() == flow_file->getAttributes()["uuid"]);
+  REQUIRE(!flow_file->addAttribute("uuid", "other"));
+  REQUIRE(!flow_file->removeAttribute("uuid"));
+
+  REQUIRE(flow_file->updateAttribute("uuid", "other"));
+  REQUIRE(flow_file->getAttribute("uuid", value));
+  REQUIRE("other" == value);
+  REQUIRE(flow_file->removeAttribute("uuid"));
+  REQUIRE(flow_file->getAttribute("uuid", value));
+  REQUIRE(flow_file->getUUIDStr() == value);
+}
+
+TEST_CASE("FlowFileInheritedAttributesAreCopiedOnWrite", "[FFA2]") {
+  auto parent = createFlowFile({ { "key", "value" } });
+  parent->setAttribute("alternate.identifier", "alternate");
+  auto child = createFlowFile();
+  child->setAttribute("flow.id", "flow");
+  child->inheritAttributes(*parent);
+  child->removeAttribute("alternate.identifier");
+
+  std::string value;
+  REQUIRE(child->getAttribute("key", value));
+  REQUIRE("value" == value);
+  REQUIRE(child->getAttribute("flow.id", value));
+  REQUIRE(!child->getAttribute("alternate.identifier", value));
+  REQUIRE(child->getUUIDStr() == child->getAttributes()["uuid"]);
+
+  child->setAttribute("key", "child");
+  REQUIRE(parent->getAttribute("key", value));
+  REQUIRE("value" == value);
+  REQUIRE(parent->getAttribute("alternate.identifier", value));
+  REQUIRE(!parent->getAttribute("flow.id", value));
+
+  parent->setAttribute("other", "parent");
+  REQUIRE(!child->getAttribute("other", value));
+}
+
+TEST_CASE("FlowFileAttributesPtrIsNotShared", "[FFA3]") {
+  auto parent = createFlowFile({ { "key", "value" } });
+  auto child = createFlowFile();
+  child->inheritAttributes(*parent);
+
+  std::map<std::string, std::string> *attributes = child->getAttributesPtr();
+  REQUIRE(child->getUUIDStr() == (*attributes)["uuid"]);
+  (*attributes)["key"] = "child";
+
+  std::string value;
+  REQUIRE(parent->getAttribute("key", value));
+  REQUIRE("value" == value);
+  REQUIRE(child->getAttribute("key", value));
+  REQUIRE("child" == value);
+}
@@ -0,0 +1,168 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../TestBase.h"
+#include "core/FlowFileQueue.h"
+#include "core/FlowFilePrioritizer.h"
+#include "FlowFileRecord.h"
+
+namespace {
+
+std::shared_ptr<core::FlowFile> createFlowFile(const std::map<std::string, std::string> &attributes = { }) {
+  return std::make_shared<minifi::FlowFileRecord>(nullptr, nullptr, attributes);
+}
+
+}  // namespace
+
+TEST_CASE("FlowFileQueueFifo", "[FFQ1]") {
+  core::FlowFileQueue queue;
+  auto first = createFlowFile();
+  auto second = createFlowFile();
+  queue.push(first);
+  queue.push(second);
+  REQUIRE(2 == queue.size());
+
+  std::shared_ptr<core::FlowFile> flow;
+  REQUIRE(queue.tryPop(flow));
+  REQUIRE(first == flow);
+  REQUIRE(queue.tryPop(flow));
+  REQUIRE(second == flow);
+  REQUIRE(!queue.tryPop(flow));
+  REQUIRE(queue.empty());
+}
+
+TEST_CASE("FlowFileQueuePenalizedDoesNotBlock", "[FFQ2]") {
+  core::FlowFileQueue queue;
+  auto penalized = createFlowFile();
+  penalized->setPenaltyExpiration(getTimeMillis() + 100);
+  auto ready = createFlowFile();
+  queue.push(penalized);
+  queue.push(ready);
+  REQUIRE(1 == queue.getPenalizedCount());
+
+  std::shared_ptr<core::FlowFile> flow;
+  REQUIRE(queue.tryPop(flow));
+  REQUIRE(ready == flow);
+  REQUIRE(!queue.tryPop(flow));
+  REQUIRE(!queue.isWorkAvailable());
+  REQUIRE(1 == queue.size());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  REQUIRE(queue.isWorkAvailable());
+  REQUIRE(queue.tryPop(flow));
+  REQUIRE(penalized == flow);
+  REQUIRE(queue.empty());
+  REQUIRE(0 == queue.getPenalizedCount());
+}
+
+TEST_CASE("FlowFileQueuePriorityAttribute", "[FFQ3]") {
+  core::FlowFileQueue queue;
+  queue.setPrioritizer(core::FlowFilePrioritizer::create("org.apache.nifi.prioritizer.PriorityAttributePrioritizer"));
+  auto none = createFlowFile();
+  auto text = createFlowFile( { { "priority", "abc" } });
+  auto ten = createFlowFile( { { "priority", "10" } });
+  auto two = createFlowFile( { { "priority", "2" } });
+  auto other_two = createFlowFile( { { "priority", "2" } });
+  queue.push(none);
+  queue.push(text);
+  queue.push(ten);
+  queue.push(two);
+  queue.push(other_two);
+
+  std::vector<std::shared_ptr<core::FlowFile>> expected { two, other_two, ten, text, none };
+  for (const auto &expected_flow : expected) {
+    std::shared_ptr<core::FlowFile> flow;
+    REQUIRE(queue.tryPop(flow));
+    REQUIRE(expected_flow == flow);
+  }
+  REQUIRE(queue.empty());
+}
+
+TEST_CASE("FlowFileQueueDrain", "[FFQ4]") {
+  core::FlowFileQueue queue;
+  queue.push(createFlowFile());
+  auto penalized = createFlowFile();
+  penalized->setPenaltyExpiration(getTimeMillis() + 60000);
+  queue.push(penalized);
+
+  std::vector<std::shared_ptr<core::FlowFile>> drained;
+  queue.drain(drained);
+  REQUIRE(2 == drained.size());
+  REQUIRE(queue.empty());
+  REQUIRE(0 == queue.getPenalizedCount());
+}
+
+TEST_CASE("FlowFileQueueConcurrentPutPoll", "[FFQ5]") {
+  core::FlowFileQueue queue;
+  const int producers = 4;
+  const int flows_per_producer = 1000;
+  std::atomic<int> consumed(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < producers; i++) {
+    threads.emplace_back([&queue]() {
+      for (int j = 0; j < flows_per_producer; j++) {
+        queue.push(createFlowFile());
+      }
+    });
+    threads.emplace_back([&queue, &consumed]() {
+      std::shared_ptr<core::FlowFile> flow;
+      while (consumed < producers * flows_per_producer) {
+        if (queue.tryPop(flow)) {
+          ++consumed;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  REQUIRE(producers * flows_per_producer == consumed);
+  REQUIRE(queue.empty());
+}
+
+TEST_CASE("FlowFileQueueBatchPop", "[FFQ6]") {
+  core::FlowFileQueue queue;
+  auto penalized = createFlowFile();
+  penalized->setPenaltyExpiration(getTimeMillis() + 60000);
+  queue.push(penalized);
+  for (int i = 0; i < 10; i++) {
+    auto flow = createFlowFile();
+    flow->setSize(10);
+    queue.push(flow);
+  }
+
+  std::vector<std::shared_ptr<core::FlowFile>> flows;
+  REQUIRE(4 == queue.tryPop(flows, 4, 0));
+  REQUIRE(4 == flows.size());
+  REQUIRE(7 == queue.size());
+
+  flows.clear();
+  REQUIRE(3 == queue.tryPop(flows, 100, 25));
+  REQUIRE(3 == flows.size());
+
+  flows.clear();
+  REQUIRE(3 == queue.tryPop(flows, 100, 0));
+  REQUIRE(1 == queue.size());
+  REQUIRE(0 == queue.tryPop(flows, 100, 0));
+}
@@ -19,6 +19,7 @@
 #include <string>
 #include <memory>
 #include <ctime>
+#include <unordered_set>
 #include "../TestBase.h"
 #include "utils/Id.h"
 
@@ -29,7 +30,7 @@ TEST_CASE("Test default is time", "[id]") {
   std::shared_ptr<utils::IdGenerator> generator = utils::IdGenerator::getIdGenerator();
   generator->initialize(std::make_shared<minifi::Properties>());
 
-  REQUIRE(true == LogTestController::getInstance().contains("Using uuid_generate_time implementation for uids."));
+  REQUIRE(true == LogTestController::getInstance().contains("Using time based implementation for uids."));
   LogTestController::getInstance().reset();
 }
 
@@ -43,7 +44,7 @@ TEST_CASE("Test time", "[id]") {
   std::shared_ptr<utils::IdGenerator> generator = utils::IdGenerator::getIdGenerator();
   generator->initialize(id_props);
 
-  REQUIRE(true == LogTestController::getInstance().contains("Using uuid_generate_time implementation for uids."));
+  REQUIRE(true == LogTestController::getInstance().contains("Using time based implementation for uids."));
   LogTestController::getInstance().reset();
 }
 
@@ -102,7 +103,7 @@ TEST_CASE("Test invalid", "[id]") {
   std::shared_ptr<utils::IdGenerator> generator = utils::IdGenerator::getIdGenerator();
   generator->initialize(id_props);
 
-  REQUIRE(true == LogTestController::getInstance().contains("Invalid value for uid.implementation (invalid). Using uuid_generate_time implementation for uids."));
+  REQUIRE(true == LogTestController::getInstance().contains("Invalid value for uid.implementation (invalid). Using time based implementation for uids."));
   LogTestController::getInstance().reset();
 }
 
@@ -199,3 +200,60 @@ TEST_CASE("Test Hex Device Segment 18 bits", "[id]") {
   REQUIRE(true == LogTestController::getInstance().contains("Using minifi uid prefix: 9af8"));
   LogTestController::getInstance().reset();
 }
+
+TEST_CASE("Test time based uuids are distinct and ordered", "[id]") {
+  TestController test_controller;
+
+  std::shared_ptr<minifi::Properties> id_props = std::make_shared<minifi::Properties>();
+  id_props->set("uid.implementation", "time");
+
+  std::shared_ptr<utils::IdGenerator> generator = utils::IdGenerator::getIdGenerator();
+  generator->initialize(id_props);
+
+  std::unordered_set<utils::Identifier, utils::IdentifierHash> generated;
+  uint64_t last_timestamp = 0;
+  for (int i = 0; i < 10000; i++) {
+    utils::Identifier uuid = generator->generate();
+    auto uid = uuid.toArray();
+    // version 1 and the RFC 4122 variant
+    REQUIRE(0x10 == (uid[6] & 0xF0));
+    REQUIRE(0x80 == (uid[8] & 0xC0));
+    uint64_t timestamp = (static_cast<uint64_t>(uid[6] & 0x0F) << 56) | (static_cast<uint64_t>(uid[7]) << 48) | (static_cast<uint64_t>(uid[4]) << 40) | (static_cast<uint64_t>(uid[5]) << 32)
+        | (static_cast<uint64_t>(uid[0]) << 24) | (static_cast<uint64_t>(uid[1]) << 16) | (static_cast<uint64_t>(uid[2]) << 8) | uid[3];
+    REQUIRE(timestamp > last_timestamp);
+    last_timestamp = timestamp;
+    REQUIRE(generated.insert(uuid).second);
+  }
+}
+
+TEST_CASE("Test identifier conversion and comparison", "[id]") {
+  const std::string text = "4a2b6c8e-1f3d-4e5a-8b7c-9d0e1f2a3b4c";
+  utils::Identifier uuid;
+  REQUIRE(uuid == nullptr);
+  REQUIRE("" == uuid.to_string());
+
+  uuid = text;
+  REQUIRE(uuid != nullptr);
+  REQUIRE(text == uuid.to_string());
+  REQUIRE(0x4a == uuid.toArray()[0]);
+  REQUIRE(0x4c == uuid.toArray()[15]);
+
+  utils::Identifier copy = uuid;
+  REQUIRE(uuid == copy);
+  REQUIRE(utils::IdentifierHash()(uuid) == utils::IdentifierHash()(copy));
+  REQUIRE(!(uuid < copy));
+
+  utils::Identifier other;
+  other = "4a2b6c8e-1f3d-4e5a-8b7c-9d0e1f2a3b4d";
+  REQUIRE(uuid != other);
+  REQUIRE(uuid < other);
+
+  // text that is not a uuid is kept as it is
+  utils::Identifier name;
+  name = "not-a-uuid";
+  REQUIRE(name != nullptr);
+  REQUIRE("not-a-uuid" == name.to_string());
+  utils::Identifier other_name;
+  other_name = "another-name";
+  REQUIRE(name != other_name);
+}
@@ -0,0 +1,79 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+#include "../TestBase.h"
+#include "utils/LatencyHistogram.h"
+
+TEST_CASE("LatencyHistogram is empty initially", "[histogram1]") {
+  utils::LatencyHistogram histogram;
+  REQUIRE(0 == histogram.getCount());
+  REQUIRE(0 == histogram.getMean());
+  REQUIRE(0 == histogram.getMax());
+  REQUIRE(0 == histogram.getPercentile(99));
+}
+
+TEST_CASE("LatencyHistogram reports small values exactly", "[histogram2]") {
+  utils::LatencyHistogram histogram;
+  for (uint64_t i = 1; i <= 4; i++) {
+    histogram.record(i);
+  }
+  REQUIRE(4 == histogram.getCount());
+  REQUIRE(10 == histogram.getSum());
+  REQUIRE(2 == histogram.getPercentile(50));
+  REQUIRE(4 == histogram.getPercentile(100));
+  REQUIRE(4 == histogram.getMax());
+}
+
+TEST_CASE("LatencyHistogram percentiles are within the bucket precision", "[histogram3]") {
+  utils::LatencyHistogram histogram;
+  for (uint64_t i = 1; i <= 10000; i++) {
+    histogram.record(i * 1000);
+  }
+  const uint64_t p50 = histogram.getPercentile(50);
+  REQUIRE(p50 >= 5000000);
+  REQUIRE(p50 <= 5000000 * 1.125);
+  const uint64_t p99 = histogram.getPercentile(99);
+  REQUIRE(p99 >= 9900000);
+  REQUIRE(p99 <= 10000000);
+  REQUIRE(10000000 == histogram.getPercentile(100));
+
+  histogram.record(std::numeric_limits<uint64_t>::max());
+  REQUIRE(std::numeric_limits<uint64_t>::max() == histogram.getMax());
+  REQUIRE(std::numeric_limits<uint64_t>::max() == histogram.getPercentile(100));
+}
+
+TEST_CASE("LatencyHistogram counts concurrent records", "[histogram4]") {
+  utils::LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&histogram]() {
+      for (uint64_t i = 0; i < 10000; i++) {
+        histogram.record(i);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  REQUIRE(40000 == histogram.getCount());
+  REQUIRE(9999 == histogram.getMax());
+}
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "../TestBase.h"
+#include "core/logging/AsyncSink.h"
 #include "core/logging/LoggerConfiguration.h"
 #include "spdlog/formatter.h"
 
@@ -96,3 +97,69 @@ TEST_CASE("TestLoggerConfiguration::initialize_namespaces", "[test initialize_na
   logTestController.resetStream(stdout);
   logTestController.resetStream(stderr);
 }
+
+TEST_CASE("TestLoggerConfiguration::initialize_namespaces with async appenders", "[test initialize_namespaces async]") {
+  TestController test_controller;
+  std::shared_ptr<logging::LoggerProperties> logger_properties = std::make_shared<logging::LoggerProperties>();
+
+  std::ostringstream stdout;
+  logger_properties->add_sink("stdout", std::make_shared<spdlog::sinks::ostream_sink_mt>(stdout, true));
+  logger_properties->set("logger.root", "INFO,stdout");
+  logger_properties->set("async.enabled", "true");
+  logger_properties->set("async.queue_size", "4");
+  logger_properties->set("async.overflow_policy", "block");
+
+  std::shared_ptr<logging::internal::LoggerNamespace> root_namespace = TestLoggerConfiguration::initialize_namespaces(logger_properties);
+  REQUIRE(1 == root_namespace->sinks.size());
+  REQUIRE(nullptr != std::dynamic_pointer_cast<logging::AsyncSink>(root_namespace->sinks.at(0)));
+
+  std::string name = "org::apache::nifi::minifi::fake::test::AsyncClass";
+  std::shared_ptr<spdlog::formatter> formatter = std::make_shared<spdlog::pattern_formatter>(logging::LoggerConfiguration::spdlog_default_pattern);
+  std::shared_ptr<spdlog::logger> logger = TestLoggerConfiguration::get_logger(root_namespace, name, formatter);
+  for (int i = 0; i < 100; i++) {
+    logger->info("Async log statement " + std::to_string(i));
+  }
+  // releasing the last reference to the sink drains its queue and stops the writer
+  spdlog::drop(name);
+  logger = nullptr;
+  root_namespace = nullptr;
+  logger_properties = nullptr;
+
+  const std::string output = stdout.str();
+  for (int i = 0; i < 100; i++) {
+    REQUIRE(output.find("Async log statement " + std::to_string(i) + "\n") != std::string::npos);
+  }
+}
+
+TEST_CASE("AsyncSink drops records when full", "[test async sink drop]") {
+  std::ostringstream stream;
+  auto delegate = std::make_shared<spdlog::sinks::ostream_sink_mt>(stream, true);
+  uint64_t dropped = 0;
+  {
+    auto sink = std::make_shared<logging::AsyncSink>(delegate, 2, logging::AsyncOverflowPolicy::DROP);
+    spdlog::logger logger("AsyncSinkDropTest", sink);
+    for (int i = 0; i < 10000; i++) {
+      logger.info("Dropped log statement");
+    }
+    dropped = sink->getDropped();
+  }
+  if (dropped > 0) {
+    REQUIRE(stream.str().find("log messages because the async log queue was full") != std::string::npos);
+  }
+}
+
+TEST_CASE("Disabled levels do not evaluate arguments", "[test log macros]") {
+  TestController test_controller;
+  LogTestController::getInstance().setInfo<logging::LoggerProperties>();
+  std::shared_ptr<logging::Logger> logger = logging::LoggerFactory<logging::LoggerProperties>::getLogger();
+  int evaluated = 0;
+  auto argument = [&evaluated]() {
+    evaluated++;
+    return std::string("argument");
+  };
+  LOG_DEBUG_F(logger, "%s", argument());
+  REQUIRE(0 == evaluated);
+  LOG_INFO_F(logger, "%s", argument());
+  REQUIRE(1 == evaluated);
+  LogTestController::getInstance().reset();
+}
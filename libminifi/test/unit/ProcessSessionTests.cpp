@@ -0,0 +1,139 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <memory>
+#include <string>
+#include <vector>
+#include "../TestBase.h"
+#include "ProvenanceTestHelper.h"
+#include "core/Processor.h"
+#include "core/ProcessContext.h"
+#include "core/ProcessSession.h"
+#include "core/ProcessorNode.h"
+#include "core/repository/VolatileContentRepository.h"
+
+namespace {
+
+class StringWriter : public minifi::OutputStreamCallback {
+ public:
+  explicit StringWriter(const std::string &content)
+      : content_(content) {
+  }
+
+  int64_t process(std::shared_ptr<minifi::io::BaseStream> stream) {
+    return stream->writeData(reinterpret_cast<uint8_t *>(const_cast<char *>(content_.data())), content_.size());
+  }
+
+ private:
+  std::string content_;
+};
+
+class StringReader : public minifi::InputStreamCallback {
+ public:
+  int64_t process(std::shared_ptr<minifi::io::BaseStream> stream) {
+    content_.clear();
+    uint8_t buffer[64];
+    int read;
+    while ((read = stream->readData(buffer, sizeof(buffer))) > 0) {
+      content_.append(reinterpret_cast<char *>(buffer), read);
+    }
+    return content_.size();
+  }
+
+  std::string content_;
+};
+
+std::string readContent(core::ProcessSession &session, const std::shared_ptr<core::FlowFile> &flow_file) {
+  StringReader reader;
+  session.read(flow_file, &reader);
+  return reader.content_;
+}
+
+struct Fixture {
+  Fixture()
+      : content_repo_(std::make_shared<core::repository::VolatileContentRepository>()),
+        repo_(std::make_shared<TestRepository>()) {
+    content_repo_->initialize(std::make_shared<minifi::Configure>());
+    auto processor = std::make_shared<core::Processor>("session");
+    auto node = std::make_shared<core::ProcessorNode>(processor);
+    std::shared_ptr<core::controller::ControllerServiceProvider> controller_services_provider = nullptr;
+    context_ = std::make_shared<core::ProcessContext>(node, controller_services_provider, repo_, repo_, content_repo_);
+  }
+
+  std::shared_ptr<core::ContentRepository> content_repo_;
+  std::shared_ptr<core::Repository> repo_;
+  std::shared_ptr<core::ProcessContext> context_;
+};
+
+}  // namespace
+
+TEST_CASE("Appending to a slice leaves its siblings alone", "[ProcessSessionAppend1]") {
+  TestController testController;
+  Fixture fixture;
+  core::ProcessSession session(fixture.context_);
+
+  auto parent = session.create();
+  StringWriter writer("firstsecond");
+  session.write(parent, &writer);
+  auto first = session.clone(parent, 0, 5);
+  auto second = session.clone(parent, 5, 6);
+  REQUIRE(first->getResourceClaim() == second->getResourceClaim());
+
+  StringWriter appended("+more");
+  session.append(first, &appended);
+
+  REQUIRE(first->getResourceClaim() != second->getResourceClaim());
+  REQUIRE(0 == first->getOffset());
+  REQUIRE(10 == first->getSize());
+  REQUIRE("first+more" == readContent(session, first));
+  REQUIRE("second" == readContent(session, second));
+  REQUIRE("firstsecond" == readContent(session, parent));
+}
+
+TEST_CASE("Appending to a whole shared claim leaves the other owner alone", "[ProcessSessionAppend2]") {
+  TestController testController;
+  Fixture fixture;
+  core::ProcessSession session(fixture.context_);
+
+  auto parent = session.create();
+  StringWriter writer("content");
+  session.write(parent, &writer);
+  auto child = session.clone(parent);
+
+  StringWriter appended("+more");
+  session.append(child, &appended);
+
+  REQUIRE("content+more" == readContent(session, child));
+  REQUIRE("content" == readContent(session, parent));
+}
+
+TEST_CASE("Appending to an owned claim appends in place", "[ProcessSessionAppend3]") {
+  TestController testController;
+  Fixture fixture;
+  core::ProcessSession session(fixture.context_);
+
+  auto flow_file = session.create();
+  StringWriter writer("content");
+  session.write(flow_file, &writer);
+  auto claim = flow_file->getResourceClaim();
+
+  StringWriter appended("+more");
+  session.append(flow_file, &appended);
+
+  REQUIRE(claim == flow_file->getResourceClaim());
+  REQUIRE("content+more" == readContent(session, flow_file));
+}
@@ -0,0 +1,146 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <set>
+#include <string>
+#include "../TestBase.h"
+#include "ProvenanceTestHelper.h"
+#include "Connection.h"
+#include "core/Processor.h"
+#include "core/ProcessContext.h"
+#include "core/ProcessSession.h"
+#include "core/ProcessSessionFactory.h"
+#include "core/ProcessorNode.h"
+#include "core/repository/VolatileContentRepository.h"
+
+namespace {
+
+const core::Relationship Success("success", "description");
+
+/**
+ * Takes one flow file per trigger from its incoming connection, or yields after yield_after triggers
+ * when it has none.
+ */
+class CountingProcessor : public core::Processor {
+ public:
+  explicit CountingProcessor(const std::string &name)
+      : Processor(name),
+        triggers_(0),
+        yield_after_(0) {
+  }
+
+  using core::Processor::onTrigger;
+
+  virtual void initialize() {
+    setSupportedRelationships({ Success });
+  }
+
+  virtual void onTrigger(core::ProcessContext *context, core::ProcessSession *session) {
+    triggers_++;
+    if (hasIncomingConnections()) {
+      auto flow_file = session->get();
+      if (flow_file != nullptr) {
+        session->remove(flow_file);
+      }
+    } else if (triggers_ == yield_after_) {
+      yield(60000);
+    }
+  }
+
+  int triggers_;
+  int yield_after_;
+};
+
+struct Fixture {
+  Fixture()
+      : content_repo_(std::make_shared<core::repository::VolatileContentRepository>()),
+        repo_(std::make_shared<TestRepository>()),
+        processor_(std::make_shared<CountingProcessor>("counter")) {
+    content_repo_->initialize(std::make_shared<minifi::Configure>());
+    processor_->initialize();
+  }
+
+  void loop() {
+    connection_ = std::make_shared<minifi::Connection>(repo_, content_repo_, "loop");
+    connection_->addRelationship(Success);
+    connection_->setSource(processor_);
+    connection_->setDestination(processor_);
+    utils::Identifier uuid;
+    processor_->getUUID(uuid);
+    connection_->setSourceUUID(uuid);
+    connection_->setDestinationUUID(uuid);
+    processor_->addConnection(connection_);
+  }
+
+  void schedule() {
+    auto node = std::make_shared<core::ProcessorNode>(processor_);
+    std::shared_ptr<core::controller::ControllerServiceProvider> controller_services_provider = nullptr;
+    context_ = std::make_shared<core::ProcessContext>(node, controller_services_provider, repo_, repo_, content_repo_);
+    factory_ = std::make_shared<core::ProcessSessionFactory>(context_);
+    processor_->setScheduledState(core::ScheduledState::RUNNING);
+    processor_->incrementActiveTasks();
+  }
+
+  std::shared_ptr<core::ContentRepository> content_repo_;
+  std::shared_ptr<core::Repository> repo_;
+  std::shared_ptr<CountingProcessor> processor_;
+  std::shared_ptr<minifi::Connection> connection_;
+  std::shared_ptr<core::ProcessContext> context_;
+  std::shared_ptr<core::ProcessSessionFactory> factory_;
+};
+
+}  // namespace
+
+TEST_CASE("Processors trigger once without a run duration", "[RunDuration1]") {
+  TestController testController;
+  Fixture fixture;
+  fixture.schedule();
+  fixture.processor_->onTrigger(fixture.context_, fixture.factory_);
+  REQUIRE(fixture.processor_->triggers_ == 1);
+}
+
+TEST_CASE("Processors trigger until they yield within the run duration", "[RunDuration2]") {
+  TestController testController;
+  Fixture fixture;
+  fixture.schedule();
+  fixture.processor_->setRunDurationNano(60000000000);
+  fixture.processor_->yield_after_ = 5;
+  fixture.processor_->onTrigger(fixture.context_, fixture.factory_);
+  REQUIRE(fixture.processor_->triggers_ == 5);
+}
+
+TEST_CASE("Processors trigger until their queues are empty within the run duration", "[RunDuration3]") {
+  TestController testController;
+  Fixture fixture;
+  fixture.loop();
+  fixture.schedule();
+  {
+    core::ProcessSession session(fixture.context_);
+    for (int i = 0; i < 3; i++) {
+      session.transfer(session.create(), Success);
+    }
+    session.commit();
+  }
+  REQUIRE(fixture.connection_->getQueueSize() == 3);
+
+  fixture.processor_->setRunDurationNano(60000000000);
+  fixture.processor_->onTrigger(fixture.context_, fixture.factory_);
+  REQUIRE(fixture.processor_->triggers_ == 3);
+  REQUIRE(fixture.connection_->getQueueSize() == 0);
+}
@@ -24,6 +24,9 @@
 
 #include "../TestBase.h"
 #include "../unit/SiteToSiteHelper.h"
+#include "io/CompactEncoding.h"
+#include "FlowFileRecord.h"
+#include "core/repository/VolatileContentRepository.h"
 #define FMT_DEFAULT fmt_lower
 
 TEST_CASE("TestWriteUTF", "[MINIFI193]") {
@@ -70,3 +73,95 @@ TEST_CASE("TestWriteUTF3", "[MINIFI193]") {
   REQUIRE(verifyString == stringOne);
 }
 
+
+TEST_CASE("TestCompactEncoding", "[compact]") {
+  const uint64_t values[] = { 0, 1, 127, 128, 16383, 16384, 1546300800000, UINT64_MAX };
+  size_t size = 0;
+  for (const auto value : values) {
+    size += org::apache::nifi::minifi::io::CompactWriter::varintSize(value);
+  }
+  std::string text = "hello world";
+  size += org::apache::nifi::minifi::io::CompactWriter::stringSize(text);
+  REQUIRE(27 + text.length() == size);
+
+  std::vector<uint8_t> buffer(size);
+  org::apache::nifi::minifi::io::CompactWriter writer(buffer.data(), buffer.size());
+  for (const auto value : values) {
+    writer.writeVarint(value);
+  }
+  writer.writeString(text);
+  REQUIRE(writer.complete());
+  writer.writeByte(0);
+  REQUIRE(!writer.ok());
+
+  org::apache::nifi::minifi::io::CompactReader reader(buffer.data(), buffer.size());
+  for (const auto value : values) {
+    uint64_t read_value;
+    REQUIRE(reader.readVarint(read_value));
+    REQUIRE(value == read_value);
+  }
+  std::string read_text;
+  REQUIRE(reader.readString(read_text));
+  REQUIRE(text == read_text);
+  uint8_t byte;
+  REQUIRE(!reader.readByte(byte));
+}
+
+TEST_CASE("TestCompactFlowFileRecord", "[compact]") {
+  std::shared_ptr<org::apache::nifi::minifi::core::ContentRepository> content_repo = std::make_shared<org::apache::nifi::minifi::core::repository::VolatileContentRepository>();
+  org::apache::nifi::minifi::FlowFileRecord record(nullptr, content_repo);
+  record.addAttribute("filename", "data.txt");
+  record.addAttribute("custom", "value");
+  record.addAttribute("empty", "");
+  record.setSize(1024);
+  record.setOffset(42);
+  record.setUuidConnection("4a2b6c8e-1f3d-4e5a-8b7c-9d0e1f2a3b4c");
+
+  org::apache::nifi::minifi::io::DataStream stream;
+  REQUIRE(record.Serialize(stream));
+  REQUIRE(0xFF == stream.getBuffer()[0]);
+
+  org::apache::nifi::minifi::FlowFileRecord read_record(nullptr, content_repo);
+  REQUIRE(read_record.DeSerialize(stream));
+  REQUIRE(record.getUUIDStr() == read_record.getUUIDStr());
+  REQUIRE(record.getConnectionUuid() == read_record.getConnectionUuid());
+  REQUIRE(record.getEntryDate() == read_record.getEntryDate());
+  REQUIRE(record.getEventTime() == read_record.getEventTime());
+  REQUIRE(record.getlineageStartDate() == read_record.getlineageStartDate());
+  REQUIRE(1024 == read_record.getSize());
+  REQUIRE(42 == read_record.getOffset());
+  REQUIRE(record.getAttributes() == read_record.getAttributes());
+
+  // a truncated record is rejected rather than read past its end
+  org::apache::nifi::minifi::FlowFileRecord truncated(nullptr, content_repo);
+  REQUIRE(!truncated.DeSerialize(stream.getBuffer(), stream.getSize() - 1));
+}
+
+TEST_CASE("TestLegacyFlowFileRecord", "[compact]") {
+  org::apache::nifi::minifi::io::DataStream stream;
+  org::apache::nifi::minifi::io::Serializable ser;
+  const uint64_t event_time = 1546300800000;
+  ser.write(event_time, &stream);
+  ser.write(event_time, &stream);
+  ser.write(event_time, &stream);
+  ser.writeUTF("4a2b6c8e-1f3d-4e5a-8b7c-9d0e1f2a3b4c", &stream);
+  ser.writeUTF("connection", &stream);
+  ser.write(static_cast<uint32_t>(1), &stream);
+  ser.writeUTF("filename", &stream, true);
+  ser.writeUTF("data.txt", &stream, true);
+  ser.writeUTF("/tmp/content", &stream);
+  ser.write(static_cast<uint64_t>(1024), &stream);
+  ser.write(static_cast<uint64_t>(0), &stream);
+
+  std::shared_ptr<org::apache::nifi::minifi::core::ContentRepository> content_repo = std::make_shared<org::apache::nifi::minifi::core::repository::VolatileContentRepository>();
+  org::apache::nifi::minifi::FlowFileRecord record(nullptr, content_repo);
+  REQUIRE(record.DeSerialize(stream));
+  REQUIRE("4a2b6c8e-1f3d-4e5a-8b7c-9d0e1f2a3b4c" == record.getUUIDStr());
+  REQUIRE("connection" == record.getConnectionUuid());
+  REQUIRE(event_time == record.getEventTime());
+  REQUIRE("/tmp/content" == record.getContentFullPath());
+  REQUIRE(1024 == record.getSize());
+  std::string filename;
+  REQUIRE(record.getAttribute("filename", filename));
+  REQUIRE("data.txt" == filename);
+}
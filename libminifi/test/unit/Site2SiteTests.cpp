@@ -21,6 +21,7 @@
 #include <memory>
 #include <utility>
 #include <map>
+#include <vector>
 #include "io/BaseStream.h"
 #include "sitetosite/Peer.h"
 #include "sitetosite/RawSocketProtocol.h"
@@ -177,3 +178,97 @@ TEST_CASE("TestSiteToSiteVerifyNegotiationFail", "[S2S4]") {
 
   REQUIRE(false == protocol.bootstrap());
 }
+
+TEST_CASE("TestSiteToSitePeerCork", "[S2S5]") {
+  SiteToSiteResponder *collector = new SiteToSiteResponder();
+  minifi::sitetosite::SiteToSitePeer peer(std::unique_ptr<minifi::io::DataStream>(new org::apache::nifi::minifi::io::BaseStream(collector)), "fake_host", 65433, "");
+
+  peer.cork();
+  REQUIRE(peer.write(static_cast<uint32_t>(5)) == 4);
+  REQUIRE(peer.writeUTF("hello") > 0);
+  REQUIRE_FALSE(collector->has_next_client_response());
+
+  // a read sends what was buffered first
+  collector->push_response("R");
+  uint8_t code;
+  REQUIRE(peer.read(code) == 1);
+  REQUIRE(code == 'R');
+  REQUIRE(collector->get_next_client_response().size() == 11);
+  REQUIRE_FALSE(collector->has_next_client_response());
+
+  // large blocks are not buffered
+  REQUIRE(peer.write(static_cast<uint16_t>(1)) == 2);
+  std::vector<uint8_t> block(minifi::sitetosite::SiteToSitePeer::WRITE_BUFFER_SIZE, 'x');
+  REQUIRE(peer.write(block.data(), block.size()) == static_cast<int>(block.size()));
+  REQUIRE(collector->get_next_client_response().size() == 2);
+  REQUIRE(collector->get_next_client_response().size() == block.size());
+
+  REQUIRE(peer.write(static_cast<uint16_t>(1)) == 2);
+  REQUIRE_FALSE(collector->has_next_client_response());
+  REQUIRE(peer.uncork() == 0);
+  REQUIRE(collector->get_next_client_response().size() == 2);
+
+  REQUIRE(peer.write(static_cast<uint16_t>(1)) == 2);
+  REQUIRE(collector->get_next_client_response().size() == 2);
+}
+
+TEST_CASE("TestPeerSelectorWeighsByLoad", "[S2S6]") {
+  auto peer = std::make_shared<minifi::sitetosite::Peer>("fake_host", 65433);
+  minifi::sitetosite::PeerSelector selector;
+  REQUIRE(selector.next() == -1);
+
+  std::vector<minifi::sitetosite::PeerStatus> idle;
+  idle.push_back(minifi::sitetosite::PeerStatus(peer, 0, false));
+  idle.push_back(minifi::sitetosite::PeerStatus(peer, 0, false));
+  idle.push_back(minifi::sitetosite::PeerStatus(peer, 0, false));
+  selector.update(idle);
+  for (int i = 0; i < 6; i++) {
+    REQUIRE(selector.next() == i % 3);
+  }
+
+  std::vector<minifi::sitetosite::PeerStatus> loaded;
+  loaded.push_back(minifi::sitetosite::PeerStatus(peer, 900, false));
+  loaded.push_back(minifi::sitetosite::PeerStatus(peer, 100, false));
+  selector.update(loaded);
+  std::vector<int> picks(2, 0);
+  for (int i = 0; i < 102; i++) {
+    picks[selector.next()]++;
+  }
+  // weights are 1 + 10 and 1 + 90
+  REQUIRE(picks[0] == 11);
+  REQUIRE(picks[1] == 91);
+}
+
+TEST_CASE("TestSiteToSitePeerCompression", "[S2S7]") {
+  minifi::sitetosite::SiteToSitePeer peer(std::unique_ptr<minifi::io::DataStream>(new minifi::io::DataStream()), "fake_host", 65433, "");
+
+  std::string content;
+  for (int i = 0; content.size() < 3 * minifi::sitetosite::SiteToSitePeer::COMPRESSION_CHUNK_SIZE; i++) {
+    content += "record " + std::to_string(i) + "\n";
+  }
+  peer.beginCompression();
+  REQUIRE(peer.write(static_cast<uint32_t>(content.size())) == 4);
+  for (size_t offset = 0; offset < content.size(); offset += 1000) {
+    int len = std::min<size_t>(1000, content.size() - offset);
+    REQUIRE(peer.write(reinterpret_cast<uint8_t*>(&content[offset]), len) == len);
+  }
+  REQUIRE(peer.endCompression() == 0);
+  // not part of the compressed packet
+  REQUIRE(peer.write(static_cast<uint8_t>('X')) == 1);
+
+  auto stream = peer.getStream();
+  REQUIRE(stream->getSize() < content.size() / 2);
+  REQUIRE(std::string(reinterpret_cast<const char*>(stream->getBuffer()), 4) == "SYNC");
+
+  peer.beginDecompression();
+  uint8_t size[4];
+  REQUIRE(peer.read(size, 4) == 4);
+  REQUIRE(((size[0] << 24) | (size[1] << 16) | (size[2] << 8) | size[3]) == static_cast<int>(content.size()));
+  std::string received(content.size(), '\0');
+  REQUIRE(peer.read(reinterpret_cast<uint8_t*>(&received[0]), received.size()) == static_cast<int>(received.size()));
+  REQUIRE(received == content);
+
+  uint8_t marker;
+  REQUIRE(peer.read(marker) == 1);
+  REQUIRE(marker == 'X');
+}
@@ -0,0 +1,171 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../TestBase.h"
+#include "ResourceClaim.h"
+#include "core/Core.h"
+#include "core/repository/SlabContentRepository.h"
+#include "properties/Configure.h"
+
+namespace {
+
+std::shared_ptr<core::repository::SlabContentRepository> createRepository(const std::string &dir, const std::string &segment_size = "1 MB",
+                                                                          const std::string &max_claim_size = "64 KB") {
+  auto configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_directory_default, dir);
+  configuration->set(minifi::Configure::nifi_content_repository_slab_segment_size, segment_size);
+  configuration->set(minifi::Configure::nifi_content_repository_slab_max_claim_size, max_claim_size);
+  auto repository = std::make_shared<core::repository::SlabContentRepository>();
+  REQUIRE(repository->initialize(configuration));
+  return repository;
+}
+
+void writeClaim(const std::shared_ptr<core::ContentRepository> &repository, const std::shared_ptr<minifi::ResourceClaim> &claim, const std::string &content,
+                bool append = false) {
+  auto stream = repository->write(claim, append);
+  REQUIRE(stream != nullptr);
+  REQUIRE(stream->writeData(reinterpret_cast<uint8_t *>(const_cast<char *>(content.data())), content.size()) == static_cast<int>(content.size()));
+  stream->closeStream();
+}
+
+std::string readClaim(const std::shared_ptr<core::ContentRepository> &repository, const std::shared_ptr<minifi::ResourceClaim> &claim) {
+  auto stream = repository->read(claim);
+  std::vector<uint8_t> buffer;
+  int ret = stream->readData(buffer, stream->getSize());
+  REQUIRE(ret == static_cast<int>(stream->getSize()));
+  return std::string(buffer.begin(), buffer.end());
+}
+
+}  // namespace
+
+TEST_CASE("SlabContentRepository writes claims into one segment", "[SlabRepository1]") {
+  TestController testController;
+  char format[] = "/tmp/testRepo.XXXXXX";
+  auto dir = std::string(testController.createTempDirectory(format));
+  auto repository = createRepository(dir);
+
+  std::vector<std::shared_ptr<minifi::ResourceClaim>> claims;
+  for (int i = 0; i < 100; i++) {
+    auto claim = std::make_shared<minifi::ResourceClaim>(dir + "/claim" + std::to_string(i), repository);
+    writeClaim(repository, claim, "content " + std::to_string(i));
+    claims.push_back(claim);
+  }
+  REQUIRE(repository->getSegmentCount() == 1);
+  for (int i = 0; i < 100; i++) {
+    REQUIRE(repository->exists(claims[i]));
+    REQUIRE(readClaim(repository, claims[i]) == "content " + std::to_string(i));
+    // nothing is written to the claim's own path
+    REQUIRE_FALSE(std::ifstream(claims[i]->getContentFullPath()).good());
+  }
+
+  writeClaim(repository, claims[0], " appended", true);
+  REQUIRE(readClaim(repository, claims[0]) == "content 0 appended");
+
+  REQUIRE(repository->remove(claims[1]));
+  REQUIRE_FALSE(repository->exists(claims[1]));
+}
+
+TEST_CASE("SlabContentRepository rebuilds its index on initialize", "[SlabRepository2]") {
+  TestController testController;
+  char format[] = "/tmp/testRepo.XXXXXX";
+  auto dir = std::string(testController.createTempDirectory(format));
+  auto first = std::make_shared<minifi::ResourceClaim>(dir + "/first", nullptr);
+  auto second = std::make_shared<minifi::ResourceClaim>(dir + "/second", nullptr);
+  auto third = std::make_shared<minifi::ResourceClaim>(dir + "/third", nullptr);
+  {
+    auto repository = createRepository(dir);
+    writeClaim(repository, first, "one");
+    writeClaim(repository, second, "two");
+    writeClaim(repository, third, "three");
+    writeClaim(repository, first, "uno");
+    repository->remove(second);
+  }
+
+  auto repository = createRepository(dir);
+  REQUIRE(readClaim(repository, first) == "uno");
+  REQUIRE_FALSE(repository->exists(second));
+  REQUIRE(readClaim(repository, third) == "three");
+}
+
+TEST_CASE("SlabContentRepository deletes segments without live claims", "[SlabRepository3]") {
+  TestController testController;
+  char format[] = "/tmp/testRepo.XXXXXX";
+  auto dir = std::string(testController.createTempDirectory(format));
+  auto repository = createRepository(dir, "1 KB");
+
+  std::string content(400, 'x');
+  std::vector<std::shared_ptr<minifi::ResourceClaim>> claims;
+  for (int i = 0; i < 10; i++) {
+    auto claim = std::make_shared<minifi::ResourceClaim>(dir + "/claim" + std::to_string(i), repository);
+    writeClaim(repository, claim, content);
+    claims.push_back(claim);
+  }
+  REQUIRE(repository->getSegmentCount() > 2);
+  for (const auto &claim : claims) {
+    repository->remove(claim);
+  }
+  // only the active segment, holding the last tombstones, remains
+  REQUIRE(repository->getSegmentCount() == 1);
+
+  auto restarted = createRepository(dir, "1 KB");
+  for (const auto &claim : claims) {
+    REQUIRE_FALSE(restarted->exists(claim));
+  }
+}
+
+TEST_CASE("SlabContentRepository spills large claims to files", "[SlabRepository4]") {
+  TestController testController;
+  char format[] = "/tmp/testRepo.XXXXXX";
+  auto dir = std::string(testController.createTempDirectory(format));
+  auto repository = createRepository(dir, "1 MB", "16 B");
+  auto claim = std::make_shared<minifi::ResourceClaim>(dir + "/large", repository);
+
+  writeClaim(repository, claim, "small");
+  writeClaim(repository, claim, "content beyond the max claim size");
+  REQUIRE(std::ifstream(claim->getContentFullPath()).good());
+  REQUIRE(readClaim(repository, claim) == "content beyond the max claim size");
+
+  auto restarted = createRepository(dir, "1 MB", "16 B");
+  REQUIRE(readClaim(restarted, claim) == "content beyond the max claim size");
+  REQUIRE(restarted->remove(claim));
+  REQUIRE_FALSE(std::ifstream(claim->getContentFullPath()).good());
+}
+
+TEST_CASE("SlabContentRepository memory maps claims", "[SlabRepository5]") {
+  TestController testController;
+  char format[] = "/tmp/testRepo.XXXXXX";
+  auto dir = std::string(testController.createTempDirectory(format));
+  auto repository = createRepository(dir);
+  auto claim = std::make_shared<minifi::ResourceClaim>(dir + "/mapped", repository);
+
+  writeClaim(repository, claim, "padding");
+  {
+    auto mm = repository->mmap(claim, 11, false);
+    REQUIRE(mm->getSize() == 11);
+    std::memcpy(mm->getData(), "write test", 11);
+  }
+  REQUIRE(readClaim(repository, claim) == std::string("write test", 11));
+
+  auto mm = repository->mmap(claim, 10, true);
+  REQUIRE(mm->getSize() == 10);
+  REQUIRE(std::string(reinterpret_cast<const char *>(mm->getData()), 10) == "write test");
+}
@@ -19,6 +19,9 @@
 #include <utility>
 #include <future>
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 #include "../TestBase.h"
 #include "utils/ThreadPool.h"
 
@@ -95,3 +98,103 @@ TEST_CASE("ThreadPoolTest2", "[TPT2]") {
   fut.wait();
   REQUIRE(20 == fut.get());
 }
+
+TEST_CASE("ThreadPoolWorkStealing", "[TPT3]") {
+  counter = 0;
+  utils::ThreadPool<int> pool(4);
+  pool.setWorkStealing(true);
+  pool.start();
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 8; i++) {
+    std::function<int()> f_ex = counterFunction;
+    std::unique_ptr<utils::AfterExecute<int>> after_execute = std::unique_ptr<utils::AfterExecute<int>>(new WorkerNumberExecutions(5));
+    utils::Worker<int> functor(f_ex, "id" + std::to_string(i), std::move(after_execute));
+    std::future<int> fut;
+    REQUIRE(true == pool.execute(std::move(functor), fut));
+    futures.push_back(std::move(fut));
+  }
+  for (auto &fut : futures) {
+    REQUIRE(std::future_status::ready == fut.wait_for(std::chrono::seconds(10)));
+  }
+  REQUIRE(40 == counter);
+}
+
+TEST_CASE("ThreadPoolWorkStealingStopTasks", "[TPT4]") {
+  counter = 0;
+  utils::ThreadPool<int> pool(2);
+  pool.setWorkStealing(true);
+  pool.start();
+  std::function<int()> f_ex = counterFunction;
+  std::unique_ptr<utils::AfterExecute<int>> after_execute = std::unique_ptr<utils::AfterExecute<int>>(new WorkerNumberExecutions(1000000));
+  utils::Worker<int> functor(f_ex, "id", std::move(after_execute));
+  std::future<int> fut;
+  REQUIRE(true == pool.execute(std::move(functor), fut));
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  REQUIRE(pool.isRunning("id"));
+  pool.stopTasks("id");
+  REQUIRE(!pool.isRunning("id"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  int runs = counter;
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  REQUIRE(runs == counter);
+}
+
+class ParkingWorker : public utils::AfterExecute<int> {
+ public:
+  virtual bool isFinished(const int &result) {
+    return result >= 3;
+  }
+  virtual bool isCancelled(const int &result) {
+    return false;
+  }
+  virtual int64_t wait_time() {
+    return 0;
+  }
+  virtual bool isParked(const int &result) {
+    return true;
+  }
+};
+
+TEST_CASE("ThreadPoolParkAndWake", "[TPT5]") {
+  counter = 0;
+  utils::ThreadPool<int> pool(2);
+  pool.setWorkStealing(true);
+  pool.setParkTimeout(60000);
+  pool.start();
+  std::function<int()> f_ex = counterFunction;
+  std::unique_ptr<utils::AfterExecute<int>> after_execute = std::unique_ptr<utils::AfterExecute<int>>(new ParkingWorker());
+  utils::Worker<int> functor(f_ex, "id", std::move(after_execute));
+  std::future<int> fut;
+  REQUIRE(true == pool.execute(std::move(functor), fut));
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  // parked after the first run, despite a wait time of 0
+  REQUIRE(1 == counter);
+  pool.wake("id");
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  REQUIRE(2 == counter);
+  pool.wake("id");
+  REQUIRE(std::future_status::ready == fut.wait_for(std::chrono::seconds(10)));
+  REQUIRE(3 == fut.get());
+}
+
+TEST_CASE("ThreadPoolStaleParkTimeout", "[TPT6]") {
+  counter = 0;
+  utils::ThreadPool<int> pool(2);
+  pool.setWorkStealing(true);
+  pool.setParkTimeout(1000);
+  pool.start();
+  std::function<int()> f_ex = counterFunction;
+  std::unique_ptr<utils::AfterExecute<int>> after_execute = std::unique_ptr<utils::AfterExecute<int>>(new ParkingWorker());
+  utils::Worker<int> functor(f_ex, "id", std::move(after_execute));
+  std::future<int> fut;
+  REQUIRE(true == pool.execute(std::move(functor), fut));
+  std::this_thread::sleep_for(std::chrono::milliseconds(600));
+  REQUIRE(1 == counter);
+  // parks again right after the wake up, with a timeout of its own
+  pool.wake("id");
+  std::this_thread::sleep_for(std::chrono::milliseconds(700));
+  // the timeout armed by the first park fired meanwhile and must not requeue the task
+  REQUIRE(2 == counter);
+  REQUIRE(std::future_status::ready == fut.wait_for(std::chrono::seconds(10)));
+  REQUIRE(3 == fut.get());
+}
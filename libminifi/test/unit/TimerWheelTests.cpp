@@ -0,0 +1,66 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <limits>
+#include <vector>
+#include "../TestBase.h"
+#include "utils/TimerWheel.h"
+
+TEST_CASE("TimerWheelExpiresInOrder", "[TW1]") {
+  utils::TimerWheel<int> wheel(1, 16);
+  uint64_t now = 100000;
+  wheel.schedule(now + 5, 5);
+  wheel.schedule(now + 1, 1);
+  wheel.schedule(now + 40, 40);
+  REQUIRE(3 == wheel.size());
+  REQUIRE(now + 1 == wheel.getNextDeadline());
+
+  std::vector<int> expired;
+  REQUIRE(0 == wheel.advance(now, expired));
+  REQUIRE(1 == wheel.advance(now + 2, expired));
+  REQUIRE(1 == expired.at(0));
+  REQUIRE(now + 5 == wheel.getNextDeadline());
+
+  // a revolution is 16 ticks, the item 40 ms out must survive the passes over its slot
+  expired.clear();
+  REQUIRE(1 == wheel.advance(now + 20, expired));
+  REQUIRE(5 == expired.at(0));
+  expired.clear();
+  REQUIRE(0 == wheel.advance(now + 39, expired));
+  REQUIRE(1 == wheel.advance(now + 40, expired));
+  REQUIRE(40 == expired.at(0));
+  REQUIRE(wheel.empty());
+  REQUIRE(std::numeric_limits<uint64_t>::max() == wheel.getNextDeadline());
+}
+
+TEST_CASE("TimerWheelPastDeadline", "[TW2]") {
+  utils::TimerWheel<int> wheel(10, 8);
+  uint64_t now = 100000;
+  std::vector<int> expired;
+  wheel.advance(now, expired);
+  wheel.schedule(now - 500, 1);
+  wheel.schedule(now + 1000, 2);
+  REQUIRE(now - 500 == wheel.getNextDeadline());
+  // the past deadline sits in the next tick's slot; advancing within the current tick does not reach it
+  REQUIRE(0 == wheel.advance(now + 5, expired));
+  REQUIRE(1 == wheel.advance(now + 10, expired));
+  REQUIRE(1 == expired.at(0));
+  expired.clear();
+  REQUIRE(1 == wheel.advance(now + 5000, expired));
+  REQUIRE(2 == expired.at(0));
+}
@@ -0,0 +1,101 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+#include "../TestBase.h"
+#include "core/repository/VolatileProvenanceRepository.h"
+#include "properties/Configure.h"
+
+namespace {
+
+std::shared_ptr<core::repository::VolatileProvenanceRepository> createRepository(const std::string &max_count) {
+  auto configuration = std::make_shared<minifi::Configure>();
+  configuration->set(std::string(minifi::Configure::nifi_volatile_repository_options) + "volatile.max.count", max_count);
+  configuration->set(std::string(minifi::Configure::nifi_volatile_repository_options) + "volatile.max.bytes", "0");
+  auto repository = std::make_shared<core::repository::VolatileProvenanceRepository>("volatile");
+  REQUIRE(repository->initialize(configuration));
+  return repository;
+}
+
+bool put(const std::shared_ptr<core::repository::VolatileProvenanceRepository> &repository, const std::string &key, const std::string &value) {
+  return repository->Put(key, reinterpret_cast<const uint8_t *>(value.data()), value.size());
+}
+
+}  // namespace
+
+TEST_CASE("VolatileRepository holds more than 65535 entries", "[VolatileRepository1]") {
+  auto repository = createRepository("70000");
+  for (int i = 0; i < 70000; i++) {
+    REQUIRE(put(repository, "key" + std::to_string(i), "value" + std::to_string(i)));
+  }
+  for (int i = 69999; i >= 0; i -= 7) {
+    std::string value;
+    REQUIRE(repository->Get("key" + std::to_string(i), value));
+    REQUIRE(value == "value" + std::to_string(i));
+    REQUIRE_FALSE(repository->Get("key" + std::to_string(i), value));
+  }
+  REQUIRE(repository->Delete("key1"));
+  REQUIRE_FALSE(repository->Delete("key1"));
+}
+
+TEST_CASE("VolatileRepository reuses freed slots before evicting", "[VolatileRepository2]") {
+  auto repository = createRepository("4");
+  for (int i = 0; i < 4; i++) {
+    REQUIRE(put(repository, "key" + std::to_string(i), "value"));
+  }
+  REQUIRE(repository->Delete("key1"));
+  REQUIRE(put(repository, "key4", "value"));
+  // replacing a key keeps its slot
+  REQUIRE(put(repository, "key4", "replaced"));
+
+  std::string value;
+  for (int i : { 0, 2, 3 }) {
+    REQUIRE(repository->Get("key" + std::to_string(i), value));
+  }
+  value.clear();
+  REQUIRE(repository->Get("key4", value));
+  REQUIRE(value == "replaced");
+  REQUIRE(repository->getRepoSize() == 0);
+}
+
+TEST_CASE("VolatileRepository evicts once full", "[VolatileRepository3]") {
+  auto repository = createRepository("4");
+  for (int i = 0; i < 5; i++) {
+    REQUIRE(put(repository, "key" + std::to_string(i), "value"));
+  }
+  std::string value;
+  REQUIRE_FALSE(repository->Get("key0", value));
+  for (int i = 1; i < 5; i++) {
+    REQUIRE(repository->Get("key" + std::to_string(i), value));
+  }
+}
+
+TEST_CASE("VolatileRepository accounts allocator size classes", "[VolatileRepository4]") {
+  using core::repository::VolatileProvenanceRepository;
+  REQUIRE(VolatileProvenanceRepository::getAccountedSize(0) == 0);
+  REQUIRE(VolatileProvenanceRepository::getAccountedSize(1) == 16);
+  REQUIRE(VolatileProvenanceRepository::getAccountedSize(128) == 128);
+  REQUIRE(VolatileProvenanceRepository::getAccountedSize(129) == 160);
+  REQUIRE(VolatileProvenanceRepository::getAccountedSize(257) == 320);
+  REQUIRE(VolatileProvenanceRepository::getAccountedSize(4096) == 4096);
+
+  auto repository = createRepository("4");
+  REQUIRE(put(repository, "key", std::string(129, 'x')));
+  REQUIRE(repository->getRepoSize() == 160);
+}